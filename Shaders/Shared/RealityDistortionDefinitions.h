@@ -0,0 +1,75 @@
+// RealityDistortionDefinitions.h
+// Constants shared between C++ (RealityDistortion module) and HLSL (RealityDistortionCommon.ush).
+// Keep this file free of anything that is not valid in both languages.
+
+#pragma once
+
+// Capacity of the per-frame field buffer. Registry slots beyond this are not uploaded.
+#define REALITY_DISTORTION_MAX_FIELDS 64
+
+// Per-draw relevant-field mask width, in 32-bit words (bit i = field slot i).
+// Must cover REALITY_DISTORTION_MAX_FIELDS.
+#define REALITY_DISTORTION_FIELD_MASK_WORDS 2
+
+// Number of float4 elements per packed field record in the field structured buffer.
+//   [0] xyz = world center, w = bounding-sphere radius (<= 0 means the slot is disabled)
+//   [1] x = strength, y = shape (REALITY_DISTORTION_FIELD_SHAPE_*), zw = reserved
+//   [2] local-to-world rotation quaternion (xyz, w)
+//   [3] xyz = shape extent, w = 1 / falloff distance (unused by spheres)
+#define REALITY_DISTORTION_FIELD_STRIDE 4
+
+// Field shapes. Capsule and cylinder axes are local Z; influence falls off from 1 on the medial
+// axis / plane to 0 on the surface (see RD_CalculateShapedFieldInfluence).
+#define REALITY_DISTORTION_FIELD_SHAPE_SPHERE 0		// Radius = bounding-sphere radius, Extent unused
+#define REALITY_DISTORTION_FIELD_SHAPE_BOX 1		// Extent = half size
+#define REALITY_DISTORTION_FIELD_SHAPE_CAPSULE 2	// Extent.x = radius, Extent.z = half length of the segment between the cap centers
+#define REALITY_DISTORTION_FIELD_SHAPE_CYLINDER 3	// Extent.x = radius, Extent.z = half height
+
+// Thread group size (per axis) of the screen-tile field binning compute shader.
+// One thread bins every field into one screen tile.
+#define REALITY_DISTORTION_TILE_BINNING_GROUP_SIZE 8
+
+// Clip-space w below which a bounding-box corner counts as behind the near plane during tile binning.
+#define REALITY_DISTORTION_TILE_MIN_CLIP_W 0.0001f
+
+// Views binned per view family (split screen, stereo). Further views are not tile filtered.
+#define REALITY_DISTORTION_MAX_TILE_VIEWS 4
+
+// Tolerances used to match the view being rendered against its binned record (see RD_FindTileViewGrid).
+#define REALITY_DISTORTION_TILE_VIEW_ORIGIN_TOLERANCE 1.0f				// World units per axis
+#define REALITY_DISTORTION_TILE_VIEW_MIN_FORWARD_DOT 0.99999f
+#define REALITY_DISTORTION_TILE_VIEW_PROJECTION_TOLERANCE 0.001f		// Relative to the projection scale
+
+// A pixel is cut out of the receiver (and filled by the RealityDistortion pass) where the max field
+// influence exceeds this value. Every receiver clip must use it.
+#define REALITY_DISTORTION_INFLUENCE_CLIP_THRESHOLD 0.001f
+
+// Falloff fraction T at which the smoothstep falloff reaches the clip threshold:
+// 0.5 - sin(asin(1 - 2 * REALITY_DISTORTION_INFLUENCE_CLIP_THRESHOLD) / 3). Update both together.
+#define REALITY_DISTORTION_INFLUENCE_CLIP_FALLOFF_FRACTION 0.0183702539f
+
+// Thread group size (per axis) of the influence clipmap update compute shader.
+#define REALITY_DISTORTION_CLIPMAP_GROUP_SIZE 4
+
+// The clipmap stores the clip distance (see RD_CalculateFieldClipDistance) clamped to this many voxels.
+// Must stay above REALITY_DISTORTION_CLIPMAP_CLIP_MARGIN so the early-out still sees "far outside".
+// The clamp also keeps each field local: its clip distance is at least |P - C| - Radius, so beyond
+// Radius + clamp it stores the clamp before and after any change, and the dirty regions only need to
+// cover that sphere (see CollectRealityDistortionDirtyFieldRegions).
+#define REALITY_DISTORTION_CLIPMAP_MAX_CLIP_DISTANCE_VOXELS 4.0f
+
+// Clip distance margin, in voxels, beyond which a trilinear clipmap sample decides the clip on its own:
+// each of the 8 filtered voxel centers is at most sqrt(3) voxels from the pixel, and the clip distance
+// is 1-Lipschitz. The rest covers filtering and half float precision.
+#define REALITY_DISTORTION_CLIPMAP_CLIP_MARGIN 1.75f
+
+// Voronoi fracture quality tiers (r.RealityDistortion.VoronoiQuality, scalable through sg.EffectsQuality).
+#define REALITY_DISTORTION_VORONOI_QUALITY_NOISE_TEXTURE 0	// One fetch from the tileable cellular-noise texture
+#define REALITY_DISTORTION_VORONOI_QUALITY_FAST 1			// Integer hash, 2x2x2 search around the nearest cell corner
+#define REALITY_DISTORTION_VORONOI_QUALITY_HIGH 2			// Integer hash, full 3x3x3 search
+#define REALITY_DISTORTION_VORONOI_QUALITY_REFERENCE 3		// Original sin hash, full 3x3x3 search
+
+// Tileable cellular-noise texture: repeats every PERIOD cells per axis, TEXELS_PER_CELL texels per cell.
+// Each texel stores (F1, F2) of the integer-hash Voronoi at its center with cell coordinates wrapped by PERIOD.
+#define REALITY_DISTORTION_VORONOI_TEXTURE_PERIOD 8
+#define REALITY_DISTORTION_VORONOI_TEXTURE_TEXELS_PER_CELL 8
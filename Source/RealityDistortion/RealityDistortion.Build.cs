@@ -38,6 +38,9 @@ public class RealityDistortion : ModuleRules
 			EngineDirectory, "Source", "Runtime", "Renderer", "Internal");
 		PublicIncludePaths.Add(RendererInternalPath);
 
+		// C++ 与 HLSL 共用的常量头文件（Shaders/Shared），保证两侧容量等定义只有一份。
+		PublicIncludePaths.Add(System.IO.Path.Combine(ModuleDirectory, "..", "..", "Shaders", "Shared"));
+
 		PublicIncludePaths.AddRange(new string[] {
 			"RealityDistortion",
 			"RealityDistortion/Rendering",  // Phase 1: 自定义渲染组件
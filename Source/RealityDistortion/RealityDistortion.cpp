@@ -4,8 +4,15 @@
 #include "Modules/ModuleManager.h"
 #include "Interfaces/IPluginManager.h"
 #include "ShaderCore.h"
-#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
 #include "RealityDistortionField.h"
+#include "Rendering/RealityDistortionPassProcessor.h"
+#include "Rendering/RealityDistortionViewExtension.h"
+#include "UObject/UObjectGlobals.h"
+#if WITH_EDITOR
+#include "Materials/Material.h"
+#endif
+#include "SceneViewExtension.h"
 
 DEFINE_LOG_CATEGORY(LogRealityDistortion)
 
@@ -21,20 +28,51 @@ public:
 		// Clear RT-side leftover fields after PIE/hot-reload.
 		ResetRealityDistortionFields_GameThread();
 
-		// Keep BasePass depth writes enabled even with full prepass so receiver meshes
-		// still write depth outside field coverage when depth pass submission is disabled.
-		if (IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(TEXT("r.BasePassWriteDepthEvenWithFullPrepass")))
+		// SceneViewExtension 依赖 GEngine，模块在 PostConfigInit 加载，因此推迟到引擎初始化完成后再创建。
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FRealityDistortionModule::OnPostEngineInit);
+
+		// 帧末提交一次力场增量栅栏：没有 ViewFamily 渲染（最小化、服务器）时增量也会被 RT 消费，不会一直积压。
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&SubmitRealityDistortionFieldUpdates_GameThread);
+
+		// 材质销毁（GC）或重新编译后，移除只剩 Shader 解析缓存持有的 ShaderMap。
+		PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddStatic(&PurgeRealityDistortionShaderResolutionCache_GameThread);
+#if WITH_EDITOR
+		MaterialCompilationFinishedHandle = UMaterial::OnMaterialCompilationFinished().AddLambda([](UMaterialInterface*)
 		{
-			CVar->Set(1, ECVF_SetByCode);
-		}
+			PurgeRealityDistortionShaderResolutionCache_GameThread();
+		});
+#endif
 
 		UE_LOG(LogRealityDistortion, Log, TEXT("RealityDistortion module started. Shader directory: %s"), *ShaderDirectory);
 	}
 
 	virtual void ShutdownModule() override
 	{
+		FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+		FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+#if WITH_EDITOR
+		UMaterial::OnMaterialCompilationFinished().Remove(MaterialCompilationFinishedHandle);
+#endif
+		ViewExtension.Reset();
+
 		UE_LOG(LogRealityDistortion, Log, TEXT("RealityDistortion module shutdown."));
 	}
+
+private:
+	void OnPostEngineInit()
+	{
+		// 负责每个 ViewFamily 更新一次力场 Uniform Buffer。
+		ViewExtension = FSceneViewExtensions::NewExtension<FRealityDistortionViewExtension>();
+	}
+
+	FDelegateHandle PostEngineInitHandle;
+	FDelegateHandle EndFrameHandle;
+	FDelegateHandle PostGarbageCollectHandle;
+#if WITH_EDITOR
+	FDelegateHandle MaterialCompilationFinishedHandle;
+#endif
+	TSharedPtr<FRealityDistortionViewExtension, ESPMode::ThreadSafe> ViewExtension;
 };
 
 IMPLEMENT_PRIMARY_GAME_MODULE(FRealityDistortionModule, RealityDistortion, "RealityDistortion");
@@ -0,0 +1,902 @@
+// RealityDistortionField.cpp
+//
+// 力场注册表
+// ----------
+// GT（唯一生产者）：
+// - 句柄池：固定容量的槽位 + 32 位代数（Generation）。Handle = (Generation << 32) | SlotIndex，
+//   槽位回收后代数递增，过期句柄的 Set/Destroy 会被直接忽略。
+// - 创建/销毁只操作预分配的数组，不分配内存。
+// - 每次 Set/Destroy/Reset 写入一条增量到 SPSC 无锁环形队列（TCircularQueue）。
+// - 每帧提交一次栅栏（SubmitRealityDistortionFieldUpdates_GameThread）：入队一条渲染命令，记录此前写入的增量数。
+// RT（唯一消费者）：
+// - 栅栏渲染命令调用 Drain，只消费到栅栏为止；同一帧的所有 ViewFamily 看到同一份力场数据。
+// - 力场数据按 SoA 保存（中心/半径/强度/开关/Tag 各一个数组），打包与空间索引只读需要的列。
+// - 降频推送的力场另存最近两次带时间戳的采样（稀疏），每个 ViewFamily 先按力场时钟预测中心 / 半径；
+//   动画力场另存一份基准设置与动画描述（稀疏），随后在（预测后的）基准值上求值。二者都写回 SoA 列。
+//
+// 力场时钟：注册表被所有世界共用，每个句柄在创建时绑定所属世界（槽位 0 为应用时间）。
+// GT 提交栅栏时采样各时钟，随栅栏命令交给 RT；GT 的采样时刻与 RT 的求值时刻来自同一个世界的同一个时钟，
+// 不再用渲染中的 ViewFamily 的时间去求值别的世界的力场。
+//
+// 队列写满时溢出到加锁的数组（不阻塞 GT、不 Flush）：溢出期间的新增量全部追加到数组末尾，
+// RT 先排空环形队列再按序消费数组，增量顺序不会被打乱。数组清空后 GT 回到无锁队列。
+
+#include "RealityDistortionField.h"
+
+#include "Containers/CircularQueue.h"
+#include "Engine/World.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/ScopeLock.h"
+#include "RealityDistortion.h"
+#include "RenderingThread.h"
+#include "Rendering/RealityDistortionStats.h"
+
+#include <atomic>
+
+DEFINE_STAT(STAT_RealityDistortion_FieldUpdatesPushed);
+DEFINE_STAT(STAT_RealityDistortion_FieldUpdatesSkipped);
+DEFINE_STAT(STAT_RealityDistortion_FieldDeltasDrained);
+DEFINE_STAT(STAT_RealityDistortion_FieldQueueOverflows);
+DEFINE_STAT(STAT_RealityDistortion_FieldsAnimated);
+DEFINE_STAT(STAT_RealityDistortion_FieldsPredicted);
+
+namespace
+{
+	// 同时存在的力场句柄上限（每个 ViewFamily 最多选出 MAX_DISTORTION_FIELDS 个上传到 GPU）。
+	constexpr uint32 MaxFieldSlots = 4096;
+	// 环形队列容量（条增量）。正常一帧远达不到，写满时溢出到加锁的数组。
+	constexpr uint32 FieldDeltaQueueCapacity = 4096;
+
+	constexpr uint32 HandleSlotBits = 32;
+	static_assert(MaxFieldSlots <= MAX_uint16 + 1, "Field slot index must fit in a delta");
+
+	// 同时存在的力场时钟上限（同时有力场的世界数 + 应用时间）。用完后新世界的力场退回应用时间。
+	constexpr int32 MaxFieldClocks = 64;
+	// 没有所属世界的句柄使用的时钟。
+	constexpr uint8 AppFieldClock = 0;
+
+	static TAutoConsoleVariable<int32> CVarRealityDistortionFieldMotionPrediction(
+		TEXT("r.RealityDistortion.FieldMotionPrediction"),
+		1,
+		TEXT("How the render thread fills frames between pushes of fields with a reduced update rate. 0=Hold last sample, 1=Extrapolate (default), 2=Interpolate with one push interval of latency"),
+		ECVF_RenderThreadSafe);
+
+	static TAutoConsoleVariable<float> CVarRealityDistortionFieldMotionMaxExtrapolationIntervals(
+		TEXT("r.RealityDistortion.FieldMotionPrediction.MaxExtrapolationIntervals"),
+		1.5f,
+		TEXT("How far a field is extrapolated past its last pushed sample before it holds position, in multiples of that field's own push interval (time between its last two samples). 1 reaches the expected next push; larger values cover late pushes."),
+		ECVF_RenderThreadSafe);
+
+	enum class EFieldDeltaType : uint8
+	{
+		Set,
+		SetAnimation,
+		Clear,
+		Reset,
+	};
+
+	struct FRealityDistortionFieldDelta
+	{
+		EFieldDeltaType Type = EFieldDeltaType::Set;
+		uint16 SlotIndex = 0;
+		FRealityDistortionFieldSettings Settings;
+		// 仅 Set 使用：采样时刻（力场时钟），< 0 表示不做运动预测。
+		double SampleTime = -1.0;
+		// Set / SetAnimation 使用：槽位的力场时钟。
+		uint8 ClockIndex = AppFieldClock;
+		// 仅 SetAnimation 使用。动画描述较大且很少变化，单独分配，不放进每条增量。
+		TSharedPtr<const FRealityDistortionFieldAnimation> Animation;
+	};
+
+	// ---------------- GameThread ----------------
+	// 预分配的句柄池。Generation 从 1 开始且跳过 0，保证 Handle 永远不等于 RealityDistortionInvalidFieldHandle。
+	struct FFieldHandlePool
+	{
+		TStaticArray<uint32, MaxFieldSlots> Generations;
+		TStaticArray<uint16, MaxFieldSlots> FreeSlots;
+		uint32 NumFreeSlots = 0;
+		uint32 NumAllocatedSlots = 0;
+
+		FFieldHandlePool()
+		{
+			for (uint32 SlotIndex = 0; SlotIndex < MaxFieldSlots; ++SlotIndex)
+			{
+				Generations[SlotIndex] = 1;
+			}
+			Reset();
+		}
+
+		void Reset()
+		{
+			for (uint32 SlotIndex = 0; SlotIndex < MaxFieldSlots; ++SlotIndex)
+			{
+				// 所有槽位递增代数，使 Reset 之前发出的句柄全部失效。
+				BumpGeneration(SlotIndex);
+				// 逆序入栈：先分配低槽位，力场选择时更容易使用与槽位相同的 Buffer 位置。
+				FreeSlots[SlotIndex] = static_cast<uint16>(MaxFieldSlots - 1 - SlotIndex);
+			}
+			NumFreeSlots = MaxFieldSlots;
+			NumAllocatedSlots = 0;
+		}
+
+		void BumpGeneration(uint32 SlotIndex)
+		{
+			// 跳过 0，保证 Handle 永远不等于 RealityDistortionInvalidFieldHandle。
+			uint32& Generation = Generations[SlotIndex];
+			Generation = (Generation == MAX_uint32) ? 1 : Generation + 1;
+		}
+
+		static uint64 MakeHandle(uint32 SlotIndex, uint32 Generation)
+		{
+			return (static_cast<uint64>(Generation) << HandleSlotBits) | SlotIndex;
+		}
+
+		bool Resolve(uint64 Handle, uint32& OutSlotIndex) const
+		{
+			const uint32 SlotIndex = static_cast<uint32>(Handle);
+			const uint32 Generation = static_cast<uint32>(Handle >> HandleSlotBits);
+			if (Handle == RealityDistortionInvalidFieldHandle || SlotIndex >= MaxFieldSlots || Generations[SlotIndex] != Generation)
+			{
+				return false;
+			}
+			OutSlotIndex = SlotIndex;
+			return true;
+		}
+	};
+
+	FFieldHandlePool GFieldHandlePool_GameThread;
+
+	// 力场时钟：下标 0 为应用时间，其余每个世界一个，按引用计数复用。
+	struct FFieldClock
+	{
+		TWeakObjectPtr<const UWorld> World;
+		uint32 NumHandles = 0;
+	};
+
+	TArray<FFieldClock, TInlineAllocator<MaxFieldClocks>> GFieldClocks_GameThread;
+	// 槽位 -> 力场时钟。
+	TStaticArray<uint8, MaxFieldSlots> GFieldSlotClocks_GameThread(InPlace, AppFieldClock);
+	// 最近一次采样时钟的帧号；每帧至少提交一次采样。
+	uint64 GLastSubmittedFieldClockFrame_GameThread = MAX_uint64;
+
+	uint8 AcquireFieldClock_GameThread(const UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return AppFieldClock;
+		}
+
+		// 下标 0 留给应用时间。
+		if (GFieldClocks_GameThread.IsEmpty())
+		{
+			GFieldClocks_GameThread.AddDefaulted();
+		}
+
+		int32 FreeIndex = INDEX_NONE;
+		for (int32 ClockIndex = 1; ClockIndex < GFieldClocks_GameThread.Num(); ++ClockIndex)
+		{
+			FFieldClock& Clock = GFieldClocks_GameThread[ClockIndex];
+			if (Clock.NumHandles > 0 && Clock.World.Get() == World)
+			{
+				++Clock.NumHandles;
+				return static_cast<uint8>(ClockIndex);
+			}
+			if (Clock.NumHandles == 0 && FreeIndex == INDEX_NONE)
+			{
+				FreeIndex = ClockIndex;
+			}
+		}
+
+		if (FreeIndex == INDEX_NONE)
+		{
+			if (GFieldClocks_GameThread.Num() >= MaxFieldClocks)
+			{
+				UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] Field clock table full (%d worlds); fields of %s animate on application time."),
+					MaxFieldClocks - 1, *World->GetName());
+				return AppFieldClock;
+			}
+			FreeIndex = GFieldClocks_GameThread.AddDefaulted();
+		}
+
+		GFieldClocks_GameThread[FreeIndex].World = World;
+		GFieldClocks_GameThread[FreeIndex].NumHandles = 1;
+		return static_cast<uint8>(FreeIndex);
+	}
+
+	void ReleaseFieldClock_GameThread(uint8 ClockIndex)
+	{
+		if (ClockIndex != AppFieldClock && GFieldClocks_GameThread.IsValidIndex(ClockIndex) && GFieldClocks_GameThread[ClockIndex].NumHandles > 0)
+		{
+			--GFieldClocks_GameThread[ClockIndex].NumHandles;
+		}
+	}
+
+	double GetFieldClockSeconds_GameThread(uint8 ClockIndex)
+	{
+		const UWorld* World = ClockIndex != AppFieldClock && GFieldClocks_GameThread.IsValidIndex(ClockIndex)
+			? GFieldClocks_GameThread[ClockIndex].World.Get() : nullptr;
+		return World != nullptr ? World->GetTimeSeconds() : FApp::GetCurrentTime();
+	}
+	TCircularQueue<FRealityDistortionFieldDelta> GFieldDeltaQueue(FieldDeltaQueueCapacity);
+
+	// 环形队列写满后的溢出数组。非空期间 GT 的新增量全部追加到这里（见 EnqueueFieldDelta_GameThread）。
+	FCriticalSection GFieldDeltaOverflowLock;
+	TArray<FRealityDistortionFieldDelta> GFieldDeltaOverflow;
+	// 溢出数组非空。GT 置位、RT 清空数组时复位；为 false 时 GT 不加锁。
+	std::atomic<bool> GFieldDeltaOverflowPending{ false };
+
+	// 帧栅栏：GT 写入的增量总数 / 最近一次提交的栅栏；RT 已消费的增量总数 / 可消费到的栅栏。
+	uint64 GNumFieldDeltasEnqueued_GameThread = 0;
+	uint64 GLastSubmittedFieldDeltaFence_GameThread = 0;
+	uint64 GNumFieldDeltasDrained_RenderThread = 0;
+	uint64 GFieldDeltaFence_RenderThread = 0;
+
+	// ---------------- RenderThread ----------------
+	// 动画力场：GT 推送的基准值 + 动画描述。SoA 列里存的是最近一次求值的结果。
+	struct FAnimatedField
+	{
+		uint32 SlotIndex = 0;
+		FRealityDistortionFieldAnimation Animation;
+		FVector BaseCenter = FVector::ZeroVector;
+		float BaseRadius = 0.0f;
+		float BaseStrength = 0.0f;
+		FVector3f BaseExtent = FVector3f::ZeroVector;
+	};
+
+	// 降频推送的力场：最近两次带时间戳的采样。预测结果写入 SoA 列，动画力场则写入动画基准值。
+	struct FPredictedField
+	{
+		uint32 SlotIndex = 0;
+		FRealityDistortionFieldMotionSamples Samples;
+		// 最近一次采样的形状尺寸；包围球半径与 Extent 成正比，预测半径时按同一比例缩放。
+		FVector3f LastExtent = FVector3f::ZeroVector;
+	};
+
+	struct FFieldStorage
+	{
+		TArray<FVector> Centers;
+		TArray<float> Radii;
+		TArray<float> Strengths;
+		TArray<bool> Enabled;
+		TArray<FName> ReceiverTagFilters;
+		TArray<int32> Priorities;
+		TArray<uint8> Shapes;
+		TArray<FQuat> Rotations;
+		TArray<FVector3f> Extents;
+		// 动画力场整个周期的包围球，基准值或动画描述变化时更新；非动画槽位 W = 0。
+		TArray<FSphere> AnimationBounds;
+		// 槽位 -> 力场时钟；ClockSeconds 是最近一次栅栏带来的各时钟采样。
+		TArray<uint8> ClockIndices;
+		TStaticArray<double, MaxFieldClocks> ClockSeconds = TStaticArray<double, MaxFieldClocks>(InPlace, 0.0);
+		// 槽位 -> AnimatedFields 下标，INDEX_NONE 表示没有动画。
+		TArray<int32> AnimationIndices;
+		TSparseArray<FAnimatedField> AnimatedFields;
+		// 槽位 -> PredictedFields 下标，INDEX_NONE 表示每帧推送（不预测）。
+		TArray<int32> MotionIndices;
+		TSparseArray<FPredictedField> PredictedFields;
+		// 写入过的最高槽位 + 1。
+		int32 NumSlots = 0;
+
+		FFieldStorage()
+		{
+			Centers.SetNumZeroed(MaxFieldSlots);
+			Radii.SetNumZeroed(MaxFieldSlots);
+			Strengths.SetNumZeroed(MaxFieldSlots);
+			Enabled.SetNumZeroed(MaxFieldSlots);
+			ReceiverTagFilters.SetNum(MaxFieldSlots);
+			Priorities.SetNumZeroed(MaxFieldSlots);
+			Shapes.SetNumZeroed(MaxFieldSlots);
+			Rotations.Init(FQuat::Identity, MaxFieldSlots);
+			Extents.SetNumZeroed(MaxFieldSlots);
+			AnimationBounds.Init(FSphere(ForceInit), MaxFieldSlots);
+			ClockIndices.Init(AppFieldClock, MaxFieldSlots);
+			AnimationIndices.Init(INDEX_NONE, MaxFieldSlots);
+			MotionIndices.Init(INDEX_NONE, MaxFieldSlots);
+		}
+
+		void Write(uint32 SlotIndex, const FRealityDistortionFieldSettings& Settings, double SampleTime = -1.0)
+		{
+			Centers[SlotIndex] = Settings.Center;
+			Radii[SlotIndex] = Settings.Radius;
+			Strengths[SlotIndex] = Settings.Strength;
+			Enabled[SlotIndex] = Settings.bEnabled;
+			ReceiverTagFilters[SlotIndex] = Settings.ReceiverTagFilter;
+			Priorities[SlotIndex] = Settings.Priority;
+			Shapes[SlotIndex] = Settings.Shape;
+			Rotations[SlotIndex] = Settings.Rotation;
+			Extents[SlotIndex] = Settings.Extent;
+			NumSlots = FMath::Max(NumSlots, static_cast<int32>(SlotIndex) + 1);
+
+			// 动画力场：新设置成为基准值，下一次 Animate 在其上求值。
+			if (AnimationIndices[SlotIndex] != INDEX_NONE)
+			{
+				FAnimatedField& AnimatedField = AnimatedFields[AnimationIndices[SlotIndex]];
+				AnimatedField.BaseCenter = Settings.Center;
+				AnimatedField.BaseRadius = Settings.Radius;
+				AnimatedField.BaseStrength = Settings.Strength;
+				AnimatedField.BaseExtent = Settings.Extent;
+				UpdateAnimationBounds(AnimatedField);
+			}
+
+			WriteMotion(SlotIndex, Settings, SampleTime);
+		}
+
+		void UpdateAnimationBounds(const FAnimatedField& AnimatedField)
+		{
+			AnimationBounds[AnimatedField.SlotIndex] = ComputeRealityDistortionFieldAnimationBounds(AnimatedField.Animation, AnimatedField.BaseCenter, AnimatedField.BaseRadius);
+		}
+
+		double GetClockSeconds(uint32 SlotIndex) const
+		{
+			return ClockSeconds[ClockIndices[SlotIndex]];
+		}
+
+		void WriteMotion(uint32 SlotIndex, const FRealityDistortionFieldSettings& Settings, double SampleTime)
+		{
+			int32& MotionIndex = MotionIndices[SlotIndex];
+			if (SampleTime < 0.0 || !Settings.bEnabled)
+			{
+				// 每帧推送 / 瞬移 / 禁用：丢弃历史，SoA 列已是本次采样。
+				if (MotionIndex != INDEX_NONE)
+				{
+					PredictedFields.RemoveAt(MotionIndex);
+					MotionIndex = INDEX_NONE;
+				}
+				return;
+			}
+
+			if (MotionIndex == INDEX_NONE)
+			{
+				FPredictedField PredictedField;
+				PredictedField.SlotIndex = SlotIndex;
+				MotionIndex = PredictedFields.Add(MoveTemp(PredictedField));
+			}
+
+			FPredictedField& PredictedField = PredictedFields[MotionIndex];
+			FRealityDistortionFieldMotionSamples& Samples = PredictedField.Samples;
+			// 同一时刻的重复推送（例如同帧改了属性）只替换最近一次采样，保留用于求速度的上一次采样。
+			if (SampleTime > Samples.LastTime)
+			{
+				Samples.PreviousCenter = Samples.LastCenter;
+				Samples.PreviousRadius = Samples.LastRadius;
+				Samples.PreviousTime = Samples.LastTime;
+			}
+			Samples.LastCenter = Settings.Center;
+			Samples.LastRadius = Settings.Radius;
+			Samples.LastTime = SampleTime;
+			PredictedField.LastExtent = Settings.Extent;
+		}
+
+		void Predict(ERealityDistortionFieldMotionPrediction Mode, double MaxExtrapolationIntervals)
+		{
+			for (const FPredictedField& PredictedField : PredictedFields)
+			{
+				// 没有速度时也写回：切换预测模式后不会残留上一次的预测值。
+				const FRealityDistortionFieldMotionSamples& Samples = PredictedField.Samples;
+				const FRealityDistortionFieldMotionSample Sample = EvaluateRealityDistortionFieldMotion(
+					Samples, GetClockSeconds(PredictedField.SlotIndex), Mode, MaxExtrapolationIntervals);
+				const FVector3f Extent = Samples.LastRadius > 0.0f ? PredictedField.LastExtent * (Sample.Radius / Samples.LastRadius) : PredictedField.LastExtent;
+
+				const uint32 SlotIndex = PredictedField.SlotIndex;
+				if (AnimationIndices[SlotIndex] != INDEX_NONE)
+				{
+					FAnimatedField& AnimatedField = AnimatedFields[AnimationIndices[SlotIndex]];
+					AnimatedField.BaseCenter = Sample.Center;
+					AnimatedField.BaseRadius = Sample.Radius;
+					AnimatedField.BaseExtent = Extent;
+					UpdateAnimationBounds(AnimatedField);
+				}
+				else
+				{
+					Centers[SlotIndex] = Sample.Center;
+					Radii[SlotIndex] = Sample.Radius;
+					Extents[SlotIndex] = Extent;
+				}
+			}
+		}
+
+		void WriteAnimation(uint32 SlotIndex, const FRealityDistortionFieldAnimation& Animation)
+		{
+			int32& AnimationIndex = AnimationIndices[SlotIndex];
+			if (!Animation.IsAnimated())
+			{
+				ClearAnimation(SlotIndex);
+				return;
+			}
+
+			if (AnimationIndex == INDEX_NONE)
+			{
+				// 尚无动画时 SoA 列就是基准值。
+				FAnimatedField AnimatedField;
+				AnimatedField.SlotIndex = SlotIndex;
+				AnimatedField.BaseCenter = Centers[SlotIndex];
+				AnimatedField.BaseRadius = Radii[SlotIndex];
+				AnimatedField.BaseStrength = Strengths[SlotIndex];
+				AnimatedField.BaseExtent = Extents[SlotIndex];
+				AnimationIndex = AnimatedFields.Add(MoveTemp(AnimatedField));
+			}
+			AnimatedFields[AnimationIndex].Animation = Animation;
+			UpdateAnimationBounds(AnimatedFields[AnimationIndex]);
+		}
+
+		void ClearAnimation(uint32 SlotIndex)
+		{
+			int32& AnimationIndex = AnimationIndices[SlotIndex];
+			if (AnimationIndex == INDEX_NONE)
+			{
+				return;
+			}
+
+			// 停止动画时恢复基准值。
+			const FAnimatedField& AnimatedField = AnimatedFields[AnimationIndex];
+			Centers[SlotIndex] = AnimatedField.BaseCenter;
+			Radii[SlotIndex] = AnimatedField.BaseRadius;
+			Strengths[SlotIndex] = AnimatedField.BaseStrength;
+			Extents[SlotIndex] = AnimatedField.BaseExtent;
+			AnimationBounds[SlotIndex] = FSphere(ForceInit);
+			AnimatedFields.RemoveAt(AnimationIndex);
+			AnimationIndex = INDEX_NONE;
+		}
+
+		void Animate()
+		{
+			for (const FAnimatedField& AnimatedField : AnimatedFields)
+			{
+				const uint32 SlotIndex = AnimatedField.SlotIndex;
+				const FRealityDistortionFieldAnimationSample Sample = EvaluateRealityDistortionFieldAnimation(AnimatedField.Animation, GetClockSeconds(SlotIndex));
+				Centers[SlotIndex] = AnimatedField.BaseCenter + FVector(Sample.CenterOffset);
+				Radii[SlotIndex] = AnimatedField.BaseRadius * Sample.RadiusScale;
+				Strengths[SlotIndex] = AnimatedField.BaseStrength * Sample.StrengthScale;
+				Extents[SlotIndex] = AnimatedField.BaseExtent * Sample.RadiusScale;
+			}
+		}
+
+		void Reset()
+		{
+			for (int32 SlotIndex = 0; SlotIndex < NumSlots; ++SlotIndex)
+			{
+				ClearAnimation(SlotIndex);
+				Write(SlotIndex, FRealityDistortionFieldSettings());
+				ClockIndices[SlotIndex] = AppFieldClock;
+			}
+			NumSlots = 0;
+		}
+	};
+
+	FFieldStorage GFieldStorage_RenderThread;
+
+	void EnqueueFieldDelta_GameThread(FRealityDistortionFieldDelta&& Delta)
+	{
+		++GNumFieldDeltasEnqueued_GameThread;
+
+		// 快路径：没有溢出时直接写入无锁队列。只有 GT 会置位 Pending，读到 false 时溢出数组一定为空。
+		if (!GFieldDeltaOverflowPending.load(std::memory_order_acquire) && GFieldDeltaQueue.Enqueue(Delta))
+		{
+			return;
+		}
+
+		// 队列已满或已有溢出：追加到溢出数组末尾，保证 RT 按写入顺序消费。
+		// RT 可能刚好清空了溢出数组，此时重新尝试无锁队列。
+		FScopeLock Lock(&GFieldDeltaOverflowLock);
+		if (GFieldDeltaOverflow.IsEmpty() && GFieldDeltaQueue.Enqueue(Delta))
+		{
+			return;
+		}
+
+		if (GFieldDeltaOverflow.IsEmpty())
+		{
+			INC_DWORD_STAT(STAT_RealityDistortion_FieldQueueOverflows);
+			UE_LOG(LogRealityDistortion, Verbose, TEXT("[RealityDistortion] Field delta queue full (%u), spilling to the overflow array."), FieldDeltaQueueCapacity);
+		}
+		GFieldDeltaOverflow.Add(MoveTemp(Delta));
+		GFieldDeltaOverflowPending.store(true, std::memory_order_release);
+	}
+
+	void ApplyFieldDelta_RenderThread(const FRealityDistortionFieldDelta& Delta)
+	{
+		switch (Delta.Type)
+		{
+		case EFieldDeltaType::Set:
+			GFieldStorage_RenderThread.ClockIndices[Delta.SlotIndex] = Delta.ClockIndex;
+			GFieldStorage_RenderThread.Write(Delta.SlotIndex, Delta.Settings, Delta.SampleTime);
+			break;
+		case EFieldDeltaType::SetAnimation:
+			GFieldStorage_RenderThread.ClockIndices[Delta.SlotIndex] = Delta.ClockIndex;
+			GFieldStorage_RenderThread.WriteAnimation(Delta.SlotIndex, *Delta.Animation);
+			break;
+		case EFieldDeltaType::Clear:
+			GFieldStorage_RenderThread.ClearAnimation(Delta.SlotIndex);
+			GFieldStorage_RenderThread.Write(Delta.SlotIndex, FRealityDistortionFieldSettings());
+			GFieldStorage_RenderThread.ClockIndices[Delta.SlotIndex] = AppFieldClock;
+			break;
+		case EFieldDeltaType::Reset:
+			GFieldStorage_RenderThread.Reset();
+			break;
+		}
+	}
+}
+
+uint64 CreateRealityDistortionFieldHandle_GameThread(const UWorld* World)
+{
+	check(IsInGameThread());
+
+	FFieldHandlePool& Pool = GFieldHandlePool_GameThread;
+	if (Pool.NumFreeSlots == 0)
+	{
+		UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] Field handle pool exhausted (%u slots)."), MaxFieldSlots);
+		return RealityDistortionInvalidFieldHandle;
+	}
+
+	// 槽位在上一次销毁时已在 RT 清成禁用状态，这里无需写入增量。
+	const uint32 SlotIndex = Pool.FreeSlots[--Pool.NumFreeSlots];
+	++Pool.NumAllocatedSlots;
+	GFieldSlotClocks_GameThread[SlotIndex] = AcquireFieldClock_GameThread(World);
+	return FFieldHandlePool::MakeHandle(SlotIndex, Pool.Generations[SlotIndex]);
+}
+
+void DestroyRealityDistortionFieldHandle_GameThread(uint64 Handle)
+{
+	check(IsInGameThread());
+
+	FFieldHandlePool& Pool = GFieldHandlePool_GameThread;
+	uint32 SlotIndex;
+	if (!Pool.Resolve(Handle, SlotIndex))
+	{
+		return;
+	}
+
+	// 代数递增使旧句柄失效。
+	Pool.BumpGeneration(SlotIndex);
+	Pool.FreeSlots[Pool.NumFreeSlots++] = static_cast<uint16>(SlotIndex);
+	--Pool.NumAllocatedSlots;
+	ReleaseFieldClock_GameThread(GFieldSlotClocks_GameThread[SlotIndex]);
+	GFieldSlotClocks_GameThread[SlotIndex] = AppFieldClock;
+
+	// 槽位复用前在 RT 清成禁用状态，否则新力场在首次推送前会继承旧数据。
+	FRealityDistortionFieldDelta Delta;
+	Delta.Type = EFieldDeltaType::Clear;
+	Delta.SlotIndex = static_cast<uint16>(SlotIndex);
+	EnqueueFieldDelta_GameThread(MoveTemp(Delta));
+}
+
+bool IsRealityDistortionFieldHandleValid_GameThread(uint64 Handle)
+{
+	check(IsInGameThread());
+
+	uint32 SlotIndex;
+	return GFieldHandlePool_GameThread.Resolve(Handle, SlotIndex);
+}
+
+double GetRealityDistortionFieldTimeSeconds_GameThread(uint64 Handle)
+{
+	check(IsInGameThread());
+
+	uint32 SlotIndex;
+	if (!GFieldHandlePool_GameThread.Resolve(Handle, SlotIndex))
+	{
+		return 0.0;
+	}
+	return GetFieldClockSeconds_GameThread(GFieldSlotClocks_GameThread[SlotIndex]);
+}
+
+void SetRealityDistortionFieldSettings_GameThread(uint64 Handle, const FRealityDistortionFieldSettings& Settings, double SampleTimeSeconds)
+{
+	check(IsInGameThread());
+
+	uint32 SlotIndex;
+	if (!GFieldHandlePool_GameThread.Resolve(Handle, SlotIndex))
+	{
+		return;
+	}
+
+	FRealityDistortionFieldDelta Delta;
+	Delta.Type = EFieldDeltaType::Set;
+	Delta.SlotIndex = static_cast<uint16>(SlotIndex);
+	Delta.Settings = Settings;
+	Delta.SampleTime = SampleTimeSeconds;
+	Delta.ClockIndex = GFieldSlotClocks_GameThread[SlotIndex];
+	EnqueueFieldDelta_GameThread(MoveTemp(Delta));
+	INC_DWORD_STAT(STAT_RealityDistortion_FieldUpdatesPushed);
+}
+
+void SetRealityDistortionFieldAnimation_GameThread(uint64 Handle, const FRealityDistortionFieldAnimation& Animation)
+{
+	check(IsInGameThread());
+
+	uint32 SlotIndex;
+	if (!GFieldHandlePool_GameThread.Resolve(Handle, SlotIndex))
+	{
+		return;
+	}
+
+	FRealityDistortionFieldDelta Delta;
+	Delta.Type = EFieldDeltaType::SetAnimation;
+	Delta.SlotIndex = static_cast<uint16>(SlotIndex);
+	Delta.Animation = MakeShared<const FRealityDistortionFieldAnimation>(Animation);
+	Delta.ClockIndex = GFieldSlotClocks_GameThread[SlotIndex];
+	EnqueueFieldDelta_GameThread(MoveTemp(Delta));
+	INC_DWORD_STAT(STAT_RealityDistortion_FieldUpdatesPushed);
+}
+
+void ResetRealityDistortionFields_GameThread()
+{
+	check(IsInGameThread());
+
+	GFieldHandlePool_GameThread.Reset();
+	GFieldClocks_GameThread.Reset();
+	for (uint8& ClockIndex : GFieldSlotClocks_GameThread)
+	{
+		ClockIndex = AppFieldClock;
+	}
+
+	FRealityDistortionFieldDelta Delta;
+	Delta.Type = EFieldDeltaType::Reset;
+	EnqueueFieldDelta_GameThread(MoveTemp(Delta));
+}
+
+void SubmitRealityDistortionFieldUpdates_GameThread()
+{
+	check(IsInGameThread());
+
+	// 有力场时每帧都要把时钟带给 RT，否则静止的动画力场拿不到新时间。
+	const uint64 Fence = GNumFieldDeltasEnqueued_GameThread;
+	const bool bSampleClocks = GFieldHandlePool_GameThread.NumAllocatedSlots > 0 && GLastSubmittedFieldClockFrame_GameThread != GFrameCounter;
+	if (Fence == GLastSubmittedFieldDeltaFence_GameThread && !bSampleClocks)
+	{
+		return;
+	}
+	GLastSubmittedFieldDeltaFence_GameThread = Fence;
+
+	// 时钟在这里采样（世界已 Tick 完），与本帧推送的采样时刻同源；没有力场的时钟保持原值。
+	TArray<double, TInlineAllocator<8>> ClockSeconds;
+	if (bSampleClocks)
+	{
+		GLastSubmittedFieldClockFrame_GameThread = GFrameCounter;
+		ClockSeconds.SetNumUninitialized(FMath::Max(GFieldClocks_GameThread.Num(), 1));
+		for (int32 ClockIndex = 0; ClockIndex < ClockSeconds.Num(); ++ClockIndex)
+		{
+			const bool bInUse = ClockIndex == AppFieldClock || GFieldClocks_GameThread[ClockIndex].NumHandles > 0;
+			ClockSeconds[ClockIndex] = bInUse ? GetFieldClockSeconds_GameThread(static_cast<uint8>(ClockIndex)) : -1.0;
+		}
+	}
+
+	// 渲染命令按入队顺序执行：栅栏之前的增量在这条命令执行时已全部写入队列 / 溢出数组。
+	ENQUEUE_RENDER_COMMAND(RealityDistortionDrainFieldDeltas)(
+		[Fence, ClockSeconds = MoveTemp(ClockSeconds)](FRHICommandListImmediate&)
+		{
+			GFieldDeltaFence_RenderThread = Fence;
+			for (int32 ClockIndex = 0; ClockIndex < ClockSeconds.Num(); ++ClockIndex)
+			{
+				if (ClockSeconds[ClockIndex] >= 0.0)
+				{
+					GFieldStorage_RenderThread.ClockSeconds[ClockIndex] = ClockSeconds[ClockIndex];
+				}
+			}
+			DrainRealityDistortionFieldUpdates_RenderThread();
+		});
+}
+
+void DrainRealityDistortionFieldUpdates_RenderThread()
+{
+	check(IsInRenderingThread());
+
+	const uint64 NumDrainedBefore = GNumFieldDeltasDrained_RenderThread;
+	uint64& NumDrained = GNumFieldDeltasDrained_RenderThread;
+	const uint64 Fence = GFieldDeltaFence_RenderThread;
+
+	// 环形队列里的增量都早于溢出数组里的增量（溢出期间 GT 不再写入环形队列）。
+	FRealityDistortionFieldDelta Delta;
+	while (NumDrained < Fence && GFieldDeltaQueue.Dequeue(Delta))
+	{
+		ApplyFieldDelta_RenderThread(Delta);
+		++NumDrained;
+	}
+
+	if (NumDrained < Fence && GFieldDeltaOverflowPending.load(std::memory_order_acquire))
+	{
+		FScopeLock Lock(&GFieldDeltaOverflowLock);
+		const int32 NumOverflowDeltas = static_cast<int32>(FMath::Min<uint64>(GFieldDeltaOverflow.Num(), Fence - NumDrained));
+		for (int32 Index = 0; Index < NumOverflowDeltas; ++Index)
+		{
+			ApplyFieldDelta_RenderThread(GFieldDeltaOverflow[Index]);
+		}
+		NumDrained += NumOverflowDeltas;
+
+		// 栅栏之后的溢出增量留到下一次提交；清空后 GT 回到无锁队列。
+		GFieldDeltaOverflow.RemoveAt(0, NumOverflowDeltas, EAllowShrinking::No);
+		if (GFieldDeltaOverflow.IsEmpty())
+		{
+			GFieldDeltaOverflowPending.store(false, std::memory_order_release);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_RealityDistortion_FieldDeltasDrained, static_cast<uint32>(NumDrained - NumDrainedBefore));
+}
+
+namespace
+{
+	// 周期曲线：Key 在一个周期内等间隔，最后一段插值回第一个 Key。
+	float EvaluatePeriodicCurve(const TStaticArray<float, RealityDistortionAnimationCurveKeys>& Keys, int32 NumKeys, double Phase)
+	{
+		NumKeys = FMath::Min(NumKeys, RealityDistortionAnimationCurveKeys);
+		const double Position = Phase * NumKeys;
+		const int32 Index = FMath::Min(FMath::FloorToInt32(Position), NumKeys - 1);
+		return FMath::Lerp(Keys[Index], Keys[(Index + 1) % NumKeys], static_cast<float>(Position - Index));
+	}
+}
+
+FRealityDistortionFieldAnimationSample EvaluateRealityDistortionFieldAnimation(const FRealityDistortionFieldAnimation& Animation, double TimeSeconds)
+{
+	FRealityDistortionFieldAnimationSample Sample;
+	const double Time = TimeSeconds + Animation.TimeOffset;
+
+	if (Animation.Period > 0.0f)
+	{
+		// 周期内的归一化相位 [0, 1)。
+		const double Phase = FMath::Frac(Time / Animation.Period);
+
+		if (Animation.NumRadiusKeys > 0)
+		{
+			Sample.RadiusScale = EvaluatePeriodicCurve(Animation.RadiusCurve, Animation.NumRadiusKeys, Phase);
+		}
+		if (Animation.NumStrengthKeys > 0)
+		{
+			Sample.StrengthScale = EvaluatePeriodicCurve(Animation.StrengthCurve, Animation.NumStrengthKeys, Phase);
+		}
+
+		const int32 NumPoints = FMath::Min<int32>(Animation.NumSplinePoints, RealityDistortionAnimationSplinePoints);
+		if (NumPoints >= 2)
+		{
+			// 点按弧长等距，沿点序号匀速插值即沿样条匀速运动。
+			int32 Index;
+			int32 NextIndex;
+			double Position;
+			if (Animation.bSplineClosedLoop)
+			{
+				Position = Phase * NumPoints;
+				Index = FMath::Min(FMath::FloorToInt32(Position), NumPoints - 1);
+				NextIndex = (Index + 1) % NumPoints;
+			}
+			else
+			{
+				const double PingPong = Phase < 0.5 ? 2.0 * Phase : 2.0 - 2.0 * Phase;
+				Position = PingPong * (NumPoints - 1);
+				Index = FMath::Min(FMath::FloorToInt32(Position), NumPoints - 2);
+				NextIndex = Index + 1;
+			}
+			Sample.CenterOffset = FMath::Lerp(Animation.SplinePoints[Index], Animation.SplinePoints[NextIndex], static_cast<float>(Position - Index));
+		}
+	}
+
+	if (Animation.HasOscillation())
+	{
+		// 先取小数部分，世界时间很大时 float 的 sin 也不丢精度。
+		const float Wave = FMath::Sin(UE_TWO_PI * static_cast<float>(FMath::Frac(Time * Animation.OscillationFrequency + Animation.OscillationPhase)));
+		Sample.RadiusScale *= 1.0f + Animation.RadiusOscillationAmplitude * Wave;
+		Sample.StrengthScale *= 1.0f + Animation.StrengthOscillationAmplitude * Wave;
+	}
+
+	// 半径不能为负（负值在 SoA 中表示禁用，会让力场意外消失 / 出现）。
+	Sample.RadiusScale = FMath::Max(Sample.RadiusScale, 0.0f);
+	return Sample;
+}
+
+FSphere ComputeRealityDistortionFieldAnimationBounds(const FRealityDistortionFieldAnimation& Animation, const FVector& BaseCenter, float BaseRadius)
+{
+	// 曲线是 Key 之间的线性插值，最大值就是最大的 Key；振荡再乘 (1 + |振幅|)。
+	float MaxRadiusScale = 1.0f;
+	FVector3f OffsetCenter = FVector3f::ZeroVector;
+	float OffsetRadius = 0.0f;
+	if (Animation.Period > 0.0f)
+	{
+		const int32 NumRadiusKeys = FMath::Min<int32>(Animation.NumRadiusKeys, RealityDistortionAnimationCurveKeys);
+		if (NumRadiusKeys > 0)
+		{
+			MaxRadiusScale = Animation.RadiusCurve[0];
+			for (int32 Key = 1; Key < NumRadiusKeys; ++Key)
+			{
+				MaxRadiusScale = FMath::Max(MaxRadiusScale, Animation.RadiusCurve[Key]);
+			}
+		}
+
+		// 相邻采样点之间线性插值，轨迹落在采样点的凸包内，取采样点 AABB 中心的外接球。
+		const int32 NumPoints = FMath::Min<int32>(Animation.NumSplinePoints, RealityDistortionAnimationSplinePoints);
+		if (NumPoints >= 2)
+		{
+			FBox3f PointBounds(ForceInit);
+			for (int32 Point = 0; Point < NumPoints; ++Point)
+			{
+				PointBounds += Animation.SplinePoints[Point];
+			}
+			OffsetCenter = PointBounds.GetCenter();
+			for (int32 Point = 0; Point < NumPoints; ++Point)
+			{
+				OffsetRadius = FMath::Max(OffsetRadius, FVector3f::Dist(Animation.SplinePoints[Point], OffsetCenter));
+			}
+		}
+	}
+
+	if (Animation.HasOscillation())
+	{
+		MaxRadiusScale *= 1.0f + FMath::Abs(Animation.RadiusOscillationAmplitude);
+	}
+
+	return FSphere(BaseCenter + FVector(OffsetCenter), OffsetRadius + BaseRadius * FMath::Max(MaxRadiusScale, 0.0f));
+}
+
+FRealityDistortionFieldMotionSample EvaluateRealityDistortionFieldMotion(
+	const FRealityDistortionFieldMotionSamples& Samples,
+	double TimeSeconds,
+	ERealityDistortionFieldMotionPrediction Mode,
+	double MaxExtrapolationIntervals)
+{
+	FRealityDistortionFieldMotionSample Sample;
+	Sample.Center = Samples.LastCenter;
+	Sample.Radius = Samples.LastRadius;
+
+	const double Interval = Samples.LastTime - Samples.PreviousTime;
+	if (Mode == ERealityDistortionFieldMotionPrediction::None || !Samples.HasVelocity() || Interval > RealityDistortionMaxFieldSampleInterval)
+	{
+		return Sample;
+	}
+
+	// 以最近一次采样为原点、以两次采样之差为单位的参数：外推为 [0, MaxExtrapolationIntervals]，
+	// 内插延迟一个间隔，为 [-1, 0]（-1 即上一次采样）。上限按间隔计，推送间隔再长也能外推到下一次推送。
+	double Alpha;
+	if (Mode == ERealityDistortionFieldMotionPrediction::Interpolate)
+	{
+		Alpha = FMath::Clamp((TimeSeconds - Samples.LastTime) / Interval, 0.0, 1.0) - 1.0;
+	}
+	else
+	{
+		Alpha = FMath::Clamp((TimeSeconds - Samples.LastTime) / Interval, 0.0, FMath::Max(MaxExtrapolationIntervals, 0.0));
+	}
+
+	Sample.Center = Samples.LastCenter + (Samples.LastCenter - Samples.PreviousCenter) * Alpha;
+	// 半径外推到负值时停在 0（SoA 中即不活跃），不会因符号翻转重新出现。
+	Sample.Radius = FMath::Max(0.0f, Samples.LastRadius + (Samples.LastRadius - Samples.PreviousRadius) * static_cast<float>(Alpha));
+	return Sample;
+}
+
+void PredictRealityDistortionFieldMotion_RenderThread()
+{
+	check(IsInRenderingThread());
+
+	const ERealityDistortionFieldMotionPrediction Mode = static_cast<ERealityDistortionFieldMotionPrediction>(
+		FMath::Clamp(CVarRealityDistortionFieldMotionPrediction.GetValueOnRenderThread(), 0, 2));
+	const double MaxExtrapolationIntervals = CVarRealityDistortionFieldMotionMaxExtrapolationIntervals.GetValueOnRenderThread();
+
+	GFieldStorage_RenderThread.Predict(Mode, MaxExtrapolationIntervals);
+	SET_DWORD_STAT(STAT_RealityDistortion_FieldsPredicted, GFieldStorage_RenderThread.PredictedFields.Num());
+}
+
+void AnimateRealityDistortionFields_RenderThread()
+{
+	check(IsInRenderingThread());
+
+	GFieldStorage_RenderThread.Animate();
+	SET_DWORD_STAT(STAT_RealityDistortion_FieldsAnimated, GFieldStorage_RenderThread.AnimatedFields.Num());
+}
+
+FRealityDistortionFieldsView GetRealityDistortionFields_RenderThread()
+{
+	check(IsInRenderingThread() || IsInParallelRenderingThread());
+
+	const FFieldStorage& Storage = GFieldStorage_RenderThread;
+	const int32 NumSlots = Storage.NumSlots;
+
+	FRealityDistortionFieldsView View;
+	View.Centers = MakeArrayView(Storage.Centers.GetData(), NumSlots);
+	View.Radii = MakeArrayView(Storage.Radii.GetData(), NumSlots);
+	View.Strengths = MakeArrayView(Storage.Strengths.GetData(), NumSlots);
+	View.Enabled = MakeArrayView(Storage.Enabled.GetData(), NumSlots);
+	View.ReceiverTagFilters = MakeArrayView(Storage.ReceiverTagFilters.GetData(), NumSlots);
+	View.Priorities = MakeArrayView(Storage.Priorities.GetData(), NumSlots);
+	View.Shapes = MakeArrayView(Storage.Shapes.GetData(), NumSlots);
+	View.Rotations = MakeArrayView(Storage.Rotations.GetData(), NumSlots);
+	View.Extents = MakeArrayView(Storage.Extents.GetData(), NumSlots);
+	View.AnimationBounds = MakeArrayView(Storage.AnimationBounds.GetData(), NumSlots);
+	return View;
+}
@@ -3,16 +3,22 @@
 // Reality Distortion Field Management API
 // ----------------------------------------
 // 提供 GT/RT 双向的力场数据管理接口
+// GT→RT 通过单生产者/单消费者无锁队列传递增量，GT 每帧提交一次栅栏，RT 只消费栅栏之前的增量（见 RealityDistortionField.cpp）。
+// 动画与运动预测使用力场时钟：每个句柄绑定所属世界的时间，GT 采样与 RT 求值读的是同一个时钟。
 
 #pragma once
 
 #include "CoreMinimal.h"
+#include "RealityDistortionDefinitions.h"
+
+class UWorld;
 
 // ============================================================================
 // 常量定义
 // ============================================================================
-constexpr uint32 RealityDistortionInvalidFieldHandle = 0;
-constexpr uint32 MAX_DISTORTION_FIELDS = 4;
+constexpr uint64 RealityDistortionInvalidFieldHandle = 0;
+// 与 HLSL 共用同一个定义（Shaders/Shared/RealityDistortionDefinitions.h）。
+constexpr uint32 MAX_DISTORTION_FIELDS = REALITY_DISTORTION_MAX_FIELDS;
 
 // ============================================================================
 // 力场设置结构体
@@ -21,31 +27,256 @@ constexpr uint32 MAX_DISTORTION_FIELDS = 4;
 struct FRealityDistortionFieldSettings
 {
 	FVector Center = FVector::ZeroVector;
+	// 包围球半径；球形力场即半径本身，其余形状由 Extent 推出（见 ComputeRealityDistortionFieldShapeBoundingRadius）。
 	float Radius = 0.0f;
 	float Strength = 1.0f;
 	bool bEnabled = false;
 	FName ReceiverTagFilter = NAME_None;
+	// 可见力场超过每个 ViewFamily 的预算时，优先级高的先上传（见 RealityDistortionFieldSelection.h）。
+	int32 Priority = 0;
+	// 形状（REALITY_DISTORTION_FIELD_SHAPE_*）、局部 → 世界旋转与 Extent，含义见 Rendering/RealityDistortionFieldShapes.h。
+	uint8 Shape = REALITY_DISTORTION_FIELD_SHAPE_SPHERE;
+	FQuat Rotation = FQuat::Identity;
+	FVector3f Extent = FVector3f::ZeroVector;
 
 	FRealityDistortionFieldSettings() = default;
+
+	// GT 变化检测用：完全相同的设置不再推送。
+	bool operator==(const FRealityDistortionFieldSettings& Other) const
+	{
+		return Center == Other.Center
+			&& Radius == Other.Radius
+			&& Strength == Other.Strength
+			&& bEnabled == Other.bEnabled
+			&& ReceiverTagFilter == Other.ReceiverTagFilter
+			&& Priority == Other.Priority
+			&& Shape == Other.Shape
+			&& Rotation == Other.Rotation
+			&& Extent == Other.Extent;
+	}
+
+	bool operator!=(const FRealityDistortionFieldSettings& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+// ============================================================================
+// 力场动画描述
+// ============================================================================
+// 脉动、环绕一类的动画由 RT 按力场时钟求值（AnimateRealityDistortionFields_RenderThread），
+// 描述只在变化时推送一次：动画力场不需要 GT Tick，也没有逐帧的 GT→RT 流量。
+// 求值结果作用在 GT 推送的基准设置上：中心加偏移，半径与形状尺寸乘 RadiusScale，强度乘 StrengthScale。
+constexpr int32 RealityDistortionAnimationCurveKeys = 16;
+constexpr int32 RealityDistortionAnimationSplinePoints = 16;
+
+struct FRealityDistortionFieldAnimation
+{
+	// 曲线与样条运动的循环周期（秒）；<= 0 时二者不生效。
+	float Period = 0.0f;
+	// 时间偏移（秒），让同一套动画的多个力场错开相位。
+	float TimeOffset = 0.0f;
+
+	// 半径 / 强度倍率曲线：一个周期内等间隔的采样，首尾相接循环，线性插值。Num*Keys 为 0 表示不使用。
+	TStaticArray<float, RealityDistortionAnimationCurveKeys> RadiusCurve = TStaticArray<float, RealityDistortionAnimationCurveKeys>(InPlace, 1.0f);
+	TStaticArray<float, RealityDistortionAnimationCurveKeys> StrengthCurve = TStaticArray<float, RealityDistortionAnimationCurveKeys>(InPlace, 1.0f);
+	uint8 NumRadiusKeys = 0;
+	uint8 NumStrengthKeys = 0;
+
+	// 正弦振荡：倍率再乘 (1 + Amplitude * sin(2π * (Frequency * t + Phase)))，与 Period 无关。
+	float RadiusOscillationAmplitude = 0.0f;
+	float StrengthOscillationAmplitude = 0.0f;
+	float OscillationFrequency = 0.0f;
+	float OscillationPhase = 0.0f;
+
+	// 样条运动：按弧长等距采样的点（相对基准中心的偏移），每个周期匀速走完一遍。
+	// 闭合样条末点接回首点；开放样条往返（前半周期去，后半周期回）。NumSplinePoints < 2 表示不使用。
+	TStaticArray<FVector3f, RealityDistortionAnimationSplinePoints> SplinePoints = TStaticArray<FVector3f, RealityDistortionAnimationSplinePoints>(InPlace, FVector3f::ZeroVector);
+	uint8 NumSplinePoints = 0;
+	bool bSplineClosedLoop = false;
+
+	bool HasCurves() const
+	{
+		return Period > 0.0f && (NumRadiusKeys > 0 || NumStrengthKeys > 0 || NumSplinePoints >= 2);
+	}
+
+	bool HasOscillation() const
+	{
+		return OscillationFrequency != 0.0f && (RadiusOscillationAmplitude != 0.0f || StrengthOscillationAmplitude != 0.0f);
+	}
+
+	bool IsAnimated() const
+	{
+		return HasCurves() || HasOscillation();
+	}
+
+	bool operator==(const FRealityDistortionFieldAnimation& Other) const
+	{
+		return Period == Other.Period
+			&& TimeOffset == Other.TimeOffset
+			&& RadiusCurve == Other.RadiusCurve
+			&& StrengthCurve == Other.StrengthCurve
+			&& NumRadiusKeys == Other.NumRadiusKeys
+			&& NumStrengthKeys == Other.NumStrengthKeys
+			&& RadiusOscillationAmplitude == Other.RadiusOscillationAmplitude
+			&& StrengthOscillationAmplitude == Other.StrengthOscillationAmplitude
+			&& OscillationFrequency == Other.OscillationFrequency
+			&& OscillationPhase == Other.OscillationPhase
+			&& SplinePoints == Other.SplinePoints
+			&& NumSplinePoints == Other.NumSplinePoints
+			&& bSplineClosedLoop == Other.bSplineClosedLoop;
+	}
+
+	bool operator!=(const FRealityDistortionFieldAnimation& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+struct FRealityDistortionFieldAnimationSample
+{
+	FVector3f CenterOffset = FVector3f::ZeroVector;
+	float RadiusScale = 1.0f;
+	float StrengthScale = 1.0f;
+};
+
+// 在 TimeSeconds（力场时钟）处求值；纯函数，GT / RT / 测试都可调用。
+REALITYDISTORTION_API FRealityDistortionFieldAnimationSample EvaluateRealityDistortionFieldAnimation(const FRealityDistortionFieldAnimation& Animation, double TimeSeconds);
+
+// 动画在整个周期内可能到达的包围球：基准中心加样条偏移，基准半径乘最大半径倍率。
+// 力场空间索引登记这个球而不是逐帧的求值结果，基准值不变时动画力场不会让索引与缓存接收体失效。
+REALITYDISTORTION_API FSphere ComputeRealityDistortionFieldAnimationBounds(const FRealityDistortionFieldAnimation& Animation, const FVector& BaseCenter, float BaseRadius);
+
+// ============================================================================
+// 力场运动预测
+// ============================================================================
+// 降频推送的力场（组件按间隔 Tick）在推送时带上采样时刻（力场时钟，见 GetRealityDistortionFieldTimeSeconds_GameThread），
+// RT 用最近两次采样在两次推送之间外推 / 内插中心与半径（PredictRealityDistortionFieldMotion_RenderThread）。
+enum class ERealityDistortionFieldMotionPrediction : uint8
+{
+	// 保持最近一次采样。
+	None = 0,
+	// 按最近两次采样的速度外推，超过 MaxExtrapolationIntervals 个推送间隔后停住。无延迟，匀速运动无误差，急停会短暂过冲。
+	Extrapolate = 1,
+	// 延迟一个推送间隔，在最近两次采样之间插值。不会过冲，但力场落后发射器一个间隔。
+	Interpolate = 2,
+};
+
+// 组件推送间隔的上限。
+constexpr float RealityDistortionMaxFieldUpdateInterval = 1.0f;
+// 两次采样间隔超过该值时视为停下后重新起步，不求速度。Tick 按帧对齐，实际间隔会略长于推送间隔，留出余量。
+constexpr float RealityDistortionMaxFieldSampleInterval = 2.0f * RealityDistortionMaxFieldUpdateInterval;
+
+struct FRealityDistortionFieldMotionSamples
+{
+	FVector PreviousCenter = FVector::ZeroVector;
+	float PreviousRadius = 0.0f;
+	double PreviousTime = -1.0;
+	FVector LastCenter = FVector::ZeroVector;
+	float LastRadius = 0.0f;
+	double LastTime = -1.0;
+
+	// 两次采样都有效且时刻递增时才能求速度。
+	bool HasVelocity() const
+	{
+		return PreviousTime >= 0.0 && LastTime > PreviousTime;
+	}
+};
+
+struct FRealityDistortionFieldMotionSample
+{
+	FVector Center = FVector::ZeroVector;
+	float Radius = 0.0f;
+};
+
+// 在 TimeSeconds（力场时钟）处预测中心与半径；纯函数，RT / 测试都可调用。没有速度时返回最近一次采样。
+// MaxExtrapolationIntervals 以该力场自己的采样间隔（LastTime - PreviousTime）为单位。
+REALITYDISTORTION_API FRealityDistortionFieldMotionSample EvaluateRealityDistortionFieldMotion(
+	const FRealityDistortionFieldMotionSamples& Samples,
+	double TimeSeconds,
+	ERealityDistortionFieldMotionPrediction Mode,
+	double MaxExtrapolationIntervals);
+
+// ============================================================================
+// RT 侧力场数据（SoA）
+// ============================================================================
+// 下标即槽位号，各数组长度相同（写入过的最高槽位 + 1）。
+// 未启用 / 已销毁的槽位 Enabled 为 false、Radius 为 0。Radii 是包围球半径，形状数据见 Shapes / Rotations / Extents。
+// 动画力场的中心 / 半径 / 强度 / Extent 是本帧的求值结果，降频推送的力场的中心 / 半径 / Extent 是本帧的预测结果。
+// AnimationBounds 是动画力场整个周期的包围球（见 ComputeRealityDistortionFieldAnimationBounds），非动画槽位 W = 0。
+struct FRealityDistortionFieldsView
+{
+	TConstArrayView<FVector> Centers;
+	TConstArrayView<float> Radii;
+	TConstArrayView<float> Strengths;
+	TConstArrayView<bool> Enabled;
+	TConstArrayView<FName> ReceiverTagFilters;
+	TConstArrayView<int32> Priorities;
+	TConstArrayView<uint8> Shapes;
+	TConstArrayView<FQuat> Rotations;
+	TConstArrayView<FVector3f> Extents;
+	TConstArrayView<FSphere> AnimationBounds;
+
+	int32 Num() const
+	{
+		return Radii.Num();
+	}
+
+	bool IsActive(int32 SlotIndex) const
+	{
+		return Enabled[SlotIndex] && Radii[SlotIndex] > 0.0f;
+	}
 };
 
 // ============================================================================
 // GameThread API - 力场句柄管理
 // ============================================================================
+// 句柄 = (32 位代数 << 32) | 槽位号，低 32 位即 SoA 下标。创建/销毁不分配内存；销毁后旧句柄的所有调用都会被忽略。
+// 代数每个槽位 40 亿次复用才回绕，实际运行中过期句柄不会与新句柄重合。
 // 创建一个新的力场句柄（每个 UDistortionFieldComponent 调用一次）
-REALITYDISTORTION_API uint32 CreateRealityDistortionFieldHandle_GameThread();
+// World：力场所属的世界，句柄的力场时钟即该世界的 GetTimeSeconds（随暂停与时间膨胀）；为空时使用应用时间。
+// 注册表被所有世界共用（编辑器、PIE、预览场景），按句柄区分时钟，一个世界的 ViewFamily 不会用自己的时间求值别的世界的力场。
+REALITYDISTORTION_API uint64 CreateRealityDistortionFieldHandle_GameThread(const UWorld* World = nullptr);
 
 // 销毁力场句柄（组件 OnUnregister 时调用）
-REALITYDISTORTION_API void DestroyRealityDistortionFieldHandle_GameThread(uint32 Handle);
+REALITYDISTORTION_API void DestroyRealityDistortionFieldHandle_GameThread(uint64 Handle);
+
+// 句柄是否仍然有效（未销毁、未被 Reset）。
+REALITYDISTORTION_API bool IsRealityDistortionFieldHandleValid_GameThread(uint64 Handle);
 
-// 设置力场参数（每帧 Tick 时调用，将数据推送到 RT）
-REALITYDISTORTION_API void SetRealityDistortionFieldSettings_GameThread(uint32 Handle, const FRealityDistortionFieldSettings& Settings);
+// 句柄的力场时钟当前时间（秒）；句柄无效时返回 0。
+REALITYDISTORTION_API double GetRealityDistortionFieldTimeSeconds_GameThread(uint64 Handle);
+
+// 设置力场参数（仅在参数变化时调用）。写入增量队列，RT 在下一次 Drain 时生效
+// SampleTimeSeconds：采样时刻（GetRealityDistortionFieldTimeSeconds_GameThread）。>= 0 时 RT 记录运动历史并在两次推送之间做运动预测；
+// < 0（默认）表示每帧推送或发生了瞬移，RT 清空历史、直接使用该采样。
+REALITYDISTORTION_API void SetRealityDistortionFieldSettings_GameThread(uint64 Handle, const FRealityDistortionFieldSettings& Settings, double SampleTimeSeconds = -1.0);
+
+// 设置力场动画（仅在描述变化时调用）。传入 IsAnimated() 为 false 的描述即停止动画，力场回到基准设置。
+REALITYDISTORTION_API void SetRealityDistortionFieldAnimation_GameThread(uint64 Handle, const FRealityDistortionFieldAnimation& Animation);
 
 // 重置所有力场（模块启动时调用，清理 PIE/热重载残留）
 REALITYDISTORTION_API void ResetRealityDistortionFields_GameThread();
 
+// 提交帧栅栏：入队一条渲染命令，让 RT 消费此前写入的全部增量。
+// ViewExtension 在每帧第一个 BeginRenderViewFamily 时调用，同一帧的所有 ViewFamily 看到同一份力场数据；
+// 模块在帧末（FCoreDelegates::OnEndFrame）再调用一次，没有 ViewFamily 渲染时增量也不会一直积压。
+// 同时采样各力场时钟，RT 的动画与预测使用这次采样；自上次提交以来没有新增量且本帧已采样过时钟时不入队。
+REALITYDISTORTION_API void SubmitRealityDistortionFieldUpdates_GameThread();
+
 // ============================================================================
 // RenderThread API - 力场数据读取
 // ============================================================================
-// 获取当前所有活跃的力场设置（在 RT 调用，用于 PassProcessor 和 Shader 绑定）
-REALITYDISTORTION_API TConstArrayView<FRealityDistortionFieldSettings> GetRealityDistortionFieldSettings_RenderThread();
+// 消费最近一次提交的栅栏之前的增量（由 SubmitRealityDistortionFieldUpdates_GameThread 入队的渲染命令调用，
+// 早于同一帧所有 ViewFamily 的打包与空间索引）。栅栏之后写入的增量留到下一次提交。
+REALITYDISTORTION_API void DrainRealityDistortionFieldUpdates_RenderThread();
+
+// 按各自的力场时钟预测所有降频推送力场的中心 / 半径（ViewExtension 在 Drain 之后、Animate 之前调用）
+REALITYDISTORTION_API void PredictRealityDistortionFieldMotion_RenderThread();
+
+// 按各自的力场时钟求值所有动画力场并写回 SoA 数据（ViewExtension 在 Predict 之后、力场选择之前调用）
+// 动画作用在预测后的基准值上，二者可以叠加。时钟每帧采样一次，同一帧的所有 ViewFamily 结果相同。
+REALITYDISTORTION_API void AnimateRealityDistortionFields_RenderThread();
+
+// 获取当前所有力场（在 RT 调用，用于每个 ViewFamily 的力场选择）
+REALITYDISTORTION_API FRealityDistortionFieldsView GetRealityDistortionFields_RenderThread();
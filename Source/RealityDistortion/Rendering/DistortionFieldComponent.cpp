@@ -3,14 +3,31 @@
 #include "Rendering/DistortionFieldComponent.h"
 
 #include "RealityDistortionField.h"
+#include "Components/SplineComponent.h"
+#include "Curves/CurveFloat.h"
 #include "DrawDebugHelpers.h"
+#include "GameFramework/Actor.h"
+#include "Rendering/RealityDistortionFieldShapes.h"
+#include "Rendering/RealityDistortionStats.h"
+#include "UObject/UObjectGlobals.h"
+
+static_assert(static_cast<uint8>(EDistortionFieldShape::Sphere) == REALITY_DISTORTION_FIELD_SHAPE_SPHERE
+	&& static_cast<uint8>(EDistortionFieldShape::Box) == REALITY_DISTORTION_FIELD_SHAPE_BOX
+	&& static_cast<uint8>(EDistortionFieldShape::Capsule) == REALITY_DISTORTION_FIELD_SHAPE_CAPSULE
+	&& static_cast<uint8>(EDistortionFieldShape::Cylinder) == REALITY_DISTORTION_FIELD_SHAPE_CYLINDER,
+	"EDistortionFieldShape must match REALITY_DISTORTION_FIELD_SHAPE_*");
 
 UDistortionFieldComponent::UDistortionFieldComponent()
 {
-	// Field 发射器默认每帧推送一次，以便位置移动时立即影响过滤结果。
+	// 默认不 Tick：变换更新（OnUpdateTransform）、属性修改与 RefreshField 唤醒 Tick，
+	// 唤醒后每次 Tick 采样推送，一次 Tick 没有任何变化就重新休眠（见 WakeFieldTick / TickComponent），
+	// 静止力场在游戏与编辑器里都没有 Tick 开销。
+	// 设置了推送间隔时唤醒期间按间隔 Tick（见 UpdateFieldTickInterval），中间帧由 RT 预测；
+	// 事件驱动模式与游戏世界里的动画力场从不 Tick（见 UpdateFieldTickEnabled）。
+	// 暂停时场景不动，不需要 Tick；bTickInEditor 只为编辑器里的唤醒与调试可视化保留。
 	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.bStartWithTickEnabled = true;
-	PrimaryComponentTick.bTickEvenWhenPaused = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.bTickEvenWhenPaused = false;
 	bTickInEditor = true;
 }
 
@@ -19,7 +36,11 @@ void UDistortionFieldComponent::EnsureFieldHandle()
 	if (FieldHandle == RealityDistortionInvalidFieldHandle)
 	{
 		// 每个发射器组件独占一个 Handle，RT 侧通过 Handle 做 upsert。
-		FieldHandle = CreateRealityDistortionFieldHandle_GameThread();
+		// 句柄绑定所属世界的时钟：动画与运动预测使用该世界的时间。
+		FieldHandle = CreateRealityDistortionFieldHandle_GameThread(GetWorld());
+		bHasPushedSettings = false;
+		bLastPushMoved = false;
+		LastPushedAnimation = FRealityDistortionFieldAnimation();
 	}
 }
 
@@ -30,51 +51,329 @@ void UDistortionFieldComponent::OnRegister()
 
 	// 注册后立刻推一次，避免第一帧读到默认值。
 	PushFieldSettingsToRenderer();
+	PushFieldAnimationToRenderer();
+	BindAnimationSpline();
+	UpdateFieldTickEnabled();
+
+#if WITH_EDITOR
+	if (!ObjectPropertyChangedHandle.IsValid())
+	{
+		ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddUObject(this, &UDistortionFieldComponent::OnObjectPropertyChanged);
+	}
+#endif
 }
 
 void UDistortionFieldComponent::OnUnregister()
 {
+	UnbindAnimationSpline();
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+	ObjectPropertyChangedHandle.Reset();
+#endif
+
 	if (FieldHandle != RealityDistortionInvalidFieldHandle)
 	{
-		// 先推送禁用状态，再销毁 Handle，避免 RT 保留脏数据。
-		// 顺序是：Disable -> Destroy，这样 RT 在处理队列时不会短暂读到“悬空有效数据”。
-		FRealityDistortionFieldSettings DisabledSettings;
-		DisabledSettings.bEnabled = false;
-		SetRealityDistortionFieldSettings_GameThread(FieldHandle, DisabledSettings);
-
+		// 销毁 Handle 时注册表会在同一个更新包里把该槽位写成禁用状态，
+		// RT 不会保留脏数据，槽位被复用时也不会继承旧参数。
 		DestroyRealityDistortionFieldHandle_GameThread(FieldHandle);
 		FieldHandle = RealityDistortionInvalidFieldHandle;
+		bHasPushedSettings = false;
+		bLastPushMoved = false;
+		LastPushedAnimation = FRealityDistortionFieldAnimation();
 	}
 
 	Super::OnUnregister();
 }
 
+void UDistortionFieldComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+	// 不 Tick 的力场（休眠 / 动画 / 事件驱动）靠这里跟随移动；醒着的 Tick 力场由 Tick 采样（降频时不在每次移动时推送），
+	// 只有瞬移立即推送，避免 RT 在新旧位置之间外推。
+	// 样条路径固定在世界空间、按相对力场中心的偏移烘焙，中心移动后与设置一起重新烘焙（Tick 里同样先推设置再推动画）。
+	const bool bTeleported = Teleport != ETeleportType::None;
+	if (!IsComponentTickEnabled() || bTeleported)
+	{
+		PushFieldSettingsToRenderer(bTeleported);
+		if (BoundAnimationSpline.IsValid())
+		{
+			PushFieldAnimationToRenderer();
+		}
+	}
+	WakeFieldTick();
+}
+
+void UDistortionFieldComponent::RegisterComponentTickFunctions(bool bRegister)
+{
+	Super::RegisterComponentTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		UpdateFieldTickEnabled();
+	}
+}
+
+#if WITH_EDITOR
+void UDistortionFieldComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// 事件驱动的力场不 Tick，属性修改（含切换模式与调试可视化）在这里推送并更新 Tick 状态。
+	if (IsRegistered())
+	{
+		RefreshField();
+	}
+}
+
+void UDistortionFieldComponent::PostEditUndo()
+{
+	Super::PostEditUndo();
+
+	if (IsRegistered())
+	{
+		RefreshField();
+	}
+}
+#endif
+
+void UDistortionFieldComponent::RefreshField()
+{
+	PushFieldSettingsToRenderer();
+	PushFieldAnimationToRenderer();
+	BindAnimationSpline();
+	WakeFieldTick();
+}
+
+void UDistortionFieldComponent::OnFieldSettingsPropertySet()
+{
+	// 与 OnUpdateTransform 相同：不 Tick 的力场（休眠 / 动画 / 事件驱动）立即推送，醒着的 Tick 力场交给 Tick 采样，
+	// 降频推送的间隔不被打乱。设置只在变化时推送，每帧赋同样的值没有 RT 流量。
+	if (IsRegistered())
+	{
+		if (!IsComponentTickEnabled())
+		{
+			PushFieldSettingsToRenderer();
+		}
+		WakeFieldTick();
+	}
+}
+
+void UDistortionFieldComponent::SetEnableField(bool bNewEnableField)
+{
+	bEnableField = bNewEnableField;
+	OnFieldSettingsPropertySet();
+}
+
+void UDistortionFieldComponent::SetFieldCenterOffset(FVector NewFieldCenterOffset)
+{
+	FieldCenterOffset = NewFieldCenterOffset;
+	OnFieldSettingsPropertySet();
+}
+
+void UDistortionFieldComponent::SetFieldShape(EDistortionFieldShape NewFieldShape)
+{
+	FieldShape = NewFieldShape;
+	OnFieldSettingsPropertySet();
+}
+
+void UDistortionFieldComponent::SetFieldRadius(float NewFieldRadius)
+{
+	FieldRadius = NewFieldRadius;
+	OnFieldSettingsPropertySet();
+}
+
+void UDistortionFieldComponent::SetFieldBoxExtent(FVector NewFieldBoxExtent)
+{
+	FieldBoxExtent = NewFieldBoxExtent;
+	OnFieldSettingsPropertySet();
+}
+
+void UDistortionFieldComponent::SetFieldHalfHeight(float NewFieldHalfHeight)
+{
+	FieldHalfHeight = NewFieldHalfHeight;
+	OnFieldSettingsPropertySet();
+}
+
+void UDistortionFieldComponent::SetFieldStrength(float NewFieldStrength)
+{
+	FieldStrength = NewFieldStrength;
+	OnFieldSettingsPropertySet();
+}
+
+void UDistortionFieldComponent::SetReceiverTagFilter(FName NewReceiverTagFilter)
+{
+	ReceiverTagFilter = NewReceiverTagFilter;
+	OnFieldSettingsPropertySet();
+}
+
+void UDistortionFieldComponent::SetFieldPriority(int32 NewFieldPriority)
+{
+	FieldPriority = NewFieldPriority;
+	OnFieldSettingsPropertySet();
+}
+
+void UDistortionFieldComponent::BindAnimationSpline()
+{
+	USplineComponent* Spline = (bAnimateField && AnimationSplineActor) ? AnimationSplineActor->FindComponentByClass<USplineComponent>() : nullptr;
+	if (Spline == BoundAnimationSpline.Get() && (Spline == nullptr || AnimationSplineTransformHandle.IsValid()))
+	{
+		return;
+	}
+
+	UnbindAnimationSpline();
+	if (Spline != nullptr)
+	{
+		BoundAnimationSpline = Spline;
+		AnimationSplineTransformHandle = Spline->TransformUpdated.AddUObject(this, &UDistortionFieldComponent::OnAnimationSplineTransformUpdated);
+	}
+}
+
+void UDistortionFieldComponent::UnbindAnimationSpline()
+{
+	if (USplineComponent* Spline = BoundAnimationSpline.Get())
+	{
+		Spline->TransformUpdated.Remove(AnimationSplineTransformHandle);
+	}
+	BoundAnimationSpline.Reset();
+	AnimationSplineTransformHandle.Reset();
+}
+
+void UDistortionFieldComponent::OnAnimationSplineTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	// 路径按相对力场中心的偏移烘焙，样条移动后偏移随之改变。
+	PushFieldAnimationToRenderer();
+}
+
+#if WITH_EDITOR
+void UDistortionFieldComponent::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (Object != nullptr && (Object == BoundAnimationSpline.Get() || Object == AnimationSplineActor))
+	{
+		// 换了样条组件（例如删除后重新添加）时顺带重新绑定。
+		BindAnimationSpline();
+		PushFieldAnimationToRenderer();
+	}
+}
+#endif
+
+void UDistortionFieldComponent::WakeFieldTick()
+{
+	bFieldTickAwake = true;
+	UpdateFieldTickEnabled();
+}
+
+void UDistortionFieldComponent::UpdateFieldTickEnabled()
+{
+	const UWorld* World = GetWorld();
+	const bool bAnimatedInGame = bAnimateField && World != nullptr && World->IsGameWorld();
+	const bool bEventDriven = UpdateMode == EDistortionFieldUpdateMode::EventDriven;
+	const bool bNeedsTick = bShowDebugVisualization || (bFieldTickAwake && !bAnimatedInGame && !bEventDriven);
+	if (IsComponentTickEnabled() != bNeedsTick)
+	{
+		SetComponentTickEnabled(bNeedsTick);
+	}
+	UpdateFieldTickInterval();
+}
+
+bool UDistortionFieldComponent::UsesReducedUpdateRate() const
+{
+	const UWorld* World = GetWorld();
+	return UpdateMode == EDistortionFieldUpdateMode::Tick
+		&& World != nullptr && World->IsGameWorld() && IsComponentTickEnabled() && !bShowDebugVisualization
+		&& (FieldUpdateInterval > 0.0f || bScaleUpdateIntervalByDistance);
+}
+
+void UDistortionFieldComponent::UpdateFieldTickInterval()
+{
+	float TickInterval = 0.0f;
+	if (UsesReducedUpdateRate())
+	{
+		TickInterval = FieldUpdateInterval;
+
+		// 距离取上一帧渲染过的所有视点中最近的一个，到力场包围球表面。
+		const TArray<FVector>& ViewLocations = GetWorld()->ViewLocationsRenderedLastFrame;
+		if (bScaleUpdateIntervalByDistance && ViewLocations.Num() > 0 && bHasPushedSettings)
+		{
+			double MinDistance = UE_BIG_NUMBER;
+			for (const FVector& ViewLocation : ViewLocations)
+			{
+				MinDistance = FMath::Min(MinDistance, FVector::Dist(ViewLocation, LastPushedSettings.Center) - LastPushedSettings.Radius);
+			}
+			const float DistanceAlpha = static_cast<float>(FMath::Clamp(MinDistance / FarUpdateDistance, 0.0, 1.0));
+			TickInterval = FMath::Lerp(FieldUpdateInterval, FarFieldUpdateInterval, DistanceAlpha);
+		}
+
+		TickInterval = FMath::Clamp(TickInterval, 0.0f, RealityDistortionMaxFieldUpdateInterval);
+	}
+
+	// 距离缩放时间隔连续变化，变化很小时不重新设置。
+	if (!FMath::IsNearlyEqual(GetComponentTickInterval(), TickInterval, 0.005f))
+	{
+		SetComponentTickInterval(TickInterval);
+	}
+}
+
 void UDistortionFieldComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
 	// Tick 时只做参数采样与推送，不在 GT 侧做渲染决策。
-	PushFieldSettingsToRenderer();
+	// 动画描述同样只在变化时推送（编辑器里拖动样条 / 修改曲线时会走到这里）。
+	const bool bPushedSettings = PushFieldSettingsToRenderer();
+	const bool bPushedAnimation = PushFieldAnimationToRenderer();
+
+	// 一次 Tick 没有任何变化：重新休眠，直到下一次变换更新 / 属性修改把它唤醒。
+	// 调试可视化需要每帧绘制，保持 Tick。
+	if (!bPushedSettings && !bPushedAnimation)
+	{
+		bFieldTickAwake = false;
+		UpdateFieldTickEnabled();
+	}
+	else if (bScaleUpdateIntervalByDistance)
+	{
+		UpdateFieldTickInterval();
+	}
 
 	// 绘制调试可视化
 	if (bShowDebugVisualization && GetWorld())
 	{
-		FVector Center = GetComponentLocation() + FieldCenterOffset;
+		const FRealityDistortionFieldSettings DebugSettings = MakeFieldSettings();
+		const FVector Center = DebugSettings.Center;
+		const FVector3f& Extent = DebugSettings.Extent;
 
-		const float ScaledRadius = FieldRadius * GetComponentScale().GetMax();
+		// 包围球半径，用于文本位置与显示。
+		const float ScaledRadius = DebugSettings.Radius;
 
-		// 绘制半透明球体显示作用范围
-		DrawDebugSphere(
-			GetWorld(),
-			Center,
-			ScaledRadius,
-			32,  // 球体段数
-			DebugColor,
-			false,  // 不持久化
-			-1.0f,  // 持续时间（-1 表示一帧）
-			0,      // 深度优先级
-			2.0f    // 线条粗细
-		);
+		// 按形状绘制作用范围（线框，不持久化，持续一帧，线条粗细 2）
+		switch (FieldShape)
+		{
+		case EDistortionFieldShape::Box:
+			DrawDebugBox(GetWorld(), Center, FVector(Extent), DebugSettings.Rotation, DebugColor, false, -1.0f, 0, 2.0f);
+			break;
+		case EDistortionFieldShape::Capsule:
+			DrawDebugCapsule(GetWorld(), Center, Extent.Z + Extent.X, Extent.X, DebugSettings.Rotation, DebugColor, false, -1.0f, 0, 2.0f);
+			break;
+		case EDistortionFieldShape::Cylinder:
+		{
+			const FVector Axis = DebugSettings.Rotation.GetAxisZ() * Extent.Z;
+			DrawDebugCylinder(GetWorld(), Center - Axis, Center + Axis, Extent.X, 32, DebugColor, false, -1.0f, 0, 2.0f);
+			break;
+		}
+		default:
+			DrawDebugSphere(
+				GetWorld(),
+				Center,
+				ScaledRadius,
+				32,  // 球体段数
+				DebugColor,
+				false,  // 不持久化
+				-1.0f,  // 持续时间（-1 表示一帧）
+				0,      // 深度优先级
+				2.0f    // 线条粗细
+			);
+			break;
+		}
 
 		// 绘制中心点
 		DrawDebugPoint(
@@ -114,23 +413,147 @@ void UDistortionFieldComponent::TickComponent(float DeltaTime, ELevelTick TickTy
 	}
 }
 
-void UDistortionFieldComponent::PushFieldSettingsToRenderer() const
+FRealityDistortionFieldSettings UDistortionFieldComponent::MakeFieldSettings() const
 {
-	if (FieldHandle == RealityDistortionInvalidFieldHandle)
-	{
-		return;
-	}
-
-	const float ScaledRadius = FieldRadius * GetComponentScale().GetMax();
+	const FVector Scale = GetComponentScale().GetAbs();
 
 	FRealityDistortionFieldSettings FieldSettings;
 	FieldSettings.Center = GetComponentLocation() + FieldCenterOffset;
-	FieldSettings.Radius = ScaledRadius;
+	FieldSettings.Shape = static_cast<uint8>(FieldShape);
 	FieldSettings.Strength = FieldStrength;
-	FieldSettings.bEnabled = IsRegistered() && bEnableField && ScaledRadius > 0.0f;
 	FieldSettings.ReceiverTagFilter = ReceiverTagFilter;
+	FieldSettings.Priority = FieldPriority;
 
-	// 通过 GameThread API 入队，真正写入发生在 RT 的命令队列消费阶段。
+	// 球保持原来的“半径 × 最大缩放”；其余形状随组件旋转，尺寸按各轴缩放（圆截面取 XY 的较大值）。
+	switch (FieldShape)
+	{
+	case EDistortionFieldShape::Box:
+		FieldSettings.Rotation = GetComponentQuat();
+		FieldSettings.Extent = FVector3f(FieldBoxExtent * Scale);
+		break;
+	case EDistortionFieldShape::Capsule:
+	{
+		const float ScaledRadius = FieldRadius * static_cast<float>(FMath::Max(Scale.X, Scale.Y));
+		FieldSettings.Rotation = GetComponentQuat();
+		FieldSettings.Extent = FVector3f(ScaledRadius, ScaledRadius, FMath::Max(0.0f, FieldHalfHeight * static_cast<float>(Scale.Z) - ScaledRadius));
+		break;
+	}
+	case EDistortionFieldShape::Cylinder:
+	{
+		const float ScaledRadius = FieldRadius * static_cast<float>(FMath::Max(Scale.X, Scale.Y));
+		FieldSettings.Rotation = GetComponentQuat();
+		FieldSettings.Extent = FVector3f(ScaledRadius, ScaledRadius, FieldHalfHeight * static_cast<float>(Scale.Z));
+		break;
+	}
+	default:
+		FieldSettings.Extent = FVector3f(FieldRadius * static_cast<float>(GetComponentScale().GetMax()));
+		break;
+	}
+
+	FieldSettings.Radius = ComputeRealityDistortionFieldShapeBoundingRadius(FieldSettings.Shape, FieldSettings.Extent);
+	FieldSettings.bEnabled = IsRegistered() && bEnableField && FieldSettings.Radius > 0.0f
+		&& ComputeRealityDistortionFieldShapeFalloffDistance(FieldSettings.Shape, FieldSettings.Extent) > 0.0f;
+	return FieldSettings;
+}
+
+bool UDistortionFieldComponent::PushFieldSettingsToRenderer(bool bTeleported)
+{
+	if (FieldHandle == RealityDistortionInvalidFieldHandle)
+	{
+		return false;
+	}
+
+	const FRealityDistortionFieldSettings FieldSettings = MakeFieldSettings();
+	const bool bReducedRate = UsesReducedUpdateRate();
+
+	// 变化检测：位置、形状、旋转、尺寸、强度、开关、Tag、优先级全部未变时跳过，不产生任何 RT 流量。
+	// 降频推送时，刚停下的力场还要再推一次同样的设置，RT 才会得到零速度而不继续外推。
+	if (bHasPushedSettings && FieldSettings == LastPushedSettings && !(bReducedRate && bLastPushMoved))
+	{
+		INC_DWORD_STAT(STAT_RealityDistortion_FieldUpdatesSkipped);
+		return false;
+	}
+
+	// 通过 GameThread API 写入增量队列，ViewExtension 在本帧第一个 BeginRenderViewFamily 时提交栅栏，RT 统一消费。
 	// 这里不直接触碰 RT 容器，避免 GT/RT 并发读写冲突。
-	SetRealityDistortionFieldSettings_GameThread(FieldHandle, FieldSettings);
+	// 采样时刻取自句柄的力场时钟，RT 用同一时钟在两次推送之间预测。
+	const double SampleTimeSeconds = (bReducedRate && !bTeleported) ? GetRealityDistortionFieldTimeSeconds_GameThread(FieldHandle) : -1.0;
+	bLastPushMoved = bHasPushedSettings && (FieldSettings.Center != LastPushedSettings.Center || FieldSettings.Radius != LastPushedSettings.Radius);
+	SetRealityDistortionFieldSettings_GameThread(FieldHandle, FieldSettings, SampleTimeSeconds);
+	LastPushedSettings = FieldSettings;
+	bHasPushedSettings = true;
+	return true;
+}
+
+FRealityDistortionFieldAnimation UDistortionFieldComponent::MakeFieldAnimation() const
+{
+	FRealityDistortionFieldAnimation Animation;
+	if (!bAnimateField)
+	{
+		return Animation;
+	}
+
+	Animation.Period = FMath::Max(AnimationPeriod, 0.01f);
+	Animation.TimeOffset = AnimationTimeOffset;
+	Animation.RadiusOscillationAmplitude = RadiusOscillationAmplitude;
+	Animation.StrengthOscillationAmplitude = StrengthOscillationAmplitude;
+	Animation.OscillationFrequency = OscillationFrequency;
+	Animation.OscillationPhase = OscillationPhase;
+
+	// 曲线在一个周期内等间隔采样，RT 线性插值并首尾相接。
+	constexpr int32 NumKeys = RealityDistortionAnimationCurveKeys;
+	if (RadiusScaleCurve)
+	{
+		for (int32 Key = 0; Key < NumKeys; ++Key)
+		{
+			Animation.RadiusCurve[Key] = RadiusScaleCurve->GetFloatValue(static_cast<float>(Key) / NumKeys);
+		}
+		Animation.NumRadiusKeys = NumKeys;
+	}
+	if (StrengthScaleCurve)
+	{
+		for (int32 Key = 0; Key < NumKeys; ++Key)
+		{
+			Animation.StrengthCurve[Key] = StrengthScaleCurve->GetFloatValue(static_cast<float>(Key) / NumKeys);
+		}
+		Animation.NumStrengthKeys = NumKeys;
+	}
+
+	// 样条按弧长等距采样：闭合样条不重复首点（RT 从末点插值回首点），开放样条包含两端。
+	const USplineComponent* Spline = AnimationSplineActor ? AnimationSplineActor->FindComponentByClass<USplineComponent>() : nullptr;
+	if (Spline && Spline->GetSplineLength() > UE_KINDA_SMALL_NUMBER)
+	{
+		constexpr int32 NumPoints = RealityDistortionAnimationSplinePoints;
+		const bool bClosedLoop = Spline->IsClosedLoop();
+		const float SplineLength = Spline->GetSplineLength();
+		const float PointSpacing = SplineLength / (bClosedLoop ? NumPoints : NumPoints - 1);
+		const FVector FieldCenter = GetComponentLocation() + FieldCenterOffset;
+		for (int32 Point = 0; Point < NumPoints; ++Point)
+		{
+			const FVector Location = Spline->GetLocationAtDistanceAlongSpline(Point * PointSpacing, ESplineCoordinateSpace::World);
+			Animation.SplinePoints[Point] = FVector3f(Location - FieldCenter);
+		}
+		Animation.NumSplinePoints = NumPoints;
+		Animation.bSplineClosedLoop = bClosedLoop;
+	}
+
+	return Animation;
+}
+
+bool UDistortionFieldComponent::PushFieldAnimationToRenderer()
+{
+	if (FieldHandle == RealityDistortionInvalidFieldHandle)
+	{
+		return false;
+	}
+
+	const FRealityDistortionFieldAnimation Animation = MakeFieldAnimation();
+	if (Animation == LastPushedAnimation)
+	{
+		return false;
+	}
+
+	SetRealityDistortionFieldAnimation_GameThread(FieldHandle, Animation);
+	LastPushedAnimation = Animation;
+	return true;
 }
@@ -4,15 +4,54 @@
 // -----------------------------------
 // 职责：
 // 1) 在 GT 上维护一个 FieldHandle 的生命周期。
-// 2) 采样组件位置/半径并推送给 Renderer（SetRealityDistortionFieldSettings_GameThread）。
+// 2) 采样组件位置/旋转/形状尺寸，仅在变化时推送给 Renderer（SetRealityDistortionFieldSettings_GameThread）。
 // 3) 不直接参与 DrawCall，只提供“空间影响范围”数据。
+// 4) 动画（Distortion|Animation）烘焙成紧凑描述只推送一次，由 RT 按力场时钟（所属世界的时间）求值；
+//    游戏世界里动画力场不 Tick，移动由 OnUpdateTransform 推送，运行时改属性后调用 RefreshField。
+//    样条路径固定在世界空间：本组件移动、样条 Actor 移动（TransformUpdated）或在编辑器里编辑样条（OnObjectPropertyChanged）时
+//    重新烘焙路径。
+// 5) 降频推送（Distortion|Update）：游戏世界里按间隔（可随到相机的距离放宽）Tick，推送附带采样时刻，
+//    两次推送之间由 RT 用最近两次采样外推 / 内插中心与半径；瞬移时立即推送并丢弃历史。
+// 6) 事件驱动（UpdateMode = EventDriven）：只在注册 / 注销、OnUpdateTransform、编辑器属性修改与 RefreshField 时推送，
+//    不 Tick（显示调试可视化时除外），大关卡编辑时不再为每个力场付出 Tick 开销。
+// 7) Tick 模式默认也不 Tick：变换更新 / 属性修改 / RefreshField 唤醒 Tick，一次 Tick 没有变化即休眠，
+//    静止力场在游戏与编辑器里都不付出 Tick 开销。
+// 8) 力场设置属性（开关、形状、尺寸、强度、Tag、优先级）带 BlueprintSetter：蓝图赋值与 C++ 调用 Set* 会推送并唤醒 Tick，
+//    每帧改半径的蓝图脉冲不需要额外调用 RefreshField。
 
 #pragma once
 
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
+#include "RealityDistortionField.h"
 #include "DistortionFieldComponent.generated.h"
 
+class UCurveFloat;
+class USplineComponent;
+
+// 力场形状，数值与 REALITY_DISTORTION_FIELD_SHAPE_* 一致（见 RealityDistortionFieldShapes.h）。
+// 胶囊与圆柱沿组件局部 Z 轴。
+UENUM(BlueprintType)
+enum class EDistortionFieldShape : uint8
+{
+	Sphere = 0,
+	Box = 1,
+	Capsule = 2,
+	Cylinder = 3,
+};
+
+// 力场的采样 / 推送时机。
+UENUM(BlueprintType)
+enum class EDistortionFieldUpdateMode : uint8
+{
+	// 变换更新 / 属性修改时唤醒 Tick 采样（可用 FieldUpdateInterval 降频），一次 Tick 没有变化即休眠。
+	// 蓝图赋值 / Set* 会推送并唤醒；C++ 直接写成员后需调用 RefreshField。
+	Tick,
+	// 只在注册 / 注销、变换更新、属性修改（含蓝图赋值 / Set*）与 RefreshField 时推送；不 Tick（显示调试可视化时除外）。
+	// C++ 直接写成员后需调用 RefreshField。
+	EventDriven,
+};
+
 UCLASS(ClassGroup=(Rendering), meta=(BlueprintSpawnableComponent))
 class REALITYDISTORTION_API UDistortionFieldComponent : public USceneComponent
 {
@@ -25,28 +64,142 @@ public:
 	virtual void OnUnregister() override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditUndo() override;
+#endif
+
+	// 重新采样属性与动画（曲线 / 样条）并推送；不 Tick 的力场（动画 / 事件驱动）在运行时修改属性后调用。
+	UFUNCTION(BlueprintCallable, Category = "Distortion|Field")
+	void RefreshField();
+
+	// 力场设置属性的 BlueprintSetter：写入后推送（与上次推送相同则跳过）并唤醒 Tick。
+	UFUNCTION(BlueprintSetter)
+	void SetEnableField(bool bNewEnableField);
+
+	UFUNCTION(BlueprintSetter)
+	void SetFieldCenterOffset(FVector NewFieldCenterOffset);
+
+	UFUNCTION(BlueprintSetter)
+	void SetFieldShape(EDistortionFieldShape NewFieldShape);
+
+	UFUNCTION(BlueprintSetter)
+	void SetFieldRadius(float NewFieldRadius);
+
+	UFUNCTION(BlueprintSetter)
+	void SetFieldBoxExtent(FVector NewFieldBoxExtent);
+
+	UFUNCTION(BlueprintSetter)
+	void SetFieldHalfHeight(float NewFieldHalfHeight);
+
+	UFUNCTION(BlueprintSetter)
+	void SetFieldStrength(float NewFieldStrength);
+
+	UFUNCTION(BlueprintSetter)
+	void SetReceiverTagFilter(FName NewReceiverTagFilter);
+
+	UFUNCTION(BlueprintSetter)
+	void SetFieldPriority(int32 NewFieldPriority);
+
 	// 发射器开关：关闭后仍保留句柄，但会以 bEnabled=false 推送到 RT。
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Field")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetEnableField, Category = "Distortion|Field")
 	bool bEnableField = true;
 
 	// 发射器中心偏移（相对于组件世界位置）。
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Field")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetFieldCenterOffset, Category = "Distortion|Field")
 	FVector FieldCenterOffset = FVector::ZeroVector;
 
-	// 作用半径（世界空间）。
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Field", meta = (ClampMin = "0.0"))
+	// 力场形状，随组件旋转；尺寸按组件缩放。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetFieldShape, Category = "Distortion|Field")
+	EDistortionFieldShape FieldShape = EDistortionFieldShape::Sphere;
+
+	// 作用半径（球 / 胶囊 / 圆柱，局部空间）。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetFieldRadius, Category = "Distortion|Field", meta = (ClampMin = "0.0", EditCondition = "FieldShape != EDistortionFieldShape::Box"))
 	float FieldRadius = 500.0f;
 
+	// 盒形半边长（局部空间）。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetFieldBoxExtent, Category = "Distortion|Field", meta = (ClampMin = "0.0", EditCondition = "FieldShape == EDistortionFieldShape::Box"))
+	FVector FieldBoxExtent = FVector(500.0f, 500.0f, 500.0f);
+
+	// 胶囊 / 圆柱沿局部 Z 的半高（局部空间）。胶囊与 UCapsuleComponent 一致，包含两端半球。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetFieldHalfHeight, Category = "Distortion|Field", meta = (ClampMin = "0.0", EditCondition = "FieldShape == EDistortionFieldShape::Capsule || FieldShape == EDistortionFieldShape::Cylinder"))
+	float FieldHalfHeight = 500.0f;
+
 	// 力场强度（控制扭曲程度）。
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Field")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetFieldStrength, Category = "Distortion|Field")
 	float FieldStrength = 1.0f;
 
 	// 力场匹配用 Tag。
 	// None：不做 Tag 过滤（命中半径即可）。
 	// 非 None：仅影响”组件 Tag 或 Actor Tag”命中该值的接收体。
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Field")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetReceiverTagFilter, Category = "Distortion|Field")
 	FName ReceiverTagFilter = NAME_None;
 
+	// 上传优先级：可见力场超过 r.RealityDistortion.MaxFieldsPerView 时，高优先级的先上传，同优先级按屏幕尺寸排序。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetFieldPriority, Category = "Distortion|Field")
+	int32 FieldPriority = 0;
+
+	// 由 RT 按帧时间求值的动画（见 FRealityDistortionFieldAnimation），开启后游戏世界里不再 Tick。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation")
+	bool bAnimateField = false;
+
+	// 曲线与样条运动的周期（秒）。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation", meta = (ClampMin = "0.01", EditCondition = "bAnimateField"))
+	float AnimationPeriod = 2.0f;
+
+	// 时间偏移（秒），让多个力场错开相位。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation", meta = (EditCondition = "bAnimateField"))
+	float AnimationTimeOffset = 0.0f;
+
+	// 半径（含形状尺寸）倍率曲线，横轴为一个周期内的归一化时间 [0, 1)，首尾相接循环。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation", meta = (EditCondition = "bAnimateField"))
+	TObjectPtr<UCurveFloat> RadiusScaleCurve;
+
+	// 强度倍率曲线，横轴同上。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation", meta = (EditCondition = "bAnimateField"))
+	TObjectPtr<UCurveFloat> StrengthScaleCurve;
+
+	// 正弦振荡：倍率乘 (1 + 振幅 * sin(2π * (频率 * t + 相位)))。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation", meta = (EditCondition = "bAnimateField"))
+	float RadiusOscillationAmplitude = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation", meta = (EditCondition = "bAnimateField"))
+	float StrengthOscillationAmplitude = 0.0f;
+
+	// 振荡频率（Hz）。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation", meta = (EditCondition = "bAnimateField"))
+	float OscillationFrequency = 0.0f;
+
+	// 振荡相位（周期数，[0, 1)）。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation", meta = (EditCondition = "bAnimateField"))
+	float OscillationPhase = 0.0f;
+
+	// 沿该 Actor 上第一个 USplineComponent 匀速运动，每个周期走完一遍（闭合样条循环，开放样条往返）。
+	// 路径固定在样条的世界位置，不随本组件移动：按相对力场中心的偏移烘焙，本组件移动、样条 Actor 移动或编辑样条时重新烘焙。
+	// 运行时用 SetSplinePoints 一类接口改样条后调用 RefreshField。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Animation", meta = (EditCondition = "bAnimateField"))
+	TObjectPtr<AActor> AnimationSplineActor;
+
+	// 采样 / 推送时机，见 EDistortionFieldUpdateMode。运行时切换后调用 RefreshField。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Update")
+	EDistortionFieldUpdateMode UpdateMode = EDistortionFieldUpdateMode::Tick;
+
+	// 推送间隔（秒），0 表示每帧采样推送。> 0 时游戏世界里按该间隔 Tick，
+	// 两次推送之间由 RT 预测位置与半径（r.RealityDistortion.FieldMotionPrediction）。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Update", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "UpdateMode == EDistortionFieldUpdateMode::Tick"))
+	float FieldUpdateInterval = 0.0f;
+
+	// 按力场到最近相机的距离放宽推送间隔：贴近相机为 FieldUpdateInterval，FarUpdateDistance 及以外为 FarFieldUpdateInterval。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Update", meta = (EditCondition = "UpdateMode == EDistortionFieldUpdateMode::Tick"))
+	bool bScaleUpdateIntervalByDistance = false;
+
+	// 到力场包围球表面的距离（cm）。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Update", meta = (ClampMin = "1.0", EditCondition = "bScaleUpdateIntervalByDistance"))
+	float FarUpdateDistance = 10000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Update", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bScaleUpdateIntervalByDistance"))
+	float FarFieldUpdateInterval = 0.25f;
+
 	// 是否显示调试可视化（编辑器中显示力场范围）
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Debug")
 	bool bShowDebugVisualization = false;
@@ -55,13 +208,70 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Debug")
 	FColor DebugColor = FColor::Cyan;
 
+protected:
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport) override;
+	// 注册 Tick 函数时会按 bStartWithTickEnabled 重新启用 Tick，这里再按更新模式关闭。
+	virtual void RegisterComponentTickFunctions(bool bRegister) override;
+
 private:
 	// 延迟创建 Handle，保证每个组件对应一个独立 Field 实例。
 	void EnsureFieldHandle();
 
-	// GT 采样组件状态并通过 SetRealityDistortionFieldSettings_GameThread 推送到 RT。
-	void PushFieldSettingsToRenderer() const;
+	// 按组件变换与形状属性计算世界空间的力场设置。
+	FRealityDistortionFieldSettings MakeFieldSettings() const;
+
+	// GT 采样组件状态，与上次推送的结果不同时才通过 SetRealityDistortionFieldSettings_GameThread 推送到 RT。
+	// 降频推送时附带采样时刻；bTeleported 时不带，RT 丢弃运动历史。返回是否推送。
+	bool PushFieldSettingsToRenderer(bool bTeleported = false);
+
+	// 游戏世界里 Tick 且设置了推送间隔（不显示调试可视化）时为 true。
+	bool UsesReducedUpdateRate() const;
+
+	// 按推送间隔（及到相机的距离）设置 Tick 间隔；不降频时恢复每帧 Tick。
+	void UpdateFieldTickInterval();
+
+	// 把动画属性烘焙成 FRealityDistortionFieldAnimation（曲线采样、样条按弧长等距采样）。
+	FRealityDistortionFieldAnimation MakeFieldAnimation() const;
+
+	// 与上次推送的动画描述不同时才推送。返回是否推送。
+	bool PushFieldAnimationToRenderer();
+
+	// 监听 AnimationSplineActor 上样条的移动，样条变化时重新烘焙并推送（动画力场不 Tick，不能靠 Tick 发现）。
+	// 注册、RefreshField（含编辑器属性修改）时重新绑定，注销时解绑。
+	void BindAnimationSpline();
+	void UnbindAnimationSpline();
+	void OnAnimationSplineTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+#if WITH_EDITOR
+	// 编辑器里拖动样条点 / 修改样条属性不会触发 TransformUpdated，由这里重新烘焙。
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+	FDelegateHandle ObjectPropertyChangedHandle;
+#endif
+
+	TWeakObjectPtr<USplineComponent> BoundAnimationSpline;
+	FDelegateHandle AnimationSplineTransformHandle;
+
+	// 只有醒着的 Tick 模式力场保持 Tick：事件驱动的力场、游戏世界里的动画力场关闭 Tick；显示调试可视化时总是 Tick。
+	void UpdateFieldTickEnabled();
+
+	// 有变化（变换更新 / 属性修改 / RefreshField）时唤醒 Tick，下一次没有变化的 Tick 会让它重新休眠。
+	void WakeFieldTick();
+
+	// Set* 的公共部分：已注册时推送设置（Tick 醒着时交给 Tick）并唤醒 Tick；未注册时由 OnRegister 推送。
+	void OnFieldSettingsPropertySet();
+
+	// Tick 模式下是否处于唤醒状态（默认休眠）。
+	bool bFieldTickAwake = false;
 
 	// 0 代表无效句柄（RealityDistortionInvalidFieldHandle）。
-	uint32 FieldHandle = 0;
+	uint64 FieldHandle = 0;
+
+	// 上次推送的设置，用于变化检测。
+	FRealityDistortionFieldSettings LastPushedSettings;
+	bool bHasPushedSettings = false;
+	// 上次推送时中心或半径有变化：降频推送时即使设置不变也再推一次，让 RT 得到零速度、停止外推。
+	bool bLastPushMoved = false;
+
+	// 上次推送的动画描述；新句柄的槽位在 RT 上没有动画，对应默认值。
+	FRealityDistortionFieldAnimation LastPushedAnimation;
 };
@@ -0,0 +1,81 @@
+﻿// DistortionInstancedMeshComponent.cpp
+
+#include "Rendering/DistortionInstancedMeshComponent.h"
+
+#include "Engine/StaticMesh.h"
+#include "Materials/Material.h"
+#include "RealityDistortion.h"
+#include "Rendering/DistortionInstancedSceneProxy.h"
+#include "Rendering/DistortionMeshComponent.h"
+#include "Rendering/RealityDistortionMeshClusterData.h"
+#include "Rendering/RealityDistortionShaders.h"
+#include "RenderingThread.h"
+#include "UObject/ConstructorHelpers.h"
+
+UDistortionInstancedMeshComponent::UDistortionInstancedMeshComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// 与 UDistortionMeshComponent 相同的默认覆盖材质。
+	static ConstructorHelpers::FObjectFinder<UMaterial> DefaultMaterialFinder(
+		TEXT("/Engine/EngineMaterials/WorldGridMaterial"));
+	if (DefaultMaterialFinder.Succeeded())
+	{
+		OverrideMaterial = DefaultMaterialFinder.Object;
+	}
+}
+
+void UDistortionInstancedMeshComponent::CollectPSOPrecacheData(const FPSOPrecacheParams& BasePrecachePSOParams, FMaterialInterfacePSOPrecacheParamsList& OutParams)
+{
+	Super::CollectPSOPrecacheData(BasePrecachePSOParams, OutParams);
+
+	if (bEnableDistortionReceiver)
+	{
+		AddDistortionOverrideMaterialPSOPrecacheData(OverrideMaterial, BasePrecachePSOParams, OutParams);
+	}
+}
+
+void UDistortionInstancedMeshComponent::SendRenderInstanceData_Concurrent()
+{
+	Super::SendRenderInstanceData_Concurrent();
+
+	// Nanite 回退时 SceneProxy 是父类的 Proxy，没有需要失效的缓存。
+	if (SceneProxy == nullptr || SceneProxy->GetTypeHash() != FDistortionInstancedSceneProxy::GetStaticTypeHash())
+	{
+		return;
+	}
+
+	// 与实例更新同样经由渲染命令队列，Proxy 在此命令之后才会被销毁。
+	FDistortionInstancedSceneProxy* DistortionProxy = static_cast<FDistortionInstancedSceneProxy*>(SceneProxy);
+	ENQUEUE_RENDER_COMMAND(RealityDistortionMarkInstanceCullingDirty)(
+		[DistortionProxy](FRHICommandListImmediate&)
+		{
+			DistortionProxy->MarkInstanceCullingDirty_RenderThread();
+		});
+}
+
+FPrimitiveSceneProxy* UDistortionInstancedMeshComponent::CreateSceneProxy()
+{
+	UStaticMesh* Mesh = GetStaticMesh();
+	if (Mesh == nullptr || Mesh->GetRenderData() == nullptr || !Mesh->GetRenderData()->IsInitialized())
+	{
+		return nullptr;
+	}
+
+	// Nanite 网格不经过 MeshPassProcessor，无法进入本 Pass，保持父类行为。
+	if (ShouldCreateNaniteProxy())
+	{
+		UE_LOG(LogRealityDistortion, Verbose, TEXT("[RealityDistortion] %s uses Nanite, instanced distortion receiver disabled."), *GetPathName());
+		return Super::CreateSceneProxy();
+	}
+
+	// 与 UDistortionMeshComponent 相同：标记为 Receiver，BasePass 的 clip 只对它生效。
+	SetCustomPrimitiveDataFloat(0, 1.0f);
+
+	// 实例化接收体不做簇剔除，只在顶点阶段影响度需要最长三角形边时读取网格的簇数据。
+	if (bEnableDistortionReceiver && IsRealityDistortionVertexInfluenceEnabled())
+	{
+		RequestRealityDistortionMeshClusters(Mesh, this, true);
+	}
+
+	return ::new FDistortionInstancedSceneProxy(this, GetWorld()->GetFeatureLevel());
+}
@@ -0,0 +1,46 @@
+﻿// DistortionInstancedMeshComponent.h
+//
+// UDistortionInstancedMeshComponent（实例化 Receiver）
+// ---------------------------------------------------
+// 职责：
+// 1) 继承 UInstancedStaticMeshComponent，大量相同接收体（一面墙的箱子）只占一个组件 / 一个 Proxy。
+// 2) 与 UDistortionMeshComponent 相同的覆盖材质劫持与接收体开关。
+// 3) RealityDistortion Pass 只提交与力场相交的实例（见 FDistortionInstancedSceneProxy）。
+//
+// 注意：
+// - 使用 Nanite 的网格会回退到父类 Proxy，不参与本 Pass。
+// - UHierarchicalInstancedStaticMeshComponent 是独立的组件类，不会创建本 Proxy，也不参与本 Pass；
+//   需要实例化接收体时直接使用本组件（GPU Scene 下的逐实例剔除由引擎完成，不依赖 HISM 的层级）。
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "DistortionInstancedMeshComponent.generated.h"
+
+UCLASS(ClassGroup=(Rendering), meta=(BlueprintSpawnableComponent))
+class REALITYDISTORTION_API UDistortionInstancedMeshComponent : public UInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	UDistortionInstancedMeshComponent(const FObjectInitializer& ObjectInitializer);
+
+	// 切换为 FDistortionInstancedSceneProxy。
+	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+
+	// 实例数据更新后通知 Proxy 重算与力场相交的实例（见 FDistortionInstancedSceneProxy::UpdateInstanceCulling）。
+	virtual void SendRenderInstanceData_Concurrent() override;
+
+	// PSO 预缓存：补上覆盖材质（实例化 VertexFactory）。
+	virtual void CollectPSOPrecacheData(const FPSOPrecacheParams& BasePrecachePSOParams, FMaterialInterfacePSOPrecacheParamsList& OutParams) override;
+
+	// 覆盖材质：所有实例的 MeshBatch.MaterialRenderProxy 都会被替换为此材质的 RenderProxy。
+	// 需要列在 r.RealityDistortion.PassMaterials 里（见 GetDistortionPassMaterial）。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion")
+	TObjectPtr<UMaterialInterface> OverrideMaterial;
+
+	// Receiver 主开关：false 表示该组件的所有实例都不作为 Distortion 接收体。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Receiver")
+	bool bEnableDistortionReceiver = true;
+};
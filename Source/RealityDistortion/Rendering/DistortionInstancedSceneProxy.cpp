@@ -0,0 +1,308 @@
+﻿// DistortionInstancedSceneProxy.cpp
+
+#include "Rendering/DistortionInstancedSceneProxy.h"
+
+#include "InstanceDataSceneProxy.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialRenderProxy.h"
+#include "Rendering/DistortionInstancedMeshComponent.h"
+#include "Rendering/DistortionMeshComponent.h"
+#include "Rendering/RealityDistortionMeshClusterData.h"
+#include "Rendering/RealityDistortionFieldCulling.h"
+#include "Rendering/RealityDistortionShaders.h"
+#include "Rendering/RealityDistortionStats.h"
+#include "SceneManagement.h"
+
+DEFINE_STAT(STAT_RealityDistortion_InstancesTested);
+DEFINE_STAT(STAT_RealityDistortion_InstancesSubmitted);
+
+namespace
+{
+	// 本帧提交的实例区间副本，由 Collector 在帧末释放。
+	struct FDistortionInstanceRunsResource : public FOneFrameResource
+	{
+		TArray<uint32> InstanceRuns;
+	};
+
+	// 父类 DrawStaticElements 在 GetMeshElement 之后才决定各 MeshBatch 是否用于深度 PrePass，
+	// 这里在提交时逐个改写：
+	// - 覆盖材质的 Section（bUseForMaterial）进入深度 PrePass，DepthOnly 的 clip 才能在深度里挖洞；
+	// - 只带默认材质的合并深度网格（!bUseForMaterial）不再写深度，只保留阴影用途。
+	// 深度里已经有洞，BasePass 保持 full prepass 下的只读深度，不需要 r.BasePassWriteDepthEvenWithFullPrepass。
+	class FDistortionReceiverDepthPDI : public FStaticPrimitiveDrawInterface
+	{
+	public:
+		explicit FDistortionReceiverDepthPDI(FStaticPrimitiveDrawInterface* InPDI)
+			: PDI(InPDI)
+		{
+		}
+
+		virtual void SetHitProxy(HHitProxy* HitProxy) override
+		{
+			PDI->SetHitProxy(HitProxy);
+		}
+
+		virtual void ReserveMemoryForMeshes(int32 MeshNum) override
+		{
+			PDI->ReserveMemoryForMeshes(MeshNum);
+		}
+
+		virtual void DrawMesh(const FMeshBatch& Mesh, float ScreenSize) override
+		{
+			FMeshBatch ReceiverMesh = Mesh;
+			ReceiverMesh.bUseForDepthPass = Mesh.bUseForMaterial;
+			ReceiverMesh.bUseAsOccluder = Mesh.bUseForMaterial && Mesh.bUseAsOccluder;
+			if (!ReceiverMesh.bUseForMaterial && !ReceiverMesh.CastShadow)
+			{
+				return;
+			}
+			PDI->DrawMesh(ReceiverMesh, ScreenSize);
+		}
+
+	private:
+		FStaticPrimitiveDrawInterface* PDI;
+	};
+}
+
+FDistortionInstancedSceneProxy::FDistortionInstancedSceneProxy(UDistortionInstancedMeshComponent* InComponent, ERHIFeatureLevel::Type InFeatureLevel)
+	: FInstancedStaticMeshSceneProxy(InComponent, InFeatureLevel)
+{
+#if WITH_EDITOR
+	// 编辑器验证：把 OverrideMaterial 加入 UsedMats，避免材质引用检查误报。
+	if (InComponent->OverrideMaterial)
+	{
+		TArray<UMaterialInterface*> UsedMats;
+		InComponent->GetUsedMaterials(UsedMats);
+		UsedMats.AddUnique(InComponent->OverrideMaterial);
+		SetUsedMaterialForVerification(UsedMats);
+	}
+#endif
+
+	// GT 拷贝纯数据，RT 不再访问组件。
+	bEnableDistortionReceiver = InComponent->bEnableDistortionReceiver;
+
+	if (UMaterialInterface* DistortionMaterial = GetDistortionPassMaterial(InComponent->OverrideMaterial))
+	{
+		OverrideMaterialProxy = DistortionMaterial->GetRenderProxy();
+	}
+
+	// 最长边随网格的簇数据构建一次（见 URealityDistortionMeshClusterData），这里不再拷贝缓冲区。
+	if (bEnableDistortionReceiver && RenderData != nullptr && IsRealityDistortionVertexInfluenceEnabled())
+	{
+		const FRealityDistortionMeshClustersPtr MeshClusters = FindRealityDistortionMeshClusters(InComponent->GetStaticMesh());
+		if (MeshClusters.IsValid() && MeshClusters->MatchesRenderData(*RenderData))
+		{
+			LocalMaxTriangleEdgeLength = MeshClusters->LocalMaxTriangleEdgeLength;
+		}
+	}
+}
+
+SIZE_T FDistortionInstancedSceneProxy::GetStaticTypeHash()
+{
+	static size_t UniquePointer;
+	return reinterpret_cast<size_t>(&UniquePointer);
+}
+
+SIZE_T FDistortionInstancedSceneProxy::GetTypeHash() const
+{
+	return GetStaticTypeHash();
+}
+
+FPrimitiveViewRelevance FDistortionInstancedSceneProxy::GetViewRelevance(const FSceneView* View) const
+{
+	FPrimitiveViewRelevance Result = FInstancedStaticMeshSceneProxy::GetViewRelevance(View);
+
+	// 静态缓存路径照常绘制全部实例；额外打开动态相关性，用于提交本 Pass 的实例子集。
+	if (bEnableDistortionReceiver && OverrideMaterialProxy)
+	{
+		Result.bDynamicRelevance = true;
+	}
+
+	return Result;
+}
+
+void FDistortionInstancedSceneProxy::DrawStaticElements(FStaticPrimitiveDrawInterface* PDI)
+{
+	if (!bEnableDistortionReceiver || OverrideMaterialProxy == nullptr)
+	{
+		FInstancedStaticMeshSceneProxy::DrawStaticElements(PDI);
+		return;
+	}
+
+	FDistortionReceiverDepthPDI ReceiverPDI(PDI);
+	FInstancedStaticMeshSceneProxy::DrawStaticElements(&ReceiverPDI);
+}
+
+bool FDistortionInstancedSceneProxy::GetMeshElement(
+	int32 LODIndex,
+	int32 BatchIndex,
+	int32 ElementIndex,
+	uint8 InDepthPriorityGroup,
+	bool bUseSelectionOutline,
+	bool bAllowPreCulledIndices,
+	FMeshBatch& OutMeshBatch) const
+{
+	if (!FInstancedStaticMeshSceneProxy::GetMeshElement(LODIndex, BatchIndex, ElementIndex, InDepthPriorityGroup, bUseSelectionOutline, bAllowPreCulledIndices, OutMeshBatch))
+	{
+		return false;
+	}
+
+	// 劫持点：与 FDistortionSceneProxy 相同，实例化的 VertexFactory / 实例数据都保持父类设置。
+	if (OverrideMaterialProxy)
+	{
+		OutMeshBatch.MaterialRenderProxy = OverrideMaterialProxy;
+	}
+	return true;
+}
+
+void FDistortionInstancedSceneProxy::OnTransformChanged(FRHICommandListBase& RHICmdList)
+{
+	FInstancedStaticMeshSceneProxy::OnTransformChanged(RHICmdList);
+	InstanceCulling.bDirty = true;
+}
+
+void FDistortionInstancedSceneProxy::UpdateInstanceCulling() const
+{
+	// 逐实例测试是 O(实例数)，只在结果可能变化时重算：
+	// - 力场索引重建（力场移动 / 增删 / 本 ViewFamily 的选择变化）；
+	// - 组件更新了实例数据或整体移动（bDirty，见 MarkInstanceCullingDirty_RenderThread / OnTransformChanged）；
+	// - 实例数变化（兜底，防止漏掉的增删实例越界访问）。
+	// 力场与接收体都静止时，之后每帧直接复用上一次的实例区间。
+	const FInstanceSceneDataBuffers* InstanceBuffers = GetInstanceSceneDataBuffers();
+	const int32 NumInstances = InstanceBuffers ? InstanceBuffers->GetNumInstances() : 0;
+	const uint32 FieldGridVersion = GetRealityDistortionFieldGridVersion_RenderThread();
+	if (!InstanceCulling.bDirty
+		&& InstanceCulling.FieldGridVersion == FieldGridVersion
+		&& InstanceCulling.NumInstances == NumInstances)
+	{
+		return;
+	}
+
+	InstanceCulling.bDirty = false;
+	InstanceCulling.FieldGridVersion = FieldGridVersion;
+	InstanceCulling.NumInstances = NumInstances;
+	InstanceCulling.InstanceRuns.Reset();
+	InstanceCulling.FieldMask = 0;
+	InstanceCulling.NumVisibleInstances = 0;
+	InstanceCulling.MaxInstanceScale = 0.0f;
+
+	const FRealityDistortionFieldGrid& FieldGrid = GetRealityDistortionFieldGrid_RenderThread();
+	if (FieldGrid.IsEmpty() || NumInstances == 0)
+	{
+		return;
+	}
+
+	// 先用整个 Primitive 的包围球粗筛，完全不相交时跳过逐实例测试。
+	const FBoxSphereBounds& PrimitiveBounds = GetBounds();
+	if (!FieldGrid.IntersectsAnyField(PrimitiveBounds.Origin, static_cast<float>(PrimitiveBounds.SphereRadius)))
+	{
+		return;
+	}
+
+	INC_DWORD_STAT_BY(STAT_RealityDistortion_InstancesTested, NumInstances);
+
+	// 相邻的相交实例合并为一个区间，实例墙里连续的一片只占一对 [First, Last]。
+	int32 RunStart = INDEX_NONE;
+	for (int32 InstanceIndex = 0; InstanceIndex < NumInstances; ++InstanceIndex)
+	{
+		const FBoxSphereBounds InstanceBounds = InstanceBuffers->GetInstanceWorldBounds(InstanceIndex);
+		const uint64 InstanceFieldMask = FieldGrid.GetOverlappingFieldMask(InstanceBounds.Origin, static_cast<float>(InstanceBounds.SphereRadius));
+
+		if (InstanceFieldMask != 0)
+		{
+			InstanceCulling.FieldMask |= InstanceFieldMask;
+			++InstanceCulling.NumVisibleInstances;
+			if (LocalMaxTriangleEdgeLength >= 0.0f)
+			{
+				InstanceCulling.MaxInstanceScale = FMath::Max(InstanceCulling.MaxInstanceScale,
+					static_cast<float>(InstanceBuffers->GetInstanceToWorld(InstanceIndex).GetMaximumAxisScale()));
+			}
+			if (RunStart == INDEX_NONE)
+			{
+				RunStart = InstanceIndex;
+			}
+		}
+		else if (RunStart != INDEX_NONE)
+		{
+			InstanceCulling.InstanceRuns.Add(RunStart);
+			InstanceCulling.InstanceRuns.Add(InstanceIndex - 1);
+			RunStart = INDEX_NONE;
+		}
+	}
+
+	if (RunStart != INDEX_NONE)
+	{
+		InstanceCulling.InstanceRuns.Add(RunStart);
+		InstanceCulling.InstanceRuns.Add(NumInstances - 1);
+	}
+}
+
+void FDistortionInstancedSceneProxy::GetDynamicMeshElements(
+	const TArray<const FSceneView*>& Views,
+	const FSceneViewFamily& ViewFamily,
+	uint32 VisibilityMap,
+	FMeshElementCollector& Collector) const
+{
+	// 调试视图（线框等）交给父类。
+	FInstancedStaticMeshSceneProxy::GetDynamicMeshElements(Views, ViewFamily, VisibilityMap, Collector);
+
+	if (!bEnableDistortionReceiver || OverrideMaterialProxy == nullptr || RenderData == nullptr)
+	{
+		return;
+	}
+
+	UpdateInstanceCulling();
+	if (InstanceCulling.InstanceRuns.IsEmpty())
+	{
+		return;
+	}
+
+	// 区间数据拷贝到单帧资源，生命周期覆盖本帧所有 DrawCommand 的构建与提交。
+	TArray<uint32>& InstanceRuns = Collector.AllocateOneFrameResource<FDistortionInstanceRunsResource>().InstanceRuns;
+	InstanceRuns = InstanceCulling.InstanceRuns;
+	const uint32 NumRuns = InstanceRuns.Num() / 2;
+
+	bool bSubmittedAnyView = false;
+	for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+	{
+		if ((VisibilityMap & (1 << ViewIndex)) == 0)
+		{
+			continue;
+		}
+
+		// 与 BasePass 相同的 LOD（父类 GetLOD），只夹到有效的驻留范围。
+		const int32 NumLODs = RenderData->LODResources.Num();
+		const int32 LODIndex = FMath::Clamp(GetLOD(Views[ViewIndex]), FMath::Min(RenderData->GetCurrentFirstLODIdx(0), NumLODs - 1), NumLODs - 1);
+		const FStaticMeshLODResources& LODModel = RenderData->LODResources[LODIndex];
+
+		for (int32 SectionIndex = 0; SectionIndex < LODModel.Sections.Num(); SectionIndex++)
+		{
+			FMeshBatch& MeshBatch = Collector.AllocateMesh();
+			if (!GetMeshElement(LODIndex, 0, SectionIndex, SDPG_World, false, false, MeshBatch))
+			{
+				continue;
+			}
+
+			// 只给 RealityDistortion Pass 使用：BasePass / 深度 / 阴影已经由静态缓存路径绘制全部实例。
+			MeshBatch.bUseForMaterial = false;
+			MeshBatch.bUseForDepthPass = false;
+			MeshBatch.bUseAsOccluder = false;
+			MeshBatch.CastShadow = false;
+			MeshBatch.SegmentIndex = SectionIndex;
+
+			FMeshBatchElement& BatchElement = MeshBatch.Elements[0];
+			BatchElement.bIsInstanceRuns = true;
+			BatchElement.InstanceRuns = InstanceRuns.GetData();
+			BatchElement.NumInstances = NumRuns;
+
+			Collector.AddMesh(ViewIndex, MeshBatch);
+			bSubmittedAnyView = true;
+		}
+	}
+
+	// 每个接收体每次收集只计一次，不随 Section 数与 View 数翻倍，与 Instances Tested 同一口径。
+	if (bSubmittedAnyView)
+	{
+		INC_DWORD_STAT_BY(STAT_RealityDistortion_InstancesSubmitted, InstanceCulling.NumVisibleInstances);
+	}
+}
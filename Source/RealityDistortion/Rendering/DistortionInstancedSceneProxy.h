@@ -0,0 +1,102 @@
+﻿// DistortionInstancedSceneProxy.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InstancedStaticMesh.h"
+
+class UDistortionInstancedMeshComponent;
+
+// 实例化接收体的渲染代理：
+// 1) GetMeshElement 劫持材质，静态缓存路径（BasePass 等）与 FDistortionSceneProxy 一致；
+//    覆盖材质的 Section 自己进入深度 PrePass，父类的合并深度网格只留给阴影。
+// 2) 静态 MeshBatch 会画出全部实例，RealityDistortion Pass 不使用它们；
+//    GetDynamicMeshElements 另外提交一份只给本 Pass 用的 MeshBatch，
+//    通过 InstanceRuns 只包含与力场相交的实例区间。
+class FDistortionInstancedSceneProxy : public FInstancedStaticMeshSceneProxy
+{
+public:
+	FDistortionInstancedSceneProxy(UDistortionInstancedMeshComponent* InComponent, ERHIFeatureLevel::Type InFeatureLevel);
+
+	// 激活接收体的静态 MeshBatch 逐个改写深度链路，见 FDistortionReceiverDepthPDI。
+	virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override;
+
+	virtual bool GetMeshElement(
+		int32 LODIndex,
+		int32 BatchIndex,
+		int32 ElementIndex,
+		uint8 InDepthPriorityGroup,
+		bool bUseSelectionOutline,
+		bool bAllowPreCulledIndices,
+		FMeshBatch& OutMeshBatch) const override;
+
+	virtual void GetDynamicMeshElements(
+		const TArray<const FSceneView*>& Views,
+		const FSceneViewFamily& ViewFamily,
+		uint32 VisibilityMap,
+		FMeshElementCollector& Collector) const override;
+
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override;
+	virtual SIZE_T GetTypeHash() const override;
+
+	// 整体移动后实例的世界包围盒都变了，下次收集时重算相交实例。
+	virtual void OnTransformChanged(FRHICommandListBase& RHICmdList) override;
+
+	// 组件更新实例数据（增删 / 移动实例）时由 GT 投递，下次收集时重算相交实例。
+	void MarkInstanceCullingDirty_RenderThread()
+	{
+		InstanceCulling.bDirty = true;
+	}
+
+	// 供 PassProcessor 在 AddMeshBatch 快速筛选。
+	static SIZE_T GetStaticTypeHash();
+
+	bool ShouldRenderInRealityDistortionPass() const
+	{
+		return bEnableDistortionReceiver;
+	}
+
+	// 是否为 GetDynamicMeshElements 专门给本 Pass 提交的（带实例区间的）MeshBatch。
+	static bool IsDistortionPassMeshBatch(const FMeshBatch& MeshBatch)
+	{
+		return MeshBatch.Elements.Num() == 1 && MeshBatch.Elements[0].bIsInstanceRuns;
+	}
+
+	// 相交实例覆盖的力场槽位掩码（所有相交实例的并集），与本帧提交的实例区间同步更新。
+	uint64 GetRelevantFieldMask() const
+	{
+		return InstanceCulling.FieldMask;
+	}
+
+	// 顶点阶段影响度使用的最长三角形边（世界空间，按相交实例的最大缩放放大）；负数表示未知。
+	float GetMaxTriangleEdgeLength() const
+	{
+		return LocalMaxTriangleEdgeLength < 0.0f ? -1.0f : LocalMaxTriangleEdgeLength * InstanceCulling.MaxInstanceScale;
+	}
+
+private:
+	// 力场索引或实例数据变化时重新计算相交实例的区间，否则沿用上一次的结果。
+	void UpdateInstanceCulling() const;
+
+	FMaterialRenderProxy* OverrideMaterialProxy = nullptr;
+	bool bEnableDistortionReceiver = true;
+
+	// 网格所有 LOD 的最长三角形边（局部空间），只在 r.RealityDistortion.VertexInfluence 开启时计算；-1 表示未知。
+	float LocalMaxTriangleEdgeLength = -1.0f;
+
+	// 以下仅在 RT 访问（GetDynamicMeshElements 与随后的 AddMeshBatch）。
+	struct FInstanceCullingCache
+	{
+		// [First, Last] 成对存放的实例区间（InstanceRuns 格式）。
+		TArray<uint32> InstanceRuns;
+		uint64 FieldMask = 0;
+		uint32 NumVisibleInstances = 0;
+		float MaxInstanceScale = 0.0f;
+
+		// 缓存键：力场索引版本、实例数，以及实例 / 变换的脏标记。
+		uint32 FieldGridVersion = MAX_uint32;
+		int32 NumInstances = INDEX_NONE;
+		bool bDirty = true;
+	};
+	mutable FInstanceCullingCache InstanceCulling;
+};
@@ -3,8 +3,13 @@
 #include "Rendering/DistortionMeshComponent.h"
 
 #include "Materials/Material.h"
+#include "PSOPrecache.h"
+#include "RealityDistortion.h"
 #include "Rendering/DistortionSceneProxy.h"
+#include "Rendering/RealityDistortionMeshClusterData.h"
+#include "Rendering/RealityDistortionShaders.h"
 #include "UObject/ConstructorHelpers.h"
+#include "UObject/ObjectKey.h"
 
 UDistortionMeshComponent::UDistortionMeshComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -19,7 +24,83 @@ UDistortionMeshComponent::UDistortionMeshComponent(const FObjectInitializer& Obj
 	}
 
 	// Receiver 走常规 PrePass / BasePass 深度链路。
-	// 具体“力场挖洞”在 DepthOnly + BasePass 的像素级 clip 里完成。
+	// 具体“力场挖洞”在 DepthOnly + BasePass 的像素级 clip 里完成：
+	// 深度 PrePass 已经带着洞，BasePass 只做 EQUAL 测试、不写深度，clip 不会破坏 early-Z。
+}
+
+UMaterialInterface* GetDistortionPassMaterial(UMaterialInterface* OverrideMaterial)
+{
+	if (IsRealityDistortionMaterialAllowed(OverrideMaterial))
+	{
+		return OverrideMaterial;
+	}
+
+	// 每个材质只提示一次：休眠切换会反复重建 Proxy。
+	static TSet<TObjectKey<UMaterialInterface>> ReportedMaterials;
+	if (OverrideMaterial && !ReportedMaterials.Contains(OverrideMaterial))
+	{
+		ReportedMaterials.Add(OverrideMaterial);
+		UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] %s is not listed in r.RealityDistortion.PassMaterials; receivers fall back to the default surface material."), *OverrideMaterial->GetPathName());
+	}
+	return UMaterial::GetDefaultMaterial(MD_Surface);
+}
+
+void AddDistortionOverrideMaterialPSOPrecacheData(
+	UMaterialInterface* OverrideMaterial,
+	const FPSOPrecacheParams& BasePrecachePSOParams,
+	FMaterialInterfacePSOPrecacheParamsList& OutParams)
+{
+	// 与 SceneProxy 构造函数的选择一致。
+	UMaterialInterface* DistortionMaterial = GetDistortionPassMaterial(OverrideMaterial);
+	if (DistortionMaterial == nullptr)
+	{
+		return;
+	}
+
+	// 覆盖材质绑定在原 Section 的 VertexFactory 上，直接复用父类收集到的 VF 列表。
+	FPSOPrecacheVertexFactoryDataList VertexFactoryDataList;
+	for (const FMaterialInterfacePSOPrecacheParams& MaterialParams : OutParams)
+	{
+		for (const FPSOPrecacheVertexFactoryData& VertexFactoryData : MaterialParams.VertexFactoryDataList)
+		{
+			VertexFactoryDataList.AddUnique(VertexFactoryData);
+		}
+	}
+
+	if (VertexFactoryDataList.IsEmpty())
+	{
+		return;
+	}
+
+	// 首次进入力场就会用到，优先级设为 High。
+	FMaterialInterfacePSOPrecacheParams& DistortionParams = OutParams[OutParams.AddDefaulted()];
+	DistortionParams.Priority = EPSOPrecachePriority::High;
+	DistortionParams.MaterialInterface = DistortionMaterial;
+	DistortionParams.VertexFactoryDataList = MoveTemp(VertexFactoryDataList);
+	DistortionParams.PSOPrecacheParams = BasePrecachePSOParams;
+}
+
+void UDistortionMeshComponent::CollectPSOPrecacheData(const FPSOPrecacheParams& BasePrecachePSOParams, FMaterialInterfacePSOPrecacheParamsList& OutParams)
+{
+	Super::CollectPSOPrecacheData(BasePrecachePSOParams, OutParams);
+
+	if (bEnableDistortionReceiver)
+	{
+		AddDistortionOverrideMaterialPSOPrecacheData(OverrideMaterial, BasePrecachePSOParams, OutParams);
+	}
+}
+
+void UDistortionMeshComponent::SetDistortionReceiverDormant(bool bDormant)
+{
+	check(IsInGameThread());
+	if (bDistortionReceiverDormant == bDormant)
+	{
+		return;
+	}
+
+	// 材质与 StaticRelevance 都在 Proxy 构造时确定，切换模式需要重建 Proxy。
+	bDistortionReceiverDormant = bDormant;
+	MarkRenderStateDirty();
 }
 
 FPrimitiveSceneProxy* UDistortionMeshComponent::CreateSceneProxy()
@@ -46,7 +127,20 @@ FPrimitiveSceneProxy* UDistortionMeshComponent::CreateSceneProxy()
 	// 通过 CustomPrimitiveData[0] 标记本 Primitive 为 Distortion Receiver，
 	// 这样 BasePassPixelShader.usf 里的 clip() 只对标记了的 mesh 生效，
 	// 避免普通 StaticMeshComponent 被误裁导致黑块。
-	SetCustomPrimitiveDataFloat(0, 1.0f);
+	// 休眠的接收体清掉标记：它按普通静态网格（原材质）渲染，不走 clip 分支。
+	SetCustomPrimitiveDataFloat(0, bDistortionReceiverDormant ? 0.0f : 1.0f);
+
+	// 洞只在深度 PrePass 里挖：不进 PrePass 的激活接收体在 full prepass 下会被 BasePass 的 EQUAL 测试整体丢弃。
+	if (!bRenderInDepthPass && bEnableDistortionReceiver && !bDistortionReceiverDormant)
+	{
+		UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] %s has bRenderInDepthPass disabled; field holes require the receiver in the depth prepass."), *GetPathName());
+	}
+
+	// 簇数据随网格构建一次；缺失或过期时在后台构建，完成后重建渲染状态（本次 Proxy 先整段提交）。
+	if (bEnableDistortionReceiver && !bDistortionReceiverDormant)
+	{
+		RequestRealityDistortionMeshClusters(GetStaticMesh(), this, IsRealityDistortionVertexInfluenceEnabled());
+	}
 
 	// 交给 FDistortionSceneProxy，后续 MeshBatch 会在其 GetDynamicMeshElements 中被”劫持”。
 	return new FDistortionSceneProxy(this);
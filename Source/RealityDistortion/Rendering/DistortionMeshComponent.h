@@ -10,6 +10,9 @@
 // 注意：
 // - 这个组件不负责“发射力场”，发射职责在 UDistortionFieldComponent。
 // - 这个组件不直接做渲染决策，真正决策在 FRealityDistortionPassProcessor::AddMeshBatch。
+// - 远离所有力场时组件进入休眠，按普通静态网格渲染（见 SetDistortionReceiverDormant）。
+// - 激活接收体的 MeshBatch 都进入深度 PrePass，由 DepthOnly 的 clip 挖洞；BasePass 保持 full prepass 下的只读深度，
+//   不修改引擎的 r.BasePassWriteDepthEvenWithFullPrepass。
 
 #pragma once
 
@@ -17,6 +20,18 @@
 #include "Components/StaticMeshComponent.h"
 #include "DistortionMeshComponent.generated.h"
 
+// 实际进入 RealityDistortion Pass 的材质：覆盖材质在 r.RealityDistortion.PassMaterials 里（见 IsRealityDistortionMaterialAllowed）
+// 时用它，否则用默认 Surface 材质。
+// 只在 GT 调用（SceneProxy 构造函数、PSO 预缓存）。
+REALITYDISTORTION_API UMaterialInterface* GetDistortionPassMaterial(UMaterialInterface* OverrideMaterial);
+
+// 把覆盖材质（经 GetDistortionPassMaterial 选择）按 OutParams 中已有的 VertexFactory 加入 PSO 预缓存列表。
+// UDistortionMeshComponent / UDistortionInstancedMeshComponent 共用。
+REALITYDISTORTION_API void AddDistortionOverrideMaterialPSOPrecacheData(
+	UMaterialInterface* OverrideMaterial,
+	const FPSOPrecacheParams& BasePrecachePSOParams,
+	FMaterialInterfacePSOPrecacheParamsList& OutParams);
+
 UCLASS(ClassGroup=(Rendering), meta=(BlueprintSpawnableComponent))
 class REALITYDISTORTION_API UDistortionMeshComponent : public UStaticMeshComponent
 {
@@ -29,13 +44,35 @@ public:
 	// 之后该 Primitive 在 RT 会以 FDistortionSceneProxy 的形态参与收集与过滤。
 	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
 
+	// PSO 预缓存：父类只收集网格自身的材质，这里补上实际参与渲染的覆盖材质，
+	// 让 RealityDistortion Pass（以及覆盖材质的 BasePass 等）在组件加载时就预编译 PSO。
+	virtual void CollectPSOPrecacheData(const FPSOPrecacheParams& BasePrecachePSOParams, FMaterialInterfacePSOPrecacheParamsList& OutParams) override;
+
 	// Phase 1 材质劫持入口。
 	// DistortionSceneProxy::GetDynamicMeshElements 会把 MeshBatch.MaterialRenderProxy
-	// 替换为此材质的 RenderProxy。
+	// 替换为此材质的 RenderProxy。需要列在 r.RealityDistortion.PassMaterials 里（见 GetDistortionPassMaterial）。
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion")
 	TObjectPtr<UMaterialInterface> OverrideMaterial;
 
 	// Receiver 主开关：false 表示该组件永远不作为 Distortion 接收体。
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Receiver")
 	bool bEnableDistortionReceiver = true;
+
+	// RealityDistortion Pass 额外的 LOD 偏移：在主渲染选中的 LOD 基础上再往粗糙方向偏移。
+	// 碎裂效果对几何精度不敏感，远处接收体可以用更低的 LOD 进入该 Pass；BasePass 不受影响。
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Distortion|Receiver", meta = (ClampMin = "0", ClampMax = "7", UIMin = "0", UIMax = "7"))
+	int32 DistortionPassLODBias = 0;
+
+	// 休眠：附近没有力场时，Proxy 按普通静态网格渲染（原材质 + 缓存 DrawCommand），不进入 RealityDistortion Pass。
+	// 由 RT 的邻近判定（r.RealityDistortion.DormantReceivers）通过 GT 任务切换，变化时重建渲染状态。
+	bool IsDistortionReceiverDormant() const
+	{
+		return bDistortionReceiverDormant;
+	}
+
+	void SetDistortionReceiverDormant(bool bDormant);
+
+private:
+	// 新组件从激活状态开始，避免出生在力场内的接收体先以原材质显示几帧。
+	bool bDistortionReceiverDormant = false;
 };
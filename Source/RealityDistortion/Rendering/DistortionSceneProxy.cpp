@@ -2,12 +2,27 @@
 
 #include "Rendering/DistortionSceneProxy.h"
 
+#include "Async/Async.h"
+#include "ComponentRecreateRenderStateContext.h"
 #include "GameFramework/Actor.h"
 #include "HAL/IConsoleManager.h"
 #include "Materials/Material.h"
 #include "Materials/MaterialRenderProxy.h"
 #include "Rendering/DistortionMeshComponent.h"
+#include "Rendering/RealityDistortionFieldCulling.h"
+#include "Rendering/RealityDistortionShaders.h"
+#include "Rendering/RealityDistortionStats.h"
+#include "SceneInterface.h"
 #include "SceneManagement.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_STAT(STAT_RealityDistortion_CachedReceivers);
+DEFINE_STAT(STAT_RealityDistortion_CachedReceiverInvalidations);
+DEFINE_STAT(STAT_RealityDistortion_TrianglesSubmitted);
+DEFINE_STAT(STAT_RealityDistortion_TrianglesCulled);
+DEFINE_STAT(STAT_RealityDistortion_ActiveReceivers);
+DEFINE_STAT(STAT_RealityDistortion_DormantReceivers);
+DEFINE_STAT(STAT_RealityDistortion_ReceiverDormancyChanges);
 
 namespace
 {
@@ -19,6 +34,80 @@ namespace
 		0,
 		TEXT("Force receiver mesh batches to disable backface culling. 0=Off, 1=On"),
 		ECVF_RenderThreadSafe);
+
+	// 1 = 接收体走 StaticRelevance，DrawCommand 被缓存，只在相关力场集合变化时失效重建。
+	// 0 = 旧路径：每帧 GetDynamicMeshElements 重新生成 MeshBatch 与 DrawCommand。
+	// 切换时重建所有组件的渲染状态，让 Proxy 按新模式重新创建。
+	static TAutoConsoleVariable<int32> CVarRealityDistortionCachedReceivers(
+		TEXT("r.RealityDistortion.CachedReceivers"),
+		1,
+		TEXT("Use cached mesh draw commands for distortion receivers. 0=Dynamic path every frame, 1=Cached (default)"),
+		FConsoleVariableDelegate::CreateLambda([](IConsoleVariable*)
+		{
+			FGlobalComponentRecreateRenderStateContext Context;
+		}),
+		ECVF_RenderThreadSafe);
+
+	// 大接收体的簇剔除：只提交与力场相交的三角形簇。
+	// 切换时重建渲染状态，Proxy 构造时按新设置引用（或忽略）网格的簇数据。
+	static TAutoConsoleVariable<int32> CVarRealityDistortionClusterCulling(
+		TEXT("r.RealityDistortion.ClusterCulling"),
+		1,
+		TEXT("Submit only triangle clusters that overlap a field for large receivers. 0=Whole sections, 1=Cluster culling (default)"),
+		FConsoleVariableDelegate::CreateLambda([](IConsoleVariable*)
+		{
+			FGlobalComponentRecreateRenderStateContext Context;
+		}),
+		ECVF_RenderThreadSafe);
+
+	// 1 = 远离所有力场的接收体休眠：按普通静态网格渲染（原材质 + 缓存 DrawCommand），不进入 RealityDistortion Pass。
+	// 切换时重建渲染状态；关闭后所有接收体都保持激活。
+	static TAutoConsoleVariable<int32> CVarRealityDistortionDormantReceivers(
+		TEXT("r.RealityDistortion.DormantReceivers"),
+		1,
+		TEXT("Render receivers far from every field as ordinary static meshes. 0=Always active, 1=Proximity gated (default)"),
+		FConsoleVariableDelegate::CreateLambda([](IConsoleVariable* CVar)
+		{
+			// 关闭时唤醒所有休眠组件，保证组件状态（CustomPrimitiveData）与 Proxy 一致。
+			if (CVar->GetInt() == 0)
+			{
+				for (TObjectIterator<UDistortionMeshComponent> It; It; ++It)
+				{
+					It->SetDistortionReceiverDormant(false);
+				}
+			}
+			FGlobalComponentRecreateRenderStateContext Context;
+		}),
+		ECVF_RenderThreadSafe);
+
+	// 唤醒距离：力场球进入“接收体包围球 + EnterMargin”即唤醒。
+	// 唤醒需要经过 GT 重建 Proxy（约 1~2 帧），余量要覆盖这段时间内力场的移动距离。
+	static TAutoConsoleVariable<float> CVarRealityDistortionDormantEnterMargin(
+		TEXT("r.RealityDistortion.DormantReceivers.EnterMargin"),
+		500.0f,
+		TEXT("Distance (cm) from a receiver's bounds at which an approaching field wakes it up."),
+		ECVF_RenderThreadSafe);
+
+	// 休眠距离：必须不小于 EnterMargin，两者之差就是滞回带。
+	static TAutoConsoleVariable<float> CVarRealityDistortionDormantExitMargin(
+		TEXT("r.RealityDistortion.DormantReceivers.ExitMargin"),
+		1000.0f,
+		TEXT("Distance (cm) from a receiver's bounds that every field must leave before it can go dormant. Clamped to >= EnterMargin."),
+		ECVF_RenderThreadSafe);
+
+	// 离开 ExitMargin 后还需保持的帧数，避免力场在边界附近来回时反复重建 Proxy。
+	static TAutoConsoleVariable<int32> CVarRealityDistortionDormantMinActiveFrames(
+		TEXT("r.RealityDistortion.DormantReceivers.MinActiveFrames"),
+		60,
+		TEXT("Frames a receiver must stay out of every field's exit margin before going dormant."),
+		ECVF_RenderThreadSafe);
+
+	// 所有使用缓存路径或参与休眠判定的接收体（仅 RT 访问）。
+	TArray<FDistortionSceneProxy*> GTrackedReceivers;
+	bool GAnyTrackedReceiverDirty = false;
+	int32 GNumCachedReceivers = 0;
+	int32 GNumActiveReceivers = 0;
+	int32 GNumDormantReceivers = 0;
 }
 
 FDistortionSceneProxy::FDistortionSceneProxy(UDistortionMeshComponent* InComponent)
@@ -38,6 +127,9 @@ FDistortionSceneProxy::FDistortionSceneProxy(UDistortionMeshComponent* InCompone
 	// 构造函数在 GT 执行，这里把 Receiver 配置拷贝到 Proxy 的纯数据字段。
 	// 后续 RT 不再访问 UDistortionMeshComponent，避免跨线程访问 UObject。
 	bEnableDistortionReceiver = InComponent->bEnableDistortionReceiver;
+	DistortionPassLODBias = FMath::Max(0, InComponent->DistortionPassLODBias);
+	bUseCachedMeshDrawCommands = CVarRealityDistortionCachedReceivers.GetValueOnGameThread() != 0;
+	OwnerComponent = InComponent;
 
 	// 收集接收体标签（组件 + Actor），供 Field 在 RT 按 Tag 过滤。
 	for (const FName& ComponentTag : InComponent->ComponentTags)
@@ -59,23 +151,334 @@ FDistortionSceneProxy::FDistortionSceneProxy(UDistortionMeshComponent* InCompone
 		}
 	}
 
-	if (InComponent->OverrideMaterial)
+	// 缓存 RenderProxy，RT 直接使用。没有覆盖材质或覆盖材质未勾选 RealityDistortion Usage 时回退默认 Surface 材质。
+	if (UMaterialInterface* DistortionMaterial = GetDistortionPassMaterial(InComponent->OverrideMaterial))
 	{
-		// 缓存 RenderProxy，RT 直接使用。
-		OverrideMaterialProxy = InComponent->OverrideMaterial->GetRenderProxy();
+		OverrideMaterialProxy = DistortionMaterial->GetRenderProxy();
 	}
-	else
+
+	// 只有真正替换材质的接收体才走缓存路径，其余情况保持父类行为。
+	bUseCachedMeshDrawCommands &= (OverrideMaterialProxy != nullptr) && bEnableDistortionReceiver;
+
+	// 休眠时整个 Proxy 等同于普通静态网格：父类的 StaticRelevance、原材质与缓存 DrawCommand。
+	bProximityGated = (OverrideMaterialProxy != nullptr) && bEnableDistortionReceiver
+		&& CVarRealityDistortionDormantReceivers.GetValueOnGameThread() != 0;
+	bDormant = bProximityGated && InComponent->IsDistortionReceiverDormant();
+	bUseCachedMeshDrawCommands &= !bDormant;
+
+	// 簇与最长边随网格构建一次（见 URealityDistortionMeshClusterData），这里只引用共享的只读数据，
+	// 休眠切换重建 Proxy 时不再拷贝索引 / 顶点缓冲区。
+	if (bEnableDistortionReceiver && !bDormant && RenderData != nullptr)
 	{
-		// 没有覆盖材质时回退默认 Surface 材质。
-		if (UMaterial* DefaultMaterial = UMaterial::GetDefaultMaterial(MD_Surface))
+		const FRealityDistortionMeshClustersPtr SharedMeshClusters = FindRealityDistortionMeshClusters(InComponent->GetStaticMesh());
+		if (SharedMeshClusters.IsValid() && CVarRealityDistortionClusterCulling.GetValueOnGameThread() != 0 && !SharedMeshClusters->Clusters.IsEmpty())
 		{
-			OverrideMaterialProxy = DefaultMaterial->GetRenderProxy();
+			MeshClusters = SharedMeshClusters;
 		}
+
+		// 最长边是整个网格的上界，只有所有 LOD / Section 都与构建时一致才可信。
+		if (SharedMeshClusters.IsValid() && IsRealityDistortionVertexInfluenceEnabled() && SharedMeshClusters->MatchesRenderData(*RenderData))
+		{
+			LocalMaxTriangleEdgeLength = SharedMeshClusters->LocalMaxTriangleEdgeLength;
+		}
+	}
+}
+
+bool FDistortionSceneProxy::GetClusterCulledMeshBatch(const FMeshBatch& SourceMeshBatch, int32 MaxRanges, FMeshBatch& OutMeshBatch) const
+{
+	if (!MeshClusters.IsValid() || SourceMeshBatch.Elements.Num() != 1
+		|| !RenderData->LODResources.IsValidIndex(SourceMeshBatch.LODIndex)
+		|| !RenderData->LODResources[SourceMeshBatch.LODIndex].Sections.IsValidIndex(SourceMeshBatch.SegmentIndex))
+	{
+		return false;
+	}
+
+	// 只处理覆盖完整 Section 的 MeshBatch（本 Proxy 产出的），其余保持原样。
+	const FMeshBatchElement& SourceElement = SourceMeshBatch.Elements[0];
+	const FStaticMeshSection& Section = RenderData->LODResources[SourceMeshBatch.LODIndex].Sections[SourceMeshBatch.SegmentIndex];
+	if (SourceElement.FirstIndex != Section.FirstIndex || SourceElement.NumPrimitives != Section.NumTriangles)
+	{
+		return false;
+	}
+
+	int32 NumClusters = 0;
+	const FRealityDistortionTriangleCluster* Clusters = MeshClusters->FindSectionClusters(
+		SourceMeshBatch.LODIndex, SourceMeshBatch.SegmentIndex, Section.FirstIndex, Section.NumTriangles, NumClusters);
+	if (Clusters == nullptr)
+	{
+		return false;
+	}
+
+	FRealityDistortionIndexRangeArray Ranges;
+	CullRealityDistortionTriangleClusters(
+		MakeArrayView(Clusters, NumClusters),
+		GetLocalToWorld(),
+		GetRealityDistortionFieldGrid_RenderThread(),
+		MaxRanges,
+		Ranges);
+
+	if (Ranges.Num() == 1 && Ranges[0].NumTriangles == Section.NumTriangles)
+	{
+		INC_DWORD_STAT_BY(STAT_RealityDistortion_TrianglesSubmitted, Section.NumTriangles);
+		return false;
 	}
+
+	OutMeshBatch = SourceMeshBatch;
+	OutMeshBatch.Elements.SetNum(Ranges.Num());
+
+	uint32 SubmittedTriangles = 0;
+	for (int32 RangeIndex = 0; RangeIndex < Ranges.Num(); ++RangeIndex)
+	{
+		// 其余字段（PrimitiveUniformBuffer、顶点范围等）与源 Element 一致，只改索引区间。
+		FMeshBatchElement& BatchElement = OutMeshBatch.Elements[RangeIndex];
+		BatchElement = SourceElement;
+		BatchElement.FirstIndex = Ranges[RangeIndex].FirstIndex;
+		BatchElement.NumPrimitives = Ranges[RangeIndex].NumTriangles;
+		SubmittedTriangles += Ranges[RangeIndex].NumTriangles;
+	}
+
+	INC_DWORD_STAT_BY(STAT_RealityDistortion_TrianglesSubmitted, SubmittedTriangles);
+	INC_DWORD_STAT_BY(STAT_RealityDistortion_TrianglesCulled, Section.NumTriangles - SubmittedTriangles);
+	return true;
+}
+
+uint32 FDistortionSceneProxy::ComputeClusterSpanHash() const
+{
+	if (!MeshClusters.IsValid() || RenderData == nullptr)
+	{
+		return 0;
+	}
+
+	const FRealityDistortionFieldGrid& FieldGrid = GetRealityDistortionFieldGrid_RenderThread();
+	const FMatrix& LocalToWorld = GetLocalToWorld();
+
+	// 只哈希本 Pass 实际会画的 LOD：与 DrawStaticElements 产出的 LOD 范围相同，再经 DistortionPassLODBias 映射。
+	// 强制 LOD 只画一个 LOD；带偏移时细 LOD 的 Section 从不进入本 Pass，它们的跨度变化不需要让缓存失效。
+	int32 FirstLODIndex = 0;
+	int32 LastLODIndex = 0;
+	GetStaticLODRange(FirstLODIndex, LastLODIndex);
+
+	uint32 Hash = 0;
+	FRealityDistortionIndexRangeArray Ranges;
+	for (int32 SourceLODIndex = FirstLODIndex; SourceLODIndex <= LastLODIndex; ++SourceLODIndex)
+	{
+		const int32 NumSections = RenderData->LODResources[SourceLODIndex].Sections.Num();
+		for (int32 SectionIndex = 0; SectionIndex < NumSections; ++SectionIndex)
+		{
+			const int32 LODIndex = GetDistortionPassLODIndex(SourceLODIndex, SectionIndex);
+			const FStaticMeshSection& Section = RenderData->LODResources[LODIndex].Sections[SectionIndex];
+
+			int32 NumClusters = 0;
+			const FRealityDistortionTriangleCluster* Clusters = MeshClusters->FindSectionClusters(LODIndex, SectionIndex, Section.FirstIndex, Section.NumTriangles, NumClusters);
+			if (Clusters == nullptr)
+			{
+				continue;
+			}
+
+			CullRealityDistortionTriangleClusters(MakeArrayView(Clusters, NumClusters), LocalToWorld, FieldGrid, 1, Ranges);
+			const FRealityDistortionIndexRange Span = Ranges.Num() > 0 ? Ranges[0] : FRealityDistortionIndexRange();
+			Hash = HashCombineFast(Hash, HashCombineFast(Span.FirstIndex, Span.NumTriangles));
+		}
+	}
+	return Hash;
 }
 
 FDistortionSceneProxy::~FDistortionSceneProxy()
 {
+	check(TrackedReceiverIndex == INDEX_NONE);
+}
+
+void FDistortionSceneProxy::CreateRenderThreadResources(FRHICommandListBase& RHICmdList)
+{
+	FStaticMeshSceneProxy::CreateRenderThreadResources(RHICmdList);
+
+	if (bUseCachedMeshDrawCommands)
+	{
+		// 在 AddStaticMeshes 缓存 DrawCommand 之前记录掩码，
+		// 与随后 AddMeshBatch 读取的是同一份力场索引。
+		CachedFieldMask = ComputeFieldMask();
+		CachedClusterSpanHash = ComputeClusterSpanHash();
+		CachedMaxTriangleEdgeLength = ComputeMaxTriangleEdgeLength();
+		++GNumCachedReceivers;
+	}
+
+	if (bProximityGated)
+	{
+		// 力场可能已经静止：新 Proxy 下一帧至少判定一次休眠状态。
+		bTrackedStateDirty = true;
+		GAnyTrackedReceiverDirty = true;
+		++(bDormant ? GNumDormantReceivers : GNumActiveReceivers);
+	}
+
+	if (bUseCachedMeshDrawCommands || bProximityGated)
+	{
+		TrackedReceiverIndex = GTrackedReceivers.Add(this);
+	}
+}
+
+void FDistortionSceneProxy::DestroyRenderThreadResources()
+{
+	if (TrackedReceiverIndex != INDEX_NONE)
+	{
+		GTrackedReceivers.RemoveAtSwap(TrackedReceiverIndex, EAllowShrinking::No);
+		if (GTrackedReceivers.IsValidIndex(TrackedReceiverIndex))
+		{
+			GTrackedReceivers[TrackedReceiverIndex]->TrackedReceiverIndex = TrackedReceiverIndex;
+		}
+		TrackedReceiverIndex = INDEX_NONE;
+
+		GNumCachedReceivers -= bUseCachedMeshDrawCommands ? 1 : 0;
+		if (bProximityGated)
+		{
+			--(bDormant ? GNumDormantReceivers : GNumActiveReceivers);
+		}
+	}
+
+	FStaticMeshSceneProxy::DestroyRenderThreadResources();
+}
+
+void FDistortionSceneProxy::OnTransformChanged(FRHICommandListBase& RHICmdList)
+{
+	FStaticMeshSceneProxy::OnTransformChanged(RHICmdList);
+
+	// 包围盒变了，下一帧重新判定相关力场。
+	if (TrackedReceiverIndex != INDEX_NONE)
+	{
+		bTrackedStateDirty = true;
+		GAnyTrackedReceiverDirty = true;
+	}
+}
+
+float FDistortionSceneProxy::ComputeMaxTriangleEdgeLength() const
+{
+	// 非均匀缩放下按最大轴缩放放大，保证不小于真实的世界空间边长。
+	return LocalMaxTriangleEdgeLength < 0.0f
+		? -1.0f
+		: LocalMaxTriangleEdgeLength * static_cast<float>(GetLocalToWorld().GetMaximumAxisScale());
+}
+
+uint64 FDistortionSceneProxy::ComputeFieldMask() const
+{
+	const FBoxSphereBounds& PrimitiveBounds = GetBounds();
+	const float PrimitiveSphereRadius = FMath::Max(0.0f, static_cast<float>(PrimitiveBounds.SphereRadius));
+	return GetRealityDistortionFieldGrid_RenderThread().GetOverlappingFieldMask(PrimitiveBounds.Origin, PrimitiveSphereRadius);
+}
+
+void FDistortionSceneProxy::RequestDormancyChange(bool bNewDormant)
+{
+	if (bDormancyChangeRequested)
+	{
+		return;
+	}
+	bDormancyChangeRequested = true;
+	INC_DWORD_STAT(STAT_RealityDistortion_ReceiverDormancyChanges);
+
+	// 组件在 GT 上重建 Proxy，新 Proxy 按新状态构造；组件已销毁时什么也不做。
+	AsyncTask(ENamedThreads::GameThread, [WeakComponent = OwnerComponent, bNewDormant]()
+	{
+		if (UDistortionMeshComponent* Component = WeakComponent.Get())
+		{
+			Component->SetDistortionReceiverDormant(bNewDormant);
+		}
+	});
+}
+
+void FDistortionSceneProxy::UpdateDormancy()
+{
+	if (bDormancyChangeRequested)
+	{
+		return;
+	}
+
+	// 不用选择后的索引：视锥外、预算外的力场也要让附近的接收体保持唤醒，否则力场进入视野时接收体还在休眠。
+	const FRealityDistortionFieldGrid& FieldGrid = GetRealityDistortionProximityFieldGrid_RenderThread();
+	const FBoxSphereBounds& PrimitiveBounds = GetBounds();
+	const float PrimitiveSphereRadius = FMath::Max(0.0f, static_cast<float>(PrimitiveBounds.SphereRadius));
+	const float EnterMargin = FMath::Max(0.0f, CVarRealityDistortionDormantEnterMargin.GetValueOnRenderThread());
+	const float ExitMargin = FMath::Max(EnterMargin, CVarRealityDistortionDormantExitMargin.GetValueOnRenderThread());
+
+	if (bDormant)
+	{
+		if (FieldGrid.IntersectsAnyField(PrimitiveBounds.Origin, PrimitiveSphereRadius + EnterMargin))
+		{
+			RequestDormancyChange(false);
+		}
+		return;
+	}
+
+	if (FieldGrid.IntersectsAnyField(PrimitiveBounds.Origin, PrimitiveSphereRadius + ExitMargin))
+	{
+		OutOfRangeSinceFrame = 0;
+		return;
+	}
+
+	const uint64 FrameCounter = GFrameCounterRenderThread;
+	if (OutOfRangeSinceFrame == 0)
+	{
+		OutOfRangeSinceFrame = FrameCounter;
+	}
+
+	const uint64 MinActiveFrames = static_cast<uint64>(FMath::Max(0, CVarRealityDistortionDormantMinActiveFrames.GetValueOnRenderThread()));
+	if (FrameCounter - OutOfRangeSinceFrame >= MinActiveFrames)
+	{
+		RequestDormancyChange(true);
+	}
+	else
+	{
+		// 力场不再变化时也要继续计时：保持脏标记，下一帧再判定。
+		bTrackedStateDirty = true;
+		GAnyTrackedReceiverDirty = true;
+	}
+}
+
+void FDistortionSceneProxy::UpdateCachedReceivers_RenderThread(bool bFieldsChanged, bool bProximityFieldsChanged)
+{
+	check(IsInRenderingThread());
+	SET_DWORD_STAT(STAT_RealityDistortion_CachedReceivers, GNumCachedReceivers);
+	SET_DWORD_STAT(STAT_RealityDistortion_ActiveReceivers, GNumActiveReceivers);
+	SET_DWORD_STAT(STAT_RealityDistortion_DormantReceivers, GNumDormantReceivers);
+
+	// 力场静止且没有接收体移动时，整个缓存路径每帧零开销。
+	if (!bFieldsChanged && !bProximityFieldsChanged && !GAnyTrackedReceiverDirty)
+	{
+		return;
+	}
+	GAnyTrackedReceiverDirty = false;
+
+	for (FDistortionSceneProxy* Receiver : GTrackedReceivers)
+	{
+		const bool bTrackedStateDirty = Receiver->bTrackedStateDirty;
+		if (!bFieldsChanged && !bProximityFieldsChanged && !bTrackedStateDirty)
+		{
+			continue;
+		}
+		Receiver->bTrackedStateDirty = false;
+
+		if (Receiver->bProximityGated && (bProximityFieldsChanged || bTrackedStateDirty))
+		{
+			Receiver->UpdateDormancy();
+		}
+
+		if (!Receiver->bUseCachedMeshDrawCommands || (!bFieldsChanged && !bTrackedStateDirty))
+		{
+			continue;
+		}
+
+		const uint64 NewFieldMask = Receiver->ComputeFieldMask();
+		const uint32 NewClusterSpanHash = NewFieldMask != 0 ? Receiver->ComputeClusterSpanHash() : 0;
+		const float NewMaxTriangleEdgeLength = Receiver->ComputeMaxTriangleEdgeLength();
+		if (NewFieldMask != Receiver->CachedFieldMask || NewClusterSpanHash != Receiver->CachedClusterSpanHash
+			|| NewMaxTriangleEdgeLength != Receiver->CachedMaxTriangleEdgeLength)
+		{
+			// 有力场开始/停止与该接收体重叠，或力场覆盖的簇跨度变化，或缩放改变了最长三角形边：
+			// 只让这一个 Primitive 的缓存 DrawCommand 重建。
+			Receiver->CachedFieldMask = NewFieldMask;
+			Receiver->CachedClusterSpanHash = NewClusterSpanHash;
+			Receiver->CachedMaxTriangleEdgeLength = NewMaxTriangleEdgeLength;
+			Receiver->GetScene().UpdateCachedRenderStates(Receiver);
+			INC_DWORD_STAT(STAT_RealityDistortion_CachedReceiverInvalidations);
+		}
+	}
 }
 
 SIZE_T FDistortionSceneProxy::GetStaticTypeHash()
@@ -93,6 +496,13 @@ FPrimitiveViewRelevance FDistortionSceneProxy::GetViewRelevance(const FSceneView
 {
 	FPrimitiveViewRelevance Result = FStaticMeshSceneProxy::GetViewRelevance(View);
 
+	// 缓存路径：保持父类的 StaticRelevance，覆盖材质已经在 DrawStaticElements 里生效。
+	// 休眠：同样保持父类结果，按普通静态网格渲染。
+	if ((bUseCachedMeshDrawCommands && OverrideMaterialProxy) || bDormant)
+	{
+		return Result;
+	}
+
 	// 强制走动态路径：每帧都会执行 GetDynamicMeshElements，材质劫持可实时生效。
 	Result.bDynamicRelevance = true;
 	Result.bStaticRelevance = false;
@@ -100,6 +510,171 @@ FPrimitiveViewRelevance FDistortionSceneProxy::GetViewRelevance(const FSceneView
 	return Result;
 }
 
+void FDistortionSceneProxy::BuildDistortionMeshBatch(int32 LODIndex, int32 SectionIndex, FMeshBatch& MeshBatch) const
+{
+	const FStaticMeshLODResources& LODModel = RenderData->LODResources[LODIndex];
+	const FStaticMeshSection& Section = LODModel.Sections[SectionIndex];
+
+	// ----------------------------------------
+	// 1) VertexFactory + Material
+	// ----------------------------------------
+	// VertexFactory 决定顶点流如何绑定和解释。
+	MeshBatch.VertexFactory = &RenderData->LODVertexFactories[LODIndex].VertexFactory;
+	// 劫持点：把原材质替换成 OverrideMaterialProxy。
+	MeshBatch.MaterialRenderProxy = OverrideMaterialProxy;
+
+	// ----------------------------------------
+	// 2) 基础绘制状态
+	// ----------------------------------------
+	MeshBatch.ReverseCulling = IsLocalToWorldDeterminantNegative();
+	MeshBatch.Type = PT_TriangleList;
+	MeshBatch.DepthPriorityGroup = SDPG_World;
+	MeshBatch.LODIndex = LODIndex;
+	MeshBatch.SegmentIndex = SectionIndex;
+	MeshBatch.bCanApplyViewModeOverrides = true;
+	MeshBatch.bDisableBackfaceCulling =
+		(CVarRealityDistortionReceiverTwoSided.GetValueOnAnyThread() != 0);
+	MeshBatch.CastShadow = true;
+	// 激活接收体按 MeshBatch 选择深度链路：覆盖材质的 Section 自己进入深度 PrePass（DepthOnly 的 clip 在这里挖洞），
+	// 不使用父类只带默认材质的合并深度网格，BasePass 因而不需要写深度。
+	MeshBatch.bUseForDepthPass = true;
+
+	// ----------------------------------------
+	// 3) Section 索引范围
+	// ----------------------------------------
+	FMeshBatchElement& BatchElement = MeshBatch.Elements[0];
+	BatchElement.IndexBuffer = &LODModel.IndexBuffer;
+	BatchElement.FirstIndex = Section.FirstIndex;
+	BatchElement.NumPrimitives = Section.NumTriangles;
+	BatchElement.MinVertexIndex = Section.MinVertexIndex;
+	BatchElement.MaxVertexIndex = Section.MaxVertexIndex;
+	// PrimitiveUniformBuffer 提供 LocalToWorld 等每个 Primitive 的常量数据。
+	BatchElement.PrimitiveUniformBuffer = GetUniformBuffer();
+}
+
+int32 FDistortionSceneProxy::GetReceiverLOD(const FSceneView* View) const
+{
+	// 直接使用父类 GetLOD：r.ForceLOD、组件 ForcedLodModel、编辑器 LOD ShowFlag、ScreenSize 与 MinLOD 的顺序都与
+	// FStaticMeshSceneProxy 一致，本 Pass 与它要填补的 BasePass 空洞用同一个 LOD。
+	// 这里只夹到有效（已驻留）的 LOD 范围，不再额外套 ClampedMinLOD：强制 LOD 在父类里本来就不受 MinLOD 限制。
+	return ClampToResidentLOD(GetLOD(View));
+}
+
+int32 FDistortionSceneProxy::ClampToResidentLOD(int32 LODIndex) const
+{
+	const int32 NumLODs = RenderData->LODResources.Num();
+	return FMath::Clamp(LODIndex, FMath::Min(RenderData->GetCurrentFirstLODIdx(0), NumLODs - 1), NumLODs - 1);
+}
+
+void FDistortionSceneProxy::GetStaticLODRange(int32& OutFirstLODIndex, int32& OutLastLODIndex) const
+{
+	// 组件强制 LOD 时只产出该 LOD；与 GetReceiverLOD 相同，强制 LOD 只夹到有效范围。
+	const bool bForcedLOD = ForcedLodModel > 0;
+	OutFirstLODIndex = bForcedLOD ? ClampToResidentLOD(ForcedLodModel - 1) : ClampedMinLOD;
+	OutLastLODIndex = bForcedLOD ? OutFirstLODIndex : RenderData->LODResources.Num() - 1;
+}
+
+int32 FDistortionSceneProxy::GetDistortionPassLODIndex(int32 SourceLODIndex, int32 SectionIndex) const
+{
+	if (DistortionPassLODBias <= 0 || RenderData == nullptr)
+	{
+		return SourceLODIndex;
+	}
+
+	const int32 NumLODs = RenderData->LODResources.Num();
+	const int32 TargetLODIndex = FMath::Min(SourceLODIndex + DistortionPassLODBias, NumLODs - 1);
+	if (TargetLODIndex <= SourceLODIndex)
+	{
+		return SourceLODIndex;
+	}
+
+	// 只在两个 LOD 的 Section 一一对应（同一材质槽）时替换，否则保留原 LOD，避免材质错位。
+	const FStaticMeshLODResources& SourceLOD = RenderData->LODResources[SourceLODIndex];
+	const FStaticMeshLODResources& TargetLOD = RenderData->LODResources[TargetLODIndex];
+	if (!SourceLOD.Sections.IsValidIndex(SectionIndex)
+		|| !TargetLOD.Sections.IsValidIndex(SectionIndex)
+		|| SourceLOD.Sections[SectionIndex].MaterialIndex != TargetLOD.Sections[SectionIndex].MaterialIndex
+		|| TargetLOD.Sections[SectionIndex].NumTriangles == 0)
+	{
+		return SourceLODIndex;
+	}
+	return TargetLODIndex;
+}
+
+bool FDistortionSceneProxy::GetDistortionPassMeshBatch(const FMeshBatch& SourceMeshBatch, FMeshBatch& OutMeshBatch) const
+{
+	if (DistortionPassLODBias <= 0 || RenderData == nullptr || SourceMeshBatch.Elements.Num() != 1)
+	{
+		return false;
+	}
+
+	const int32 SourceLODIndex = SourceMeshBatch.LODIndex;
+	const int32 SectionIndex = SourceMeshBatch.SegmentIndex;
+	const int32 TargetLODIndex = GetDistortionPassLODIndex(SourceLODIndex, SectionIndex);
+	if (TargetLODIndex == SourceLODIndex)
+	{
+		return false;
+	}
+
+	const FStaticMeshLODResources& TargetLOD = RenderData->LODResources[TargetLODIndex];
+	const FStaticMeshSection& TargetSection = TargetLOD.Sections[SectionIndex];
+
+	// 其余状态（材质、剔除、PrimitiveUniformBuffer 等）保持与源 MeshBatch 一致，只替换几何数据。
+	OutMeshBatch = SourceMeshBatch;
+	OutMeshBatch.LODIndex = TargetLODIndex;
+	OutMeshBatch.VertexFactory = &RenderData->LODVertexFactories[TargetLODIndex].VertexFactory;
+
+	FMeshBatchElement& BatchElement = OutMeshBatch.Elements[0];
+	BatchElement.IndexBuffer = &TargetLOD.IndexBuffer;
+	BatchElement.FirstIndex = TargetSection.FirstIndex;
+	BatchElement.NumPrimitives = TargetSection.NumTriangles;
+	BatchElement.MinVertexIndex = TargetSection.MinVertexIndex;
+	BatchElement.MaxVertexIndex = TargetSection.MaxVertexIndex;
+	return true;
+}
+
+void FDistortionSceneProxy::DrawStaticElements(FStaticPrimitiveDrawInterface* PDI)
+{
+	if (!bUseCachedMeshDrawCommands || OverrideMaterialProxy == nullptr)
+	{
+		FStaticMeshSceneProxy::DrawStaticElements(PDI);
+		return;
+	}
+
+	if (RenderData == nullptr || RenderData->LODResources.Num() == 0)
+	{
+		return;
+	}
+
+	// 每个 LOD 的每个 Section 产出一个 StaticMesh，按 ScreenSize 交给引擎做 LOD 选择。
+	// 这些 StaticMesh 会在加入场景时为每个 MeshPass 缓存 DrawCommand，之后每帧不再重建。
+	// 组件强制 LOD 时只产出该 LOD，ScreenSize 设为 FLT_MAX 使其始终被选中；与 GetReceiverLOD 相同，
+	// 强制 LOD 只夹到有效范围，BasePass 与本 Pass 都来自这里产出的 StaticMesh，二者的 LOD 自然一致。
+	const bool bForcedLOD = ForcedLodModel > 0;
+	int32 FirstLODIndex = 0;
+	int32 LastLODIndex = 0;
+	GetStaticLODRange(FirstLODIndex, LastLODIndex);
+
+	for (int32 LODIndex = FirstLODIndex; LODIndex <= LastLODIndex; ++LODIndex)
+	{
+		const FStaticMeshLODResources& LODModel = RenderData->LODResources[LODIndex];
+		const float ScreenSize = bForcedLOD ? FLT_MAX : RenderData->ScreenSize[LODIndex].GetValue();
+
+		for (int32 SectionIndex = 0; SectionIndex < LODModel.Sections.Num(); ++SectionIndex)
+		{
+			if (LODModel.Sections[SectionIndex].NumTriangles == 0)
+			{
+				continue;
+			}
+
+			FMeshBatch MeshBatch;
+			BuildDistortionMeshBatch(LODIndex, SectionIndex, MeshBatch);
+			MeshBatch.bUseAsOccluder = ShouldUseAsOccluder();
+			PDI->DrawMesh(MeshBatch, ScreenSize);
+		}
+	}
+}
+
 void FDistortionSceneProxy::GetDynamicMeshElements(
 	const TArray<const FSceneView*>& Views,
 	const FSceneViewFamily& ViewFamily,
@@ -107,7 +682,8 @@ void FDistortionSceneProxy::GetDynamicMeshElements(
 	FMeshElementCollector& Collector) const
 {
 	// 没有覆盖材质时，回退父类逻辑。
-	if (OverrideMaterialProxy == nullptr)
+	// 缓存路径（或休眠）下本函数只会在调试视图等强制动态的情况下被调用，同样交给父类。
+	if (OverrideMaterialProxy == nullptr || bUseCachedMeshDrawCommands || bDormant)
 	{
 		FStaticMeshSceneProxy::GetDynamicMeshElements(Views, ViewFamily, VisibilityMap, Collector);
 		return;
@@ -130,49 +706,16 @@ void FDistortionSceneProxy::GetDynamicMeshElements(
 			continue;
 		}
 
-		// 这里固定使用 LOD0，便于教学与调试；后续可按距离切换 LOD。
-		const int32 LODIndex = 0;
+		// 与父类相同的屏幕尺寸 LOD 选择，远处接收体不再提交 LOD0 的完整几何。
+		const int32 LODIndex = GetReceiverLOD(Views[ViewIndex]);
 		const FStaticMeshLODResources& LODModel = RenderData->LODResources[LODIndex];
 
 		// 遍历 LOD 的每个 Section（材质槽）。
 		for (int32 SectionIndex = 0; SectionIndex < LODModel.Sections.Num(); SectionIndex++)
 		{
-			const FStaticMeshSection& Section = LODModel.Sections[SectionIndex];
-
 			// 向 Collector 申请一个新的 MeshBatch。
 			FMeshBatch& MeshBatch = Collector.AllocateMesh();
-
-			// ----------------------------------------
-			// 1) VertexFactory + Material
-			// ----------------------------------------
-			// VertexFactory 决定顶点流如何绑定和解释。
-			MeshBatch.VertexFactory = &RenderData->LODVertexFactories[LODIndex].VertexFactory;
-			// 劫持点：把原材质替换成 OverrideMaterialProxy。
-			MeshBatch.MaterialRenderProxy = OverrideMaterialProxy;
-
-			// ----------------------------------------
-			// 2) 基础绘制状态
-			// ----------------------------------------
-			MeshBatch.ReverseCulling = IsLocalToWorldDeterminantNegative();
-			MeshBatch.Type = PT_TriangleList;
-			MeshBatch.DepthPriorityGroup = SDPG_World;
-			MeshBatch.LODIndex = LODIndex;
-			MeshBatch.bCanApplyViewModeOverrides = true;
-			MeshBatch.bDisableBackfaceCulling =
-				(CVarRealityDistortionReceiverTwoSided.GetValueOnAnyThread() != 0);
-			MeshBatch.CastShadow = true;
-
-			// ----------------------------------------
-			// 3) Section 索引范围
-			// ----------------------------------------
-			FMeshBatchElement& BatchElement = MeshBatch.Elements[0];
-			BatchElement.IndexBuffer = &LODModel.IndexBuffer;
-			BatchElement.FirstIndex = Section.FirstIndex;
-			BatchElement.NumPrimitives = Section.NumTriangles;
-			BatchElement.MinVertexIndex = Section.MinVertexIndex;
-			BatchElement.MaxVertexIndex = Section.MaxVertexIndex;
-			// PrimitiveUniformBuffer 提供 LocalToWorld 等每个 Primitive 的常量数据。
-			BatchElement.PrimitiveUniformBuffer = GetUniformBuffer();
+			BuildDistortionMeshBatch(LODIndex, SectionIndex, MeshBatch);
 
 			// 最终提交给 Collector，后续进入 MeshPassProcessor 的 AddMeshBatch。
 			Collector.AddMesh(ViewIndex, MeshBatch);
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Rendering/RealityDistortionMeshClusterData.h"
 #include "StaticMeshSceneProxy.h"
 
 class UDistortionMeshComponent;
@@ -20,16 +21,23 @@ public:
 		uint32 VisibilityMap,
 		FMeshElementCollector& Collector) const override;
 
+	// 缓存路径：以覆盖材质产出 StaticMesh，由引擎为各 MeshPass（含 RealityDistortion）缓存 DrawCommand。
+	virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override;
+
 	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override;
 	virtual SIZE_T GetTypeHash() const override;
 
+	virtual void CreateRenderThreadResources(FRHICommandListBase& RHICmdList) override;
+	virtual void DestroyRenderThreadResources() override;
+	virtual void OnTransformChanged(FRHICommandListBase& RHICmdList) override;
+
 	// 提供稳定类型标识，供 PassProcessor 在 AddMeshBatch 快速筛选 Receiver Proxy。
 	// 这么做比 RTTI/dynamic_cast 成本更低，且符合 UE 渲染层常见做法。
 	static SIZE_T GetStaticTypeHash();
 
 	bool ShouldRenderInRealityDistortionPass() const
 	{
-		return bEnableDistortionReceiver;
+		return bEnableDistortionReceiver && !bDormant;
 	}
 
 	// Field 侧按 Tag 过滤时使用。None 表示不限制。
@@ -38,10 +46,96 @@ public:
 		return ReceiverTag.IsNone() || ReceiverTags.Contains(ReceiverTag);
 	}
 
+	// true：走 StaticRelevance + 缓存 DrawCommand；false：旧的每帧 GetDynamicMeshElements 路径。
+	bool UsesCachedMeshDrawCommands() const
+	{
+		return bUseCachedMeshDrawCommands;
+	}
+
+	// 缓存 DrawCommand 时使用的相关力场掩码。
+	// AddMeshBatch 在缓存路径直接读取它，保证 DrawCommand 与失效判定使用同一份数据。
+	uint64 GetCachedFieldMask() const
+	{
+		return CachedFieldMask;
+	}
+
+	// 顶点阶段影响度使用的最长三角形边（世界空间，负数表示未知）。缓存路径读取与 DrawCommand 同步的副本。
+	float GetCachedMaxTriangleEdgeLength() const
+	{
+		return CachedMaxTriangleEdgeLength;
+	}
+	float ComputeMaxTriangleEdgeLength() const;
+
+	// 把主渲染产出的 MeshBatch 按 DistortionPassLODBias 映射到更粗的 LOD。
+	// 成功时 OutMeshBatch 指向粗 LOD 的顶点/索引数据；偏移为 0 或 Section 对不上时返回 false，调用方沿用原 MeshBatch。
+	bool GetDistortionPassMeshBatch(const FMeshBatch& SourceMeshBatch, FMeshBatch& OutMeshBatch) const;
+
+	// 簇剔除：把 MeshBatch 的 Section 索引范围替换为与力场相交的簇区间（最多 MaxRanges 个 Element）。
+	// 返回 false 表示该 Section 没有簇数据或全部相交，调用方沿用原 MeshBatch；
+	// 返回 true 且 OutMeshBatch.Elements 为空表示没有簇与力场相交，不需要提交。
+	bool GetClusterCulledMeshBatch(const FMeshBatch& SourceMeshBatch, int32 MaxRanges, FMeshBatch& OutMeshBatch) const;
+
+	// 每个 ViewFamily 调用一次（在力场索引重建之后）：
+	// 只有当某个接收体的相关力场集合变化时（力场开始/停止与其重叠），才让它的缓存 DrawCommand 失效；
+	// 同时按全部启用力场的距离判定接收体是否进入 / 退出休眠（bProximityFieldsChanged 对应休眠判定索引）。
+	static void UpdateCachedReceivers_RenderThread(bool bFieldsChanged, bool bProximityFieldsChanged);
+
 private:
+	// 组装一个使用覆盖材质的 MeshBatch（动态与缓存路径共用）。
+	void BuildDistortionMeshBatch(int32 LODIndex, int32 SectionIndex, FMeshBatch& MeshBatch) const;
+
+	// 动态路径的 LOD 选择：直接用 FStaticMeshSceneProxy::GetLOD（r.ForceLOD / 强制 LOD / MinLOD / ScreenSize），只夹到有效范围。
+	int32 GetReceiverLOD(const FSceneView* View) const;
+
+	// 夹到 [首个驻留 LOD, 最后一个 LOD]。
+	int32 ClampToResidentLOD(int32 LODIndex) const;
+
+	// 用本帧力场索引计算与该接收体相交的槽位掩码。
+	uint64 ComputeFieldMask() const;
+
+	// 缓存路径每个 Section 只提交一个跨度；本 Pass 会画的 LOD 的跨度变化时缓存 DrawCommand 也要失效。
+	uint32 ComputeClusterSpanHash() const;
+
+	// DrawStaticElements 产出的 LOD 范围（强制 LOD 时只有一个）。
+	void GetStaticLODRange(int32& OutFirstLODIndex, int32& OutLastLODIndex) const;
+
+	// 本 Pass 为该 Section 实际使用的 LOD（应用 DistortionPassLODBias；Section 对不上时为源 LOD）。
+	int32 GetDistortionPassLODIndex(int32 SourceLODIndex, int32 SectionIndex) const;
+
+	// 邻近判定（带滞回，使用休眠判定索引，视锥外的力场同样计入）：力场进入 EnterMargin 时唤醒；离开 ExitMargin 且持续 MinActiveFrames 帧后休眠。
+	void UpdateDormancy();
+
+	// 通知 GT 切换组件的休眠状态（组件随后重建 Proxy）。每个 Proxy 只发一次。
+	void RequestDormancyChange(bool bNewDormant);
+
 	FMaterialRenderProxy* OverrideMaterialProxy = nullptr;
 
+	bool bUseCachedMeshDrawCommands = false;
+
+	// 休眠的接收体完全按父类（普通静态网格）渲染；bProximityGated 为 false 时永不休眠。
+	bool bProximityGated = false;
+	bool bDormant = false;
+
+	// 只在 GT 任务里解引用，用于切换休眠状态。
+	TWeakObjectPtr<UDistortionMeshComponent> OwnerComponent;
+
+	// 以下仅在 RT 访问。
+	uint64 CachedFieldMask = 0;
+	uint32 CachedClusterSpanHash = 0;
+	float CachedMaxTriangleEdgeLength = -1.0f;
+	bool bTrackedStateDirty = false;
+	bool bDormancyChangeRequested = false;
+	uint64 OutOfRangeSinceFrame = 0;
+	int32 TrackedReceiverIndex = INDEX_NONE;
+
 	// 下列数据在构造时从组件拷贝到 RT，避免跨线程直接访问 UObjects。
 	bool bEnableDistortionReceiver = true;
+	int32 DistortionPassLODBias = 0;
 	TArray<FName> ReceiverTags;
+
+	// 网格共享的三角形簇（局部空间，只读）；没有簇数据或关闭簇剔除时为空。
+	FRealityDistortionMeshClustersPtr MeshClusters;
+
+	// 所有 LOD 的最长三角形边（局部空间），只在 r.RealityDistortion.VertexInfluence 开启时读取；-1 表示未知。
+	float LocalMaxTriangleEdgeLength = -1.0f;
 };
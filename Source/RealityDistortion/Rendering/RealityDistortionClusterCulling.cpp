@@ -0,0 +1,277 @@
+﻿// RealityDistortionClusterCulling.cpp
+
+#include "Rendering/RealityDistortionClusterCulling.h"
+
+#include "Rendering/RealityDistortionFieldCulling.h"
+#include "StaticMeshResources.h"
+
+void BuildRealityDistortionTriangleClusters(
+	TConstArrayView<uint32> Indices,
+	TConstArrayView<FVector3f> Positions,
+	uint32 FirstIndex,
+	uint32 NumTriangles,
+	TArray<FRealityDistortionTriangleCluster>& OutClusters)
+{
+	for (uint32 ClusterTriangle = 0; ClusterTriangle < NumTriangles; ClusterTriangle += RealityDistortionTrianglesPerCluster)
+	{
+		FRealityDistortionTriangleCluster& Cluster = OutClusters.AddDefaulted_GetRef();
+		Cluster.FirstIndex = FirstIndex + ClusterTriangle * 3;
+		Cluster.NumTriangles = FMath::Min(RealityDistortionTrianglesPerCluster, NumTriangles - ClusterTriangle);
+		Cluster.LocalBounds.Init();
+
+		const uint32 EndIndex = Cluster.FirstIndex + Cluster.NumTriangles * 3;
+		for (uint32 Index = Cluster.FirstIndex; Index < EndIndex; ++Index)
+		{
+			Cluster.LocalBounds += Positions[Indices[Index]];
+		}
+	}
+}
+
+uint32 CullRealityDistortionTriangleClusters(
+	TConstArrayView<FRealityDistortionTriangleCluster> Clusters,
+	const FMatrix& LocalToWorld,
+	const FRealityDistortionFieldGrid& FieldGrid,
+	int32 MaxRanges,
+	FRealityDistortionIndexRangeArray& OutRanges)
+{
+	OutRanges.Reset();
+	if (FieldGrid.IsEmpty())
+	{
+		return 0;
+	}
+
+	const float MaxScale = static_cast<float>(LocalToWorld.GetMaximumAxisScale());
+	uint32 NumVisibleTriangles = 0;
+
+	for (const FRealityDistortionTriangleCluster& Cluster : Clusters)
+	{
+		const FVector WorldCenter = LocalToWorld.TransformPosition(FVector(Cluster.LocalBounds.GetCenter()));
+		const float WorldRadius = Cluster.LocalBounds.GetExtent().Size() * MaxScale;
+		if (!FieldGrid.IntersectsAnyField(WorldCenter, WorldRadius))
+		{
+			continue;
+		}
+
+		NumVisibleTriangles += Cluster.NumTriangles;
+
+		// 簇按索引顺序排列，紧邻上一个区间时直接延长。
+		if (OutRanges.Num() > 0)
+		{
+			FRealityDistortionIndexRange& LastRange = OutRanges.Last();
+			if (LastRange.FirstIndex + LastRange.NumTriangles * 3 == Cluster.FirstIndex)
+			{
+				LastRange.NumTriangles += Cluster.NumTriangles;
+				continue;
+			}
+		}
+		OutRanges.Add({ Cluster.FirstIndex, Cluster.NumTriangles });
+	}
+
+	// 区间过多时合并间隔最小的相邻区间，多画少量三角形换取更少的 DrawCall / 单一跨度。
+	MaxRanges = FMath::Max(1, MaxRanges);
+	while (OutRanges.Num() > MaxRanges)
+	{
+		int32 BestIndex = 0;
+		uint32 BestGap = MAX_uint32;
+		for (int32 RangeIndex = 0; RangeIndex + 1 < OutRanges.Num(); ++RangeIndex)
+		{
+			const uint32 Gap = OutRanges[RangeIndex + 1].FirstIndex - (OutRanges[RangeIndex].FirstIndex + OutRanges[RangeIndex].NumTriangles * 3);
+			if (Gap < BestGap)
+			{
+				BestGap = Gap;
+				BestIndex = RangeIndex;
+			}
+		}
+
+		FRealityDistortionIndexRange& Merged = OutRanges[BestIndex];
+		const FRealityDistortionIndexRange& Next = OutRanges[BestIndex + 1];
+		Merged.NumTriangles = (Next.FirstIndex + Next.NumTriangles * 3 - Merged.FirstIndex) / 3;
+		OutRanges.RemoveAt(BestIndex + 1, EAllowShrinking::No);
+	}
+
+	return NumVisibleTriangles;
+}
+
+const FRealityDistortionTriangleCluster* FRealityDistortionMeshClusters::FindSectionClusters(
+	int32 LODIndex,
+	int32 SectionIndex,
+	uint32 FirstIndex,
+	uint32 NumTriangles,
+	int32& OutNumClusters) const
+{
+	OutNumClusters = 0;
+	if (!LODSections.IsValidIndex(LODIndex) || !LODSections[LODIndex].IsValidIndex(SectionIndex))
+	{
+		return nullptr;
+	}
+
+	const FRealityDistortionSectionClusters& Section = LODSections[LODIndex][SectionIndex];
+	if (Section.NumClusters == 0 || Section.FirstIndex != FirstIndex || Section.NumTriangles != NumTriangles)
+	{
+		return nullptr;
+	}
+
+	OutNumClusters = Section.NumClusters;
+	return &Clusters[Section.FirstCluster];
+}
+
+bool FRealityDistortionMeshClusters::MatchesRenderData(const FStaticMeshRenderData& RenderData) const
+{
+	if (LODSections.Num() != RenderData.LODResources.Num())
+	{
+		return false;
+	}
+
+	for (int32 LODIndex = 0; LODIndex < LODSections.Num(); ++LODIndex)
+	{
+		const TArray<FStaticMeshSection>& Sections = RenderData.LODResources[LODIndex].Sections;
+		if (LODSections[LODIndex].Num() != Sections.Num())
+		{
+			return false;
+		}
+
+		for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); ++SectionIndex)
+		{
+			const FRealityDistortionSectionClusters& Section = LODSections[LODIndex][SectionIndex];
+			if (Section.FirstIndex != Sections[SectionIndex].FirstIndex || Section.NumTriangles != Sections[SectionIndex].NumTriangles)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+FArchive& operator<<(FArchive& Ar, FRealityDistortionMeshClusters& MeshClusters)
+{
+	// 簇与 Section 都是平铺的 POD，逐字段序列化，保证跨平台字节序。
+	int32 NumClusters = MeshClusters.Clusters.Num();
+	Ar << NumClusters;
+	if (Ar.IsLoading())
+	{
+		MeshClusters.Clusters.SetNum(NumClusters);
+	}
+	for (FRealityDistortionTriangleCluster& Cluster : MeshClusters.Clusters)
+	{
+		Ar << Cluster.LocalBounds << Cluster.FirstIndex << Cluster.NumTriangles;
+	}
+
+	int32 NumLODs = MeshClusters.LODSections.Num();
+	Ar << NumLODs;
+	if (Ar.IsLoading())
+	{
+		MeshClusters.LODSections.SetNum(NumLODs);
+	}
+	for (TArray<FRealityDistortionSectionClusters>& Sections : MeshClusters.LODSections)
+	{
+		int32 NumSections = Sections.Num();
+		Ar << NumSections;
+		if (Ar.IsLoading())
+		{
+			Sections.SetNum(NumSections);
+		}
+		for (FRealityDistortionSectionClusters& Section : Sections)
+		{
+			Ar << Section.FirstIndex << Section.NumTriangles << Section.FirstCluster << Section.NumClusters;
+		}
+	}
+
+	Ar << MeshClusters.LocalMaxTriangleEdgeLength;
+	return Ar;
+}
+
+bool GatherRealityDistortionMeshClusterSource(
+	const FStaticMeshRenderData& RenderData,
+	bool bMaxTriangleEdgeLength,
+	FRealityDistortionMeshClusterSource& OutSource)
+{
+	OutSource.LODs.SetNum(RenderData.LODResources.Num());
+	OutSource.bMaxTriangleEdgeLength = bMaxTriangleEdgeLength;
+
+	for (int32 LODIndex = 0; LODIndex < RenderData.LODResources.Num(); ++LODIndex)
+	{
+		const FStaticMeshLODResources& LODModel = RenderData.LODResources[LODIndex];
+		FRealityDistortionMeshClusterSource::FLOD& LOD = OutSource.LODs[LODIndex];
+
+		// 先只看 Section 的三角形数：没有达到门槛的 Section、又不需要最长边时，不拷贝这个 LOD 的任何缓冲区。
+		bool bNeedsBuffers = bMaxTriangleEdgeLength;
+		LOD.Sections.SetNum(LODModel.Sections.Num());
+		for (int32 SectionIndex = 0; SectionIndex < LODModel.Sections.Num(); ++SectionIndex)
+		{
+			LOD.Sections[SectionIndex].FirstIndex = LODModel.Sections[SectionIndex].FirstIndex;
+			LOD.Sections[SectionIndex].NumTriangles = LODModel.Sections[SectionIndex].NumTriangles;
+			bNeedsBuffers |= IsRealityDistortionClusteredSection(LODModel.Sections[SectionIndex].NumTriangles);
+		}
+
+		if (!bNeedsBuffers)
+		{
+			continue;
+		}
+
+		// 编辑器中总是保留 CPU 侧数据；Cook 后需要网格开启 Allow CPUAccess，否则只能使用随网格保存（显式添加 URealityDistortionMeshClusterData）的簇数据。
+		const FPositionVertexBuffer& PositionBuffer = LODModel.VertexBuffers.PositionVertexBuffer;
+		if (PositionBuffer.GetVertexData() == nullptr || LODModel.IndexBuffer.GetNumIndices() == 0)
+		{
+			return false;
+		}
+
+		LODModel.IndexBuffer.GetCopy(LOD.Indices);
+		LOD.Positions.SetNumUninitialized(PositionBuffer.GetNumVertices());
+		for (uint32 VertexIndex = 0; VertexIndex < PositionBuffer.GetNumVertices(); ++VertexIndex)
+		{
+			LOD.Positions[VertexIndex] = PositionBuffer.VertexPosition(VertexIndex);
+		}
+	}
+	return true;
+}
+
+void BuildRealityDistortionMeshClusters(
+	const FRealityDistortionMeshClusterSource& Source,
+	FRealityDistortionMeshClusters& OutMeshClusters)
+{
+	OutMeshClusters.Clusters.Reset();
+	OutMeshClusters.LODSections.SetNum(Source.LODs.Num());
+
+	float MaxEdgeLengthSquared = 0.0f;
+	bool bMaxTriangleEdgeLengthValid = Source.bMaxTriangleEdgeLength;
+
+	for (int32 LODIndex = 0; LODIndex < Source.LODs.Num(); ++LODIndex)
+	{
+		const FRealityDistortionMeshClusterSource::FLOD& LOD = Source.LODs[LODIndex];
+		TArray<FRealityDistortionSectionClusters>& Sections = OutMeshClusters.LODSections[LODIndex];
+		Sections = LOD.Sections;
+
+		if (LOD.Indices.IsEmpty())
+		{
+			bMaxTriangleEdgeLengthValid &= LOD.Sections.IsEmpty();
+			continue;
+		}
+
+		for (FRealityDistortionSectionClusters& Section : Sections)
+		{
+			Section.FirstCluster = OutMeshClusters.Clusters.Num();
+			Section.NumClusters = 0;
+			if (IsRealityDistortionClusteredSection(Section.NumTriangles)
+				&& Section.FirstIndex + Section.NumTriangles * 3 <= static_cast<uint32>(LOD.Indices.Num()))
+			{
+				BuildRealityDistortionTriangleClusters(LOD.Indices, LOD.Positions, Section.FirstIndex, Section.NumTriangles, OutMeshClusters.Clusters);
+				Section.NumClusters = OutMeshClusters.Clusters.Num() - Section.FirstCluster;
+			}
+		}
+
+		if (Source.bMaxTriangleEdgeLength)
+		{
+			for (int32 Index = 0; Index + 2 < LOD.Indices.Num(); Index += 3)
+			{
+				const FVector3f& P0 = LOD.Positions[LOD.Indices[Index + 0]];
+				const FVector3f& P1 = LOD.Positions[LOD.Indices[Index + 1]];
+				const FVector3f& P2 = LOD.Positions[LOD.Indices[Index + 2]];
+				MaxEdgeLengthSquared = FMath::Max(MaxEdgeLengthSquared,
+					FMath::Max3(FVector3f::DistSquared(P0, P1), FVector3f::DistSquared(P1, P2), FVector3f::DistSquared(P2, P0)));
+			}
+		}
+	}
+
+	OutMeshClusters.Clusters.Shrink();
+	OutMeshClusters.LocalMaxTriangleEdgeLength = bMaxTriangleEdgeLengthValid ? FMath::Sqrt(MaxEdgeLengthSquared) : -1.0f;
+}
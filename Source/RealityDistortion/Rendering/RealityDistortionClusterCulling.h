@@ -0,0 +1,123 @@
+﻿// RealityDistortionClusterCulling.h
+//
+// 接收体三角形簇
+// --------------
+// 大接收体（地板、墙面）的一个 Section 往往只有一小块落在力场里。
+// 每个网格构建一次簇数据：把每个 LOD Section 按索引顺序切成固定大小的三角形簇并记录局部包围盒，
+// AddMeshBatch 只提交与力场相交的簇对应的索引区间，其余三角形不再进入本 Pass。
+//
+// 说明：
+// - 簇是连续的索引区间，因此可以直接改写 FMeshBatchElement 的 FirstIndex / NumPrimitives。
+// - 相邻的相交簇合并为一个区间；区间数超过上限时合并间隔最小的相邻区间（上限为 1 即单一跨度）。
+// - 簇数据按网格构建一次，放在瞬态缓存里，所有使用该网格的 Proxy 共享同一份只读数据；
+//   网格显式添加 URealityDistortionMeshClusterData 后随资源保存，Cook 后不需要网格开启 Allow CPUAccess。
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FRealityDistortionFieldGrid;
+class FStaticMeshRenderData;
+
+// 每个簇的三角形数。
+constexpr uint32 RealityDistortionTrianglesPerCluster = 128;
+
+// 三角形数不足这么多簇的 Section 不做簇剔除，整段提交更省。
+constexpr uint32 RealityDistortionMinClustersPerSection = 4;
+
+inline bool IsRealityDistortionClusteredSection(uint32 NumTriangles)
+{
+	return NumTriangles >= RealityDistortionTrianglesPerCluster * RealityDistortionMinClustersPerSection;
+}
+
+struct FRealityDistortionTriangleCluster
+{
+	FBox3f LocalBounds;
+	uint32 FirstIndex = 0;
+	uint32 NumTriangles = 0;
+};
+
+struct FRealityDistortionIndexRange
+{
+	uint32 FirstIndex = 0;
+	uint32 NumTriangles = 0;
+};
+
+using FRealityDistortionIndexRangeArray = TArray<FRealityDistortionIndexRange, TInlineAllocator<16>>;
+
+// 一个 LOD Section 的簇范围。FirstIndex / NumTriangles 记录构建时的 Section，用于校验与当前 RenderData 是否一致。
+struct FRealityDistortionSectionClusters
+{
+	uint32 FirstIndex = 0;
+	uint32 NumTriangles = 0;
+	int32 FirstCluster = 0;
+	int32 NumClusters = 0;
+};
+
+// 一个网格的簇数据（局部空间，只读）。
+struct FRealityDistortionMeshClusters
+{
+	TArray<FRealityDistortionTriangleCluster> Clusters;
+
+	// LODSections[LOD][Section]，包含所有 Section；NumClusters 为 0 表示该 Section 不做簇剔除。
+	TArray<TArray<FRealityDistortionSectionClusters>> LODSections;
+
+	// 所有 LOD 中最长三角形边（局部空间），-1 表示构建时没有计算。
+	float LocalMaxTriangleEdgeLength = -1.0f;
+
+	// 返回该 Section 的簇；Section 与构建时不一致（网格重新构建、平台 LOD 设置不同）时返回 nullptr。
+	REALITYDISTORTION_API const FRealityDistortionTriangleCluster* FindSectionClusters(
+		int32 LODIndex,
+		int32 SectionIndex,
+		uint32 FirstIndex,
+		uint32 NumTriangles,
+		int32& OutNumClusters) const;
+
+	// 所有 LOD / Section 都与 RenderData 一致；最长边只在一致时才可信。
+	REALITYDISTORTION_API bool MatchesRenderData(const FStaticMeshRenderData& RenderData) const;
+
+	friend REALITYDISTORTION_API FArchive& operator<<(FArchive& Ar, FRealityDistortionMeshClusters& MeshClusters);
+};
+
+// 构建输入：在 GT 上从 RenderData 拷贝，之后可以在任意线程构建。
+struct FRealityDistortionMeshClusterSource
+{
+	struct FLOD
+	{
+		TArray<FRealityDistortionSectionClusters> Sections;
+		// 该 LOD 不需要构建任何数据时为空。
+		TArray<uint32> Indices;
+		TArray<FVector3f> Positions;
+	};
+
+	TArray<FLOD> LODs;
+	bool bMaxTriangleEdgeLength = false;
+};
+
+// 先按 Section 三角形数判断是否需要簇（以及是否需要最长边），只拷贝确实要用的 LOD 的索引 / 顶点。
+// 需要的 LOD 缺少 CPU 侧数据（Cook 后未开启 Allow CPUAccess）时返回 false。
+REALITYDISTORTION_API bool GatherRealityDistortionMeshClusterSource(
+	const FStaticMeshRenderData& RenderData,
+	bool bMaxTriangleEdgeLength,
+	FRealityDistortionMeshClusterSource& OutSource);
+
+REALITYDISTORTION_API void BuildRealityDistortionMeshClusters(
+	const FRealityDistortionMeshClusterSource& Source,
+	FRealityDistortionMeshClusters& OutMeshClusters);
+
+// 把 [FirstIndex, FirstIndex + NumTriangles * 3) 的三角形按索引顺序切成簇，追加到 OutClusters。
+REALITYDISTORTION_API void BuildRealityDistortionTriangleClusters(
+	TConstArrayView<uint32> Indices,
+	TConstArrayView<FVector3f> Positions,
+	uint32 FirstIndex,
+	uint32 NumTriangles,
+	TArray<FRealityDistortionTriangleCluster>& OutClusters);
+
+// 输出与任一力场相交的簇合并后的索引区间（按 FirstIndex 升序），最多 MaxRanges 个。
+// 返回相交簇的三角形总数（合并区间时补进来的间隔不计入）。
+REALITYDISTORTION_API uint32 CullRealityDistortionTriangleClusters(
+	TConstArrayView<FRealityDistortionTriangleCluster> Clusters,
+	const FMatrix& LocalToWorld,
+	const FRealityDistortionFieldGrid& FieldGrid,
+	int32 MaxRanges,
+	FRealityDistortionIndexRangeArray& OutRanges);
@@ -0,0 +1,387 @@
+﻿// RealityDistortionFieldCulling.cpp
+
+#include "Rendering/RealityDistortionFieldCulling.h"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RealityDistortion.h"
+#include "RealityDistortionField.h"
+#include "Rendering/RealityDistortionFieldSelection.h"
+#include "Rendering/RealityDistortionStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Build Field Grid"), STAT_RealityDistortion_BuildFieldGrid, STATGROUP_RealityDistortion);
+
+namespace
+{
+	// 单轴最多格子数；总格子数另外按力场数量限制，避免稀疏场景分配大量空格子。
+	constexpr int32 MaxGridDimension = 64;
+	constexpr int32 TargetCellsPerField = 8;
+
+	// 单个力场最多登记的格子数，超过则放进 OversizedFields。
+	constexpr int32 MaxCellsPerField = 64;
+
+	FRealityDistortionFieldGrid GRealityDistortionFieldGrid;
+	// 上一次 Build 的输入，用于检测力场是否变化。
+	TArray<FSphere> GRealityDistortionFieldSpheres;
+	TArray<FRealityDistortionFieldShape> GRealityDistortionFieldShapes;
+	// 每次重建递增，按力场索引缓存结果的使用者（实例化接收体）据此判断是否失效。
+	uint32 GRealityDistortionFieldGridVersion = 0;
+
+	// 索引登记的范围：动画力场登记整个周期的包围球（按球处理），基准值不变时索引输入不变，
+	// 不会每帧重建、让缓存接收体重新判定；其余力场登记本帧的形状。
+	void GetFieldGridInput(const FRealityDistortionFieldsView& Fields, int32 SlotIndex, FSphere& OutSphere, FRealityDistortionFieldShape& OutShape)
+	{
+		const FSphere& AnimationBounds = Fields.AnimationBounds[SlotIndex];
+		if (AnimationBounds.W > 0.0)
+		{
+			OutSphere = AnimationBounds;
+			OutShape = FRealityDistortionFieldShape();
+			OutShape.Center = AnimationBounds.Center;
+			OutShape.Extent = FVector3f(static_cast<float>(AnimationBounds.W));
+			return;
+		}
+
+		OutSphere = FSphere(Fields.Centers[SlotIndex], Fields.Radii[SlotIndex]);
+		OutShape = GetRealityDistortionFieldShape(Fields, SlotIndex);
+	}
+
+	// 休眠判定用的索引：全部启用的力场，下标为注册表槽位，与选择无关。
+	FRealityDistortionFieldGrid GRealityDistortionProximityFieldGrid;
+	TArray<FSphere> GRealityDistortionProximityFieldSpheres;
+	TArray<FRealityDistortionFieldShape> GRealityDistortionProximityFieldShapes;
+}
+
+void FRealityDistortionFieldGrid::Reset()
+{
+	Fields.Reset();
+	OversizedFields.Reset();
+	CellStart.Reset();
+	CellFieldIndices.Reset();
+}
+
+void FRealityDistortionFieldGrid::Build(TConstArrayView<FSphere> FieldSpheres, TConstArrayView<FRealityDistortionFieldShape> FieldShapes)
+{
+	Reset();
+	check(FieldShapes.IsEmpty() || FieldShapes.Num() == FieldSpheres.Num());
+
+	FBox Bounds(ForceInit);
+	double SumDiameter = 0.0;
+	for (int32 SlotIndex = 0; SlotIndex < FieldSpheres.Num(); ++SlotIndex)
+	{
+		const FSphere& Sphere = FieldSpheres[SlotIndex];
+		if (Sphere.W <= 0.0)
+		{
+			continue;
+		}
+
+		FGridField& Field = Fields.AddDefaulted_GetRef();
+		Field.Center = Sphere.Center;
+		Field.Radius = static_cast<float>(Sphere.W);
+		Field.SlotIndex = static_cast<uint32>(SlotIndex);
+		if (!FieldShapes.IsEmpty() && FieldShapes[SlotIndex].Type != REALITY_DISTORTION_FIELD_SHAPE_SPHERE)
+		{
+			Field.Shape = FieldShapes[SlotIndex];
+			Field.Bounds = ComputeRealityDistortionFieldShapeBounds(Field.Shape);
+		}
+		else
+		{
+			Field.Shape.Type = REALITY_DISTORTION_FIELD_SHAPE_SPHERE;
+			Field.Bounds = FBox(Sphere.Center - FVector(Sphere.W), Sphere.Center + FVector(Sphere.W));
+		}
+
+		Bounds += Field.Bounds;
+		SumDiameter += Field.Bounds.GetSize().GetMax();
+	}
+
+	if (Fields.IsEmpty())
+	{
+		return;
+	}
+
+	// 格子边长取“平均直径”与“按目标格子数均分包围盒”两者的较大值：
+	// 前者保证普通力场只落在少量格子里，后者限制总格子数。
+	const FVector Extent = Bounds.GetSize();
+	const double AverageDiameter = SumDiameter / Fields.Num();
+	const double TargetCells = FMath::Min<double>(Fields.Num() * TargetCellsPerField, FMath::Cube<double>(MaxGridDimension));
+	const double VolumeCellSize = FMath::Pow(FMath::Max(Extent.X * Extent.Y * Extent.Z, UE_KINDA_SMALL_NUMBER) / TargetCells, 1.0 / 3.0);
+	const double MaxExtent = FMath::Max(Extent.GetMax(), UE_KINDA_SMALL_NUMBER);
+	const double CellSize = FMath::Max3(AverageDiameter, VolumeCellSize, MaxExtent / MaxGridDimension);
+
+	GridOrigin = Bounds.Min;
+	GridMax = Bounds.Max;
+	InvCellSize = static_cast<float>(1.0 / CellSize);
+	GridDims = FIntVector(
+		FMath::Clamp(FMath::CeilToInt32(Extent.X / CellSize), 1, MaxGridDimension),
+		FMath::Clamp(FMath::CeilToInt32(Extent.Y / CellSize), 1, MaxGridDimension),
+		FMath::Clamp(FMath::CeilToInt32(Extent.Z / CellSize), 1, MaxGridDimension));
+
+	const int32 NumCells = GridDims.X * GridDims.Y * GridDims.Z;
+	CellStart.SetNumZeroed(NumCells + 1);
+
+	// 第一遍：统计每个格子的力场数量。
+	TArray<FIntVector, TInlineAllocator<256>> FieldMaxCells;
+	FieldMaxCells.SetNumUninitialized(Fields.Num());
+	for (int32 FieldIndex = 0; FieldIndex < Fields.Num(); ++FieldIndex)
+	{
+		FGridField& Field = Fields[FieldIndex];
+		Field.MinCell = GetCellCoord(Field.Bounds.Min);
+		const FIntVector MaxCell = GetCellCoord(Field.Bounds.Max);
+		FieldMaxCells[FieldIndex] = MaxCell;
+
+		const FIntVector Span = MaxCell - Field.MinCell + FIntVector(1, 1, 1);
+		if (Span.X * Span.Y * Span.Z > MaxCellsPerField)
+		{
+			OversizedFields.Add(FieldIndex);
+			continue;
+		}
+
+		for (int32 Z = Field.MinCell.Z; Z <= MaxCell.Z; ++Z)
+		{
+			for (int32 Y = Field.MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 X = Field.MinCell.X; X <= MaxCell.X; ++X)
+				{
+					++CellStart[GetCellIndex(X, Y, Z) + 1];
+				}
+			}
+		}
+	}
+
+	// 前缀和得到每个格子的起始位置。
+	for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
+	{
+		CellStart[CellIndex + 1] += CellStart[CellIndex];
+	}
+
+	// 第二遍：填充格子列表。
+	CellFieldIndices.SetNumUninitialized(CellStart[NumCells]);
+	TArray<uint32> CellWriteOffset(CellStart.GetData(), NumCells);
+	int32 NextOversized = 0;
+	for (int32 FieldIndex = 0; FieldIndex < Fields.Num(); ++FieldIndex)
+	{
+		if (NextOversized < OversizedFields.Num() && OversizedFields[NextOversized] == static_cast<uint32>(FieldIndex))
+		{
+			++NextOversized;
+			continue;
+		}
+
+		const FGridField& Field = Fields[FieldIndex];
+		const FIntVector MaxCell = FieldMaxCells[FieldIndex];
+		for (int32 Z = Field.MinCell.Z; Z <= MaxCell.Z; ++Z)
+		{
+			for (int32 Y = Field.MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 X = Field.MinCell.X; X <= MaxCell.X; ++X)
+				{
+					CellFieldIndices[CellWriteOffset[GetCellIndex(X, Y, Z)]++] = FieldIndex;
+				}
+			}
+		}
+	}
+}
+
+bool UpdateRealityDistortionFieldGrid_RenderThread()
+{
+	check(IsInRenderingThread());
+	SCOPE_CYCLE_COUNTER(STAT_RealityDistortion_BuildFieldGrid);
+
+	const FRealityDistortionFieldsView Fields = GetRealityDistortionFields_RenderThread();
+	const FRealityDistortionFieldSelection& Selection = GetRealityDistortionFieldSelection_RenderThread();
+
+	// 与 FieldBuffer 打包保持一致：只索引本 ViewFamily 选中的力场，下标为 Buffer 位置。
+	TArray<FSphere, TInlineAllocator<MAX_DISTORTION_FIELDS>> FieldSpheres;
+	TArray<FRealityDistortionFieldShape, TInlineAllocator<MAX_DISTORTION_FIELDS>> FieldShapes;
+	FieldSpheres.SetNumUninitialized(Selection.NumBufferSlots);
+	FieldShapes.SetNum(Selection.NumBufferSlots);
+	for (int32 BufferIndex = 0; BufferIndex < Selection.NumBufferSlots; ++BufferIndex)
+	{
+		const int32 SlotIndex = Selection.BufferToSlot[BufferIndex];
+		if (SlotIndex != INDEX_NONE)
+		{
+			GetFieldGridInput(Fields, SlotIndex, FieldSpheres[BufferIndex], FieldShapes[BufferIndex]);
+		}
+		else
+		{
+			FieldSpheres[BufferIndex] = FSphere(FVector::ZeroVector, 0.0f);
+		}
+	}
+
+	// 力场完全静止时跳过重建，也让缓存接收体不必重新判定。
+	// 形状结构体有填充字节，逐个比较而不是 Memcmp。
+	bool bFieldsChanged = FieldSpheres.Num() != GRealityDistortionFieldSpheres.Num()
+		|| FMemory::Memcmp(FieldSpheres.GetData(), GRealityDistortionFieldSpheres.GetData(), FieldSpheres.Num() * sizeof(FSphere)) != 0;
+	for (int32 BufferIndex = 0; !bFieldsChanged && BufferIndex < FieldShapes.Num(); ++BufferIndex)
+	{
+		bFieldsChanged = FieldShapes[BufferIndex] != GRealityDistortionFieldShapes[BufferIndex];
+	}
+	if (!bFieldsChanged)
+	{
+		return false;
+	}
+
+	GRealityDistortionFieldSpheres = FieldSpheres;
+	GRealityDistortionFieldShapes = FieldShapes;
+	GRealityDistortionFieldGrid.Build(FieldSpheres, FieldShapes);
+	++GRealityDistortionFieldGridVersion;
+	return true;
+}
+
+bool UpdateRealityDistortionProximityFieldGrid_RenderThread()
+{
+	check(IsInRenderingThread());
+	SCOPE_CYCLE_COUNTER(STAT_RealityDistortion_BuildFieldGrid);
+
+	const FRealityDistortionFieldsView Fields = GetRealityDistortionFields_RenderThread();
+
+	TArray<FSphere> FieldSpheres;
+	TArray<FRealityDistortionFieldShape> FieldShapes;
+	FieldSpheres.SetNumUninitialized(Fields.Num());
+	FieldShapes.SetNum(Fields.Num());
+	for (int32 SlotIndex = 0; SlotIndex < Fields.Num(); ++SlotIndex)
+	{
+		// 动画力场半径短暂缩到 0 时仍按整个周期的范围登记。
+		if (Fields.Enabled[SlotIndex] && (Fields.Radii[SlotIndex] > 0.0f || Fields.AnimationBounds[SlotIndex].W > 0.0))
+		{
+			GetFieldGridInput(Fields, SlotIndex, FieldSpheres[SlotIndex], FieldShapes[SlotIndex]);
+		}
+		else
+		{
+			FieldSpheres[SlotIndex] = FSphere(FVector::ZeroVector, 0.0f);
+		}
+	}
+
+	bool bFieldsChanged = FieldSpheres.Num() != GRealityDistortionProximityFieldSpheres.Num()
+		|| FMemory::Memcmp(FieldSpheres.GetData(), GRealityDistortionProximityFieldSpheres.GetData(), FieldSpheres.Num() * sizeof(FSphere)) != 0;
+	for (int32 SlotIndex = 0; !bFieldsChanged && SlotIndex < FieldShapes.Num(); ++SlotIndex)
+	{
+		bFieldsChanged = FieldShapes[SlotIndex] != GRealityDistortionProximityFieldShapes[SlotIndex];
+	}
+	if (!bFieldsChanged)
+	{
+		return false;
+	}
+
+	GRealityDistortionProximityFieldGrid.Build(FieldSpheres, FieldShapes);
+	GRealityDistortionProximityFieldSpheres = MoveTemp(FieldSpheres);
+	GRealityDistortionProximityFieldShapes = MoveTemp(FieldShapes);
+	return true;
+}
+
+const FRealityDistortionFieldGrid& GetRealityDistortionProximityFieldGrid_RenderThread()
+{
+	check(IsInRenderingThread() || IsInParallelRenderingThread());
+	return GRealityDistortionProximityFieldGrid;
+}
+
+const FRealityDistortionFieldGrid& GetRealityDistortionFieldGrid_RenderThread()
+{
+	check(IsInRenderingThread() || IsInParallelRenderingThread());
+	return GRealityDistortionFieldGrid;
+}
+
+uint32 GetRealityDistortionFieldGridVersion_RenderThread()
+{
+	check(IsInRenderingThread() || IsInParallelRenderingThread());
+	return GRealityDistortionFieldGridVersion;
+}
+
+// ============================================================================
+// 基准工具：r.RealityDistortion.BenchmarkFieldCulling [NumReceivers] [NumFields]
+// ============================================================================
+// 纯 CPU，不依赖 RT / GPU。只测耗时，正确性由自动化测试 RealityDistortion.FieldCulling.* 保证。
+// 结果追加到 Saved/Profiling/RealityDistortion/FieldCulling.csv（每次一行），便于在不同版本 / 机器之间对比。
+static void RunRealityDistortionFieldCullingBenchmark(const TArray<FString>& Args)
+{
+	const int32 NumReceivers = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+	const int32 NumFields = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 1000;
+
+	// 固定种子，保证结果可复现。
+	FRandomStream Random(0x5244);
+	const double WorldHalfSize = 50000.0;
+
+	auto RandomPoint = [&Random, WorldHalfSize]()
+	{
+		return FVector(
+			Random.FRandRange(-WorldHalfSize, WorldHalfSize),
+			Random.FRandRange(-WorldHalfSize, WorldHalfSize),
+			Random.FRandRange(-WorldHalfSize * 0.1, WorldHalfSize * 0.1));
+	};
+
+	TArray<FSphere> FieldSpheres;
+	FieldSpheres.Reserve(NumFields);
+	for (int32 Index = 0; Index < NumFields; ++Index)
+	{
+		FieldSpheres.Emplace(RandomPoint(), Random.FRandRange(200.0, 2000.0));
+	}
+
+	TArray<FSphere> ReceiverSpheres;
+	ReceiverSpheres.Reserve(NumReceivers);
+	for (int32 Index = 0; Index < NumReceivers; ++Index)
+	{
+		ReceiverSpheres.Emplace(RandomPoint(), Random.FRandRange(50.0, 1000.0));
+	}
+
+	// 线性遍历：与旧版 AddMeshBatch 相同的逐个球-球测试。
+	uint64 LinearHits = 0;
+	const double LinearStart = FPlatformTime::Seconds();
+	for (const FSphere& Receiver : ReceiverSpheres)
+	{
+		for (const FSphere& Field : FieldSpheres)
+		{
+			if (FVector::DistSquared(Receiver.Center, Field.Center) <= FMath::Square(Receiver.W + Field.W))
+			{
+				++LinearHits;
+			}
+		}
+	}
+	const double LinearSeconds = FPlatformTime::Seconds() - LinearStart;
+
+	FRealityDistortionFieldGrid Grid;
+	const double BuildStart = FPlatformTime::Seconds();
+	Grid.Build(FieldSpheres);
+	const double BuildSeconds = FPlatformTime::Seconds() - BuildStart;
+
+	uint64 GridHits = 0;
+	const double QueryStart = FPlatformTime::Seconds();
+	for (const FSphere& Receiver : ReceiverSpheres)
+	{
+		Grid.ForEachOverlappingField(Receiver.Center, static_cast<float>(Receiver.W), [&GridHits](uint32)
+		{
+			++GridHits;
+			return true;
+		});
+	}
+	const double QuerySeconds = FPlatformTime::Seconds() - QueryStart;
+
+	const FString CsvHeader = TEXT("Receivers,Fields,LinearMs,GridBuildMs,GridQueryMs,Hits\n");
+	const FString CsvRow = FString::Printf(TEXT("%d,%d,%.4f,%.4f,%.4f,%llu\n"),
+		NumReceivers, NumFields, LinearSeconds * 1000.0, BuildSeconds * 1000.0, QuerySeconds * 1000.0, GridHits);
+
+	const FString CsvPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("RealityDistortion"), TEXT("FieldCulling.csv"));
+	if (!IFileManager::Get().FileExists(*CsvPath))
+	{
+		FFileHelper::SaveStringToFile(CsvHeader, *CsvPath);
+	}
+	FFileHelper::SaveStringToFile(CsvRow, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	UE_LOG(LogRealityDistortion, Display,
+		TEXT("[RealityDistortion] Field culling benchmark: %d receivers x %d fields | linear %.3f ms | grid build %.3f ms + query %.3f ms | %llu hits -> %s"),
+		NumReceivers, NumFields,
+		LinearSeconds * 1000.0,
+		BuildSeconds * 1000.0, QuerySeconds * 1000.0, GridHits,
+		*CsvPath);
+	if (LinearHits != GridHits)
+	{
+		// 正常情况下不会出现；出现时说明自动化测试没有覆盖到该分布。
+		UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] Field culling benchmark: linear scan found %llu hits, grid %llu"), LinearHits, GridHits);
+	}
+}
+
+static FAutoConsoleCommand CmdRealityDistortionBenchmarkFieldCulling(
+	TEXT("r.RealityDistortion.BenchmarkFieldCulling"),
+	TEXT("Time receiver-vs-field culling (linear scan vs. grid) and append a row to Saved/Profiling/RealityDistortion/FieldCulling.csv. Args: [NumReceivers=10000] [NumFields=1000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunRealityDistortionFieldCullingBenchmark));
@@ -0,0 +1,205 @@
+﻿// RealityDistortionFieldCulling.h
+//
+// FRealityDistortionFieldGrid
+// ---------------------------
+// 力场的 RT 侧空间索引（均匀网格）：
+// 1) 每个 ViewFamily 由 ViewExtension 重建一次，只收录选中上传的力场（见 RealityDistortionFieldSelection.h），
+//    “槽位”指 FieldBuffer 中的位置，与 Shader 侧的掩码一致。
+//    接收体休眠判定另用一份收录全部启用力场的索引（槽位为注册表槽位），视锥外的力场也能让接收体保持唤醒，
+//    力场进入视野的那一帧接收体已经在活跃路径上，不必等 GT 重建 Proxy。
+// 2) AddMeshBatch 只对接收体包围球覆盖到的格子里的力场做球-球测试，
+//    不再对全部力场线性遍历。
+// 3) 非球形力场（盒 / 胶囊 / 圆柱，见 RealityDistortionFieldShapes.h）按旋转后的 AABB 登记格子，
+//    包围球测试通过后再用精确 SDF 测试（SDF(接收体球心) <= 接收体半径），细长力场不会按包围球误判。
+//
+// 说明：
+// - 一个力场会登记到它 AABB 覆盖的所有格子；查询时用“参考格子”去重（见 ForEachOverlappingField），
+//   因此查询是无状态的，可以在并行的 MeshPass 任务里同时调用。
+// - 覆盖格子过多的超大力场单独放进 OversizedFields，每次查询都直接测试。
+// - 动画力场登记整个动画周期的包围球（FRealityDistortionFieldsView::AnimationBounds），不登记逐帧的求值结果：
+//   只有基准值或动画描述变化（即登记范围跨过格子）时索引才重建、缓存接收体才重新判定，代价是查询对动画力场偏保守。
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Rendering/RealityDistortionFieldShapes.h"
+
+class REALITYDISTORTION_API FRealityDistortionFieldGrid
+{
+public:
+	// 输入：下标即槽位号；Radius <= 0 表示该槽位不参与索引。
+	// FieldShapes 为空时全部按球处理；否则与 FieldSpheres 一一对应（球为对应形状的包围球）。
+	void Build(TConstArrayView<FSphere> FieldSpheres, TConstArrayView<FRealityDistortionFieldShape> FieldShapes = {});
+
+	void Reset();
+
+	bool IsEmpty() const
+	{
+		return Fields.IsEmpty();
+	}
+
+	int32 GetNumFields() const
+	{
+		return Fields.Num();
+	}
+
+	// 对每个与球 (Center, Radius) 相交的力场调用 Function(SlotIndex)。
+	// Function 返回 false 时提前结束遍历。每个力场最多回调一次。
+	template<typename FunctionType>
+	void ForEachOverlappingField(const FVector& Center, float Radius, FunctionType&& Function) const;
+
+	bool IntersectsAnyField(const FVector& Center, float Radius) const
+	{
+		bool bIntersects = false;
+		ForEachOverlappingField(Center, Radius, [&bIntersects](uint32)
+		{
+			bIntersects = true;
+			return false;
+		});
+		return bIntersects;
+	}
+
+	// 与球相交的力场槽位位掩码（bit = SlotIndex），只覆盖前 64 个槽位。
+	uint64 GetOverlappingFieldMask(const FVector& Center, float Radius) const
+	{
+		uint64 FieldMask = 0;
+		ForEachOverlappingField(Center, Radius, [&FieldMask](uint32 SlotIndex)
+		{
+			if (SlotIndex < 64)
+			{
+				FieldMask |= uint64(1) << SlotIndex;
+			}
+			return true;
+		});
+		return FieldMask;
+	}
+
+private:
+	struct FGridField
+	{
+		FVector Center;
+		float Radius;
+		uint32 SlotIndex;
+		// 该力场登记范围的最小格子坐标，用于查询去重。
+		FIntVector MinCell;
+		// 登记范围：球形为包围球的 AABB，其余形状为旋转后的紧致 AABB。
+		FBox Bounds;
+		FRealityDistortionFieldShape Shape;
+	};
+
+	FIntVector GetCellCoord(const FVector& Position) const
+	{
+		const FVector Local = (Position - GridOrigin) * InvCellSize;
+		return FIntVector(
+			FMath::Clamp(FMath::FloorToInt32(Local.X), 0, GridDims.X - 1),
+			FMath::Clamp(FMath::FloorToInt32(Local.Y), 0, GridDims.Y - 1),
+			FMath::Clamp(FMath::FloorToInt32(Local.Z), 0, GridDims.Z - 1));
+	}
+
+	int32 GetCellIndex(int32 X, int32 Y, int32 Z) const
+	{
+		return (Z * GridDims.Y + Y) * GridDims.X + X;
+	}
+
+	static bool SpheresIntersect(const FGridField& Field, const FVector& Center, float Radius)
+	{
+		return FVector::DistSquared(Field.Center, Center) <= FMath::Square(Field.Radius + Radius);
+	}
+
+	// 先做包围球测试，非球形力场再做精确形状测试。
+	static bool FieldIntersectsSphere(const FGridField& Field, const FVector& Center, float Radius)
+	{
+		return SpheresIntersect(Field, Center, Radius)
+			&& (Field.Shape.Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE || RealityDistortionFieldShapeIntersectsSphere(Field.Shape, Center, Radius));
+	}
+
+	TArray<FGridField> Fields;
+	TArray<uint32> OversizedFields;
+
+	// CSR 布局：格子 i 的力场列表是 CellFieldIndices[CellStart[i], CellStart[i + 1])。
+	TArray<uint32> CellStart;
+	TArray<uint32> CellFieldIndices;
+
+	FVector GridOrigin = FVector::ZeroVector;
+	FVector GridMax = FVector::ZeroVector;
+	float InvCellSize = 1.0f;
+	FIntVector GridDims = FIntVector(1, 1, 1);
+};
+
+template<typename FunctionType>
+void FRealityDistortionFieldGrid::ForEachOverlappingField(const FVector& Center, float Radius, FunctionType&& Function) const
+{
+	for (const uint32 FieldIndex : OversizedFields)
+	{
+		const FGridField& Field = Fields[FieldIndex];
+		if (FieldIntersectsSphere(Field, Center, Radius) && !Function(Field.SlotIndex))
+		{
+			return;
+		}
+	}
+
+	if (CellStart.IsEmpty())
+	{
+		return;
+	}
+
+	const FVector QueryMin = Center - FVector(Radius);
+	const FVector QueryMax = Center + FVector(Radius);
+	if (QueryMax.X < GridOrigin.X || QueryMax.Y < GridOrigin.Y || QueryMax.Z < GridOrigin.Z
+		|| QueryMin.X > GridMax.X || QueryMin.Y > GridMax.Y || QueryMin.Z > GridMax.Z)
+	{
+		return;
+	}
+
+	const FIntVector MinCell = GetCellCoord(QueryMin);
+	const FIntVector MaxCell = GetCellCoord(QueryMax);
+
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const int32 CellIndex = GetCellIndex(X, Y, Z);
+				for (uint32 Entry = CellStart[CellIndex]; Entry < CellStart[CellIndex + 1]; ++Entry)
+				{
+					const FGridField& Field = Fields[CellFieldIndices[Entry]];
+
+					// 去重：力场与查询 AABB 的交集最小角所在格子是唯一的，只在那个格子里上报。
+					// floor/clamp 单调，因此该格子坐标 = max(力场最小格子, 查询最小格子)。
+					if (X != FMath::Max(Field.MinCell.X, MinCell.X)
+						|| Y != FMath::Max(Field.MinCell.Y, MinCell.Y)
+						|| Z != FMath::Max(Field.MinCell.Z, MinCell.Z))
+					{
+						continue;
+					}
+
+					if (FieldIntersectsSphere(Field, Center, Radius) && !Function(Field.SlotIndex))
+					{
+						return;
+					}
+				}
+			}
+		}
+	}
+}
+
+// ============================================================================
+// RenderThread API
+// ============================================================================
+// 由 FRealityDistortionViewExtension 每个 ViewFamily 调用一次，基于当前注册表重建索引。
+// 返回值：力场的位置/形状/启用状态相对上一次调用是否有变化（缓存接收体据此决定是否重新判定）。
+REALITYDISTORTION_API bool UpdateRealityDistortionFieldGrid_RenderThread();
+
+// 用全部启用的力场重建休眠判定索引（与选择无关，下标为注册表槽位）。
+// 返回值：相对上一次调用是否有变化（休眠接收体据此决定是否重新判定）。
+REALITYDISTORTION_API bool UpdateRealityDistortionProximityFieldGrid_RenderThread();
+
+// 休眠判定使用的力场索引，只用于“附近有没有力场”的查询。
+REALITYDISTORTION_API const FRealityDistortionFieldGrid& GetRealityDistortionProximityFieldGrid_RenderThread();
+
+// AddMeshBatch 使用的本帧力场索引（只读，可在并行 MeshPass 任务中访问）。
+REALITYDISTORTION_API const FRealityDistortionFieldGrid& GetRealityDistortionFieldGrid_RenderThread();
+
+// 力场索引的版本号：每次重建（力场移动 / 增删 / 选择变化）递增，索引不变时保持不变。
+REALITYDISTORTION_API uint32 GetRealityDistortionFieldGridVersion_RenderThread();
@@ -0,0 +1,217 @@
+﻿// RealityDistortionFieldSelection.cpp
+
+#include "Rendering/RealityDistortionFieldSelection.h"
+
+#include "HAL/IConsoleManager.h"
+#include "RealityDistortion.h"
+#include "Rendering/RealityDistortionStats.h"
+#include "SceneManagement.h"
+#include "SceneView.h"
+
+DEFINE_STAT(STAT_RealityDistortion_FieldsActive);
+DEFINE_STAT(STAT_RealityDistortion_FieldsFrustumCulled);
+DEFINE_STAT(STAT_RealityDistortion_FieldsOverBudget);
+DEFINE_STAT(STAT_RealityDistortion_FieldsSelected);
+
+namespace
+{
+	static TAutoConsoleVariable<int32> CVarRealityDistortionMaxFieldsPerView(
+		TEXT("r.RealityDistortion.MaxFieldsPerView"),
+		MAX_DISTORTION_FIELDS,
+		TEXT("Maximum number of fields uploaded per view family, ranked by priority and then projected screen size. Clamped to [1, REALITY_DISTORTION_MAX_FIELDS]."),
+		ECVF_RenderThreadSafe);
+
+	static TAutoConsoleVariable<int32> CVarRealityDistortionFieldFrustumCulling(
+		TEXT("r.RealityDistortion.FieldFrustumCulling"),
+		1,
+		TEXT("Skip fields whose sphere is outside every view frustum of the view family before ranking. 0=Off, 1=On (default)"),
+		ECVF_RenderThreadSafe);
+
+	FRealityDistortionFieldSelection GRealityDistortionFieldSelection;
+	TArray<FRealityDistortionFieldCandidate> GRealityDistortionFieldCandidates;
+
+	// 屏幕尺寸的并集，下标为注册表槽位：本帧已处理的各 ViewFamily，以及上一帧的全部 ViewFamily。
+	// 同一帧的多个 ViewFamily（分屏窗口、SceneCapture 等）共用一份选择，排序只看并集，不会互相覆盖。
+	TArray<float> GRealityDistortionFrameScreenSizes;
+	TArray<float> GRealityDistortionPreviousFrameScreenSizes;
+	uint32 GRealityDistortionSelectionFrameNumber = MAX_uint32;
+
+	// 排序：优先级高的在前，同优先级屏幕尺寸大的在前，再按槽位保证结果确定。
+	bool RanksBefore(const FRealityDistortionFieldCandidate& A, int32 SlotA, const FRealityDistortionFieldCandidate& B, int32 SlotB)
+	{
+		if (A.Priority != B.Priority)
+		{
+			return A.Priority > B.Priority;
+		}
+		if (A.ScreenSize != B.ScreenSize)
+		{
+			return A.ScreenSize > B.ScreenSize;
+		}
+		return SlotA < SlotB;
+	}
+}
+
+void SelectRealityDistortionFields(
+	TConstArrayView<FRealityDistortionFieldCandidate> Candidates,
+	int32 Budget,
+	const FRealityDistortionFieldSelection& PreviousSelection,
+	FRealityDistortionFieldSelection& OutSelection)
+{
+	OutSelection.Reset();
+	Budget = FMath::Clamp(Budget, 0, static_cast<int32>(MAX_DISTORTION_FIELDS));
+
+	TArray<int32, TInlineAllocator<MAX_DISTORTION_FIELDS>> VisibleSlots;
+	for (int32 SlotIndex = 0; SlotIndex < Candidates.Num(); ++SlotIndex)
+	{
+		const FRealityDistortionFieldCandidate& Candidate = Candidates[SlotIndex];
+		if (Candidate.Sphere.W <= 0.0f)
+		{
+			continue;
+		}
+
+		++OutSelection.NumActive;
+		if (Candidate.ScreenSize < 0.0f)
+		{
+			++OutSelection.NumFrustumCulled;
+			continue;
+		}
+		VisibleSlots.Add(SlotIndex);
+	}
+
+	if (VisibleSlots.Num() > Budget)
+	{
+		VisibleSlots.Sort([Candidates](int32 SlotA, int32 SlotB)
+		{
+			return RanksBefore(Candidates[SlotA], SlotA, Candidates[SlotB], SlotB);
+		});
+		OutSelection.NumOverBudget = VisibleSlots.Num() - Budget;
+		VisibleSlots.SetNum(Budget, EAllowShrinking::No);
+	}
+	OutSelection.NumSelected = VisibleSlots.Num();
+
+	// 位置分配分三轮：沿用上一次的位置 -> 与注册表槽位相同的位置 -> 最小的空闲位置。
+	TBitArray<> bAssigned(false, VisibleSlots.Num());
+	for (int32 Index = 0; Index < VisibleSlots.Num(); ++Index)
+	{
+		for (int32 BufferIndex = 0; BufferIndex < PreviousSelection.NumBufferSlots; ++BufferIndex)
+		{
+			if (PreviousSelection.BufferToSlot[BufferIndex] == VisibleSlots[Index])
+			{
+				OutSelection.BufferToSlot[BufferIndex] = VisibleSlots[Index];
+				bAssigned[Index] = true;
+				break;
+			}
+		}
+	}
+
+	for (int32 Index = 0; Index < VisibleSlots.Num(); ++Index)
+	{
+		const int32 SlotIndex = VisibleSlots[Index];
+		if (!bAssigned[Index] && SlotIndex < static_cast<int32>(MAX_DISTORTION_FIELDS) && OutSelection.BufferToSlot[SlotIndex] == INDEX_NONE)
+		{
+			OutSelection.BufferToSlot[SlotIndex] = SlotIndex;
+			bAssigned[Index] = true;
+		}
+	}
+
+	int32 NextFreeIndex = 0;
+	for (int32 Index = 0; Index < VisibleSlots.Num(); ++Index)
+	{
+		if (bAssigned[Index])
+		{
+			continue;
+		}
+
+		while (OutSelection.BufferToSlot[NextFreeIndex] != INDEX_NONE)
+		{
+			++NextFreeIndex;
+		}
+		OutSelection.BufferToSlot[NextFreeIndex] = VisibleSlots[Index];
+	}
+
+	for (int32 BufferIndex = 0; BufferIndex < static_cast<int32>(MAX_DISTORTION_FIELDS); ++BufferIndex)
+	{
+		if (OutSelection.BufferToSlot[BufferIndex] != INDEX_NONE)
+		{
+			OutSelection.NumBufferSlots = BufferIndex + 1;
+		}
+	}
+}
+
+void UpdateRealityDistortionFieldSelection_RenderThread(const FSceneViewFamily& ViewFamily)
+{
+	check(IsInRenderingThread());
+
+	const FRealityDistortionFieldsView Fields = GetRealityDistortionFields_RenderThread();
+	const bool bFrustumCulling = CVarRealityDistortionFieldFrustumCulling.GetValueOnRenderThread() != 0 && ViewFamily.Views.Num() > 0;
+
+	// 新的一帧：本帧并集转为上一帧并集。上一帧的并集让本帧先渲染的 ViewFamily 也看到后渲染的 ViewFamily 可见的力场，
+	// 选择结果在帧内、帧间都保持一致，代价是离开所有视锥的力场会多保留一帧。
+	if (GRealityDistortionSelectionFrameNumber != ViewFamily.FrameNumber)
+	{
+		GRealityDistortionSelectionFrameNumber = ViewFamily.FrameNumber;
+		Swap(GRealityDistortionFrameScreenSizes, GRealityDistortionPreviousFrameScreenSizes);
+		GRealityDistortionFrameScreenSizes.Reset();
+	}
+
+	TArray<float>& FrameScreenSizes = GRealityDistortionFrameScreenSizes;
+	const TArray<float>& PreviousFrameScreenSizes = GRealityDistortionPreviousFrameScreenSizes;
+	for (int32 SlotIndex = FrameScreenSizes.Num(); SlotIndex < Fields.Num(); ++SlotIndex)
+	{
+		FrameScreenSizes.Add(-1.0f);
+	}
+
+	TArray<FRealityDistortionFieldCandidate>& Candidates = GRealityDistortionFieldCandidates;
+	Candidates.SetNum(Fields.Num(), EAllowShrinking::No);
+	for (int32 SlotIndex = 0; SlotIndex < Fields.Num(); ++SlotIndex)
+	{
+		FRealityDistortionFieldCandidate& Candidate = Candidates[SlotIndex];
+		Candidate.Sphere = FSphere(Fields.Centers[SlotIndex], Fields.IsActive(SlotIndex) ? Fields.Radii[SlotIndex] : 0.0f);
+		Candidate.Priority = Fields.Priorities[SlotIndex];
+		Candidate.ScreenSize = -1.0f;
+		if (Candidate.Sphere.W <= 0.0f)
+		{
+			continue;
+		}
+
+		float FamilyScreenSize = bFrustumCulling ? -1.0f : 0.0f;
+		for (const FSceneView* View : ViewFamily.Views)
+		{
+			if (View == nullptr || (bFrustumCulling && !View->ViewFrustum.IntersectSphere(Candidate.Sphere.Center, Candidate.Sphere.W)))
+			{
+				continue;
+			}
+			FamilyScreenSize = FMath::Max(FamilyScreenSize, ComputeBoundsScreenSize(FVector4(Candidate.Sphere.Center, 1.0), Candidate.Sphere.W, *View));
+		}
+
+		FrameScreenSizes[SlotIndex] = FMath::Max(FrameScreenSizes[SlotIndex], FamilyScreenSize);
+		Candidate.ScreenSize = FMath::Max(FrameScreenSizes[SlotIndex],
+			PreviousFrameScreenSizes.IsValidIndex(SlotIndex) ? PreviousFrameScreenSizes[SlotIndex] : -1.0f);
+	}
+
+	const FRealityDistortionFieldSelection PreviousSelection = GRealityDistortionFieldSelection;
+	SelectRealityDistortionFields(Candidates, CVarRealityDistortionMaxFieldsPerView.GetValueOnRenderThread(), PreviousSelection, GRealityDistortionFieldSelection);
+
+	const FRealityDistortionFieldSelection& Selection = GRealityDistortionFieldSelection;
+	SET_DWORD_STAT(STAT_RealityDistortion_FieldsActive, Selection.NumActive);
+	SET_DWORD_STAT(STAT_RealityDistortion_FieldsFrustumCulled, Selection.NumFrustumCulled);
+	SET_DWORD_STAT(STAT_RealityDistortion_FieldsOverBudget, Selection.NumOverBudget);
+	SET_DWORD_STAT(STAT_RealityDistortion_FieldsSelected, Selection.NumSelected);
+
+	if (Selection.NumOverBudget > 0)
+	{
+		static bool bWarnedOverBudget = false;
+		if (!bWarnedOverBudget)
+		{
+			bWarnedOverBudget = true;
+			UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] %d visible fields exceed r.RealityDistortion.MaxFieldsPerView; the lowest ranked %d are not uploaded (see stat RealityDistortion)."),
+				Selection.NumSelected + Selection.NumOverBudget, Selection.NumOverBudget);
+		}
+	}
+}
+
+const FRealityDistortionFieldSelection& GetRealityDistortionFieldSelection_RenderThread()
+{
+	check(IsInRenderingThread() || IsInParallelRenderingThread());
+	return GRealityDistortionFieldSelection;
+}
@@ -0,0 +1,86 @@
+﻿// RealityDistortionFieldSelection.h
+//
+// 每帧的力场选择
+// ----------------
+// 注册表最多有 4096 个槽位，但 FieldBuffer 与相关力场掩码只有 MAX_DISTORTION_FIELDS 个位置。
+// 以前直接上传前 MAX_DISTORTION_FIELDS 个注册表槽位，屏幕外的力场会挤掉可见力场。现在每个 ViewFamily：
+// 1) 用每个 View 的视锥剔除力场包围球（任一 View 可见即保留）；
+// 2) 把各 View 的投影屏幕尺寸并入本帧的并集，再与上一帧的并集取最大；
+// 3) 按设计师设置的优先级、再按并集屏幕尺寸排序；
+// 4) 前 r.RealityDistortion.MaxFieldsPerView 个力场分配 Buffer 位置，其余不上传。
+//
+// 说明：
+// - 上一次已选中的力场保留原位置，新选中的优先使用与注册表槽位相同的位置。位置稳定，
+//   别的力场进出预算时，缓存接收体的掩码不会整体错位。
+// - 同一帧的多个 ViewFamily（多窗口、SceneCapture）共用一份选择：排序看的是所有 ViewFamily 的并集，
+//   先渲染的 ViewFamily 通过上一帧的并集看到后渲染的 ViewFamily，选择不会在 ViewFamily 之间来回切换。
+//   离开所有视锥的力场因此会多保留一帧。
+// - FieldBuffer 打包与力场空间索引（AddMeshBatch、簇剔除）只看选择结果，下标都是 Buffer 位置；
+//   休眠判定看全部启用的力场（见 RealityDistortionFieldCulling.h），不受选择影响。
+// - `stat RealityDistortion` 的 Fields Over Budget 大于 0 表示有可见力场因预算没有上传（力场饥饿）。
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RealityDistortionField.h"
+
+class FSceneViewFamily;
+
+// 选择的输入，下标即注册表槽位。
+struct FRealityDistortionFieldCandidate
+{
+	// 半径 <= 0 表示该槽位未启用。
+	FSphere Sphere = FSphere(ForceInit);
+	int32 Priority = 0;
+	// 各 View 中最大的投影屏幕尺寸（ComputeBoundsScreenSize）；< 0 表示在所有 View 的视锥外。
+	// RT 上是本帧与上一帧所有 ViewFamily 的并集。
+	float ScreenSize = 0.0f;
+};
+
+struct FRealityDistortionFieldSelection
+{
+	// Buffer 位置 -> 注册表槽位，INDEX_NONE 表示该位置空闲。
+	TStaticArray<int32, MAX_DISTORTION_FIELDS> BufferToSlot;
+	// 最后一个占用位置 + 1（需要上传的记录数）。
+	int32 NumBufferSlots = 0;
+
+	int32 NumActive = 0;
+	int32 NumFrustumCulled = 0;
+	int32 NumOverBudget = 0;
+	int32 NumSelected = 0;
+
+	FRealityDistortionFieldSelection()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		for (int32& Slot : BufferToSlot)
+		{
+			Slot = INDEX_NONE;
+		}
+		NumBufferSlots = 0;
+		NumActive = 0;
+		NumFrustumCulled = 0;
+		NumOverBudget = 0;
+		NumSelected = 0;
+	}
+};
+
+// 纯 CPU 的选择步骤：剔除、排序、取前 Budget 个，并在 PreviousSelection 的基础上分配稳定的 Buffer 位置。
+REALITYDISTORTION_API void SelectRealityDistortionFields(
+	TConstArrayView<FRealityDistortionFieldCandidate> Candidates,
+	int32 Budget,
+	const FRealityDistortionFieldSelection& PreviousSelection,
+	FRealityDistortionFieldSelection& OutSelection);
+
+// ============================================================================
+// RenderThread API
+// ============================================================================
+// 由 FRealityDistortionViewExtension 每个 ViewFamily 调用一次：在消费力场增量之后、重建力场空间索引之前。
+// 按 ViewFamily.FrameNumber 区分帧，同一帧内并入各 ViewFamily 的屏幕尺寸后重新选择。
+REALITYDISTORTION_API void UpdateRealityDistortionFieldSelection_RenderThread(const FSceneViewFamily& ViewFamily);
+
+// 当前的选择结果（只读，可在并行 MeshPass 任务中访问）。
+REALITYDISTORTION_API const FRealityDistortionFieldSelection& GetRealityDistortionFieldSelection_RenderThread();
@@ -0,0 +1,154 @@
+﻿// RealityDistortionFieldShapes.cpp
+
+#include "Rendering/RealityDistortionFieldShapes.h"
+
+namespace
+{
+	float SmoothFalloff(float T)
+	{
+		return T * T * (3.0f - 2.0f * T);
+	}
+
+	// 局部坐标下的有符号距离，公式与 HLSL 逐行对应。
+	float ComputeLocalSignedDistance(uint8 Type, const FVector3f& Extent, const FVector3f& P)
+	{
+		switch (Type)
+		{
+		case REALITY_DISTORTION_FIELD_SHAPE_BOX:
+		{
+			const FVector3f Q = P.GetAbs() - Extent;
+			return FVector3f::Max(Q, FVector3f::ZeroVector).Length() + FMath::Min(Q.GetMax(), 0.0f);
+		}
+		case REALITY_DISTORTION_FIELD_SHAPE_CAPSULE:
+			return FVector3f(P.X, P.Y, P.Z - FMath::Clamp(P.Z, -Extent.Z, Extent.Z)).Length() - Extent.X;
+		case REALITY_DISTORTION_FIELD_SHAPE_CYLINDER:
+		{
+			const FVector2f D(FVector2f(P.X, P.Y).Length() - Extent.X, FMath::Abs(P.Z) - Extent.Z);
+			return FVector2f::Max(D, FVector2f::ZeroVector).Length() + FMath::Min(FMath::Max(D.X, D.Y), 0.0f);
+		}
+		default:
+			return P.Length() - Extent.X;
+		}
+	}
+}
+
+float ComputeRealityDistortionFieldShapeBoundingRadius(uint8 Type, const FVector3f& Extent)
+{
+	switch (Type)
+	{
+	case REALITY_DISTORTION_FIELD_SHAPE_BOX:
+		return Extent.Length();
+	case REALITY_DISTORTION_FIELD_SHAPE_CAPSULE:
+		return Extent.X + Extent.Z;
+	case REALITY_DISTORTION_FIELD_SHAPE_CYLINDER:
+		return FMath::Sqrt(FMath::Square(Extent.X) + FMath::Square(Extent.Z));
+	default:
+		return Extent.X;
+	}
+}
+
+float ComputeRealityDistortionFieldShapeFalloffDistance(uint8 Type, const FVector3f& Extent)
+{
+	switch (Type)
+	{
+	case REALITY_DISTORTION_FIELD_SHAPE_BOX:
+		return Extent.GetMin();
+	case REALITY_DISTORTION_FIELD_SHAPE_CYLINDER:
+		return FMath::Min(Extent.X, Extent.Z);
+	default:
+		// 球与胶囊：到中心 / 中轴线段的深度最大为半径。
+		return Extent.X;
+	}
+}
+
+FBox ComputeRealityDistortionFieldShapeBounds(const FRealityDistortionFieldShape& Shape)
+{
+	FVector HalfSize;
+	switch (Shape.Type)
+	{
+	case REALITY_DISTORTION_FIELD_SHAPE_BOX:
+	{
+		const FVector AxisX = Shape.Rotation.GetAxisX() * Shape.Extent.X;
+		const FVector AxisY = Shape.Rotation.GetAxisY() * Shape.Extent.Y;
+		const FVector AxisZ = Shape.Rotation.GetAxisZ() * Shape.Extent.Z;
+		HalfSize = AxisX.GetAbs() + AxisY.GetAbs() + AxisZ.GetAbs();
+		break;
+	}
+	case REALITY_DISTORTION_FIELD_SHAPE_CAPSULE:
+		HalfSize = (Shape.Rotation.GetAxisZ() * Shape.Extent.Z).GetAbs() + FVector(Shape.Extent.X);
+		break;
+	case REALITY_DISTORTION_FIELD_SHAPE_CYLINDER:
+	{
+		// 端面圆盘在世界轴 k 上的半跨度为 R * sqrt(1 - Axis_k^2)。
+		const FVector Axis = Shape.Rotation.GetAxisZ();
+		HalfSize = FVector(
+			FMath::Abs(Axis.X) * Shape.Extent.Z + Shape.Extent.X * FMath::Sqrt(FMath::Max(0.0, 1.0 - FMath::Square(Axis.X))),
+			FMath::Abs(Axis.Y) * Shape.Extent.Z + Shape.Extent.X * FMath::Sqrt(FMath::Max(0.0, 1.0 - FMath::Square(Axis.Y))),
+			FMath::Abs(Axis.Z) * Shape.Extent.Z + Shape.Extent.X * FMath::Sqrt(FMath::Max(0.0, 1.0 - FMath::Square(Axis.Z))));
+		break;
+	}
+	default:
+		HalfSize = FVector(Shape.Extent.X);
+		break;
+	}
+
+	return FBox(Shape.Center - HalfSize, Shape.Center + HalfSize);
+}
+
+float ComputeRealityDistortionFieldSignedDistance(const FRealityDistortionFieldShape& Shape, const FVector& Position)
+{
+	const FVector Offset = Position - Shape.Center;
+	if (Shape.Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE)
+	{
+		return static_cast<float>(Offset.Length()) - Shape.Extent.X;
+	}
+
+	return ComputeLocalSignedDistance(Shape.Type, Shape.Extent, FVector3f(Shape.Rotation.UnrotateVector(Offset)));
+}
+
+float CalculateRealityDistortionShapedFieldInfluence(const FRealityDistortionFieldShape& Shape, const FVector& Position)
+{
+	// 球形走原来的 RD_CalculateFieldInfluence，其余形状按 SDF / 衰减距离（与 HLSL 分支一致）。
+	if (Shape.Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE)
+	{
+		if (Shape.Extent.X <= 0.001f)
+		{
+			return 0.0f;
+		}
+		return SmoothFalloff(FMath::Clamp(1.0f - static_cast<float>(FVector::Dist(Position, Shape.Center)) / Shape.Extent.X, 0.0f, 1.0f));
+	}
+
+	const float FalloffDistance = ComputeRealityDistortionFieldShapeFalloffDistance(Shape.Type, Shape.Extent);
+	if (ComputeRealityDistortionFieldShapeBoundingRadius(Shape.Type, Shape.Extent) <= 0.001f || FalloffDistance <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return SmoothFalloff(FMath::Clamp(-ComputeRealityDistortionFieldSignedDistance(Shape, Position) / FalloffDistance, 0.0f, 1.0f));
+}
+
+float ComputeRealityDistortionFieldClipDistance(const FRealityDistortionFieldShape& Shape, const FVector& Position)
+{
+	// SDF 平移一个常数：smoothstep(T) = 阈值 处 T = REALITY_DISTORTION_INFLUENCE_CLIP_FALLOFF_FRACTION。
+	const float FalloffDistance = ComputeRealityDistortionFieldShapeFalloffDistance(Shape.Type, Shape.Extent);
+	if (ComputeRealityDistortionFieldShapeBoundingRadius(Shape.Type, Shape.Extent) <= 0.001f || FalloffDistance <= 0.0f)
+	{
+		return MAX_flt;
+	}
+
+	return ComputeRealityDistortionFieldSignedDistance(Shape, Position) + REALITY_DISTORTION_INFLUENCE_CLIP_FALLOFF_FRACTION * FalloffDistance;
+}
+
+FRealityDistortionFieldShape GetRealityDistortionFieldShape(const FRealityDistortionFieldsView& Fields, int32 SlotIndex)
+{
+	FRealityDistortionFieldShape Shape;
+	Shape.Center = Fields.Centers[SlotIndex];
+	Shape.Rotation = Fields.Rotations[SlotIndex];
+	Shape.Extent = Fields.Extents[SlotIndex];
+	Shape.Type = Fields.Shapes[SlotIndex];
+	if (Shape.Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE)
+	{
+		Shape.Extent = FVector3f(Fields.Radii[SlotIndex]);
+	}
+	return Shape;
+}
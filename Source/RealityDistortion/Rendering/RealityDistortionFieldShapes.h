@@ -0,0 +1,72 @@
+﻿// RealityDistortionFieldShapes.h
+//
+// 力场形状
+// --------
+// 球 / 盒 / 胶囊 / 圆柱四种形状，统一用“中心 + 有向旋转 + Extent”描述（胶囊与圆柱的轴为局部 Z）：
+// - Sphere：Extent.X = 半径
+// - Box：Extent = 半边长
+// - Capsule：Extent.X = 半径，Extent.Z = 两端半球球心之间线段的半长
+// - Cylinder：Extent.X = 半径，Extent.Z = 半高
+//
+// 说明：
+// - 影响度由精确的欧氏有符号距离（内部为负）推出：T = saturate(-SDF / 衰减距离)，再做 smoothstep。
+//   衰减距离取形状内切半径，中轴 / 中面处为 1，表面为 0；球形与原来的 1 - d / R 完全一致。
+// - SDF 是精确距离，“球 (C, r) 与形状相交”当且仅当 SDF(C) <= r。力场网格在包围球测试之后用它做紧致测试，
+//   细长的走廊盒、胶囊不会再因为包围球过大命中大量接收体。
+// - 本文件与 RealityDistortionCommon.ush 的 RD_CalculateFieldSignedDistance / RD_CalculateShapedFieldInfluence 一一对应，
+//   改动任何一侧都要同步，并跑 RealityDistortion.FieldShapes 自动化测试（参考点 + 独立参考实现）。
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RealityDistortionField.h"
+
+struct FRealityDistortionFieldShape
+{
+	FVector Center = FVector::ZeroVector;
+	// 局部 → 世界旋转。
+	FQuat Rotation = FQuat::Identity;
+	FVector3f Extent = FVector3f::ZeroVector;
+	uint8 Type = REALITY_DISTORTION_FIELD_SHAPE_SPHERE;
+
+	bool operator==(const FRealityDistortionFieldShape& Other) const
+	{
+		return Center == Other.Center
+			&& Rotation == Other.Rotation
+			&& Extent == Other.Extent
+			&& Type == Other.Type;
+	}
+
+	bool operator!=(const FRealityDistortionFieldShape& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+// 以 Center 为球心的包围球半径。
+REALITYDISTORTION_API float ComputeRealityDistortionFieldShapeBoundingRadius(uint8 Type, const FVector3f& Extent);
+
+// 影响度从 1 衰减到 0 的距离（形状内切半径）；<= 0 表示退化形状，影响度恒为 0。
+REALITYDISTORTION_API float ComputeRealityDistortionFieldShapeFalloffDistance(uint8 Type, const FVector3f& Extent);
+
+// 世界空间 AABB（旋转后的紧致包围盒，比包围球更小）。
+REALITYDISTORTION_API FBox ComputeRealityDistortionFieldShapeBounds(const FRealityDistortionFieldShape& Shape);
+
+// 精确欧氏有符号距离，内部为负（与 HLSL RD_CalculateFieldSignedDistance 一致）。
+REALITYDISTORTION_API float ComputeRealityDistortionFieldSignedDistance(const FRealityDistortionFieldShape& Shape, const FVector& Position);
+
+// 影响度 [0, 1]（与 HLSL RD_CalculateShapedFieldInfluence 一致）。
+REALITYDISTORTION_API float CalculateRealityDistortionShapedFieldInfluence(const FRealityDistortionFieldShape& Shape, const FVector& Position);
+
+// 到 clip 等值面（影响度 = REALITY_DISTORTION_INFLUENCE_CLIP_THRESHOLD）的有符号距离，影响度超过阈值处为负；
+// 没有影响度的形状返回 MAX_flt（与 HLSL RD_CalculateFieldClipDistance 一致）。
+REALITYDISTORTION_API float ComputeRealityDistortionFieldClipDistance(const FRealityDistortionFieldShape& Shape, const FVector& Position);
+
+// 球 (Center, Radius) 是否与形状相交；精确测试，没有包围球带来的误判。
+inline bool RealityDistortionFieldShapeIntersectsSphere(const FRealityDistortionFieldShape& Shape, const FVector& Center, float Radius)
+{
+	return ComputeRealityDistortionFieldSignedDistance(Shape, Center) <= Radius;
+}
+
+// 从 RT 注册表读出槽位的形状；球形的 Extent.X 补为半径。
+REALITYDISTORTION_API FRealityDistortionFieldShape GetRealityDistortionFieldShape(const FRealityDistortionFieldsView& Fields, int32 SlotIndex);
@@ -0,0 +1,398 @@
+﻿// RealityDistortionInfluenceClipmap.cpp
+
+#include "Rendering/RealityDistortionInfluenceClipmap.h"
+
+#include "DataDrivenShaderPlatformInfo.h"
+#include "GlobalShader.h"
+#include "HAL/IConsoleManager.h"
+#include "RealityDistortionField.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "RenderResource.h"
+#include "Rendering/RealityDistortionFieldShapes.h"
+#include "Rendering/RealityDistortionShaders.h"
+#include "Rendering/RealityDistortionStats.h"
+#include "SceneView.h"
+#include "ShaderParameterStruct.h"
+
+DEFINE_STAT(STAT_RealityDistortion_ClipmapVoxelsUpdated);
+
+namespace
+{
+	// 0 = 解析路径：逐像素遍历力场（默认）。
+	// 1 = Clipmap：每帧增量光栅化到相机周围的 3D 纹理，范围内一次采样。
+	static TAutoConsoleVariable<int32> CVarRealityDistortionInfluenceClipmap(
+		TEXT("r.RealityDistortion.InfluenceClipmap"),
+		0,
+		TEXT("How pixels evaluate field influence. 0=Analytic per-field loop (default), 1=Camera-centered 3D influence clipmap with analytic fallback outside it"),
+		ECVF_RenderThreadSafe);
+
+	static TAutoConsoleVariable<int32> CVarRealityDistortionInfluenceClipmapResolution(
+		TEXT("r.RealityDistortion.InfluenceClipmap.Resolution"),
+		96,
+		TEXT("Voxels per axis of the influence clipmap. Clamped to [16, 256]. Changing it rebuilds the clipmap."),
+		ECVF_RenderThreadSafe);
+
+	static TAutoConsoleVariable<float> CVarRealityDistortionInfluenceClipmapVoxelSize(
+		TEXT("r.RealityDistortion.InfluenceClipmap.VoxelSize"),
+		50.0f,
+		TEXT("World size (cm) of one influence clipmap voxel. Changing it rebuilds the clipmap."),
+		ECVF_RenderThreadSafe);
+
+	// 每帧最多的更新 Dispatch 数，超过时合并成一个包围范围。
+	constexpr int32 MaxClipmapUpdateRegions = 16;
+
+	// 常驻 Clipmap 纹理与上一次更新时的状态（仅 RT 访问）。
+	class FRealityDistortionInfluenceClipmapResources : public FRenderResource
+	{
+	public:
+		virtual void ReleaseRHI() override
+		{
+			Reset();
+		}
+
+		void Reset()
+		{
+			Texture.SafeRelease();
+			Region = FRealityDistortionVoxelRegion();
+			VoxelSize = 0.0f;
+			Resolution = 0;
+			PreviousFields.Reset();
+		}
+
+		TRefCountPtr<IPooledRenderTarget> Texture;
+		FRealityDistortionVoxelRegion Region;
+		float VoxelSize = 0.0f;
+		int32 Resolution = 0;
+		TArray<FRealityDistortionPackedField> PreviousFields;
+	};
+
+	TGlobalResource<FRealityDistortionInfluenceClipmapResources> GRealityDistortionInfluenceClipmapResources;
+
+	// 与 HLSL RD_LoadField 一致；禁用槽位返回 false。
+	bool UnpackFieldShape(const FRealityDistortionPackedField& Field, FRealityDistortionFieldShape& OutShape)
+	{
+		if (Field.CenterAndRadius.W <= 0.001f)
+		{
+			return false;
+		}
+
+		OutShape.Center = FVector(FVector3f(Field.CenterAndRadius));
+		OutShape.Rotation = FQuat(Field.Rotation.X, Field.Rotation.Y, Field.Rotation.Z, Field.Rotation.W);
+		OutShape.Type = static_cast<uint8>(Field.Params.Y);
+		OutShape.Extent = OutShape.Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE ? FVector3f(Field.CenterAndRadius.W) : FVector3f(Field.ExtentAndInvFalloff);
+		return true;
+	}
+}
+
+class FRealityDistortionInfluenceClipmapCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FRealityDistortionInfluenceClipmapCS);
+	SHADER_USE_PARAMETER_STRUCT(FRealityDistortionInfluenceClipmapCS, FGlobalShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntVector, RegionMin)
+		SHADER_PARAMETER(FUintVector3, RegionSize)
+		SHADER_PARAMETER(float, VoxelSize)
+		SHADER_PARAMETER(uint32, Resolution)
+		SHADER_PARAMETER(uint32, FieldCount)
+		SHADER_PARAMETER_SRV(StructuredBuffer<float4>, FieldBuffer)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture3D<float2>, RWInfluenceClipmap)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(
+	FRealityDistortionInfluenceClipmapCS,
+	"/Plugin/RealityDistortion/Private/RealityDistortionInfluenceClipmap.usf",
+	"UpdateClipmapCS",
+	SF_Compute);
+
+FRealityDistortionVoxelRegion ComputeRealityDistortionClipmapRegion(const FVector& CameraPosition, float VoxelSize, int32 Resolution)
+{
+	const FVector CameraVoxel = CameraPosition / VoxelSize;
+
+	FRealityDistortionVoxelRegion Region;
+	Region.Min = FIntVector(
+		FMath::FloorToInt32(CameraVoxel.X) - Resolution / 2,
+		FMath::FloorToInt32(CameraVoxel.Y) - Resolution / 2,
+		FMath::FloorToInt32(CameraVoxel.Z) - Resolution / 2);
+	Region.Max = Region.Min + FIntVector(Resolution);
+	return Region;
+}
+
+FRealityDistortionVoxelRegion ComputeRealityDistortionFieldVoxelBounds(const FVector3f& Center, float Radius, float VoxelSize)
+{
+	FRealityDistortionVoxelRegion Bounds;
+	if (Radius <= 0.0f)
+	{
+		return Bounds;
+	}
+
+	// 体素 k 的中心在 (k + 0.5) * VoxelSize，距力场中心小于 Radius 才有影响度；两端各放宽到整数边界。
+	const FVector3f MinVoxel = (Center - FVector3f(Radius)) / VoxelSize - FVector3f(0.5f);
+	const FVector3f MaxVoxel = (Center + FVector3f(Radius)) / VoxelSize - FVector3f(0.5f);
+	Bounds.Min = FIntVector(FMath::FloorToInt32(MinVoxel.X), FMath::FloorToInt32(MinVoxel.Y), FMath::FloorToInt32(MinVoxel.Z));
+	Bounds.Max = FIntVector(FMath::FloorToInt32(MaxVoxel.X), FMath::FloorToInt32(MaxVoxel.Y), FMath::FloorToInt32(MaxVoxel.Z)) + FIntVector(1);
+	return Bounds;
+}
+
+void CollectRealityDistortionDirtyFieldRegions(
+	TConstArrayView<FRealityDistortionPackedField> PreviousFields,
+	TConstArrayView<FRealityDistortionPackedField> CurrentFields,
+	float VoxelSize,
+	TArray<FRealityDistortionVoxelRegion>& OutRegions)
+{
+	OutRegions.Reset();
+
+	// 影响度只取决于几何（中心、包围球、形状、旋转、Extent），强度变化不需要重新光栅化。
+	// clip 距离通道是所有力场的最小值，但存储时夹到 REALITY_DISTORTION_CLIPMAP_MAX_CLIP_DISTANCE_VOXELS 个体素：
+	// 包围球外 clip 距离 >= |P - C| - R，距离超过 R + 上限的体素变化前后都是上限值。
+	// 脏范围取扩大了上限与 sqrt(3) 个体素（浮点余量）的包围球体素范围，对非球形力场是保守的。
+	const float DirtyMargin = (REALITY_DISTORTION_CLIPMAP_MAX_CLIP_DISTANCE_VOXELS + UE_SQRT_3) * VoxelSize;
+	const FRealityDistortionPackedField DisabledField;
+	const int32 NumSlots = FMath::Max(PreviousFields.Num(), CurrentFields.Num());
+	for (int32 SlotIndex = 0; SlotIndex < NumSlots; ++SlotIndex)
+	{
+		const FRealityDistortionPackedField& PreviousField = PreviousFields.IsValidIndex(SlotIndex) ? PreviousFields[SlotIndex] : DisabledField;
+		const FRealityDistortionPackedField& CurrentField = CurrentFields.IsValidIndex(SlotIndex) ? CurrentFields[SlotIndex] : DisabledField;
+		if (PreviousField.HasSameGeometry(CurrentField))
+		{
+			continue;
+		}
+
+		const FVector4f& Previous = PreviousField.CenterAndRadius;
+		const FVector4f& Current = CurrentField.CenterAndRadius;
+
+		if (Previous.W > 0.0f)
+		{
+			OutRegions.Add(ComputeRealityDistortionFieldVoxelBounds(FVector3f(Previous), Previous.W + DirtyMargin, VoxelSize));
+		}
+		if (Current.W > 0.0f)
+		{
+			OutRegions.Add(ComputeRealityDistortionFieldVoxelBounds(FVector3f(Current), Current.W + DirtyMargin, VoxelSize));
+		}
+	}
+}
+
+void ComputeRealityDistortionClipmapUpdateRegions(
+	const FRealityDistortionVoxelRegion& PreviousClipmap,
+	const FRealityDistortionVoxelRegion& NewClipmap,
+	TConstArrayView<FRealityDistortionVoxelRegion> DirtyFieldRegions,
+	int32 MaxRegions,
+	TArray<FRealityDistortionVoxelRegion>& OutRegions)
+{
+	OutRegions.Reset();
+	if (NewClipmap.IsEmpty())
+	{
+		return;
+	}
+
+	// 没有可复用的旧数据：整个 Clipmap 重建，脏范围已被覆盖。
+	if (PreviousClipmap.IsEmpty() || PreviousClipmap.Size() != NewClipmap.Size() || PreviousClipmap.Intersect(NewClipmap).IsEmpty())
+	{
+		OutRegions.Add(NewClipmap);
+		return;
+	}
+
+	// 逐轴切出新露出的切片，Remaining 最终收缩为新旧范围的交集。
+	FRealityDistortionVoxelRegion Remaining = NewClipmap;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		FRealityDistortionVoxelRegion Slab = Remaining;
+		if (NewClipmap.Min[Axis] > PreviousClipmap.Min[Axis])
+		{
+			Slab.Min[Axis] = PreviousClipmap.Max[Axis];
+			Remaining.Max[Axis] = PreviousClipmap.Max[Axis];
+		}
+		else if (NewClipmap.Min[Axis] < PreviousClipmap.Min[Axis])
+		{
+			Slab.Max[Axis] = PreviousClipmap.Min[Axis];
+			Remaining.Min[Axis] = PreviousClipmap.Min[Axis];
+		}
+		else
+		{
+			continue;
+		}
+
+		if (!Slab.IsEmpty())
+		{
+			OutRegions.Add(Slab);
+		}
+	}
+
+	for (const FRealityDistortionVoxelRegion& DirtyRegion : DirtyFieldRegions)
+	{
+		const FRealityDistortionVoxelRegion ClippedRegion = DirtyRegion.Intersect(NewClipmap);
+		if (!ClippedRegion.IsEmpty())
+		{
+			OutRegions.Add(ClippedRegion);
+		}
+	}
+
+	if (OutRegions.Num() > MaxRegions)
+	{
+		FRealityDistortionVoxelRegion MergedRegion = OutRegions[0];
+		for (const FRealityDistortionVoxelRegion& Region : OutRegions)
+		{
+			MergedRegion.Min = FIntVector(FMath::Min(MergedRegion.Min.X, Region.Min.X), FMath::Min(MergedRegion.Min.Y, Region.Min.Y), FMath::Min(MergedRegion.Min.Z, Region.Min.Z));
+			MergedRegion.Max = FIntVector(FMath::Max(MergedRegion.Max.X, Region.Max.X), FMath::Max(MergedRegion.Max.Y, Region.Max.Y), FMath::Max(MergedRegion.Max.Z, Region.Max.Z));
+		}
+		OutRegions.Reset();
+		OutRegions.Add(MergedRegion.Intersect(NewClipmap));
+	}
+}
+
+void VoxelizeRealityDistortionInfluence(
+	TConstArrayView<FRealityDistortionPackedField> Fields,
+	float VoxelSize,
+	const FRealityDistortionVoxelRegion& Region,
+	TArrayView<FVector2f> OutVoxels)
+{
+	check(OutVoxels.Num() >= Region.NumVoxels());
+
+	// 与 UpdateClipmapCS 一致：体素中心、最多 MAX_DISTORTION_FIELDS 个槽位，影响度取最大、clip 距离取最小并夹到 REALITY_DISTORTION_CLIPMAP_MAX_CLIP_DISTANCE_VOXELS 个体素。
+	const int32 NumFields = FMath::Min(Fields.Num(), static_cast<int32>(MAX_DISTORTION_FIELDS));
+	const float MaxClipDistance = REALITY_DISTORTION_CLIPMAP_MAX_CLIP_DISTANCE_VOXELS * VoxelSize;
+	int32 OutputIndex = 0;
+	for (int32 Z = Region.Min.Z; Z < Region.Max.Z; ++Z)
+	{
+		for (int32 Y = Region.Min.Y; Y < Region.Max.Y; ++Y)
+		{
+			for (int32 X = Region.Min.X; X < Region.Max.X; ++X)
+			{
+				const FVector3f VoxelCenter = (FVector3f(X, Y, Z) + 0.5f) * VoxelSize;
+
+				float MaxInfluence = 0.0f;
+				float MinClipDistance = MaxClipDistance;
+				for (int32 FieldIndex = 0; FieldIndex < NumFields; ++FieldIndex)
+				{
+					FRealityDistortionFieldShape Shape;
+					if (UnpackFieldShape(Fields[FieldIndex], Shape))
+					{
+						MaxInfluence = FMath::Max(MaxInfluence, CalculateRealityDistortionShapedFieldInfluence(Shape, FVector(VoxelCenter)));
+						MinClipDistance = FMath::Min(MinClipDistance, ComputeRealityDistortionFieldClipDistance(Shape, FVector(VoxelCenter)));
+					}
+				}
+				OutVoxels[OutputIndex++] = FVector2f(MaxInfluence, MinClipDistance);
+			}
+		}
+	}
+}
+
+FRealityDistortionInfluenceClipmapResult AddRealityDistortionInfluenceClipmapPasses_RenderThread(
+	FRDGBuilder& GraphBuilder,
+	const FSceneViewFamily& ViewFamily,
+	FRHIShaderResourceView* FieldBufferSRV,
+	TConstArrayView<FRealityDistortionPackedField> PackedFields)
+{
+	check(IsInRenderingThread());
+
+	FRealityDistortionInfluenceClipmapResult Result;
+	FRealityDistortionInfluenceClipmapResources& Resources = GRealityDistortionInfluenceClipmapResources;
+
+	if (CVarRealityDistortionInfluenceClipmap.GetValueOnRenderThread() == 0)
+	{
+		// 切回解析路径时归还纹理，重新开启时整体重建。
+		if (Resources.Texture.IsValid())
+		{
+			Resources.Reset();
+		}
+		return Result;
+	}
+
+	// 场景捕获 / 反射等附加 ViewFamily 不移动 Clipmap，本次走解析路径，避免来回重建。
+	if (ViewFamily.Views.Num() != 1 || ViewFamily.GetFeatureLevel() < ERHIFeatureLevel::SM5 || FieldBufferSRV == nullptr)
+	{
+		return Result;
+	}
+
+	const FSceneView& View = *ViewFamily.Views[0];
+	if (View.bIsSceneCapture || View.bIsReflectionCapture || View.bIsPlanarReflection)
+	{
+		return Result;
+	}
+
+	const int32 Resolution = FMath::Clamp(CVarRealityDistortionInfluenceClipmapResolution.GetValueOnRenderThread(), 16, 256);
+	const float VoxelSize = FMath::Max(1.0f, CVarRealityDistortionInfluenceClipmapVoxelSize.GetValueOnRenderThread());
+
+	FRDGTextureRef ClipmapTexture = nullptr;
+	bool bFullUpdate = false;
+	if (!Resources.Texture.IsValid() || Resources.Resolution != Resolution)
+	{
+		// RG16F：R = 影响度（只用于着色），G = clip 距离（决定是否需要精确计算）。
+		const FRDGTextureDesc Desc = FRDGTextureDesc::Create3D(
+			FIntVector(Resolution),
+			PF_G16R16F,
+			FClearValueBinding::Black,
+			TexCreate_ShaderResource | TexCreate_UAV);
+		ClipmapTexture = GraphBuilder.CreateTexture(Desc, TEXT("RealityDistortion.InfluenceClipmap"));
+		// 立即分配：Uniform Buffer 在 Graph 执行前就要引用该纹理。
+		Resources.Texture = GraphBuilder.ConvertToExternalTexture(ClipmapTexture);
+		bFullUpdate = true;
+	}
+	else
+	{
+		ClipmapTexture = GraphBuilder.RegisterExternalTexture(Resources.Texture);
+	}
+	bFullUpdate |= Resources.VoxelSize != VoxelSize;
+
+	const FRealityDistortionVoxelRegion NewRegion = ComputeRealityDistortionClipmapRegion(View.ViewMatrices.GetViewOrigin(), VoxelSize, Resolution);
+
+	TArray<FRealityDistortionVoxelRegion> DirtyFieldRegions;
+	if (!bFullUpdate)
+	{
+		CollectRealityDistortionDirtyFieldRegions(Resources.PreviousFields, PackedFields, VoxelSize, DirtyFieldRegions);
+	}
+
+	TArray<FRealityDistortionVoxelRegion> UpdateRegions;
+	ComputeRealityDistortionClipmapUpdateRegions(
+		bFullUpdate ? FRealityDistortionVoxelRegion() : Resources.Region,
+		NewRegion,
+		DirtyFieldRegions,
+		MaxClipmapUpdateRegions,
+		UpdateRegions);
+
+	TShaderMapRef<FRealityDistortionInfluenceClipmapCS> ComputeShader(GetGlobalShaderMap(ViewFamily.GetFeatureLevel()));
+	FRDGTextureUAVRef ClipmapUAV = GraphBuilder.CreateUAV(ClipmapTexture);
+	for (const FRealityDistortionVoxelRegion& Region : UpdateRegions)
+	{
+		const FIntVector RegionSize = Region.Size();
+
+		FRealityDistortionInfluenceClipmapCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FRealityDistortionInfluenceClipmapCS::FParameters>();
+		PassParameters->RegionMin = Region.Min;
+		PassParameters->RegionSize = FUintVector3(RegionSize.X, RegionSize.Y, RegionSize.Z);
+		PassParameters->VoxelSize = VoxelSize;
+		PassParameters->Resolution = static_cast<uint32>(Resolution);
+		PassParameters->FieldCount = static_cast<uint32>(PackedFields.Num());
+		PassParameters->FieldBuffer = FieldBufferSRV;
+		PassParameters->RWInfluenceClipmap = ClipmapUAV;
+
+		FComputeShaderUtils::AddPass(
+			GraphBuilder,
+			RDG_EVENT_NAME("RealityDistortion.InfluenceClipmap %dx%dx%d", RegionSize.X, RegionSize.Y, RegionSize.Z),
+			ComputeShader,
+			PassParameters,
+			FComputeShaderUtils::GetGroupCount(RegionSize, REALITY_DISTORTION_CLIPMAP_GROUP_SIZE));
+
+		INC_DWORD_STAT_BY(STAT_RealityDistortion_ClipmapVoxelsUpdated, static_cast<uint32>(Region.NumVoxels()));
+	}
+
+	// 与 Tile 掩码相同：MeshPass 通过常驻 Uniform Buffer 读取，更新完成后切换到外部只读状态。
+	GraphBuilder.UseExternalAccessMode(ClipmapTexture, ERHIAccess::SRVMask);
+
+	Resources.Region = NewRegion;
+	Resources.VoxelSize = VoxelSize;
+	Resources.Resolution = Resolution;
+	Resources.PreviousFields = PackedFields;
+
+	Result.WorldMin = FVector3f(NewRegion.Min) * VoxelSize;
+	Result.VoxelSize = VoxelSize;
+	Result.Resolution = static_cast<uint32>(Resolution);
+	Result.Texture = Resources.Texture->GetRHI();
+	return Result;
+}
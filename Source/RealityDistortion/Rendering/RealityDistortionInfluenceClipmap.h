@@ -0,0 +1,105 @@
+﻿// RealityDistortionInfluenceClipmap.h
+//
+// 力场影响度 Clipmap
+// ------------------
+// 可选模式（r.RealityDistortion.InfluenceClipmap）：每帧把力场影响度光栅化到一张以相机为中心的低分辨率 3D 纹理，
+// 接收体的 clip（MainPS 与 BasePass / DepthOnly 共用 RD_CalculateReceiverInfluence）在 Clipmap 范围内先做一次三线性采样。
+//
+// 说明：
+// - 纹理按环形寻址：世界体素 k 存在纹素 k mod Resolution。相机移动时只更新新露出的切片，
+//   力场移动 / 缩放时只更新它新旧两个（扩大后的）包围体素范围，其余体素跨帧保留。
+// - 每个体素存体素中心的最大影响度与到 clip 等值面的最小有符号距离（RD_CalculateFieldClipDistance），
+//   距离夹到 REALITY_DISTORTION_CLIPMAP_MAX_CLIP_DISTANCE_VOXELS 个体素，这样每个力场只影响它包围球附近的体素。
+// - Clipmap 只是保守的提前结束：采样到的距离离等值面超过 REALITY_DISTORTION_CLIPMAP_CLIP_MARGIN 个体素时直接决定 clip，
+//   否则走与解析路径相同的精确计算，挖洞的形状不受体素分辨率影响；影响度通道只用于着色。
+// - VoxelizeRealityDistortionInfluence 是 GPU UpdateClipmapCS 的 CPU 镜像，两边必须同步修改。
+// - 校验见 Tests/RealityDistortionInfluenceClipmapTests.cpp。
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FRDGBuilder;
+class FRHIShaderResourceView;
+class FRHITexture;
+class FSceneViewFamily;
+struct FRealityDistortionPackedField;
+
+// 世界体素坐标的轴对齐范围，Max 不包含。
+struct FRealityDistortionVoxelRegion
+{
+	FIntVector Min = FIntVector::ZeroValue;
+	FIntVector Max = FIntVector::ZeroValue;
+
+	bool IsEmpty() const
+	{
+		return Max.X <= Min.X || Max.Y <= Min.Y || Max.Z <= Min.Z;
+	}
+
+	int64 NumVoxels() const
+	{
+		return IsEmpty() ? 0 : int64(Max.X - Min.X) * int64(Max.Y - Min.Y) * int64(Max.Z - Min.Z);
+	}
+
+	FIntVector Size() const
+	{
+		return IsEmpty() ? FIntVector::ZeroValue : Max - Min;
+	}
+
+	FRealityDistortionVoxelRegion Intersect(const FRealityDistortionVoxelRegion& Other) const
+	{
+		FRealityDistortionVoxelRegion Result;
+		Result.Min = FIntVector(FMath::Max(Min.X, Other.Min.X), FMath::Max(Min.Y, Other.Min.Y), FMath::Max(Min.Z, Other.Min.Z));
+		Result.Max = FIntVector(FMath::Min(Max.X, Other.Max.X), FMath::Min(Max.Y, Other.Max.Y), FMath::Min(Max.Z, Other.Max.Z));
+		return Result;
+	}
+};
+
+// 以相机为中心、按体素对齐的 Clipmap 范围（Resolution^3 个体素）。
+REALITYDISTORTION_API FRealityDistortionVoxelRegion ComputeRealityDistortionClipmapRegion(const FVector& CameraPosition, float VoxelSize, int32 Resolution);
+
+// 体素中心影响度可能大于 0 的体素范围（保守）。Radius <= 0 时为空。
+REALITYDISTORTION_API FRealityDistortionVoxelRegion ComputeRealityDistortionFieldVoxelBounds(const FVector3f& Center, float Radius, float VoxelSize);
+
+// 对比前后两帧的打包力场，为几何变化的槽位输出新旧包围体素范围，
+// 半径扩大 clip 距离上限（REALITY_DISTORTION_CLIPMAP_MAX_CLIP_DISTANCE_VOXELS）加 sqrt(3) 个体素。
+REALITYDISTORTION_API void CollectRealityDistortionDirtyFieldRegions(
+	TConstArrayView<FRealityDistortionPackedField> PreviousFields,
+	TConstArrayView<FRealityDistortionPackedField> CurrentFields,
+	float VoxelSize,
+	TArray<FRealityDistortionVoxelRegion>& OutRegions);
+
+// 本帧需要重新光栅化的体素范围（都落在 NewClipmap 内，互不保证不重叠）：
+// 1) 相机移动后新露出的切片（最多 3 块）；PreviousClipmap 为空或与 NewClipmap 不相交时为整个 Clipmap；
+// 2) DirtyFieldRegions 与 NewClipmap 的交集。
+// 总数超过 MaxRegions 时合并成一个包围范围。
+REALITYDISTORTION_API void ComputeRealityDistortionClipmapUpdateRegions(
+	const FRealityDistortionVoxelRegion& PreviousClipmap,
+	const FRealityDistortionVoxelRegion& NewClipmap,
+	TConstArrayView<FRealityDistortionVoxelRegion> DirtyFieldRegions,
+	int32 MaxRegions,
+	TArray<FRealityDistortionVoxelRegion>& OutRegions);
+
+// CPU 参考实现：计算 Region 内每个体素中心的 (最大影响度, 最小 clip 距离)，按 X 最快、Z 最慢的顺序写入 OutVoxels。
+REALITYDISTORTION_API void VoxelizeRealityDistortionInfluence(
+	TConstArrayView<FRealityDistortionPackedField> Fields,
+	float VoxelSize,
+	const FRealityDistortionVoxelRegion& Region,
+	TArrayView<FVector2f> OutVoxels);
+
+// 写入力场 Uniform Buffer 的 Clipmap 参数。Resolution 为 0 表示本 ViewFamily 走解析路径。
+struct FRealityDistortionInfluenceClipmapResult
+{
+	FVector3f WorldMin = FVector3f::ZeroVector;
+	float VoxelSize = 0.0f;
+	uint32 Resolution = 0;
+	FRHITexture* Texture = nullptr;
+};
+
+// 为 ViewFamily 添加 Clipmap 更新 Pass（在力场 Buffer 上传之后调用）。
+// 关闭、多 View、场景捕获或不支持 SM5 时不更新，返回的 Resolution 为 0。
+FRealityDistortionInfluenceClipmapResult AddRealityDistortionInfluenceClipmapPasses_RenderThread(
+	FRDGBuilder& GraphBuilder,
+	const FSceneViewFamily& ViewFamily,
+	FRHIShaderResourceView* FieldBufferSRV,
+	TConstArrayView<FRealityDistortionPackedField> PackedFields);
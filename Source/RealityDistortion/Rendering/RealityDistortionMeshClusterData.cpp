@@ -0,0 +1,335 @@
+﻿// RealityDistortionMeshClusterData.cpp
+
+#include "Rendering/RealityDistortionMeshClusterData.h"
+
+#include "Async/Async.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Misc/ScopeRWLock.h"
+#include "RealityDistortion.h"
+#include "StaticMeshResources.h"
+#include "UObject/ObjectSaveContext.h"
+
+namespace
+{
+	// 序列化格式版本；不一致时按负载长度跳过，数据视为缺失，之后重新构建。
+	constexpr int32 MeshClusterDataVersion = 2;
+
+	struct FPendingMeshClusterBuild
+	{
+		TArray<TWeakObjectPtr<UPrimitiveComponent>> Requesters;
+	};
+
+	// 瞬态缓存：GT 写入，CreateSceneProxy（可能不在 GT）读取。
+	struct FCachedMeshClusters
+	{
+		TWeakObjectPtr<const UStaticMesh> Mesh;
+		FRealityDistortionMeshClustersPtr Clusters;
+		FString SourceKey;
+	};
+	TMap<TObjectKey<UStaticMesh>, FCachedMeshClusters> GMeshClusterCache;
+	FRWLock GMeshClusterCacheLock;
+
+	// 以下仅在 GT 访问。
+	TMap<TObjectKey<UStaticMesh>, FPendingMeshClusterBuild> GPendingMeshClusterBuilds;
+
+	// 没有 CPU 侧数据、也没有保存簇数据的网格，记住结果避免每次注册都重新尝试。
+	TSet<TObjectKey<UStaticMesh>> GUnavailableMeshClusters;
+
+	FString GetMeshClusterSourceKey(const UStaticMesh& Mesh)
+	{
+#if WITH_EDITORONLY_DATA
+		if (const FStaticMeshRenderData* RenderData = Mesh.GetRenderData())
+		{
+			return RenderData->DerivedDataKey;
+		}
+#endif
+		return FString();
+	}
+
+	bool AreMeshClustersUpToDate(const FRealityDistortionMeshClustersPtr& Clusters, const FString& SourceKey, const UStaticMesh& Mesh)
+	{
+		if (!Clusters.IsValid() || Mesh.GetRenderData() == nullptr)
+		{
+			return false;
+		}
+
+#if WITH_EDITORONLY_DATA
+		if (SourceKey != GetMeshClusterSourceKey(Mesh))
+		{
+			return false;
+		}
+#endif
+		return Clusters->MatchesRenderData(*Mesh.GetRenderData());
+	}
+
+	FCachedMeshClusters FindCachedMeshClusters(const UStaticMesh* Mesh)
+	{
+		FReadScopeLock ReadLock(GMeshClusterCacheLock);
+		const FCachedMeshClusters* Cached = GMeshClusterCache.Find(TObjectKey<UStaticMesh>(Mesh));
+		return Cached ? *Cached : FCachedMeshClusters();
+	}
+
+	void InstallMeshClusters_GameThread(
+		TObjectKey<UStaticMesh> MeshKey,
+		FRealityDistortionMeshClustersPtr MeshClusters,
+		const FString& SourceKey)
+	{
+		check(IsInGameThread());
+
+		FPendingMeshClusterBuild Pending;
+		GPendingMeshClusterBuilds.RemoveAndCopyValue(MeshKey, Pending);
+
+		UStaticMesh* Mesh = MeshKey.ResolveObjectPtr();
+		if (Mesh == nullptr || Mesh->GetRenderData() == nullptr)
+		{
+			return;
+		}
+
+		// 构建期间网格被重新构建：丢弃结果，等待的组件重建渲染状态时会重新发起请求。
+		if (SourceKey == GetMeshClusterSourceKey(*Mesh) && MeshClusters->MatchesRenderData(*Mesh->GetRenderData()))
+		{
+			{
+				// 顺带清掉已被回收的网格，缓存大小跟随当前加载的接收体网格。
+				FWriteScopeLock WriteLock(GMeshClusterCacheLock);
+				for (auto It = GMeshClusterCache.CreateIterator(); It; ++It)
+				{
+					if (!It.Value().Mesh.IsValid())
+					{
+						It.RemoveCurrent();
+					}
+				}
+				GMeshClusterCache.Add(MeshKey, FCachedMeshClusters{ Mesh, MeshClusters, SourceKey });
+			}
+
+			// 显式开启保存的网格只更新内存副本，不标脏：保存 / Cook 时 PreSave 会按当前 RenderData 重建。
+			if (URealityDistortionMeshClusterData* ClusterData = Mesh->GetAssetUserData<URealityDistortionMeshClusterData>())
+			{
+				ClusterData->SetClusters(MoveTemp(MeshClusters), SourceKey);
+			}
+		}
+
+		for (const TWeakObjectPtr<UPrimitiveComponent>& WeakRequester : Pending.Requesters)
+		{
+			if (UPrimitiveComponent* Requester = WeakRequester.Get())
+			{
+				Requester->MarkRenderStateDirty();
+			}
+		}
+	}
+}
+
+void SerializeRealityDistortionMeshClusters(FArchive& Ar, FRealityDistortionMeshClustersPtr& InOutClusters)
+{
+	// 版本在负载之前：先确认格式，再决定解析还是跳过。
+	int32 Version = MeshClusterDataVersion;
+	Ar << Version;
+
+	// 负载长度先写占位，写完负载后回填，读取时据此跳过不认识的格式。
+	const int64 PayloadSizeOffset = Ar.Tell();
+	int64 PayloadSize = 0;
+	Ar << PayloadSize;
+	const int64 PayloadStart = Ar.Tell();
+
+	if (Ar.IsLoading())
+	{
+		InOutClusters.Reset();
+		if (Version != MeshClusterDataVersion)
+		{
+			UE_LOG(LogRealityDistortion, Verbose, TEXT("[RealityDistortion] Skipping mesh cluster data version %d (expected %d); clusters will be rebuilt."), Version, MeshClusterDataVersion);
+			Ar.Seek(PayloadStart + PayloadSize);
+			return;
+		}
+
+		bool bHasClusters = false;
+		Ar << bHasClusters;
+		if (bHasClusters)
+		{
+			TSharedRef<FRealityDistortionMeshClusters, ESPMode::ThreadSafe> LoadedClusters = MakeShared<FRealityDistortionMeshClusters, ESPMode::ThreadSafe>();
+			Ar << *LoadedClusters;
+			InOutClusters = LoadedClusters;
+		}
+
+		// 同版本但长度对不上（数据损坏）：丢弃并对齐到负载末尾，不影响后续属性。
+		if (Ar.IsError() || Ar.Tell() != PayloadStart + PayloadSize)
+		{
+			UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] Mesh cluster data size mismatch (%lld bytes read, %lld stored); clusters will be rebuilt."), Ar.Tell() - PayloadStart, PayloadSize);
+			InOutClusters.Reset();
+			Ar.Seek(PayloadStart + PayloadSize);
+		}
+		return;
+	}
+
+	bool bHasClusters = InOutClusters.IsValid();
+	Ar << bHasClusters;
+	if (bHasClusters)
+	{
+		// 保存时数据只读，序列化接口需要非 const 引用。
+		Ar << const_cast<FRealityDistortionMeshClusters&>(*InOutClusters);
+	}
+
+	const int64 PayloadEnd = Ar.Tell();
+	PayloadSize = PayloadEnd - PayloadStart;
+	Ar.Seek(PayloadSizeOffset);
+	Ar << PayloadSize;
+	Ar.Seek(PayloadEnd);
+}
+
+void URealityDistortionMeshClusterData::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// 引用收集、内存统计等不读写数据的归档不需要负载（也不一定支持 Seek）。
+	if (Ar.IsLoading() || Ar.IsSaving())
+	{
+		SerializeRealityDistortionMeshClusters(Ar, Clusters);
+	}
+}
+
+#if WITH_EDITOR
+void URealityDistortionMeshClusterData::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	UStaticMesh* Mesh = Cast<UStaticMesh>(GetOuter());
+	if (Mesh == nullptr || Mesh->GetRenderData() == nullptr || IsUpToDate(*Mesh))
+	{
+		return;
+	}
+
+	// 编辑器中总能拿到 CPU 侧数据；保存时一并计算最长边，运行时打开顶点阶段影响度不需要再构建。
+	FRealityDistortionMeshClusterSource Source;
+	if (!GatherRealityDistortionMeshClusterSource(*Mesh->GetRenderData(), true, Source))
+	{
+		return;
+	}
+
+	TSharedRef<FRealityDistortionMeshClusters, ESPMode::ThreadSafe> BuiltClusters = MakeShared<FRealityDistortionMeshClusters, ESPMode::ThreadSafe>();
+	BuildRealityDistortionMeshClusters(Source, *BuiltClusters);
+	SetClusters(BuiltClusters, GetMeshClusterSourceKey(*Mesh));
+}
+#endif
+
+void URealityDistortionMeshClusterData::SetClusters(FRealityDistortionMeshClustersPtr InClusters, const FString& InSourceKey)
+{
+	Clusters = MoveTemp(InClusters);
+#if WITH_EDITORONLY_DATA
+	SourceKey = InSourceKey;
+#endif
+}
+
+bool URealityDistortionMeshClusterData::IsUpToDate(const UStaticMesh& Mesh) const
+{
+#if WITH_EDITORONLY_DATA
+	return AreMeshClustersUpToDate(Clusters, SourceKey, Mesh);
+#else
+	return AreMeshClustersUpToDate(Clusters, FString(), Mesh);
+#endif
+}
+
+FRealityDistortionMeshClustersPtr FindRealityDistortionMeshClusters(const UStaticMesh* Mesh)
+{
+	if (Mesh == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (FRealityDistortionMeshClustersPtr CachedClusters = FindCachedMeshClusters(Mesh).Clusters)
+	{
+		return CachedClusters;
+	}
+
+	const TArray<UAssetUserData*>* AssetUserData = Mesh->GetAssetUserDataArray();
+	if (AssetUserData == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (const UAssetUserData* UserData : *AssetUserData)
+	{
+		if (const URealityDistortionMeshClusterData* ClusterData = Cast<URealityDistortionMeshClusterData>(UserData))
+		{
+			return ClusterData->GetClusters();
+		}
+	}
+	return nullptr;
+}
+
+void RequestRealityDistortionMeshClusters(
+	UStaticMesh* Mesh,
+	UPrimitiveComponent* Requester,
+	bool bNeedMaxTriangleEdgeLength)
+{
+	if (!IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::GameThread,
+			[WeakMesh = TWeakObjectPtr<UStaticMesh>(Mesh), WeakRequester = TWeakObjectPtr<UPrimitiveComponent>(Requester), bNeedMaxTriangleEdgeLength]()
+			{
+				if (UStaticMesh* RequestedMesh = WeakMesh.Get())
+				{
+					RequestRealityDistortionMeshClusters(RequestedMesh, WeakRequester.Get(), bNeedMaxTriangleEdgeLength);
+				}
+			});
+		return;
+	}
+
+	if (Mesh == nullptr || Mesh->GetRenderData() == nullptr || !Mesh->GetRenderData()->IsInitialized())
+	{
+		return;
+	}
+
+	auto IsUsable = [Mesh, bNeedMaxTriangleEdgeLength](const FRealityDistortionMeshClustersPtr& Clusters, const FString& SourceKey)
+	{
+		return AreMeshClustersUpToDate(Clusters, SourceKey, *Mesh)
+			&& (!bNeedMaxTriangleEdgeLength || Clusters->LocalMaxTriangleEdgeLength >= 0.0f);
+	};
+
+	const FCachedMeshClusters Cached = FindCachedMeshClusters(Mesh);
+	if (IsUsable(Cached.Clusters, Cached.SourceKey))
+	{
+		return;
+	}
+
+	const URealityDistortionMeshClusterData* ClusterData = Mesh->GetAssetUserData<URealityDistortionMeshClusterData>();
+	if (ClusterData != nullptr && ClusterData->IsUpToDate(*Mesh)
+		&& (!bNeedMaxTriangleEdgeLength || ClusterData->GetClusters()->LocalMaxTriangleEdgeLength >= 0.0f))
+	{
+		return;
+	}
+
+	const TObjectKey<UStaticMesh> MeshKey(Mesh);
+	if (FPendingMeshClusterBuild* Pending = GPendingMeshClusterBuilds.Find(MeshKey))
+	{
+		Pending->Requesters.AddUnique(TWeakObjectPtr<UPrimitiveComponent>(Requester));
+		return;
+	}
+
+	if (GUnavailableMeshClusters.Contains(MeshKey))
+	{
+		return;
+	}
+
+	// GT 上只做拷贝（先按 Section 门槛筛掉不需要的 LOD），切簇与求最长边放到后台任务。
+	FRealityDistortionMeshClusterSource Source;
+	if (!GatherRealityDistortionMeshClusterSource(*Mesh->GetRenderData(), bNeedMaxTriangleEdgeLength, Source))
+	{
+		GUnavailableMeshClusters.Add(MeshKey);
+		UE_LOG(LogRealityDistortion, Verbose, TEXT("[RealityDistortion] %s has no saved clusters and no CPU-side mesh data; receivers submit whole sections."), *Mesh->GetPathName());
+		return;
+	}
+
+	FPendingMeshClusterBuild& Pending = GPendingMeshClusterBuilds.Add(MeshKey);
+	Pending.Requesters.Add(Requester);
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask,
+		[MeshKey, Source = MoveTemp(Source), SourceKey = GetMeshClusterSourceKey(*Mesh)]()
+		{
+			TSharedRef<FRealityDistortionMeshClusters, ESPMode::ThreadSafe> BuiltClusters = MakeShared<FRealityDistortionMeshClusters, ESPMode::ThreadSafe>();
+			BuildRealityDistortionMeshClusters(Source, *BuiltClusters);
+
+			AsyncTask(ENamedThreads::GameThread, [MeshKey, BuiltClusters, SourceKey]()
+			{
+				InstallMeshClusters_GameThread(MeshKey, BuiltClusters, SourceKey);
+			});
+		});
+}
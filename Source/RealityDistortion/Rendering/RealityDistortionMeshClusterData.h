@@ -0,0 +1,77 @@
+﻿// RealityDistortionMeshClusterData.h
+//
+// URealityDistortionMeshClusterData（网格簇数据）
+// ----------------------------------------------
+// 职责：
+// 1) 接收体三角形簇与最长三角形边（见 RealityDistortionClusterCulling.h）默认只放在按网格索引的瞬态缓存里：
+//    缺失或过期时由接收体组件创建 Proxy 时发起一次异步构建，完成后写入缓存并让等待的组件重建渲染状态。
+//    网格资源本身不被修改、不被标脏，引擎 / 插件里的共享网格不会被存进本模块的类。
+// 2) 需要随资源保存时（Cook 后网格没有 CPU 侧数据，运行时无法构建）由用户显式开启：
+//    在静态网格编辑器的 Asset User Data 里添加 URealityDistortionMeshClusterData，
+//    编辑器保存 / Cook 时按当前 RenderData 重新构建并写入资源，Cook 后的网格不需要 Allow CPUAccess。
+//
+// 注意：
+// - 数据只构建一次，所有使用该网格的 Proxy 共享同一份只读副本；Proxy 的创建（含休眠切换）不再拷贝缓冲区。
+// - 序列化先写版本与负载长度：版本不一致时按长度跳过负载，数据视为缺失，之后重新构建。
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/AssetUserData.h"
+#include "Rendering/RealityDistortionClusterCulling.h"
+#include "RealityDistortionMeshClusterData.generated.h"
+
+class UPrimitiveComponent;
+class UStaticMesh;
+
+using FRealityDistortionMeshClustersPtr = TSharedPtr<const FRealityDistortionMeshClusters, ESPMode::ThreadSafe>;
+
+// 簇数据负载的序列化：版本、负载长度、负载。读取时版本不一致（旧格式 / 更新的格式）或长度对不上时
+// 跳过整个负载并返回空；InOutClusters 为空时只写一个“无数据”的标记。
+REALITYDISTORTION_API void SerializeRealityDistortionMeshClusters(FArchive& Ar, FRealityDistortionMeshClustersPtr& InOutClusters);
+
+// 显式开启“簇数据随网格保存”：在静态网格编辑器的 Asset User Data 里添加。
+UCLASS(EditInlineNew, meta = (DisplayName = "Reality Distortion Mesh Clusters"))
+class REALITYDISTORTION_API URealityDistortionMeshClusterData : public UAssetUserData
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Serialize(FArchive& Ar) override;
+
+#if WITH_EDITOR
+	// 保存 / Cook 前确认簇数据与网格当前的 RenderData 一致，不一致时同步重建。
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
+
+	const FRealityDistortionMeshClustersPtr& GetClusters() const
+	{
+		return Clusters;
+	}
+
+	void SetClusters(FRealityDistortionMeshClustersPtr InClusters, const FString& InSourceKey);
+
+	// 簇数据是否对应网格当前的 RenderData（编辑器比较 DDC Key，Cook 后只校验 Section）。
+	bool IsUpToDate(const UStaticMesh& Mesh) const;
+
+private:
+	FRealityDistortionMeshClustersPtr Clusters;
+
+#if WITH_EDITORONLY_DATA
+	// 构建时 RenderData 的 DerivedDataKey，网格重新构建后不再相等。
+	UPROPERTY()
+	FString SourceKey;
+#endif
+};
+
+// 返回网格可用的簇数据（瞬态缓存优先，其次是随网格保存的数据；都没有时为空）。只读，可在 CreateSceneProxy 中调用。
+REALITYDISTORTION_API FRealityDistortionMeshClustersPtr FindRealityDistortionMeshClusters(const UStaticMesh* Mesh);
+
+// 网格缺少簇数据、数据过期、或缺少需要的最长边时发起一次异步构建（同一网格同时只有一个），
+// 完成后写入瞬态缓存（网格显式带有 URealityDistortionMeshClusterData 时同时更新它的内存副本，不标脏），
+// 并让 Requester 重建渲染状态。网格没有 CPU 侧数据且没有保存的簇数据时什么也不做。
+// 可在 CreateSceneProxy（可能不在 GT）中调用：判定与构建请求都转到 GT 执行。
+REALITYDISTORTION_API void RequestRealityDistortionMeshClusters(
+	UStaticMesh* Mesh,
+	UPrimitiveComponent* Requester,
+	bool bNeedMaxTriangleEdgeLength);
@@ -8,7 +8,11 @@
 #include "HAL/IConsoleManager.h"
 #include "RealityDistortion.h"
 #include "RealityDistortionField.h"
+#include "RenderingThread.h"
+#include "SceneTexturesConfig.h"
+#include "Rendering/DistortionInstancedSceneProxy.h"
 #include "Rendering/DistortionSceneProxy.h"
+#include "Rendering/RealityDistortionFieldCulling.h"
 #include "Rendering/RealityDistortionShaders.h"
 
 namespace
@@ -33,6 +37,301 @@ namespace
 			return PT_TriangleList;
 		}
 	}
+
+	// 动态路径上簇剔除每个 Section 最多提交的区间数（每个区间一个 FMeshBatchElement）。
+	constexpr int32 MaxDynamicClusterRanges = 16;
+
+	// 缓存键：源材质 ShaderMap 的 ID（含 QualityLevel / 静态参数）+ FeatureLevel + VertexFactory 类型。
+	// 不含任何 RenderProxy / FMaterial 指针：同一份 ShaderMap 的所有材质实例共用一个条目，
+	// RenderProxy 释放后也不会留下指向它的键。
+	struct FShaderResolutionKeyRef
+	{
+		const FMaterialShaderMapId& ShaderMapId;
+		const FVertexFactoryType* VertexFactoryType;
+		ERHIFeatureLevel::Type FeatureLevel;
+
+		uint32 GetHash() const
+		{
+			return HashCombineFast(HashCombineFast(GetTypeHash(ShaderMapId), GetTypeHash(VertexFactoryType)), GetTypeHash(FeatureLevel));
+		}
+	};
+
+	struct FShaderResolutionKey
+	{
+		FMaterialShaderMapId ShaderMapId;
+		const FVertexFactoryType* VertexFactoryType = nullptr;
+		ERHIFeatureLevel::Type FeatureLevel = ERHIFeatureLevel::Num;
+
+		explicit FShaderResolutionKey(const FShaderResolutionKeyRef& KeyRef)
+			: ShaderMapId(KeyRef.ShaderMapId)
+			, VertexFactoryType(KeyRef.VertexFactoryType)
+			, FeatureLevel(KeyRef.FeatureLevel)
+		{
+		}
+
+		bool operator==(const FShaderResolutionKey& Other) const
+		{
+			return VertexFactoryType == Other.VertexFactoryType && FeatureLevel == Other.FeatureLevel && ShaderMapId == Other.ShaderMapId;
+		}
+
+		// 查找时与不拷贝 ShaderMapId 的 FShaderResolutionKeyRef 比较（TMap::FindByHash）。
+		bool operator==(const FShaderResolutionKeyRef& Other) const
+		{
+			return VertexFactoryType == Other.VertexFactoryType && FeatureLevel == Other.FeatureLevel && ShaderMapId == Other.ShaderMapId;
+		}
+
+		friend uint32 GetTypeHash(const FShaderResolutionKey& Key)
+		{
+			return FShaderResolutionKeyRef{ Key.ShaderMapId, Key.VertexFactoryType, Key.FeatureLevel }.GetHash();
+		}
+	};
+
+	// 解析方式：沿源 RenderProxy 的 Fallback 链走 FallbackDepth 步，或使用默认 Surface 材质。
+	// 命中时只沿调用方传入的（存活的）RenderProxy 重新走一遍，从不解引用缓存里的 RenderProxy / FMaterial。
+	enum class EShaderResolutionSource : uint8
+	{
+		// 该材质不在本 Pass 绘制（半透明 / Volume / 无可用 Shader）。
+		None,
+		FallbackChain,
+		DefaultMaterial,
+	};
+
+	struct FShaderResolutionCacheEntry
+	{
+		EShaderResolutionSource Source = EShaderResolutionSource::None;
+		int32 FallbackDepth = 0;
+
+		// 持有引用：条目存在期间 Shaders 指向的 ShaderMap 不会被释放，也不会出现同地址复用。
+		// 命中时与调用方材质当前的 ShaderMap 比较（只比较指针），重新编译后不一致即重新解析并替换条目。
+		TRefCountPtr<FMaterialShaderMap> SourceShaderMap;
+		TRefCountPtr<FMaterialShaderMap> ResolvedShaderMap;
+		FRealityDistortionPassShaders Shaders;
+
+		// 除缓存自身外没有其他持有者：材质已销毁或已重新编译，条目不会再命中。
+		bool IsOrphaned() const
+		{
+			const uint32 NumCacheReferences = SourceShaderMap == ResolvedShaderMap ? 2 : 1;
+			return SourceShaderMap->GetRefCount() <= NumCacheReferences;
+		}
+	};
+
+	FRWLock GShaderResolutionCacheLock;
+	TMap<FShaderResolutionKey, FShaderResolutionCacheEntry> GShaderResolutionCache;
+
+	static bool TryGetRealityDistortionShaders(
+		const FMaterial& Material,
+		const FVertexFactoryType* VertexFactoryType,
+		FRealityDistortionPassShaders& OutShaders)
+	{
+		// RealityDistortion Pass 必须始终使用自定义 PS（输出青色），不能跳过。
+		// 每个 PS 变体与对应的 VS 变体单独查询；变体在同一个 ShaderMap 里编译，要么全部可用，要么都不可用。
+		for (int32 PermutationId = 0; PermutationId < FRealityDistortionPS::FPermutationDomain::PermutationCount; ++PermutationId)
+		{
+			const int32 VertexPermutationId = FRealityDistortionPassShaders::GetVertexShaderPermutationId(PermutationId);
+
+			FMaterialShaderTypes ShaderTypes;
+			ShaderTypes.AddShaderType<FRealityDistortionVS>(VertexPermutationId);
+			ShaderTypes.AddShaderType<FRealityDistortionPS>(PermutationId);
+
+			FMaterialShaders Shaders;
+			if (!Material.TryGetShaders(ShaderTypes, VertexFactoryType, Shaders))
+			{
+				return false;
+			}
+
+			Shaders.TryGetVertexShader(OutShaders.VertexShaders[VertexPermutationId]);
+			Shaders.TryGetPixelShader(OutShaders.PixelShaders[PermutationId]);
+		}
+		return true;
+	}
+
+	static const FMaterialRenderProxy* GetDefaultSurfaceMaterialRenderProxy()
+	{
+		const UMaterial* DefaultMaterial = UMaterial::GetDefaultMaterial(MD_Surface);
+		return DefaultMaterial ? DefaultMaterial->GetRenderProxy() : nullptr;
+	}
+
+	// 未命中缓存时的完整解析：
+	// 1) 沿 Fallback 链找第一个有 ShaderMap 的材质；半透明 / Volume 直接判定为不绘制。
+	// 2) 该材质没有本 Pass 的 Shader 时继续沿链查找。
+	// 3) 整条链都不可用时兜底到默认 Surface 材质，避免 BasePass 已 clip 但 Distortion pass 无法提交导致黑洞。
+	static FShaderResolutionCacheEntry ResolveRealityDistortionShadersUncached(
+		const FMaterialRenderProxy& SourceMaterialRenderProxy,
+		const FVertexFactoryType* VertexFactoryType,
+		ERHIFeatureLevel::Type FeatureLevel,
+		bool bLogFailures)
+	{
+		FShaderResolutionCacheEntry Entry;
+		const FMaterial* SourceMaterial = SourceMaterialRenderProxy.GetMaterialNoFallback(FeatureLevel);
+		Entry.SourceShaderMap = SourceMaterial ? SourceMaterial->GetRenderingThreadShaderMap() : nullptr;
+
+		auto TryResolve = [&Entry, VertexFactoryType](const FMaterial& Material, EShaderResolutionSource Source, int32 FallbackDepth)
+		{
+			if (!TryGetRealityDistortionShaders(Material, VertexFactoryType, Entry.Shaders))
+			{
+				return false;
+			}
+			Entry.Source = Source;
+			Entry.FallbackDepth = FallbackDepth;
+			Entry.ResolvedShaderMap = Material.GetRenderingThreadShaderMap();
+			return true;
+		};
+
+		int32 FallbackDepth = 0;
+		for (const FMaterialRenderProxy* MaterialRenderProxy = &SourceMaterialRenderProxy; MaterialRenderProxy; MaterialRenderProxy = MaterialRenderProxy->GetFallback(FeatureLevel), ++FallbackDepth)
+		{
+			const FMaterial* Material = MaterialRenderProxy->GetMaterialNoFallback(FeatureLevel);
+			if (Material == nullptr || Material->GetRenderingThreadShaderMap() == nullptr)
+			{
+				continue;
+			}
+
+			// 只处理不透明/Masked；半透明与 Volume 材质域不在本 Pass 渲染。
+			if (IsTranslucentBlendMode(Material->GetBlendMode()) || Material->GetMaterialDomain() == MD_Volume)
+			{
+				return Entry;
+			}
+
+			if (TryResolve(*Material, EShaderResolutionSource::FallbackChain, FallbackDepth))
+			{
+				return Entry;
+			}
+		}
+
+		// 某些工程材质不会为自定义 pass 编译对应 shader，兜底到默认 Surface 材质。
+		if (const FMaterialRenderProxy* DefaultProxy = GetDefaultSurfaceMaterialRenderProxy())
+		{
+			const FMaterial* DefaultMat = DefaultProxy->GetMaterialNoFallback(FeatureLevel);
+			if (DefaultMat && DefaultMat->GetRenderingThreadShaderMap())
+			{
+				TryResolve(*DefaultMat, EShaderResolutionSource::DefaultMaterial, 0);
+			}
+		}
+
+		// 只在写入缓存时记录一次，之后同一 (ShaderMap, VF) 不再刷屏。
+		if (!bLogFailures)
+		{
+			return Entry;
+		}
+
+		if (Entry.Source == EShaderResolutionSource::None)
+		{
+			UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] No usable shaders for material: %s, VF: %s%s"),
+				SourceMaterial ? *SourceMaterial->GetFriendlyName() : TEXT("<null>"), VertexFactoryType->GetName(),
+				IsRealityDistortionVertexFactoryAllowed(VertexFactoryType) ? TEXT("") : TEXT(" (not listed in r.RealityDistortion.ShaderVertexFactories)"));
+		}
+		else if (Entry.Source == EShaderResolutionSource::DefaultMaterial)
+		{
+			UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] TryGetShaders FAILED for material: %s, VF: %s. Falling back to the default surface material."),
+				SourceMaterial ? *SourceMaterial->GetFriendlyName() : TEXT("<null>"), VertexFactoryType->GetName());
+		}
+
+		return Entry;
+	}
+
+	// 按条目记录的方式从调用方的 RenderProxy 重新走到绘制材质，并确认其 ShaderMap 仍是解析时的那一份。
+	// 只解引用调用方传入的 RenderProxy 及其当前的 Fallback / 默认材质，缓存里的 ShaderMap 只做指针比较。
+	static bool ApplyShaderResolutionCacheEntry(
+		const FShaderResolutionCacheEntry& Entry,
+		const FMaterialRenderProxy& SourceMaterialRenderProxy,
+		ERHIFeatureLevel::Type FeatureLevel,
+		FRealityDistortionShaderResolution& OutResolution)
+	{
+		OutResolution = FRealityDistortionShaderResolution();
+		if (Entry.Source == EShaderResolutionSource::None)
+		{
+			return true;
+		}
+
+		const FMaterialRenderProxy* MaterialRenderProxy = nullptr;
+		if (Entry.Source == EShaderResolutionSource::DefaultMaterial)
+		{
+			MaterialRenderProxy = GetDefaultSurfaceMaterialRenderProxy();
+		}
+		else
+		{
+			MaterialRenderProxy = &SourceMaterialRenderProxy;
+			for (int32 Depth = 0; Depth < Entry.FallbackDepth && MaterialRenderProxy; ++Depth)
+			{
+				MaterialRenderProxy = MaterialRenderProxy->GetFallback(FeatureLevel);
+			}
+		}
+
+		const FMaterial* Material = MaterialRenderProxy ? MaterialRenderProxy->GetMaterialNoFallback(FeatureLevel) : nullptr;
+		if (Material == nullptr || Material->GetRenderingThreadShaderMap() != Entry.ResolvedShaderMap.GetReference())
+		{
+			return false;
+		}
+
+		OutResolution.MaterialRenderProxy = MaterialRenderProxy;
+		OutResolution.Material = Material;
+		OutResolution.Shaders = Entry.Shaders;
+		OutResolution.bUsedDefaultMaterial = Entry.Source == EShaderResolutionSource::DefaultMaterial;
+		return true;
+	}
+}
+
+bool ResolveRealityDistortionShaders(
+	const FMaterialRenderProxy& MaterialRenderProxy,
+	const FVertexFactoryType* VertexFactoryType,
+	ERHIFeatureLevel::Type FeatureLevel,
+	FRealityDistortionShaderResolution& OutResolution)
+{
+	const FMaterial* SourceMaterial = MaterialRenderProxy.GetMaterialNoFallback(FeatureLevel);
+	FMaterialShaderMap* SourceShaderMap = SourceMaterial ? SourceMaterial->GetRenderingThreadShaderMap() : nullptr;
+	if (SourceShaderMap == nullptr)
+	{
+		// 源材质还没有可用的 ShaderMap（编译中）：没有稳定的 ID 可作为键，直接解析、不缓存。
+		// 编译完成后 ShaderMap 就绪，下一次构建 DrawCommand 时写入缓存。
+		INC_DWORD_STAT(STAT_RealityDistortion_ShaderCacheMisses);
+		const FShaderResolutionCacheEntry Entry = ResolveRealityDistortionShadersUncached(MaterialRenderProxy, VertexFactoryType, FeatureLevel, false);
+		return ApplyShaderResolutionCacheEntry(Entry, MaterialRenderProxy, FeatureLevel, OutResolution) && OutResolution.Material != nullptr;
+	}
+
+	const FShaderResolutionKeyRef KeyRef{ SourceShaderMap->GetShaderMapId(), VertexFactoryType, FeatureLevel };
+	const uint32 KeyHash = KeyRef.GetHash();
+
+	// AddMeshBatch 会在并行的 MeshPass 任务里调用，命中时只取读锁。
+	// 键相同但 ShaderMap 不同（重新编译后新旧 ShaderMap 同 ID）时视为未命中，替换条目。
+	{
+		FReadScopeLock ReadLock(GShaderResolutionCacheLock);
+		if (const FShaderResolutionCacheEntry* Entry = GShaderResolutionCache.FindByHash(KeyHash, KeyRef))
+		{
+			if (Entry->SourceShaderMap.GetReference() == SourceShaderMap
+				&& ApplyShaderResolutionCacheEntry(*Entry, MaterialRenderProxy, FeatureLevel, OutResolution))
+			{
+				return OutResolution.Material != nullptr;
+			}
+		}
+	}
+
+	INC_DWORD_STAT(STAT_RealityDistortion_ShaderCacheMisses);
+	FShaderResolutionCacheEntry NewEntry = ResolveRealityDistortionShadersUncached(MaterialRenderProxy, VertexFactoryType, FeatureLevel, true);
+	verify(ApplyShaderResolutionCacheEntry(NewEntry, MaterialRenderProxy, FeatureLevel, OutResolution));
+	{
+		FWriteScopeLock WriteLock(GShaderResolutionCacheLock);
+		GShaderResolutionCache.AddByHash(KeyHash, FShaderResolutionKey(KeyRef), MoveTemp(NewEntry));
+	}
+	return OutResolution.Material != nullptr;
+}
+
+void PurgeRealityDistortionShaderResolutionCache_GameThread()
+{
+	check(IsInGameThread());
+
+	// ShaderMap 的引用计数在 RT 释放，清理放在 RT 上按命令顺序执行。
+	ENQUEUE_RENDER_COMMAND(RealityDistortionPurgeShaderResolutionCache)(
+		[](FRHICommandListImmediate&)
+		{
+			FWriteScopeLock WriteLock(GShaderResolutionCacheLock);
+			for (auto It = GShaderResolutionCache.CreateIterator(); It; ++It)
+			{
+				if (It.Value().IsOrphaned())
+				{
+					It.RemoveCurrent();
+				}
+			}
+		});
 }
 
 FRealityDistortionPassProcessor::FRealityDistortionPassProcessor(
@@ -62,75 +361,105 @@ void FRealityDistortionPassProcessor::AddMeshBatch(
 	// ==================================================
 	// 第一层：Receiver 类型过滤
 	// ==================================================
-	// 只有自定义 FDistortionSceneProxy 才参与本 Pass。
+	// 只有自定义 FDistortionSceneProxy / FDistortionInstancedSceneProxy 才参与本 Pass。
 	// 这样可以把“受影响物体”与普通 BasePass 物体分开。
-	if (PrimitiveSceneProxy->GetTypeHash() != FDistortionSceneProxy::GetStaticTypeHash())
-	{
-		return;
-	}
+	const SIZE_T ProxyTypeHash = PrimitiveSceneProxy->GetTypeHash();
+	const FMeshBatch* EffectiveMeshBatch = &MeshBatch;
+	FMeshBatch LODBiasedMeshBatch;
+	FMeshBatch ClusterCulledMeshBatch;
+	uint64 EffectiveBatchElementMask = BatchElementMask;
+	uint64 RelevantFieldMask = 0;
+	float MaxTriangleEdgeLength = -1.0f;
 
-	const FDistortionSceneProxy* DistortionProxy = static_cast<const FDistortionSceneProxy*>(PrimitiveSceneProxy);
-	if (!DistortionProxy->ShouldRenderInRealityDistortionPass())
+	if (ProxyTypeHash == FDistortionSceneProxy::GetStaticTypeHash())
 	{
-		return;
-	}
+		const FDistortionSceneProxy* DistortionProxy = static_cast<const FDistortionSceneProxy*>(PrimitiveSceneProxy);
+		if (!DistortionProxy->ShouldRenderInRealityDistortionPass() || !MeshBatch.bUseForMaterial)
+		{
+			return;
+		}
 
-	// ==================================================
-	// 第二层：Field 粗筛（仅空间，不做 Tag）
-	// ==================================================
-	// 这里保留包围球相交粗筛以减少无意义提交，但不使用 Tag 过滤，
-	// 避免与 BasePass 的 receiver 判定条件不一致导致“已挖洞但 RD 没提交”。
-	const TConstArrayView<FRealityDistortionFieldSettings> Fields = GetRealityDistortionFieldSettings_RenderThread();
-	if (Fields.IsEmpty())
-	{
-		return;
-	}
+		// ==================================================
+		// 第二层：Field 粗筛（仅空间，不做 Tag）
+		// ==================================================
+		// 这里保留包围球相交粗筛以减少无意义提交，但不使用 Tag 过滤，
+		// 避免与 BasePass 的 receiver 判定条件不一致导致“已挖洞但 RD 没提交”。
+		// 力场空间索引由 ViewExtension 每个 ViewFamily 重建一次，这里只查询接收体附近的格子。
+		// 缓存接收体直接使用 Proxy 记录的掩码：它与缓存 DrawCommand 同步更新，
+		// 掩码变化时 Proxy 会让自己的缓存失效，这里随之重新执行。
+		if (DistortionProxy->UsesCachedMeshDrawCommands())
+		{
+			RelevantFieldMask = DistortionProxy->GetCachedFieldMask();
+			MaxTriangleEdgeLength = DistortionProxy->GetCachedMaxTriangleEdgeLength();
+		}
+		else
+		{
+			const FRealityDistortionFieldGrid& FieldGrid = GetRealityDistortionFieldGrid_RenderThread();
+			if (FieldGrid.IsEmpty())
+			{
+				return;
+			}
 
-	const FBoxSphereBounds PrimitiveBounds = PrimitiveSceneProxy->GetBounds();
-	const FVector PrimitiveCenter = PrimitiveBounds.Origin;
-	const float PrimitiveSphereRadius = FMath::Max(0.0f, PrimitiveBounds.SphereRadius);
+			// 同时记录命中的槽位，作为 RelevantFieldMask 传给 PS，PS 只遍历这些力场。
+			const FBoxSphereBounds PrimitiveBounds = PrimitiveSceneProxy->GetBounds();
+			const float PrimitiveSphereRadius = FMath::Max(0.0f, static_cast<float>(PrimitiveBounds.SphereRadius));
+			RelevantFieldMask = FieldGrid.GetOverlappingFieldMask(PrimitiveBounds.Origin, PrimitiveSphereRadius);
+			MaxTriangleEdgeLength = DistortionProxy->ComputeMaxTriangleEdgeLength();
+		}
 
-	bool bIntersectsAnyPackedField = false;
-	uint32 PackedFieldCount = 0;
-	for (const FRealityDistortionFieldSettings& Field : Fields)
-	{
-		if (!Field.bEnabled || Field.Radius <= 0.0f)
+		// 接收体配置了 DistortionPassLODBias 时，本 Pass 换用更粗的 LOD；BasePass 仍使用原 MeshBatch。
+		if (DistortionProxy->GetDistortionPassMeshBatch(MeshBatch, LODBiasedMeshBatch))
 		{
-			continue;
+			EffectiveMeshBatch = &LODBiasedMeshBatch;
 		}
 
-		++PackedFieldCount;
-		if (PackedFieldCount >= MAX_DISTORTION_FIELDS)
+		// 大接收体只提交与力场相交的三角形簇。缓存 DrawCommand 只能有一个 Element，
+		// 缓存路径合并成单个跨度（跨度变化时 Proxy 会让缓存失效）；动态路径每帧最多 16 个区间。
+		if (RelevantFieldMask != 0 && (BatchElementMask & 1ull) != 0)
 		{
-			break;
+			const int32 MaxClusterRanges = StaticMeshId >= 0 ? 1 : MaxDynamicClusterRanges;
+			if (DistortionProxy->GetClusterCulledMeshBatch(*EffectiveMeshBatch, MaxClusterRanges, ClusterCulledMeshBatch))
+			{
+				if (ClusterCulledMeshBatch.Elements.IsEmpty())
+				{
+					return;
+				}
+
+				EffectiveMeshBatch = &ClusterCulledMeshBatch;
+				EffectiveBatchElementMask = (1ull << ClusterCulledMeshBatch.Elements.Num()) - 1ull;
+			}
 		}
-		
-		const float IntersectRadius = Field.Radius + PrimitiveSphereRadius;
-		const float DistSq = FVector::DistSquared(PrimitiveCenter, Field.Center);
-		if (DistSq <= FMath::Square(IntersectRadius))
+	}
+	else if (ProxyTypeHash == FDistortionInstancedSceneProxy::GetStaticTypeHash())
+	{
+		// 实例化接收体：逐实例的力场粗筛已在 Proxy 的 GetDynamicMeshElements 里完成，
+		// 这里只接受它为本 Pass 单独提交的 MeshBatch（InstanceRuns 只含相交实例）。
+		// 缓存的静态 MeshBatch 会画出全部实例，跳过。
+		const FDistortionInstancedSceneProxy* InstancedProxy = static_cast<const FDistortionInstancedSceneProxy*>(PrimitiveSceneProxy);
+		if (!InstancedProxy->ShouldRenderInRealityDistortionPass() || !FDistortionInstancedSceneProxy::IsDistortionPassMeshBatch(MeshBatch))
 		{
-			bIntersectsAnyPackedField = true;
-			break;
+			return;
 		}
-	}
 
-	if (!bIntersectsAnyPackedField)
+		RelevantFieldMask = InstancedProxy->GetRelevantFieldMask();
+		MaxTriangleEdgeLength = InstancedProxy->GetMaxTriangleEdgeLength();
+	}
+	else
 	{
 		return;
 	}
 
-	if (!MeshBatch.bUseForMaterial)
+	if (RelevantFieldMask == 0)
 	{
 		return;
 	}
 
 	const EPrimitiveType PrimitiveTypeOverride = GetRealityDistortionPrimitiveType();
-	const FMeshBatch* EffectiveMeshBatch = &MeshBatch;
 	FMeshBatch OverriddenMeshBatch;
 
-	if (PrimitiveTypeOverride != MeshBatch.Type)
+	if (PrimitiveTypeOverride != EffectiveMeshBatch->Type)
 	{
-		OverriddenMeshBatch = MeshBatch;
+		OverriddenMeshBatch = *EffectiveMeshBatch;
 		OverriddenMeshBatch.Type = PrimitiveTypeOverride;
 
 		// 源数据来自三角形网格。切到线/点时，按索引数量重算 NumPrimitives，避免非法读索引。
@@ -151,120 +480,82 @@ void FRealityDistortionPassProcessor::AddMeshBatch(
 	}
 
 	// ==================================================
-	// 第三层：材质 fallback 链
+	// 第三层：材质 fallback 链（按材质缓存）
 	// ==================================================
-	// 同 BasePass 思路：沿 MaterialRenderProxy->Fallback 链找可用 ShaderMap。
-	bool bSubmitted = false;
-	const FMaterialRenderProxy* MaterialRenderProxy = EffectiveMeshBatch->MaterialRenderProxy;
-	while (MaterialRenderProxy)
-	{
-		const FMaterial* Material = MaterialRenderProxy->GetMaterialNoFallback(FeatureLevel);
-		if (Material && Material->GetRenderingThreadShaderMap())
-		{
-			if (TryAddMeshBatch(*EffectiveMeshBatch, BatchElementMask, PrimitiveSceneProxy, StaticMeshId, *MaterialRenderProxy, *Material))
-			{
-				bSubmitted = true;
-				break;
-			}
-		}
-
-		MaterialRenderProxy = MaterialRenderProxy->GetFallback(FeatureLevel);
-	}
-
-	// 某些工程材质不会为自定义 pass 编译对应 shader，兜底到默认 Surface 材质，
-	// 避免 BasePass 已 clip 但 Distortion pass 无法提交 DrawCommand 导致黑洞。
-	if (!bSubmitted)
-	{
-		if (UMaterial* DefaultMaterial = UMaterial::GetDefaultMaterial(MD_Surface))
-		{
-			const FMaterialRenderProxy* DefaultProxy = DefaultMaterial->GetRenderProxy();
-			const FMaterial* DefaultMat = DefaultProxy ? DefaultProxy->GetMaterialNoFallback(FeatureLevel) : nullptr;
-			if (DefaultMat && DefaultMat->GetRenderingThreadShaderMap())
-			{
-				TryAddMeshBatch(*EffectiveMeshBatch, BatchElementMask, PrimitiveSceneProxy, StaticMeshId, *DefaultProxy, *DefaultMat);
-			}
-		}
-	}
-}
-
-bool FRealityDistortionPassProcessor::TryAddMeshBatch(
-	const FMeshBatch& RESTRICT MeshBatch,
-	uint64 BatchElementMask,
-	const FPrimitiveSceneProxy* RESTRICT PrimitiveSceneProxy,
-	int32 StaticMeshId,
-	const FMaterialRenderProxy& MaterialRenderProxy,
-	const FMaterial& Material)
-{
-	// 只处理不透明/Masked；半透明直接跳过。
-	const EBlendMode BlendMode = Material.GetBlendMode();
-	if (IsTranslucentBlendMode(BlendMode))
-	{
-		return true;
-	}
-
-	// Volume 材质域不在本 Pass 渲染。
-	if (Material.GetMaterialDomain() == MD_Volume)
+	// 同 BasePass 思路：沿 MaterialRenderProxy->Fallback 链找可用 ShaderMap，最后兜底到默认 Surface 材质。
+	// 结果按 (材质, VertexFactory 类型, FeatureLevel) 缓存在 RT，热路径上不再重复查 ShaderMap。
+	FRealityDistortionShaderResolution Resolution;
+	if (!ResolveRealityDistortionShaders(*EffectiveMeshBatch->MaterialRenderProxy, EffectiveMeshBatch->VertexFactory->GetType(), FeatureLevel, Resolution))
 	{
-		return true;
+		return;
 	}
 
-	const FMaterialRenderProxy* FinalMaterialProxy = &MaterialRenderProxy;
-	const FMaterial* FinalMaterial = &Material;
-
 	// 计算 Fill/Cull 状态，准备进入 Process 构建 DrawCommand。
-	const FMeshDrawingPolicyOverrideSettings OverrideSettings = ComputeMeshOverrideSettings(MeshBatch);
-	const ERasterizerFillMode MeshFillMode = ComputeMeshFillMode(*FinalMaterial, OverrideSettings);
+	const FMeshDrawingPolicyOverrideSettings OverrideSettings = ComputeMeshOverrideSettings(*EffectiveMeshBatch);
+	const ERasterizerFillMode MeshFillMode = ComputeMeshFillMode(*Resolution.Material, OverrideSettings);
 	// Force two-sided in this pass so inside/outside camera positions render consistently.
 	const ERasterizerCullMode MeshCullMode = CM_None;
 
-	return Process(
-		MeshBatch,
-		BatchElementMask,
+	Process(
+		*EffectiveMeshBatch,
+		EffectiveBatchElementMask,
 		StaticMeshId,
 		PrimitiveSceneProxy,
-		*FinalMaterialProxy,
-		*FinalMaterial,
+		*Resolution.MaterialRenderProxy,
+		*Resolution.Material,
+		Resolution.Shaders,
 		MeshFillMode,
-		MeshCullMode);
+		MeshCullMode,
+		RelevantFieldMask,
+		MaxTriangleEdgeLength);
 }
 
-bool FRealityDistortionPassProcessor::Process(
+void FRealityDistortionPassProcessor::Process(
 	const FMeshBatch& RESTRICT MeshBatch,
 	uint64 BatchElementMask,
 	int32 StaticMeshId,
 	const FPrimitiveSceneProxy* RESTRICT PrimitiveSceneProxy,
 	const FMaterialRenderProxy& RESTRICT MaterialRenderProxy,
 	const FMaterial& RESTRICT MaterialResource,
+	const FRealityDistortionPassShaders& PassShaders,
 	ERasterizerFillMode MeshFillMode,
-	ERasterizerCullMode MeshCullMode)
+	ERasterizerCullMode MeshCullMode,
+	uint64 RelevantFieldMask,
+	float MaxTriangleEdgeLength)
 {
-	const FVertexFactory* VertexFactory = MeshBatch.VertexFactory;
-
-	// RealityDistortion Pass 必须始终使用自定义 PS（输出青色），不能跳过。
-	// 构建 Shader 类型列表
-	FMaterialShaderTypes ShaderTypes;
-	ShaderTypes.AddShaderType<FRealityDistortionVS>();
-	ShaderTypes.AddShaderType<FRealityDistortionPS>();
-
-	// 获取编译好的 Shader
-	FMaterialShaders Shaders;
-	if (!MaterialResource.TryGetShaders(ShaderTypes, VertexFactory->GetType(), Shaders))
-	{
-		UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] TryGetShaders FAILED for material: %s, VF: %s"),
-			*MaterialResource.GetFriendlyName(), VertexFactory->GetType()->GetName());
-		return false;
-	}
-
-	// 提取 VS 和 PS
-	TMeshProcessorShaders<FRealityDistortionVS, FRealityDistortionPS> PassShaders;
-	Shaders.TryGetVertexShader(PassShaders.VertexShader);
-	Shaders.TryGetPixelShader(PassShaders.PixelShader);
+	// 相关力场为 0 的接收体在 AddMeshBatch 里已经跳过，不会生成 DrawCommand。
+	check(RelevantFieldMask != 0);
 
 	// ShaderElementData 会把 Primitive/Material 相关绑定数据带到 DrawCommand。
-	FMeshMaterialShaderElementData ShaderElementData;
+	// 力场 Uniform Buffer 是常驻的，这里只记录引用，不在 DrawCall 粒度上重建。
+	FRealityDistortionShaderElementData ShaderElementData;
 	ShaderElementData.InitializeMeshMaterialData(ViewIfDynamicMeshCommand, PrimitiveSceneProxy, MeshBatch, StaticMeshId, false);
+	ShaderElementData.RealityDistortionUniformBuffer = GetRealityDistortionUniformBuffer_RenderThread();
+	ShaderElementData.RelevantFieldMask = RelevantFieldMask;
+	ShaderElementData.MaxTriangleEdgeLength = MaxTriangleEdgeLength;
+
+	// 按相关力场数选择 PS 变体：不超过 4 个时用展开变体，槽位直接写进 RelevantFieldSlots；
+	// 单力场场景落到最便宜的 1 力场变体。缓存 DrawCommand 的掩码变化时 Proxy 会让缓存失效，变体随之重选。
+	// 顶点阶段影响度变体的“完全在内”判定读取前 4 个槽位，因此不展开的变体也写入槽位。
+	const int32 NumRelevantFields = FMath::CountBits(RelevantFieldMask);
+	const bool bVertexInfluence = IsRealityDistortionVertexInfluenceEnabled();
+	const TMeshProcessorShaders<FRealityDistortionVS, FRealityDistortionPS> SelectedShaders = PassShaders.GetShaders(NumRelevantFields, bVertexInfluence);
+	if (bVertexInfluence || FRealityDistortionPS::GetUnrolledFieldCount(NumRelevantFields) > 0)
+	{
+		uint64 RemainingFields = RelevantFieldMask;
+		uint32 LastSlot = 0;
+		for (int32 SlotIndex = 0; SlotIndex < 4; ++SlotIndex)
+		{
+			if (RemainingFields != 0)
+			{
+				LastSlot = static_cast<uint32>(FMath::CountTrailingZeros64(RemainingFields));
+				RemainingFields &= RemainingFields - 1ull;
+			}
+			ShaderElementData.RelevantFieldSlots[SlotIndex] = LastSlot;
+		}
+	}
 
-	const FMeshDrawCommandSortKey SortKey = CalculateMeshStaticSortKey(PassShaders.VertexShader, PassShaders.PixelShader);
+	const FMeshDrawCommandSortKey SortKey = CalculateMeshStaticSortKey(SelectedShaders.VertexShader, SelectedShaders.PixelShader);
 
 	// 最终生成 FMeshDrawCommand（包含 PSO、Shader、VertexStreams、Bindings）。
 	BuildMeshDrawCommands(
@@ -274,14 +565,82 @@ bool FRealityDistortionPassProcessor::Process(
 		MaterialRenderProxy,
 		MaterialResource,
 		PassDrawRenderState,
-		PassShaders,
+		SelectedShaders,
 		MeshFillMode,
 		MeshCullMode,
 		SortKey,
 		EMeshPassFeatures::Default,
 		ShaderElementData);
+}
+
+void FRealityDistortionPassProcessor::CollectPSOInitializers(
+	const FSceneTexturesConfig& SceneTexturesConfig,
+	const FMaterial& Material,
+	const FPSOPrecacheVertexFactoryData& VertexFactoryData,
+	const FPSOPrecacheParams& PreCacheParams,
+	TArray<FPSOPrecacheData>& PSOInitializers)
+{
+	// 过滤条件与 ResolveRealityDistortionShaders 保持一致，避免预编译永远用不到的 PSO。
+	if (!PreCacheParams.bRenderInMainPass)
+	{
+		return;
+	}
+
+	if (IsTranslucentBlendMode(Material.GetBlendMode()) || Material.GetMaterialDomain() == MD_Volume)
+	{
+		return;
+	}
 
-	return true;
+	FRealityDistortionPassShaders PassShaders;
+	if (!TryGetRealityDistortionShaders(Material, VertexFactoryData.VertexFactoryType, PassShaders))
+	{
+		return;
+	}
+
+	const FMeshDrawingPolicyOverrideSettings OverrideSettings = ComputeMeshOverrideSettings(PreCacheParams);
+	const ERasterizerFillMode MeshFillMode = ComputeMeshFillMode(Material, OverrideSettings);
+	// 与 AddMeshBatch 相同：本 Pass 固定双面。
+	const ERasterizerCullMode MeshCullMode = CM_None;
+
+	// 本 Pass 在 BasePass 之后画到 SceneColor 上，深度只读（构造函数里关闭了深度写入）。
+	FGraphicsPipelineRenderTargetsInfo RenderTargetsInfo;
+	RenderTargetsInfo.NumSamples = SceneTexturesConfig.NumSamples;
+	AddRenderTargetInfo(SceneTexturesConfig.ColorFormat, SceneTexturesConfig.ColorCreateFlags, RenderTargetsInfo);
+	SetupDepthStencilInfo(
+		PF_DepthStencil,
+		SceneTexturesConfig.DepthCreateFlags,
+		ERenderTargetLoadAction::ELoad,
+		ERenderTargetLoadAction::ELoad,
+		FExclusiveDepthStencil::DepthRead_StencilNop,
+		RenderTargetsInfo);
+
+	// r.RealityDistortion.PrimitiveMode 可在运行时切换，三种拓扑都预编译；
+	// 当前模式标记为 Required，其余两种作为可选（调试用）。
+	// 相关力场数随力场移动变化，每个 PS 变体都可能用到，全部预编译；
+	// r.RealityDistortion.VertexInfluence 同样可在运行时切换，两组变体都预编译。
+	const EPrimitiveType CurrentPrimitiveType = GetRealityDistortionPrimitiveType();
+	for (int32 PermutationId = 0; PermutationId < FRealityDistortionPS::FPermutationDomain::PermutationCount; ++PermutationId)
+	{
+		TMeshProcessorShaders<FRealityDistortionVS, FRealityDistortionPS> VariantShaders;
+		VariantShaders.VertexShader = PassShaders.VertexShaders[FRealityDistortionPassShaders::GetVertexShaderPermutationId(PermutationId)];
+		VariantShaders.PixelShader = PassShaders.PixelShaders[PermutationId];
+
+		for (const EPrimitiveType PrimitiveType : { PT_TriangleList, PT_LineList, PT_PointList })
+		{
+			AddGraphicsPipelineStateInitializer(
+				VertexFactoryData,
+				Material,
+				PassDrawRenderState,
+				RenderTargetsInfo,
+				VariantShaders,
+				MeshFillMode,
+				MeshCullMode,
+				PrimitiveType,
+				EMeshPassFeatures::Default,
+				PrimitiveType == CurrentPrimitiveType,
+				PSOInitializers);
+		}
+	}
 }
 
 static FMeshPassProcessor* CreateRealityDistortionPassProcessor(
@@ -4,13 +4,69 @@
 // ------------------------------
 // 这是 RealityDistortion Pass 的决策层：
 // 1) AddMeshBatch: 决定“画什么”（Receiver/空间/材质三层过滤）
-// 2) TryAddMeshBatch: 决定“是否可用当前材质 + 是否需要 DefaultMaterial 回退”
-// 3) Process: 决定“怎么画”（Shader/Pipeline/RenderState/DrawCommand）
+// 2) ResolveRealityDistortionShaders: 决定“是否可用当前材质 + 是否需要 DefaultMaterial 回退”（按材质缓存）
+// 3) Process: 决定“怎么画”（Shader 变体/Pipeline/RenderState/DrawCommand）
+// 4) CollectPSOInitializers: 组件加载时预编译 Process 会用到的 PSO，避免首次进入力场时卡顿
 
 #pragma once
 
 #include "CoreMinimal.h"
 #include "MeshPassProcessor.h"
+#include "Rendering/RealityDistortionShaders.h"
+
+// 本 Pass 的全部 VS / PS 变体（分别按各自 FPermutationDomain 的 PermutationId 排列）。
+struct FRealityDistortionPassShaders
+{
+	TStaticArray<TShaderRef<FRealityDistortionVS>, FRealityDistortionVS::FPermutationDomain::PermutationCount> VertexShaders;
+	TStaticArray<TShaderRef<FRealityDistortionPS>, FRealityDistortionPS::FPermutationDomain::PermutationCount> PixelShaders;
+
+	// PS 变体对应的 VS 变体（顶点阶段影响度维度必须一致）。
+	static int32 GetVertexShaderPermutationId(int32 PixelShaderPermutationId)
+	{
+		const FRealityDistortionPS::FPermutationDomain PixelPermutationVector(PixelShaderPermutationId);
+		FRealityDistortionVS::FPermutationDomain VertexPermutationVector;
+		VertexPermutationVector.Set<FRealityDistortionVertexInfluenceDim>(PixelPermutationVector.Get<FRealityDistortionVertexInfluenceDim>());
+		return VertexPermutationVector.ToDimensionValueId();
+	}
+
+	// 相关力场数为 NumRelevantFields 时使用的 Shader 组合。
+	TMeshProcessorShaders<FRealityDistortionVS, FRealityDistortionPS> GetShaders(int32 NumRelevantFields, bool bVertexInfluence) const
+	{
+		FRealityDistortionPS::FPermutationDomain PermutationVector;
+		PermutationVector.Set<FRealityDistortionPS::FUnrolledFieldCountDim>(FRealityDistortionPS::GetUnrolledFieldCount(NumRelevantFields));
+		PermutationVector.Set<FRealityDistortionVertexInfluenceDim>(bVertexInfluence);
+
+		const int32 PixelShaderPermutationId = PermutationVector.ToDimensionValueId();
+		TMeshProcessorShaders<FRealityDistortionVS, FRealityDistortionPS> Shaders;
+		Shaders.VertexShader = VertexShaders[GetVertexShaderPermutationId(PixelShaderPermutationId)];
+		Shaders.PixelShader = PixelShaders[PixelShaderPermutationId];
+		return Shaders;
+	}
+};
+
+// 某个 (材质, VertexFactory 类型, FeatureLevel) 在本 Pass 的最终绘制方式。
+struct FRealityDistortionShaderResolution
+{
+	// 沿 Fallback 链（或默认 Surface 材质）解析出的实际绘制材质；Material 为 nullptr 表示不在本 Pass 绘制。
+	const FMaterialRenderProxy* MaterialRenderProxy = nullptr;
+	const FMaterial* Material = nullptr;
+	FRealityDistortionPassShaders Shaders;
+	bool bUsedDefaultMaterial = false;
+};
+
+// 解析并缓存材质在本 Pass 使用的 Shader（RT / 并行 MeshPass 任务可调用）。
+// 缓存以源材质的 ShaderMap ID + FeatureLevel + VF 类型为键，条目持有 ShaderMap 引用、不保存 RenderProxy 指针；
+// 材质 ShaderMap 变化时条目作废并被替换；解析失败只在写入缓存时记录一次日志。
+// 返回 false 表示该材质不在本 Pass 绘制。
+bool ResolveRealityDistortionShaders(
+	const FMaterialRenderProxy& MaterialRenderProxy,
+	const FVertexFactoryType* VertexFactoryType,
+	ERHIFeatureLevel::Type FeatureLevel,
+	FRealityDistortionShaderResolution& OutResolution);
+
+// 移除材质已销毁 / 已重新编译的缓存条目（只剩缓存持有其 ShaderMap）。
+// 模块在 GC 之后与编辑器里材质编译完成时调用。
+void PurgeRealityDistortionShaderResolutionCache_GameThread();
 
 class FRealityDistortionPassProcessor
 	: public FSceneRenderingAllocatorObject<FRealityDistortionPassProcessor>
@@ -30,26 +86,29 @@ public:
 		const FPrimitiveSceneProxy* RESTRICT PrimitiveSceneProxy,
 		int32 StaticMeshId = -1) override final;
 
-private:
-	// 第二阶段过滤：处理 BlendMode/Domain，并做必要的材质回退。
-	bool TryAddMeshBatch(
-		const FMeshBatch& RESTRICT MeshBatch,
-		uint64 BatchElementMask,
-		const FPrimitiveSceneProxy* RESTRICT PrimitiveSceneProxy,
-		int32 StaticMeshId,
-		const FMaterialRenderProxy& MaterialRenderProxy,
-		const FMaterial& Material);
+	// PSO 预缓存：与 Process 使用相同的 Shader 与固定 RenderState，覆盖全部 PrimitiveMode 拓扑。
+	virtual void CollectPSOInitializers(
+		const FSceneTexturesConfig& SceneTexturesConfig,
+		const FMaterial& Material,
+		const FPSOPrecacheVertexFactoryData& VertexFactoryData,
+		const FPSOPrecacheParams& PreCacheParams,
+		TArray<FPSOPrecacheData>& PSOInitializers) override final;
 
-	// 最终构建 DrawCommand：查找 Shader、组装 RenderState、调用 BuildMeshDrawCommands。
-	bool Process(
+private:
+	// 最终构建 DrawCommand：按相关力场数与 r.RealityDistortion.VertexInfluence 选择变体，组装 RenderState、调用 BuildMeshDrawCommands。
+	// MaxTriangleEdgeLength 为接收体最长三角形边（世界空间，负数表示未知），只有顶点阶段影响度变体使用。
+	void Process(
 		const FMeshBatch& RESTRICT MeshBatch,
 		uint64 BatchElementMask,
 		int32 StaticMeshId,
 		const FPrimitiveSceneProxy* RESTRICT PrimitiveSceneProxy,
 		const FMaterialRenderProxy& RESTRICT MaterialRenderProxy,
 		const FMaterial& RESTRICT MaterialResource,
+		const FRealityDistortionPassShaders& PassShaders,
 		ERasterizerFillMode MeshFillMode,
-		ERasterizerCullMode MeshCullMode);
+		ERasterizerCullMode MeshCullMode,
+		uint64 RelevantFieldMask,
+		float MaxTriangleEdgeLength);
 
 	FMeshPassProcessorRenderState PassDrawRenderState;
 };
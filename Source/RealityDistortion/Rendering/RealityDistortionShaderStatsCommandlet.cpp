@@ -0,0 +1,196 @@
+﻿// RealityDistortionShaderStatsCommandlet.cpp
+
+#include "Rendering/RealityDistortionShaderStatsCommandlet.h"
+
+#include "RealityDistortion.h"
+
+#if WITH_EDITOR
+
+#include "AssetRegistry/IAssetRegistry.h"
+#include "DataDrivenShaderPlatformInfo.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialInstance.h"
+#include "MaterialShared.h"
+#include "Rendering/RealityDistortionShaders.h"
+#include "RHIShaderPlatform.h"
+#include "RHIStrings.h"
+#include "UObject/UObjectGlobals.h"
+#include "VertexFactory.h"
+
+namespace
+{
+	// 每加载这么多材质做一次 GC，避免大工程一次性把所有材质留在内存里。
+	constexpr int32 MaterialsPerGarbageCollection = 256;
+
+	struct FShaderCounts
+	{
+		int64 Unfiltered = 0;
+		// 按 VertexFactory 允许列表过滤（实际编译的数量）。
+		int64 Filtered = 0;
+		// 实际编译且材质在 r.RealityDistortion.PassMaterials 里（本 Pass 会用到的数量）。
+		int64 Allowed = 0;
+
+		void operator+=(const FShaderCounts& Other)
+		{
+			Unfiltered += Other.Unfiltered;
+			Filtered += Other.Filtered;
+			Allowed += Other.Allowed;
+		}
+	};
+
+	// 一个 (材质, VertexFactory) 组合下本 Pass 的 Shader 数：VS 与 PS 的每个排列各一个。
+	FShaderCounts CountRealityDistortionShaders(
+		EShaderPlatform ShaderPlatform,
+		const FMaterialShaderParameters& MaterialParameters,
+		const FVertexFactoryType* VertexFactoryType,
+		bool bMaterialAllowed)
+	{
+		FShaderCounts Counts;
+
+		auto CountPermutation = [&](int32 PermutationId)
+		{
+			const FMeshMaterialShaderPermutationParameters Parameters(ShaderPlatform, MaterialParameters, VertexFactoryType, PermutationId, EShaderPermutationFlags::None);
+			const bool bCompiled = ShouldCompileRealityDistortionShaders(Parameters, ERealityDistortionShaderFilter::All);
+			Counts.Unfiltered += ShouldCompileRealityDistortionShaders(Parameters, ERealityDistortionShaderFilter::None) ? 1 : 0;
+			Counts.Filtered += bCompiled ? 1 : 0;
+			Counts.Allowed += bCompiled && bMaterialAllowed ? 1 : 0;
+		};
+
+		for (int32 PermutationId = 0; PermutationId < FRealityDistortionVS::FPermutationDomain::PermutationCount; ++PermutationId)
+		{
+			CountPermutation(PermutationId);
+		}
+		for (int32 PermutationId = 0; PermutationId < FRealityDistortionPS::FPermutationDomain::PermutationCount; ++PermutationId)
+		{
+			CountPermutation(PermutationId);
+		}
+		return Counts;
+	}
+}
+
+#endif // WITH_EDITOR
+
+URealityDistortionShaderStatsCommandlet::URealityDistortionShaderStatsCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 URealityDistortionShaderStatsCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	EShaderPlatform ShaderPlatform = GMaxRHIShaderPlatform;
+	FString PlatformName;
+	if (FParse::Value(*Params, TEXT("Platform="), PlatformName))
+	{
+		ShaderPlatform = FDataDrivenShaderPlatformInfo::GetShaderPlatformFromName(FName(*PlatformName));
+		if (ShaderPlatform == SP_NumPlatforms)
+		{
+			UE_LOG(LogRealityDistortion, Error, TEXT("[RealityDistortion] ShaderStats: unknown shader platform '%s'"), *PlatformName);
+			return 1;
+		}
+	}
+	const bool bVerbose = FParse::Param(*Params, TEXT("Verbose"));
+	const ERHIFeatureLevel::Type FeatureLevel = GetMaxSupportedFeatureLevel(ShaderPlatform);
+
+	IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> MaterialAssets;
+	AssetRegistry.GetAssetsByClass(UMaterialInterface::StaticClass()->GetClassPathName(), MaterialAssets, true);
+
+	int32 NumShaderMaps = 0;
+	int32 NumEligibleShaderMaps = 0;
+	int32 NumAllowedShaderMaps = 0;
+	FShaderCounts TotalCounts;
+	TMap<FName, FShaderCounts> CountsPerVertexFactory;
+
+	int32 NumLoaded = 0;
+	for (const FAssetData& MaterialAsset : MaterialAssets)
+	{
+		UMaterialInterface* MaterialInterface = Cast<UMaterialInterface>(MaterialAsset.GetAsset());
+		if (MaterialInterface == nullptr)
+		{
+			continue;
+		}
+
+		if (++NumLoaded % MaterialsPerGarbageCollection == 0)
+		{
+			CollectGarbage(RF_NoFlags);
+		}
+
+		// 没有静态参数排列的材质实例复用父材质的 ShaderMap，不单独计数。
+		const UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(MaterialInterface);
+		if (MaterialInstance != nullptr && !MaterialInstance->bHasStaticPermutationResource)
+		{
+			continue;
+		}
+
+		const FMaterialResource* MaterialResource = MaterialInterface->GetMaterialResource(FeatureLevel);
+		if (MaterialResource == nullptr)
+		{
+			continue;
+		}
+
+		++NumShaderMaps;
+		const FMaterialShaderParameters MaterialParameters(MaterialResource);
+		const bool bMaterialAllowed = IsRealityDistortionMaterialAllowed(MaterialInterface);
+
+		FShaderCounts MaterialCounts;
+		for (const FVertexFactoryType* VertexFactoryType : FVertexFactoryType::GetSortedMaterialTypes())
+		{
+			const FVertexFactoryShaderPermutationParameters VertexFactoryParameters(
+				ShaderPlatform,
+				MaterialParameters,
+				VertexFactoryType,
+				&FRealityDistortionPS::GetStaticType(),
+				EShaderPermutationFlags::None);
+			if (!VertexFactoryType->ShouldCache(VertexFactoryParameters))
+			{
+				continue;
+			}
+
+			const FShaderCounts Counts = CountRealityDistortionShaders(ShaderPlatform, MaterialParameters, VertexFactoryType, bMaterialAllowed);
+			MaterialCounts += Counts;
+			CountsPerVertexFactory.FindOrAdd(VertexFactoryType->GetFName()) += Counts;
+		}
+
+		NumEligibleShaderMaps += MaterialCounts.Unfiltered > 0 ? 1 : 0;
+		NumAllowedShaderMaps += MaterialCounts.Allowed > 0 ? 1 : 0;
+		TotalCounts += MaterialCounts;
+
+		if (bVerbose && MaterialCounts.Unfiltered > 0)
+		{
+			UE_LOG(LogRealityDistortion, Display, TEXT("[RealityDistortion] ShaderStats: %s: %lld -> %lld -> %lld shaders%s"),
+				*MaterialAsset.GetObjectPathString(), MaterialCounts.Unfiltered, MaterialCounts.Filtered, MaterialCounts.Allowed,
+				bMaterialAllowed ? TEXT("") : TEXT("  (not in r.RealityDistortion.PassMaterials)"));
+		}
+	}
+
+	CountsPerVertexFactory.ValueSort([](const FShaderCounts& A, const FShaderCounts& B)
+	{
+		return A.Unfiltered > B.Unfiltered;
+	});
+	for (const TPair<FName, FShaderCounts>& Pair : CountsPerVertexFactory)
+	{
+		UE_LOG(LogRealityDistortion, Display, TEXT("[RealityDistortion] ShaderStats: %-48s %8lld -> %8lld -> %8lld%s"),
+			*Pair.Key.ToString(), Pair.Value.Unfiltered, Pair.Value.Filtered, Pair.Value.Allowed,
+			Pair.Value.Filtered == 0 ? TEXT("  (filtered)") : TEXT(""));
+	}
+
+	const int64 SavedShaders = TotalCounts.Unfiltered - TotalCounts.Filtered;
+	UE_LOG(LogRealityDistortion, Display, TEXT("[RealityDistortion] ShaderStats: platform %s, %d shader maps (%d opaque/masked surface, %d in r.RealityDistortion.PassMaterials)"),
+		*LexToString(ShaderPlatform), NumShaderMaps, NumEligibleShaderMaps, NumAllowedShaderMaps);
+	UE_LOG(LogRealityDistortion, Display, TEXT("[RealityDistortion] ShaderStats: RealityDistortion shaders unfiltered=%lld, with VF allowlist=%lld, saved=%lld (%.1f%%), used by pass materials=%lld"),
+		TotalCounts.Unfiltered, TotalCounts.Filtered, SavedShaders,
+		TotalCounts.Unfiltered > 0 ? 100.0 * SavedShaders / TotalCounts.Unfiltered : 0.0,
+		TotalCounts.Allowed);
+
+	return 0;
+#else
+	UE_LOG(LogRealityDistortion, Error, TEXT("[RealityDistortion] ShaderStats: requires an editor build."));
+	return 1;
+#endif // WITH_EDITOR
+}
@@ -0,0 +1,30 @@
+﻿// RealityDistortionShaderStatsCommandlet.h
+//
+// URealityDistortionShaderStatsCommandlet
+// ---------------------------------------
+// 统计 RealityDistortion Pass 在工程里会编译多少个材质 Shader、r.RealityDistortion.ShaderVertexFactories 省下了多少，
+// 以及其中有多少属于 r.RealityDistortion.PassMaterials 允许的材质（其余的编译了但本 Pass 不会用到）。
+// 用法：UnrealEditor-Cmd <Project>.uproject -run=RealityDistortionShaderStats [-Platform=<ShaderPlatform>] [-Verbose]
+//
+// 说明：
+// - 遍历工程里的 UMaterial，以及带静态参数排列（有独立 ShaderMap）的材质实例。
+// - 对每个 (材质, VertexFactory) 组合，按 VertexFactory 自身的 ShouldCache 与本 Pass 的编译条件逐个 Shader 排列计数，
+//   依次给出不过滤、按 VertexFactory 过滤（实际编译）、再只保留允许材质后的数量。只做计数，不编译任何 Shader。
+// - 只在编辑器构建里可用（需要加载工程里的所有材质资源）；非编辑器构建里类仍然存在，但 Main 直接报错返回。
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RealityDistortionShaderStatsCommandlet.generated.h"
+
+UCLASS()
+class URealityDistortionShaderStatsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	URealityDistortionShaderStatsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
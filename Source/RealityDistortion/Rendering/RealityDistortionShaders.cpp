@@ -2,72 +2,326 @@
 
 #include "Rendering/RealityDistortionShaders.h"
 
+#include "ComponentRecreateRenderStateContext.h"
+#include "HAL/IConsoleManager.h"
 #include "HAL/PlatformTime.h"
+#include "Materials/MaterialInstance.h"
+#include "RealityDistortion.h"
 #include "RealityDistortionField.h"
+#include "RenderResource.h"
+#include "RenderUtils.h"
+#include "Rendering/RealityDistortionFieldSelection.h"
+#include "Rendering/RealityDistortionFieldShapes.h"
+#include "Rendering/RealityDistortionInfluenceClipmap.h"
+#include "Rendering/RealityDistortionStats.h"
+#include "Rendering/RealityDistortionTiledCulling.h"
+#include "Rendering/RealityDistortionVoronoi.h"
+#include "RenderGraphBuilder.h"
+
+DEFINE_STAT(STAT_RealityDistortion_UniformBuffersCreated);
+DEFINE_STAT(STAT_RealityDistortion_UniformBufferUpdates);
 
 IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FRealityDistortionUniformParameters, "RealityDistortionParameters");
 
-TUniformBufferRef<FRealityDistortionUniformParameters> CreateRealityDistortionUniformBuffer()
+namespace
 {
-	check(IsInRenderingThread() || IsInParallelRenderingThread());
+	// 编译范围按 (材质, VertexFactory) 展开，ShouldCompilePermutation 看不到具体材质，只能按 VertexFactory 收窄；
+	// 接收体都是静态网格（实例化接收体在 GPUScene 下同样使用 FLocalVertexFactory），其余 VertexFactory 默认不编译。
+	static TAutoConsoleVariable<FString> CVarRealityDistortionShaderVertexFactories(
+		TEXT("r.RealityDistortion.ShaderVertexFactories"),
+		TEXT("FLocalVertexFactory"),
+		TEXT("Comma-separated vertex factory types the RealityDistortion pass shaders are compiled for. Empty = every vertex factory the material supports.\n")
+		TEXT("Read-only; set it in DefaultEngine.ini under [/Script/Engine.RendererSettings]. Run -run=RealityDistortionShaderStats to see the savings."),
+		ECVF_ReadOnly);
+
+	// 允许作为覆盖材质进入本 Pass 的材质（对象路径），列出的材质的实例同样允许；不在列表里的回退到默认 Surface 材质。
+	// 本 Pass 用到的材质集合因此在工程设置里一目了然，PSO 预缓存与 ShaderStats 命令行也按它统计。
+	static TAutoConsoleVariable<FString> CVarRealityDistortionPassMaterials(
+		TEXT("r.RealityDistortion.PassMaterials"),
+		TEXT(""),
+		TEXT("Comma-separated material object paths (e.g. /Game/Materials/M_Distortion.M_Distortion) receivers may use as OverrideMaterial.\n")
+		TEXT("Instances of a listed material are allowed too; other override materials fall back to the default surface material. Empty = every material.\n")
+		TEXT("Read-only; set it in DefaultEngine.ini under [/Script/Engine.RendererSettings]."),
+		ECVF_ReadOnly);
+
+	// 顶点阶段影响度：VS 逐顶点计算影响度与内 / 外界，PS 只对跨越力场边界的像素做精确判定。
+	// 切换时重建渲染状态：接收体 Proxy 按新设置计算（或跳过）最长三角形边，缓存 DrawCommand 重新选择变体。
+	static TAutoConsoleVariable<int32> CVarRealityDistortionVertexInfluence(
+		TEXT("r.RealityDistortion.VertexInfluence"),
+		0,
+		TEXT("Evaluate field influence per vertex and run the exact per-pixel test only near field boundaries.\n")
+		TEXT("Pixels proven inside a field use the interpolated vertex influence. 0=Per-pixel (default), 1=Vertex-stage"),
+		FConsoleVariableDelegate::CreateLambda([](IConsoleVariable*)
+		{
+			FGlobalComponentRecreateRenderStateContext Context;
+		}),
+		ECVF_RenderThreadSafe);
+
+	// 常驻渲染资源：
+	// - FieldBuffer：打包后的力场记录（StructuredBuffer<float4>），容量固定为 MAX_DISTORTION_FIELDS。
+	// - EmptyTileMasks：没有分箱时绑定的占位 Buffer（Shader 看到 NumTileViews 为 0 不会读取）。
+	//   Clipmap 关闭时同理绑定 GBlackVolumeTexture。
+	// - UniformBuffer：InitRHI 时创建一次，之后只更新内容；RHI 资源被释放（设备重建 / 切换 FeatureLevel）后
+	//   由 InitRHI 或首次更新重新创建。所有创建都经过 CreateUniformBuffer，计入 Uniform Buffers Created。
+	// 所有 DrawCommand 引用同一个 RHI 对象，不再每个 DrawCall 分配 UniformBuffer_SingleFrame。
+	class FRealityDistortionSceneResources : public FRenderResource
+	{
+	public:
+		virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+		{
+			const uint32 BufferSize = sizeof(FRealityDistortionPackedField) * MAX_DISTORTION_FIELDS;
+
+			FRHIResourceCreateInfo CreateInfo(TEXT("RealityDistortion.FieldBuffer"));
+			FieldBuffer = RHICmdList.CreateStructuredBuffer(
+				sizeof(FVector4f),
+				BufferSize,
+				BUF_ShaderResource | BUF_Dynamic,
+				CreateInfo);
+			FieldBufferSRV = RHICmdList.CreateShaderResourceView(
+				FieldBuffer,
+				FRHIViewDesc::CreateBufferSRV().SetTypeFromBuffer(FieldBuffer));
+
+			void* Data = RHICmdList.LockBuffer(FieldBuffer, 0, BufferSize, RLM_WriteOnly);
+			FMemory::Memzero(Data, BufferSize);
+			RHICmdList.UnlockBuffer(FieldBuffer);
+
+			FRHIResourceCreateInfo TileMasksCreateInfo(TEXT("RealityDistortion.EmptyFieldTileMasks"));
+			EmptyTileMasks = RHICmdList.CreateStructuredBuffer(
+				sizeof(FUintVector2),
+				sizeof(FUintVector2),
+				BUF_ShaderResource | BUF_Static,
+				TileMasksCreateInfo);
+			EmptyTileMasksSRV = RHICmdList.CreateShaderResourceView(
+				EmptyTileMasks,
+				FRHIViewDesc::CreateBufferSRV().SetTypeFromBuffer(EmptyTileMasks));
+
+			// Zero initialize：首帧更新前 ActiveFieldCount = 0，Shader 不会读到垃圾数据。
+			FRealityDistortionUniformParameters Parameters{};
+			Parameters.FieldBuffer = FieldBufferSRV;
+			Parameters.FieldTileMasks = EmptyTileMasksSRV;
+			Parameters.InfluenceClipmap = GBlackVolumeTexture->TextureRHI;
+			Parameters.InfluenceClipmapSampler = TStaticSamplerState<SF_Bilinear, AM_Wrap, AM_Wrap, AM_Wrap>::GetRHI();
+			Parameters.VoronoiQuality = REALITY_DISTORTION_VORONOI_QUALITY_REFERENCE;
+			Parameters.VoronoiNoiseTexture = GBlackVolumeTexture->TextureRHI;
+			Parameters.VoronoiNoiseSampler = TStaticSamplerState<SF_Bilinear, AM_Wrap, AM_Wrap, AM_Wrap>::GetRHI();
+			CreateUniformBuffer(Parameters);
+		}
+
+		void CreateUniformBuffer(const FRealityDistortionUniformParameters& Parameters)
+		{
+			UniformBuffer = TUniformBufferRef<FRealityDistortionUniformParameters>::CreateUniformBufferImmediate(
+				Parameters,
+				UniformBuffer_MultiFrame);
+			INC_DWORD_STAT(STAT_RealityDistortion_UniformBuffersCreated);
+		}
+
+		// 原地更新；Buffer 尚未创建或已被释放时重新创建（计入创建次数，而不是更新次数）。
+		void UpdateUniformBuffer(FRHICommandListBase& RHICmdList, const FRealityDistortionUniformParameters& Parameters)
+		{
+			if (!UniformBuffer.IsValid())
+			{
+				CreateUniformBuffer(Parameters);
+				return;
+			}
+
+			UniformBuffer.UpdateUniformBufferImmediate(RHICmdList, Parameters);
+			INC_DWORD_STAT(STAT_RealityDistortion_UniformBufferUpdates);
+		}
+
+		virtual void ReleaseRHI() override
+		{
+			UniformBuffer.SafeRelease();
+			EmptyTileMasksSRV.SafeRelease();
+			EmptyTileMasks.SafeRelease();
+			FieldBufferSRV.SafeRelease();
+			FieldBuffer.SafeRelease();
+		}
+
+		FBufferRHIRef FieldBuffer;
+		FShaderResourceViewRHIRef FieldBufferSRV;
+		FBufferRHIRef EmptyTileMasks;
+		FShaderResourceViewRHIRef EmptyTileMasksSRV;
+		TUniformBufferRef<FRealityDistortionUniformParameters> UniformBuffer;
+	};
+
+	TGlobalResource<FRealityDistortionSceneResources> GRealityDistortionSceneResources;
+}
+
+FRealityDistortionPackedField PackRealityDistortionField(const FRealityDistortionFieldShape& Shape, float BoundingRadius, float Strength)
+{
+	const float FalloffDistance = ComputeRealityDistortionFieldShapeFalloffDistance(Shape.Type, Shape.Extent);
+
+	FRealityDistortionPackedField Packed;
+	Packed.CenterAndRadius = FVector4f(FVector3f(Shape.Center), BoundingRadius);
+	Packed.Params = FVector4f(Strength, static_cast<float>(Shape.Type), 0.0f, 0.0f);
+	Packed.Rotation = FVector4f(Shape.Rotation.X, Shape.Rotation.Y, Shape.Rotation.Z, Shape.Rotation.W);
+	Packed.ExtentAndInvFalloff = FVector4f(Shape.Extent, FalloffDistance > 0.0f ? 1.0f / FalloffDistance : 0.0f);
+	return Packed;
+}
+
+// 按本 ViewFamily 的力场选择打包：Buffer 位置 i 写入选中的注册表槽位，空闲位置半径写 0。
+// 选中力场的位置在帧与帧之间保持稳定，AddMeshBatch 的筛选结果也能直接对应到 Shader。
+// 返回需要上传的记录数（最后一个占用位置 + 1）。
+static uint32 PackRealityDistortionFields(TArrayView<FRealityDistortionPackedField> OutPackedFields)
+{
+	const FRealityDistortionFieldsView Fields = GetRealityDistortionFields_RenderThread();
+	const FRealityDistortionFieldSelection& Selection = GetRealityDistortionFieldSelection_RenderThread();
+	check(Selection.NumBufferSlots <= OutPackedFields.Num());
+
+	for (int32 BufferIndex = 0; BufferIndex < Selection.NumBufferSlots; ++BufferIndex)
+	{
+		FRealityDistortionPackedField& Packed = OutPackedFields[BufferIndex];
+
+		const int32 SlotIndex = Selection.BufferToSlot[BufferIndex];
+		if (SlotIndex == INDEX_NONE)
+		{
+			Packed = FRealityDistortionPackedField();
+			continue;
+		}
+
+		Packed = PackRealityDistortionField(GetRealityDistortionFieldShape(Fields, SlotIndex), Fields.Radii[SlotIndex], Fields.Strengths[SlotIndex]);
+	}
+
+	return static_cast<uint32>(Selection.NumBufferSlots);
+}
+
+void UpdateRealityDistortionUniformBuffer_RenderThread(FRDGBuilder& GraphBuilder, const FSceneViewFamily& ViewFamily)
+{
+	check(IsInRenderingThread());
+	FRHICommandListBase& RHICmdList = GraphBuilder.RHICmdList;
+
+	TStaticArray<FRealityDistortionPackedField, MAX_DISTORTION_FIELDS> PackedFields;
+	const uint32 PackedFieldCount = PackRealityDistortionFields(PackedFields);
+
+	// 每个 ViewFamily 只上传一次，且只上传 Shader 会读到的前 PackedFieldCount 条。
+	if (PackedFieldCount > 0)
+	{
+		const uint32 UploadSize = sizeof(FRealityDistortionPackedField) * PackedFieldCount;
+		void* Data = RHICmdList.LockBuffer(GRealityDistortionSceneResources.FieldBuffer, 0, UploadSize, RLM_WriteOnly);
+		FMemory::Memcpy(Data, PackedFields.GetData(), UploadSize);
+		RHICmdList.UnlockBuffer(GRealityDistortionSceneResources.FieldBuffer);
+	}
+
+	// 分箱 Pass 在 Graph 执行时读取上面刚上传的 FieldBuffer。
+	const FRealityDistortionTileBinningResult TileBinning = AddRealityDistortionTileBinningPass_RenderThread(
+		GraphBuilder,
+		ViewFamily,
+		GRealityDistortionSceneResources.FieldBufferSRV,
+		PackedFieldCount);
+
+	// Clipmap 更新同样读取 FieldBuffer，并用 CPU 侧的打包结果找出需要重新光栅化的范围。
+	const FRealityDistortionInfluenceClipmapResult InfluenceClipmap = AddRealityDistortionInfluenceClipmapPasses_RenderThread(
+		GraphBuilder,
+		ViewFamily,
+		GRealityDistortionSceneResources.FieldBufferSRV,
+		MakeArrayView(PackedFields.GetData(), PackedFieldCount));
 
 	// Zero initialize to avoid undefined values when some fields are inactive.
 	FRealityDistortionUniformParameters Parameters{};
-
-	const TConstArrayView<FRealityDistortionFieldSettings> Fields = GetRealityDistortionFieldSettings_RenderThread();
+	Parameters.ActiveFieldCount = PackedFieldCount;
 	Parameters.GlobalDistortionScale = 1.0f;
 	Parameters.CurrentTime = static_cast<float>(FPlatformTime::Seconds());
 	Parameters.GlitchSpeed = 5.0f;
+	Parameters.FieldBuffer = GRealityDistortionSceneResources.FieldBufferSRV;
+	Parameters.NumTileViews = static_cast<uint32>(TileBinning.NumViews);
+	for (int32 ViewIndex = 0; ViewIndex < TileBinning.NumViews; ++ViewIndex)
+	{
+		const FRealityDistortionTileView& TileView = TileBinning.Views[ViewIndex];
+		Parameters.TileViewOrigins[ViewIndex] = FVector4f(TileView.Origin, TileView.ProjectionScale.X);
+		Parameters.TileViewForwards[ViewIndex] = FVector4f(TileView.Forward, TileView.ProjectionScale.Y);
+		Parameters.TileViewGrids[ViewIndex] = FUintVector4(TileView.TileGridSize.X, TileView.TileGridSize.Y, TileView.FirstTileMask, 0);
+	}
+	Parameters.FieldTileMasks = TileBinning.FieldTileMasksSRV
+		? TileBinning.FieldTileMasksSRV
+		: GRealityDistortionSceneResources.EmptyTileMasksSRV.GetReference();
+	Parameters.InfluenceClipmapWorldMin = InfluenceClipmap.WorldMin;
+	Parameters.InfluenceClipmapVoxelSize = InfluenceClipmap.VoxelSize;
+	Parameters.InfluenceClipmapResolution = InfluenceClipmap.Resolution;
+	Parameters.InfluenceClipmap = InfluenceClipmap.Texture ? InfluenceClipmap.Texture : GBlackVolumeTexture->TextureRHI.GetReference();
+	// 环形寻址：纹理坐标直接用 世界坐标 / Clipmap 尺寸，靠 Wrap 折回。
+	Parameters.InfluenceClipmapSampler = TStaticSamplerState<SF_Bilinear, AM_Wrap, AM_Wrap, AM_Wrap>::GetRHI();
+	Parameters.VoronoiQuality = static_cast<uint32>(GetRealityDistortionVoronoiQuality_RenderThread());
+	Parameters.VoronoiNoiseTexture = GetRealityDistortionVoronoiNoiseTexture_RenderThread();
+	Parameters.VoronoiNoiseSampler = GetRealityDistortionVoronoiNoiseSampler_RenderThread();
+
+	GRealityDistortionSceneResources.UpdateUniformBuffer(RHICmdList, Parameters);
+}
+
+FRHIUniformBuffer* GetRealityDistortionUniformBuffer_RenderThread()
+{
+	check(IsInRenderingThread() || IsInParallelRenderingThread());
+	return GRealityDistortionSceneResources.UniformBuffer.GetReference();
+}
 
-	auto PackField = [&Parameters](uint32 PackedIndex, const FRealityDistortionFieldSettings& Field)
+bool IsRealityDistortionVertexFactoryAllowed(const FVertexFactoryType* VertexFactoryType)
+{
+	// 只读 CVar 在进程内不变，解析一次（ShouldCompilePermutation 是热路径）。
+	static const TSet<FName> AllowedVertexFactoryTypes = []()
 	{
-		switch (PackedIndex)
+		TArray<FString> TypeNames;
+		CVarRealityDistortionShaderVertexFactories.GetValueOnAnyThread().ParseIntoArray(TypeNames, TEXT(","), true);
+
+		TSet<FName> Result;
+		for (const FString& TypeName : TypeNames)
 		{
-		case 0:
-			Parameters.Field0_Center = FVector3f(Field.Center);
-			Parameters.Field0_Radius = Field.Radius;
-			Parameters.Field0_Strength = Field.Strength;
-			break;
-		case 1:
-			Parameters.Field1_Center = FVector3f(Field.Center);
-			Parameters.Field1_Radius = Field.Radius;
-			Parameters.Field1_Strength = Field.Strength;
-			break;
-		case 2:
-			Parameters.Field2_Center = FVector3f(Field.Center);
-			Parameters.Field2_Radius = Field.Radius;
-			Parameters.Field2_Strength = Field.Strength;
-			break;
-		case 3:
-			Parameters.Field3_Center = FVector3f(Field.Center);
-			Parameters.Field3_Radius = Field.Radius;
-			Parameters.Field3_Strength = Field.Strength;
-			break;
-		default:
-			break;
+			Result.Add(FName(*TypeName.TrimStartAndEnd()));
 		}
-	};
+		return Result;
+	}();
+
+	return AllowedVertexFactoryTypes.IsEmpty()
+		|| (VertexFactoryType != nullptr && AllowedVertexFactoryTypes.Contains(VertexFactoryType->GetFName()));
+}
 
-	uint32 PackedFieldCount = 0;
-	for (const FRealityDistortionFieldSettings& Field : Fields)
+bool IsRealityDistortionMaterialAllowed(const UMaterialInterface* Material)
+{
+	static const TSet<FString> AllowedMaterialPaths = []()
 	{
-		if (!Field.bEnabled || Field.Radius <= 0.0f)
+		TArray<FString> MaterialPaths;
+		CVarRealityDistortionPassMaterials.GetValueOnAnyThread().ParseIntoArray(MaterialPaths, TEXT(","), true);
+
+		TSet<FString> Result;
+		for (const FString& MaterialPath : MaterialPaths)
 		{
-			continue;
+			Result.Add(MaterialPath.TrimStartAndEnd());
 		}
+		return Result;
+	}();
 
-		PackField(PackedFieldCount, Field);
-		++PackedFieldCount;
-		if (PackedFieldCount >= MAX_DISTORTION_FIELDS)
+	if (AllowedMaterialPaths.IsEmpty())
+	{
+		return Material != nullptr;
+	}
+
+	// 沿材质实例的 Parent 链向上，任意一级在列表里即允许。
+	for (const UMaterialInterface* Current = Material; Current != nullptr; )
+	{
+		if (AllowedMaterialPaths.Contains(Current->GetPathName()))
 		{
-			break;
+			return true;
 		}
+
+		const UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(Current);
+		Current = MaterialInstance != nullptr ? MaterialInstance->Parent.Get() : nullptr;
+	}
+	return false;
+}
+
+bool IsRealityDistortionVertexInfluenceEnabled()
+{
+	return CVarRealityDistortionVertexInfluence.GetValueOnAnyThread() != 0;
+}
+
+bool ShouldCompileRealityDistortionShaders(const FMeshMaterialShaderPermutationParameters& Parameters, ERealityDistortionShaderFilter Filters)
+{
+	if (!IsOpaqueOrMaskedBlendMode(Parameters.MaterialParameters.BlendMode)
+		|| Parameters.MaterialParameters.MaterialDomain != MD_Surface)
+	{
+		return false;
 	}
-	Parameters.ActiveFieldCount = PackedFieldCount;
 
-	return TUniformBufferRef<FRealityDistortionUniformParameters>::CreateUniformBufferImmediate(
-		Parameters,
-		UniformBuffer_SingleFrame);
+	return !EnumHasAnyFlags(Filters, ERealityDistortionShaderFilter::VertexFactoryAllowlist)
+		|| IsRealityDistortionVertexFactoryAllowed(Parameters.VertexFactoryType);
 }
 
 IMPLEMENT_MATERIAL_SHADER_TYPE(
@@ -1,4 +1,4 @@
-// RealityDistortionShaders.h
+﻿// RealityDistortionShaders.h
 //
 // Reality Distortion Shader Declarations
 // ---------------------------------------
@@ -13,51 +13,151 @@
 #include "ShaderParameterStruct.h"
 #include "MeshMaterialShader.h"
 #include "MeshDrawShaderBindings.h"
+#include "RealityDistortionDefinitions.h"
+
+class FRDGBuilder;
+class FSceneViewFamily;
+class UMaterialInterface;
+struct FRealityDistortionFieldShape;
 
 // ============================================================================
 // Uniform Buffer - 力场参数
 // ============================================================================
-// 最多支持 4 个力场
-#define MAX_DISTORTION_FIELDS 4
-
-// Uniform Buffer 结构体
-// 注意：为了避免结构体数组的对齐问题，这里展开为单独的字段
+// 力场数据不再展开成 FieldN_* 字段，而是打包进一个 StructuredBuffer：
+// 每个力场占 REALITY_DISTORTION_FIELD_STRIDE 个 float4，布局见 RealityDistortionDefinitions.h。
+// Buffer 下标与注册表槽位一一对应，Shader 按 ActiveFieldCount 循环。
 BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FRealityDistortionUniformParameters, REALITYDISTORTION_API)
 	SHADER_PARAMETER(uint32, ActiveFieldCount)
 	SHADER_PARAMETER(float, GlobalDistortionScale)
 	SHADER_PARAMETER(float, CurrentTime)
 	SHADER_PARAMETER(float, GlitchSpeed)
-
-	// Field 0
-	SHADER_PARAMETER(FVector3f, Field0_Center)
-	SHADER_PARAMETER(float, Field0_Radius)
-	SHADER_PARAMETER(float, Field0_Strength)
-	SHADER_PARAMETER(float, Field0_Padding)
-
-	// Field 1
-	SHADER_PARAMETER(FVector3f, Field1_Center)
-	SHADER_PARAMETER(float, Field1_Radius)
-	SHADER_PARAMETER(float, Field1_Strength)
-	SHADER_PARAMETER(float, Field1_Padding)
-
-	// Field 2
-	SHADER_PARAMETER(FVector3f, Field2_Center)
-	SHADER_PARAMETER(float, Field2_Radius)
-	SHADER_PARAMETER(float, Field2_Strength)
-	SHADER_PARAMETER(float, Field2_Padding)
-
-	// Field 3
-	SHADER_PARAMETER(FVector3f, Field3_Center)
-	SHADER_PARAMETER(float, Field3_Radius)
-	SHADER_PARAMETER(float, Field3_Strength)
-	SHADER_PARAMETER(float, Field3_Padding)
+	SHADER_PARAMETER_SRV(StructuredBuffer<float4>, FieldBuffer)
+	// 屏幕 Tile 分箱结果（见 RealityDistortionTiledCulling.h）：NumTileViews 为 0 表示本 ViewFamily 没有分箱。
+	// 每个 View 一条记录：Origins = (相机位置, 投影 [0][0])，Forwards = (相机朝向, 投影 [1][1])，
+	// Grids = (Tile 列数, Tile 行数, 第一个 Tile 的掩码下标, 0)。
+	SHADER_PARAMETER(uint32, NumTileViews)
+	SHADER_PARAMETER_ARRAY(FVector4f, TileViewOrigins, [REALITY_DISTORTION_MAX_TILE_VIEWS])
+	SHADER_PARAMETER_ARRAY(FVector4f, TileViewForwards, [REALITY_DISTORTION_MAX_TILE_VIEWS])
+	SHADER_PARAMETER_ARRAY(FUintVector4, TileViewGrids, [REALITY_DISTORTION_MAX_TILE_VIEWS])
+	SHADER_PARAMETER_SRV(StructuredBuffer<uint2>, FieldTileMasks)
+	// 影响度 Clipmap（见 RealityDistortionInfluenceClipmap.h）：InfluenceClipmapResolution 为 0 表示走解析路径。
+	// 纹素为 (影响度, clip 距离)。
+	SHADER_PARAMETER(FVector3f, InfluenceClipmapWorldMin)
+	SHADER_PARAMETER(float, InfluenceClipmapVoxelSize)
+	SHADER_PARAMETER(uint32, InfluenceClipmapResolution)
+	SHADER_PARAMETER_TEXTURE(Texture3D<float2>, InfluenceClipmap)
+	SHADER_PARAMETER_SAMPLER(SamplerState, InfluenceClipmapSampler)
+	// Voronoi 裂纹质量档位（见 RealityDistortionVoronoi.h），MainPS 用 RD_VoronoiEdgeTiered 绘制裂纹。
+	SHADER_PARAMETER(uint32, VoronoiQuality)
+	SHADER_PARAMETER_TEXTURE(Texture3D<float2>, VoronoiNoiseTexture)
+	SHADER_PARAMETER_SAMPLER(SamplerState, VoronoiNoiseSampler)
 END_GLOBAL_SHADER_PARAMETER_STRUCT()
 
+// CPU 侧的打包记录，与 HLSL 的 RD_LoadField 一一对应。
+struct FRealityDistortionPackedField
+{
+	// xyz = 世界空间中心，w = 包围球半径（<= 0 表示该槽位未启用）
+	FVector4f CenterAndRadius = FVector4f(0.0f, 0.0f, 0.0f, 0.0f);
+	// x = 强度，y = 形状（REALITY_DISTORTION_FIELD_SHAPE_*），zw 预留
+	FVector4f Params = FVector4f(0.0f, 0.0f, 0.0f, 0.0f);
+	// 局部 → 世界旋转四元数 (x, y, z, w)
+	FVector4f Rotation = FVector4f(0.0f, 0.0f, 0.0f, 1.0f);
+	// xyz = 形状 Extent，w = 1 / 衰减距离（球形不使用）
+	FVector4f ExtentAndInvFalloff = FVector4f(0.0f, 0.0f, 0.0f, 0.0f);
+
+	// 影响度只取决于几何（强度除外），Clipmap 据此判断是否需要重新光栅化。
+	bool HasSameGeometry(const FRealityDistortionPackedField& Other) const
+	{
+		return CenterAndRadius == Other.CenterAndRadius
+			&& Params.Y == Other.Params.Y
+			&& Rotation == Other.Rotation
+			&& ExtentAndInvFalloff == Other.ExtentAndInvFalloff;
+	}
+};
+static_assert(sizeof(FRealityDistortionPackedField) == REALITY_DISTORTION_FIELD_STRIDE * sizeof(FVector4f),
+	"FRealityDistortionPackedField must match REALITY_DISTORTION_FIELD_STRIDE");
+
+// 打包一个力场（Uniform Buffer 上传与 CPU 参考实现共用）。BoundingRadius 为注册表里的包围球半径。
+REALITYDISTORTION_API FRealityDistortionPackedField PackRealityDistortionField(const FRealityDistortionFieldShape& Shape, float BoundingRadius, float Strength);
+
 // ============================================================================
-// 辅助函数 - 构建 Uniform Buffer
+// 辅助函数 - 常驻 Uniform Buffer
 // ============================================================================
-// 从 RT 侧的力场数据构建 Uniform Buffer
-REALITYDISTORTION_API TUniformBufferRef<FRealityDistortionUniformParameters> CreateRealityDistortionUniformBuffer();
+// Uniform Buffer 只创建一次（UniformBuffer_MultiFrame），之后每个 ViewFamily 原地更新内容。
+// DrawCommand 持有的是同一个 Buffer 的引用，所以缓存的 DrawCommand 也能读到最新力场。
+
+// 从 RT 侧的力场数据重新打包并更新 Uniform Buffer（由 FRealityDistortionViewExtension 调用）。
+// 同时为该 ViewFamily 添加屏幕 Tile 分箱 Pass，结果一并写入 Uniform Buffer。
+REALITYDISTORTION_API void UpdateRealityDistortionUniformBuffer_RenderThread(FRDGBuilder& GraphBuilder, const FSceneViewFamily& ViewFamily);
+
+// 获取常驻 Uniform Buffer，供 PassProcessor 填入 ShaderElementData。
+REALITYDISTORTION_API FRHIUniformBuffer* GetRealityDistortionUniformBuffer_RenderThread();
+
+// ============================================================================
+// ShaderElementData - 每个 DrawCommand 的附加绑定数据
+// ============================================================================
+static_assert(REALITY_DISTORTION_MAX_FIELDS <= REALITY_DISTORTION_FIELD_MASK_WORDS * 32,
+	"Relevant-field mask must cover every field slot");
+
+class FRealityDistortionShaderElementData : public FMeshMaterialShaderElementData
+{
+public:
+	FRHIUniformBuffer* RealityDistortionUniformBuffer = nullptr;
+
+	// AddMeshBatch 粗筛得到的“与该接收体相交的力场槽位”位掩码（bit i = 槽位 i）。
+	// PS 只遍历这些槽位，而不是全部 ActiveFieldCount。
+	uint64 RelevantFieldMask = 0;
+
+	// 展开变体（FRealityDistortionPS::FUnrolledFieldCountDim > 0）直接读取的槽位下标，未用到的分量重复最后一个槽位。
+	FUintVector4 RelevantFieldSlots = FUintVector4(0, 0, 0, 0);
+
+	// 顶点阶段影响度变体使用：该 DrawCommand 最长三角形边的世界空间长度，负数表示未知（PS 不做“完全在外”跳过）。
+	float MaxTriangleEdgeLength = -1.0f;
+
+	FUintVector2 GetRelevantFieldMaskWords() const
+	{
+		return FUintVector2(static_cast<uint32>(RelevantFieldMask), static_cast<uint32>(RelevantFieldMask >> 32));
+	}
+};
+
+// ============================================================================
+// 编译范围
+// ============================================================================
+// 本 Pass 的 VS/PS 只为不透明 / Masked 的 Surface 材质编译，并且只针对 r.RealityDistortion.ShaderVertexFactories
+// 列出的 VertexFactory（只读，默认只有 FLocalVertexFactory）。
+// 引擎的 FMaterialShaderParameters 不带材质身份，编译期无法按材质过滤；哪些材质能进入本 Pass 由
+// r.RealityDistortion.PassMaterials 在选择绘制材质时决定（见 IsRealityDistortionMaterialAllowed / GetDistortionPassMaterial）。
+enum class ERealityDistortionShaderFilter : uint8
+{
+	None = 0,
+	VertexFactoryAllowlist = 1 << 0,
+	All = VertexFactoryAllowlist,
+};
+ENUM_CLASS_FLAGS(ERealityDistortionShaderFilter);
+
+// Filters 只用于 RealityDistortionShaderStats 命令行分别统计各过滤条件省下的 Shader 数；编译时始终使用 All。
+REALITYDISTORTION_API bool ShouldCompileRealityDistortionShaders(
+	const FMeshMaterialShaderPermutationParameters& Parameters,
+	ERealityDistortionShaderFilter Filters = ERealityDistortionShaderFilter::All);
+
+// VertexFactory 是否在 r.RealityDistortion.ShaderVertexFactories 允许列表里（列表为空时全部允许）。
+REALITYDISTORTION_API bool IsRealityDistortionVertexFactoryAllowed(const FVertexFactoryType* VertexFactoryType);
+
+// 材质（或它所在 Parent 链上的任意一级）是否在 r.RealityDistortion.PassMaterials 里（列表为空时全部允许，nullptr 不允许）。
+REALITYDISTORTION_API bool IsRealityDistortionMaterialAllowed(const UMaterialInterface* Material);
+
+// r.RealityDistortion.VertexInfluence：是否使用顶点阶段影响度变体（任意线程可调用）。
+REALITYDISTORTION_API bool IsRealityDistortionVertexInfluenceEnabled();
+
+// ============================================================================
+// 顶点阶段影响度
+// ============================================================================
+// VS 逐顶点输出影响度、前 4 个相关槽位的有符号 clip 距离（RD_INSIDE_METRICS：RD_CalculateFieldClipDistance，
+// 即 SDF + f·FalloffDistance，f = REALITY_DISTORTION_INFLUENCE_CLIP_FALLOFF_FRACTION），以及所有相关力场 clip 距离的最小值
+// （RD_INFLUENCE_OUTSIDE_DISTANCE，到外界的距离下界）；
+// 插值后 PS 能证明像素完全在某个力场内（用插值影响度，近似）或完全在所有力场外（丢弃），
+// 只有力场边界附近的像素才执行精确判定。后者需要每个 DrawCommand 的最长三角形边（MaxTriangleEdgeLength）。
+class FRealityDistortionVertexInfluenceDim : SHADER_PERMUTATION_BOOL("REALITY_DISTORTION_VERTEX_INFLUENCE");
 
 // ============================================================================
 // Vertex Shader
@@ -67,19 +167,23 @@ class FRealityDistortionVS : public FMeshMaterialShader
 	DECLARE_SHADER_TYPE(FRealityDistortionVS, MeshMaterial);
 
 public:
+	using FPermutationDomain = TShaderPermutationDomain<FRealityDistortionVertexInfluenceDim>;
+
 	FRealityDistortionVS() = default;
 	FRealityDistortionVS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
 		: FMeshMaterialShader(Initializer)
 	{
 		// 绑定 Uniform Buffer
 		RealityDistortionParameters.Bind(Initializer.ParameterMap, TEXT("RealityDistortionParameters"));
+		// 只有顶点阶段影响度变体会用到。
+		RelevantFieldMask.Bind(Initializer.ParameterMap, TEXT("RelevantFieldMask"));
+		RelevantFieldSlots.Bind(Initializer.ParameterMap, TEXT("RelevantFieldSlots"));
 	}
 
 	static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& Parameters)
 	{
-		// 只为不透明和 Masked 材质编译
-		return IsOpaqueOrMaskedBlendMode(Parameters.MaterialParameters.BlendMode)
-			&& Parameters.MaterialParameters.MaterialDomain == MD_Surface;
+		// 只为不透明和 Masked 材质、允许列表里的 VertexFactory 编译
+		return ShouldCompileRealityDistortionShaders(Parameters);
 	}
 
 	static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
@@ -94,39 +198,62 @@ public:
 		const FPrimitiveSceneProxy* PrimitiveSceneProxy,
 		const FMaterialRenderProxy& MaterialRenderProxy,
 		const FMaterial& Material,
-		const FMeshMaterialShaderElementData& ShaderElementData,
+		const FRealityDistortionShaderElementData& ShaderElementData,
 		FMeshDrawSingleShaderBindings& ShaderBindings) const
 	{
 		FMeshMaterialShader::GetShaderBindings(Scene, FeatureLevel, PrimitiveSceneProxy, MaterialRenderProxy, Material, ShaderElementData, ShaderBindings);
 
-		// 绑定 Uniform Buffer
-		TUniformBufferRef<FRealityDistortionUniformParameters> UniformBuffer = CreateRealityDistortionUniformBuffer();
-		ShaderBindings.Add(RealityDistortionParameters, UniformBuffer);
+		// 按引用绑定常驻 Uniform Buffer（由 ViewExtension 每个 ViewFamily 更新一次）。
+		ShaderBindings.Add(RealityDistortionParameters, ShaderElementData.RealityDistortionUniformBuffer);
+		ShaderBindings.Add(RelevantFieldMask, ShaderElementData.GetRelevantFieldMaskWords());
+		ShaderBindings.Add(RelevantFieldSlots, ShaderElementData.RelevantFieldSlots);
 	}
 
 private:
 	LAYOUT_FIELD(FShaderUniformBufferParameter, RealityDistortionParameters);
+	LAYOUT_FIELD(FShaderParameter, RelevantFieldMask);
+	LAYOUT_FIELD(FShaderParameter, RelevantFieldSlots);
 };
 
 // ============================================================================
 // Pixel Shader
 // ============================================================================
+// FUnrolledFieldCountDim 是 PS 完全展开、无分支求值的力场数（从 RelevantFieldSlots 读取槽位，多余分量重复最后一个槽位）；
+// 为 0 时不展开，按掩码循环并使用 Tile 分箱 / 影响度 Clipmap。变体在 FRealityDistortionPassProcessor::Process 里选择。
+// 只保留 1 和 4：单力场是最常见的场景；2 / 3 个力场用 4 的变体，多算的一两个力场只是 ALU，
+// 比再加一个变体（乘以材质、VertexFactory 与顶点阶段影响度维度）便宜。
+// FRealityDistortionVertexInfluenceDim 必须与 VS 一致（VS 输出的插值量只在该变体里声明）。
 class FRealityDistortionPS : public FMeshMaterialShader
 {
 	DECLARE_SHADER_TYPE(FRealityDistortionPS, MeshMaterial);
 
 public:
+	class FUnrolledFieldCountDim : SHADER_PERMUTATION_SPARSE_INT("REALITY_DISTORTION_UNROLLED_FIELD_COUNT", 0, 1, 4);
+	using FPermutationDomain = TShaderPermutationDomain<FUnrolledFieldCountDim, FRealityDistortionVertexInfluenceDim>;
+
+	// 覆盖 NumRelevantFields 个力场的最小展开数；超过 4 个时返回 0（不展开）。
+	static int32 GetUnrolledFieldCount(int32 NumRelevantFields)
+	{
+		if (NumRelevantFields <= 1)
+		{
+			return 1;
+		}
+		return NumRelevantFields <= 4 ? 4 : 0;
+	}
+
 	FRealityDistortionPS() = default;
 	FRealityDistortionPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
 		: FMeshMaterialShader(Initializer)
 	{
 		RealityDistortionParameters.Bind(Initializer.ParameterMap, TEXT("RealityDistortionParameters"));
+		RelevantFieldMask.Bind(Initializer.ParameterMap, TEXT("RelevantFieldMask"));
+		RelevantFieldSlots.Bind(Initializer.ParameterMap, TEXT("RelevantFieldSlots"));
+		MaxTriangleEdgeLength.Bind(Initializer.ParameterMap, TEXT("MaxTriangleEdgeLength"));
 	}
 
 	static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& Parameters)
 	{
-		return IsOpaqueOrMaskedBlendMode(Parameters.MaterialParameters.BlendMode)
-			&& Parameters.MaterialParameters.MaterialDomain == MD_Surface;
+		return ShouldCompileRealityDistortionShaders(Parameters);
 	}
 
 	static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
@@ -141,15 +268,21 @@ public:
 		const FPrimitiveSceneProxy* PrimitiveSceneProxy,
 		const FMaterialRenderProxy& MaterialRenderProxy,
 		const FMaterial& Material,
-		const FMeshMaterialShaderElementData& ShaderElementData,
+		const FRealityDistortionShaderElementData& ShaderElementData,
 		FMeshDrawSingleShaderBindings& ShaderBindings) const
 	{
 		FMeshMaterialShader::GetShaderBindings(Scene, FeatureLevel, PrimitiveSceneProxy, MaterialRenderProxy, Material, ShaderElementData, ShaderBindings);
 
-		TUniformBufferRef<FRealityDistortionUniformParameters> UniformBuffer = CreateRealityDistortionUniformBuffer();
-		ShaderBindings.Add(RealityDistortionParameters, UniformBuffer);
+		ShaderBindings.Add(RealityDistortionParameters, ShaderElementData.RealityDistortionUniformBuffer);
+		// 每个 DrawCommand 的相关力场掩码 / 槽位（Loose 参数，不展开的变体只用掩码，展开变体只用槽位）。
+		ShaderBindings.Add(RelevantFieldMask, ShaderElementData.GetRelevantFieldMaskWords());
+		ShaderBindings.Add(RelevantFieldSlots, ShaderElementData.RelevantFieldSlots);
+		ShaderBindings.Add(MaxTriangleEdgeLength, ShaderElementData.MaxTriangleEdgeLength);
 	}
 
 private:
 	LAYOUT_FIELD(FShaderUniformBufferParameter, RealityDistortionParameters);
+	LAYOUT_FIELD(FShaderParameter, RelevantFieldMask);
+	LAYOUT_FIELD(FShaderParameter, RelevantFieldSlots);
+	LAYOUT_FIELD(FShaderParameter, MaxTriangleEdgeLength);
 };
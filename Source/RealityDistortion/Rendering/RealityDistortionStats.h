@@ -0,0 +1,59 @@
+﻿// RealityDistortionStats.h
+//
+// RealityDistortion 统计项
+// ------------------------
+// 统一声明 stat group，`stat RealityDistortion` 可在运行时查看。
+// 各计数器在使用它的 .cpp 中 DEFINE_STAT。
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("RealityDistortion"), STATGROUP_RealityDistortion, STATCAT_Advanced);
+
+// Uniform Buffer：新建（含 RHI 资源释放后的重建）/ 原地更新的次数（正常情况下新建只在启动时出现一次，更新为每个 ViewFamily 一次）。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Uniform Buffers Created"), STAT_RealityDistortion_UniformBuffersCreated, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Uniform Buffer Updates"), STAT_RealityDistortion_UniformBufferUpdates, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// 缓存 DrawCommand 的接收体：当前数量 / 因相关力场变化而重建缓存的次数。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cached Receivers"), STAT_RealityDistortion_CachedReceivers, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cached Receiver Invalidations"), STAT_RealityDistortion_CachedReceiverInvalidations, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// 力场 GT→RT 更新：实际推送 / 因无变化跳过的次数；RT 消费的增量数，以及队列写满触发同步排空的次数。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Field Updates Pushed"), STAT_RealityDistortion_FieldUpdatesPushed, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Field Updates Skipped"), STAT_RealityDistortion_FieldUpdatesSkipped, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Field Deltas Drained"), STAT_RealityDistortion_FieldDeltasDrained, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Field Queue Overflows"), STAT_RealityDistortion_FieldQueueOverflows, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// RT 按帧时间求值的动画力场数（这些力场没有逐帧的 GT→RT 推送）。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Fields Animated"), STAT_RealityDistortion_FieldsAnimated, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// RT 在两次推送之间做运动预测的降频力场数（r.RealityDistortion.FieldMotionPrediction）。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Fields Predicted"), STAT_RealityDistortion_FieldsPredicted, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// 材质 Shader 解析缓存未命中次数（正常情况下只在材质首次出现或重新编译后出现）。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shader Cache Misses"), STAT_RealityDistortion_ShaderCacheMisses, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// 实例化接收体：逐实例测试的实例数（剔除结果缓存命中时不计）/ 提交到 RealityDistortion Pass 的实例数（每个接收体每个 ViewFamily 计一次，
+// 不随 Section 数与 View 数翻倍）。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances Tested"), STAT_RealityDistortion_InstancesTested, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances Submitted"), STAT_RealityDistortion_InstancesSubmitted, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// 大接收体簇剔除：提交到 RealityDistortion Pass 的三角形数 / 因不与力场相交而被剔除的三角形数。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Triangles Submitted"), STAT_RealityDistortion_TrianglesSubmitted, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Triangles Culled"), STAT_RealityDistortion_TrianglesCulled, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// 休眠判定：当前激活 / 休眠的接收体数，以及请求切换休眠状态（重建 Proxy）的次数。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Active Receivers"), STAT_RealityDistortion_ActiveReceivers, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dormant Receivers"), STAT_RealityDistortion_DormantReceivers, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Receiver Dormancy Changes"), STAT_RealityDistortion_ReceiverDormancyChanges, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// 每个 ViewFamily 的力场选择：启用的力场 / 视锥外 / 可见但超出预算未上传（力场饥饿）/ 上传的力场数。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Fields Active"), STAT_RealityDistortion_FieldsActive, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Fields Frustum Culled"), STAT_RealityDistortion_FieldsFrustumCulled, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Fields Over Budget"), STAT_RealityDistortion_FieldsOverBudget, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Fields Selected"), STAT_RealityDistortion_FieldsSelected, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
+
+// 影响度 Clipmap：本帧重新光栅化的体素数（相机移动露出的切片 + 力场移动的包围范围）。
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Clipmap Voxels Updated"), STAT_RealityDistortion_ClipmapVoxelsUpdated, STATGROUP_RealityDistortion, REALITYDISTORTION_API);
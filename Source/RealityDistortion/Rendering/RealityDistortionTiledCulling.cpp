@@ -0,0 +1,300 @@
+﻿// RealityDistortionTiledCulling.cpp
+
+#include "Rendering/RealityDistortionTiledCulling.h"
+
+#include "DataDrivenShaderPlatformInfo.h"
+#include "GlobalShader.h"
+#include "HAL/IConsoleManager.h"
+#include "RealityDistortion.h"
+#include "RealityDistortionField.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "RenderResource.h"
+#include "Rendering/RealityDistortionShaders.h"
+#include "SceneView.h"
+#include "ShaderParameterStruct.h"
+
+namespace
+{
+	static TAutoConsoleVariable<int32> CVarRealityDistortionTiledCulling(
+		TEXT("r.RealityDistortion.TiledCulling"),
+		1,
+		TEXT("Bin fields into screen tiles once per view so pixels only evaluate the fields of their own tile. 0=Off, 1=On (default)"),
+		ECVF_RenderThreadSafe);
+
+	static TAutoConsoleVariable<int32> CVarRealityDistortionTiledCullingTileSize(
+		TEXT("r.RealityDistortion.TiledCulling.TileSize"),
+		32,
+		TEXT("Screen tile size in (unscaled) pixels used for field binning. Clamped to [8, 256]."),
+		ECVF_RenderThreadSafe);
+
+	// 抖动（TAA Jitter）最多偏移约 1 个渲染像素，分箱时每边多留 2 个像素。
+	constexpr float TileBinningMarginPixels = 2.0f;
+
+	// 常驻的 Tile 掩码 Buffer：视口变大时按 1024 个 Tile 对齐重新分配，否则跨帧复用。
+	class FRealityDistortionTileMaskResources : public FRenderResource
+	{
+	public:
+		virtual void ReleaseRHI() override
+		{
+			FieldTileMasksSRV.SafeRelease();
+			FieldTileMasks.SafeRelease();
+		}
+
+		TRefCountPtr<FRDGPooledBuffer> FieldTileMasks;
+		FShaderResourceViewRHIRef FieldTileMasksSRV;
+	};
+
+	TGlobalResource<FRealityDistortionTileMaskResources> GRealityDistortionTileMaskResources;
+}
+
+class FRealityDistortionTileBinningCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FRealityDistortionTileBinningCS);
+	SHADER_USE_PARAMETER_STRUCT(FRealityDistortionTileBinningCS, FGlobalShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FMatrix44f, TranslatedWorldToClip)
+		SHADER_PARAMETER(FVector3f, PreViewTranslation)
+		SHADER_PARAMETER(FVector2f, UVMargin)
+		SHADER_PARAMETER(FUintVector2, TileGridSize)
+		SHADER_PARAMETER(uint32, FirstTileMask)
+		SHADER_PARAMETER(uint32, FieldCount)
+		SHADER_PARAMETER_SRV(StructuredBuffer<float4>, FieldBuffer)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<uint2>, RWFieldTileMasks)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(
+	FRealityDistortionTileBinningCS,
+	"/Plugin/RealityDistortion/Private/RealityDistortionTileBinning.usf",
+	"BinFieldsCS",
+	SF_Compute);
+
+bool ComputeRealityDistortionFieldTileRect(
+	const FMatrix44f& TranslatedWorldToClip,
+	const FVector3f& TranslatedCenter,
+	float Radius,
+	const FVector2f& UVMargin,
+	const FUintVector2& TileGridSize,
+	FUintVector4& OutTileRect)
+{
+	// 与 HLSL RD_ComputeFieldTileRect 逐行对应。
+	OutTileRect = FUintVector4(0, 0, 0, 0);
+
+	FVector2f UVMin(1.0e10f, 1.0e10f);
+	FVector2f UVMax(-1.0e10f, -1.0e10f);
+	uint32 NumCornersBehind = 0;
+
+	for (uint32 Corner = 0; Corner < 8; ++Corner)
+	{
+		const FVector3f CornerOffset(
+			(Corner & 1) ? Radius : -Radius,
+			(Corner & 2) ? Radius : -Radius,
+			(Corner & 4) ? Radius : -Radius);
+		const FVector4f ClipPosition = TranslatedWorldToClip.TransformFVector4(FVector4f(TranslatedCenter + CornerOffset, 1.0f));
+
+		if (ClipPosition.W <= REALITY_DISTORTION_TILE_MIN_CLIP_W)
+		{
+			++NumCornersBehind;
+			continue;
+		}
+
+		const FVector2f ViewportUV(
+			ClipPosition.X / ClipPosition.W * 0.5f + 0.5f,
+			ClipPosition.Y / ClipPosition.W * -0.5f + 0.5f);
+		UVMin = UVMin.ComponentMin(ViewportUV);
+		UVMax = UVMax.ComponentMax(ViewportUV);
+	}
+
+	if (NumCornersBehind == 8)
+	{
+		return false;
+	}
+
+	if (NumCornersBehind > 0)
+	{
+		UVMin = FVector2f(0.0f, 0.0f);
+		UVMax = FVector2f(1.0f, 1.0f);
+	}
+
+	UVMin -= UVMargin;
+	UVMax += UVMargin;
+	if (UVMax.X < 0.0f || UVMax.Y < 0.0f || UVMin.X > 1.0f || UVMin.Y > 1.0f)
+	{
+		return false;
+	}
+
+	const FVector2f GridSize(static_cast<float>(TileGridSize.X), static_cast<float>(TileGridSize.Y));
+	OutTileRect.X = static_cast<uint32>(FMath::Clamp(FMath::FloorToFloat(UVMin.X * GridSize.X), 0.0f, GridSize.X - 1.0f));
+	OutTileRect.Y = static_cast<uint32>(FMath::Clamp(FMath::FloorToFloat(UVMin.Y * GridSize.Y), 0.0f, GridSize.Y - 1.0f));
+	OutTileRect.Z = static_cast<uint32>(FMath::Clamp(FMath::FloorToFloat(UVMax.X * GridSize.X), 0.0f, GridSize.X - 1.0f));
+	OutTileRect.W = static_cast<uint32>(FMath::Clamp(FMath::FloorToFloat(UVMax.Y * GridSize.Y), 0.0f, GridSize.Y - 1.0f));
+	return true;
+}
+
+bool MatchesRealityDistortionTileView(
+	const FRealityDistortionTileView& TileView,
+	const FVector3f& CameraOrigin,
+	const FVector3f& CameraForward,
+	const FVector2f& ProjectionScale)
+{
+	// 与 HLSL RD_MatchesTileView 逐行对应。
+	const FVector3f OriginDelta = (CameraOrigin - TileView.Origin).GetAbs();
+	return OriginDelta.GetMax() <= REALITY_DISTORTION_TILE_VIEW_ORIGIN_TOLERANCE
+		&& FVector3f::DotProduct(CameraForward, TileView.Forward) >= REALITY_DISTORTION_TILE_VIEW_MIN_FORWARD_DOT
+		&& FMath::Abs(ProjectionScale.X - TileView.ProjectionScale.X) <= FMath::Abs(ProjectionScale.X) * REALITY_DISTORTION_TILE_VIEW_PROJECTION_TOLERANCE
+		&& FMath::Abs(ProjectionScale.Y - TileView.ProjectionScale.Y) <= FMath::Abs(ProjectionScale.Y) * REALITY_DISTORTION_TILE_VIEW_PROJECTION_TOLERANCE;
+}
+
+void BinRealityDistortionFields(
+	TConstArrayView<FRealityDistortionPackedField> PackedFields,
+	const FMatrix44f& TranslatedWorldToClip,
+	const FVector3f& PreViewTranslation,
+	const FVector2f& UVMargin,
+	const FUintVector2& TileGridSize,
+	TArrayView<uint64> OutTileMasks)
+{
+	check(OutTileMasks.Num() >= static_cast<int32>(TileGridSize.X * TileGridSize.Y));
+	FMemory::Memzero(OutTileMasks.GetData(), OutTileMasks.NumBytes());
+
+	// GPU 每个 Tile 遍历全部力场；这里反过来对每个力场填充它覆盖的 Tile 范围，结果相同。
+	const int32 NumFields = FMath::Min(PackedFields.Num(), static_cast<int32>(MAX_DISTORTION_FIELDS));
+	for (int32 FieldIndex = 0; FieldIndex < NumFields; ++FieldIndex)
+	{
+		const FVector4f& CenterAndRadius = PackedFields[FieldIndex].CenterAndRadius;
+		if (CenterAndRadius.W <= 0.0f)
+		{
+			continue;
+		}
+
+		FUintVector4 TileRect;
+		if (!ComputeRealityDistortionFieldTileRect(TranslatedWorldToClip, FVector3f(CenterAndRadius) + PreViewTranslation, CenterAndRadius.W, UVMargin, TileGridSize, TileRect))
+		{
+			continue;
+		}
+
+		const uint64 FieldBit = uint64(1) << FieldIndex;
+		for (uint32 TileY = TileRect.Y; TileY <= TileRect.W; ++TileY)
+		{
+			for (uint32 TileX = TileRect.X; TileX <= TileRect.Z; ++TileX)
+			{
+				OutTileMasks[TileY * TileGridSize.X + TileX] |= FieldBit;
+			}
+		}
+	}
+}
+
+FRealityDistortionTileBinningResult AddRealityDistortionTileBinningPass_RenderThread(
+	FRDGBuilder& GraphBuilder,
+	const FSceneViewFamily& ViewFamily,
+	FRHIShaderResourceView* FieldBufferSRV,
+	uint32 FieldCount)
+{
+	check(IsInRenderingThread());
+
+	FRealityDistortionTileBinningResult Result;
+	if (CVarRealityDistortionTiledCulling.GetValueOnRenderThread() == 0
+		|| FieldCount == 0
+		|| FieldBufferSRV == nullptr
+		|| ViewFamily.GetFeatureLevel() < ERHIFeatureLevel::SM5)
+	{
+		return Result;
+	}
+
+	// 超出上限的 View 没有记录，Shader 对它们不按 Tile 过滤（结果仍然正确，只是更慢）。
+	if (ViewFamily.Views.Num() > REALITY_DISTORTION_MAX_TILE_VIEWS)
+	{
+		static bool bWarnedTooManyViews = false;
+		if (!bWarnedTooManyViews)
+		{
+			bWarnedTooManyViews = true;
+			UE_LOG(LogRealityDistortion, Warning, TEXT("[RealityDistortion] View family has %d views; tiled culling bins only the first %d, the rest evaluate every field."),
+				ViewFamily.Views.Num(), REALITY_DISTORTION_MAX_TILE_VIEWS);
+		}
+	}
+
+	// 每个 View 一个网格，依次排在同一个掩码 Buffer 里。
+	const int32 TileSize = FMath::Clamp(CVarRealityDistortionTiledCullingTileSize.GetValueOnRenderThread(), 8, 256);
+	TStaticArray<const FSceneView*, REALITY_DISTORTION_MAX_TILE_VIEWS> BinnedViews;
+	uint32 NumTiles = 0;
+	for (const FSceneView* View : ViewFamily.Views)
+	{
+		const FIntPoint ViewSize = View->UnscaledViewRect.Size();
+		if (Result.NumViews == REALITY_DISTORTION_MAX_TILE_VIEWS || ViewSize.X <= 0 || ViewSize.Y <= 0)
+		{
+			continue;
+		}
+
+		FRealityDistortionTileView& TileView = Result.Views[Result.NumViews];
+		const FMatrix& ProjectionMatrix = View->ViewMatrices.GetProjectionMatrix();
+		TileView.Origin = FVector3f(View->ViewMatrices.GetViewOrigin());
+		TileView.Forward = FVector3f(View->ViewMatrices.GetOverriddenTranslatedViewMatrix().GetColumn(2));
+		TileView.ProjectionScale = FVector2f(ProjectionMatrix.M[0][0], ProjectionMatrix.M[1][1]);
+		TileView.TileGridSize = FUintVector2(
+			static_cast<uint32>(FMath::DivideAndRoundUp(ViewSize.X, TileSize)),
+			static_cast<uint32>(FMath::DivideAndRoundUp(ViewSize.Y, TileSize)));
+		TileView.FirstTileMask = NumTiles;
+
+		NumTiles += TileView.TileGridSize.X * TileView.TileGridSize.Y;
+		BinnedViews[Result.NumViews++] = View;
+	}
+
+	if (Result.NumViews == 0)
+	{
+		return Result;
+	}
+
+	FRealityDistortionTileMaskResources& Resources = GRealityDistortionTileMaskResources;
+	if (!Resources.FieldTileMasks.IsValid() || Resources.FieldTileMasks->Desc.NumElements < NumTiles)
+	{
+		Resources.FieldTileMasks = AllocatePooledBuffer(
+			FRDGBufferDesc::CreateStructuredDesc(sizeof(FUintVector2), Align(NumTiles, 1024u)),
+			TEXT("RealityDistortion.FieldTileMasks"));
+		FRHIBuffer* TileMasksBuffer = Resources.FieldTileMasks->GetRHI();
+		Resources.FieldTileMasksSRV = GraphBuilder.RHICmdList.CreateShaderResourceView(
+			TileMasksBuffer,
+			FRHIViewDesc::CreateBufferSRV().SetTypeFromBuffer(TileMasksBuffer));
+	}
+
+	FRDGBufferRef FieldTileMasks = GraphBuilder.RegisterExternalBuffer(Resources.FieldTileMasks);
+	// 各 View 写入不重叠的区间，Pass 之间不需要 UAV 屏障。
+	FRDGBufferUAVRef FieldTileMasksUAV = GraphBuilder.CreateUAV(FieldTileMasks, ERDGUnorderedAccessViewFlags::SkipBarrier);
+	TShaderMapRef<FRealityDistortionTileBinningCS> ComputeShader(GetGlobalShaderMap(ViewFamily.GetFeatureLevel()));
+
+	for (int32 ViewIndex = 0; ViewIndex < Result.NumViews; ++ViewIndex)
+	{
+		const FSceneView& View = *BinnedViews[ViewIndex];
+		const FRealityDistortionTileView& TileView = Result.Views[ViewIndex];
+		const FIntPoint ViewSize = View.UnscaledViewRect.Size();
+
+		FRealityDistortionTileBinningCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FRealityDistortionTileBinningCS::FParameters>();
+		PassParameters->TranslatedWorldToClip = FMatrix44f(View.ViewMatrices.GetTranslatedViewProjectionMatrix());
+		PassParameters->PreViewTranslation = FVector3f(View.ViewMatrices.GetPreViewTranslation());
+		PassParameters->UVMargin = FVector2f(TileBinningMarginPixels / ViewSize.X, TileBinningMarginPixels / ViewSize.Y);
+		PassParameters->TileGridSize = TileView.TileGridSize;
+		PassParameters->FirstTileMask = TileView.FirstTileMask;
+		PassParameters->FieldCount = FieldCount;
+		PassParameters->FieldBuffer = FieldBufferSRV;
+		PassParameters->RWFieldTileMasks = FieldTileMasksUAV;
+
+		FComputeShaderUtils::AddPass(
+			GraphBuilder,
+			RDG_EVENT_NAME("RealityDistortion.TileBinning View%d %ux%u", ViewIndex, TileView.TileGridSize.X, TileView.TileGridSize.Y),
+			ComputeShader,
+			PassParameters,
+			FComputeShaderUtils::GetGroupCount(FIntPoint(TileView.TileGridSize.X, TileView.TileGridSize.Y), REALITY_DISTORTION_TILE_BINNING_GROUP_SIZE));
+	}
+
+	// MeshPass 通过常驻 Uniform Buffer 读取掩码，RDG 不跟踪这种访问：
+	// 分箱完成后切换到外部只读状态，之后本 Graph 里的 BasePass / RealityDistortion Pass 都能直接读。
+	GraphBuilder.UseExternalAccessMode(FieldTileMasks, ERHIAccess::SRVMask);
+
+	Result.FieldTileMasksSRV = Resources.FieldTileMasksSRV;
+	return Result;
+}
@@ -0,0 +1,83 @@
+﻿// RealityDistortionTiledCulling.h
+//
+// 屏幕 Tile 力场分箱
+// ------------------
+// 力场很多时，逐像素遍历接收体的全部相关力场不再划算。
+// 每个 ViewFamily 用一个 RDG Compute Pass（RealityDistortionTileBinning.usf）把启用的力场分到屏幕 Tile，
+// 每个 Tile 输出一个槽位掩码；MainPS 与 BasePass 的 clip 只遍历自己所在 Tile 的力场。
+//
+// 说明：
+// - Tile 按视口 UV 划分（数量由未缩放的 ViewRect / TileSize 决定），Shader 用 SvPositionToViewportUV 查表，
+//   与 ScreenPercentage 之后的渲染分辨率无关。
+// - 掩码 Buffer 与力场 Uniform Buffer 一样跨帧常驻，缓存的 DrawCommand 按引用读取。
+// - 分屏 / 立体等多 View 时每个 View 各自分箱（最多 REALITY_DISTORTION_MAX_TILE_VIEWS 个），掩码依次排在同一个 Buffer 里；
+//   Shader 用正在渲染的 View 的相机（位置、朝向、投影缩放）找到自己的记录。超出上限的 View 不按 Tile 过滤，并输出一次警告。
+// - ComputeRealityDistortionFieldTileRect / MatchesRealityDistortionTileView 是 HLSL RD_ComputeFieldTileRect /
+//   RD_MatchesTileView 的 CPU 镜像，两边必须同步修改。
+// - 校验见 Tests/RealityDistortionTiledCullingTests.cpp。
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "RealityDistortionDefinitions.h"
+
+class FRDGBuilder;
+class FRHIShaderResourceView;
+class FSceneViewFamily;
+struct FRealityDistortionPackedField;
+
+// 力场球覆盖的 Tile 范围（闭区间，xy = 最小 Tile，zw = 最大 Tile）。
+// 球完全在相机后方或视口外时返回 false；包围盒跨过近平面时覆盖整个视口。
+REALITYDISTORTION_API bool ComputeRealityDistortionFieldTileRect(
+	const FMatrix44f& TranslatedWorldToClip,
+	const FVector3f& TranslatedCenter,
+	float Radius,
+	const FVector2f& UVMargin,
+	const FUintVector2& TileGridSize,
+	FUintVector4& OutTileRect);
+
+// CPU 参考实现，输出与 BinFieldsCS 逐 Tile 一致：下标 = Y * TileGridSize.X + X，bit i = 槽位 i。
+REALITYDISTORTION_API void BinRealityDistortionFields(
+	TConstArrayView<FRealityDistortionPackedField> PackedFields,
+	const FMatrix44f& TranslatedWorldToClip,
+	const FVector3f& PreViewTranslation,
+	const FVector2f& UVMargin,
+	const FUintVector2& TileGridSize,
+	TArrayView<uint64> OutTileMasks);
+
+// 一个 View 的分箱记录，对应 Uniform Buffer 的 TileViewOrigins / TileViewForwards / TileViewGrids。
+struct FRealityDistortionTileView
+{
+	// 世界空间相机位置与朝向
+	FVector3f Origin = FVector3f::ZeroVector;
+	FVector3f Forward = FVector3f::ForwardVector;
+	// 投影矩阵 [0][0] / [1][1]（不受 TAA 抖动影响）
+	FVector2f ProjectionScale = FVector2f::ZeroVector;
+	FUintVector2 TileGridSize = FUintVector2(0, 0);
+	// 本 View 第一个 Tile 在掩码 Buffer 里的下标
+	uint32 FirstTileMask = 0;
+};
+
+// 相机是否就是该记录分箱时使用的相机（与 HLSL RD_MatchesTileView 一致）。
+REALITYDISTORTION_API bool MatchesRealityDistortionTileView(
+	const FRealityDistortionTileView& TileView,
+	const FVector3f& CameraOrigin,
+	const FVector3f& CameraForward,
+	const FVector2f& ProjectionScale);
+
+// 写入力场 Uniform Buffer 的分箱结果。NumViews 为 0 表示本 ViewFamily 没有分箱。
+struct FRealityDistortionTileBinningResult
+{
+	int32 NumViews = 0;
+	TStaticArray<FRealityDistortionTileView, REALITY_DISTORTION_MAX_TILE_VIEWS> Views;
+	FRHIShaderResourceView* FieldTileMasksSRV = nullptr;
+};
+
+// 为 ViewFamily 的每个 View 添加分箱 Pass（在力场 Buffer 上传之后调用）。
+// 关闭、不支持 SM5 或没有启用的力场时不添加 Pass，返回的 NumViews 为 0。
+FRealityDistortionTileBinningResult AddRealityDistortionTileBinningPass_RenderThread(
+	FRDGBuilder& GraphBuilder,
+	const FSceneViewFamily& ViewFamily,
+	FRHIShaderResourceView* FieldBufferSRV,
+	uint32 FieldCount);
@@ -0,0 +1,44 @@
+﻿// RealityDistortionViewExtension.cpp
+
+#include "Rendering/RealityDistortionViewExtension.h"
+
+#include "RealityDistortionField.h"
+#include "RenderGraphBuilder.h"
+#include "Rendering/DistortionSceneProxy.h"
+#include "Rendering/RealityDistortionFieldCulling.h"
+#include "Rendering/RealityDistortionFieldSelection.h"
+#include "Rendering/RealityDistortionShaders.h"
+
+FRealityDistortionViewExtension::FRealityDistortionViewExtension(const FAutoRegister& AutoRegister)
+	: FSceneViewExtensionBase(AutoRegister)
+{
+}
+
+void FRealityDistortionViewExtension::BeginRenderViewFamily(FSceneViewFamily& InViewFamily)
+{
+	// 栅栏渲染命令先于本 ViewFamily 的渲染命令执行；同一帧之后的 ViewFamily 不再提交，
+	// 它们与第一个 ViewFamily 看到同一份力场数据，本帧稍后写入的增量在帧末提交（见 RealityDistortion.cpp）。
+	if (LastFieldFenceFrame != GFrameCounter)
+	{
+		LastFieldFenceFrame = GFrameCounter;
+		SubmitRealityDistortionFieldUpdates_GameThread();
+	}
+}
+
+void FRealityDistortionViewExtension::PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily)
+{
+	// 这里处于 InitViews 之前，后续所有 RealityDistortion DrawCommand 绑定的都是这次更新后的内容。
+	// 本帧的力场增量与力场时钟已由 BeginRenderViewFamily 提交的栅栏命令带到 RT，
+	// 按各力场所属世界的时钟预测降频推送力场的位置、求值动画力场（选择、空间索引与打包都看到同一份结果），
+	// 按本 ViewFamily 的视锥与预算选出要上传的力场，
+	// 再重建力场空间索引，AddMeshBatch 的粗筛与 FieldBuffer 使用同一批槽位；休眠判定另看全部启用的力场。
+	PredictRealityDistortionFieldMotion_RenderThread();
+	AnimateRealityDistortionFields_RenderThread();
+	UpdateRealityDistortionFieldSelection_RenderThread(InViewFamily);
+	const bool bFieldsChanged = UpdateRealityDistortionFieldGrid_RenderThread();
+	const bool bProximityFieldsChanged = UpdateRealityDistortionProximityFieldGrid_RenderThread();
+	// 缓存接收体只在相关力场集合变化时让自己的缓存 DrawCommand 失效。
+	FDistortionSceneProxy::UpdateCachedReceivers_RenderThread(bFieldsChanged, bProximityFieldsChanged);
+	// 打包上传力场并添加屏幕 Tile 分箱 Pass（同一 Graph 里先于 BasePass 执行）。
+	UpdateRealityDistortionUniformBuffer_RenderThread(GraphBuilder, InViewFamily);
+}
@@ -0,0 +1,35 @@
+﻿// RealityDistortionViewExtension.h
+//
+// FRealityDistortionViewExtension
+// -------------------------------
+// RealityDistortion 的“每帧入口”：
+// 1) 每帧第一个 ViewFamily 开始渲染时在 GT 提交力场增量栅栏，RT 在该帧所有 ViewFamily 之前消费一次；
+//    在 RT 渲染每个 ViewFamily 之前，按帧时间预测降频力场并求值动画力场，
+//    再按视锥与预算选出力场（见 RealityDistortionFieldSelection.h），
+//    再把选中的力场打包进常驻 Uniform Buffer。
+// 2) MeshDrawCommand 只按引用绑定该 Buffer，不再每个 DrawCall 重建一次。
+// 3) 同一时机添加屏幕 Tile 力场分箱 Pass（见 RealityDistortionTiledCulling.h）。
+// 4) 开启 r.RealityDistortion.InfluenceClipmap 时增量更新影响度 Clipmap（见 RealityDistortionInfluenceClipmap.h）。
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SceneViewExtension.h"
+
+class FRealityDistortionViewExtension : public FSceneViewExtensionBase
+{
+public:
+	FRealityDistortionViewExtension(const FAutoRegister& AutoRegister);
+
+	virtual void SetupViewFamily(FSceneViewFamily& InViewFamily) override {}
+	virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override {}
+	// GT：每帧只提交一次力场增量栅栏，同一帧的 ViewFamily 看到同一份力场数据。
+	virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override;
+
+	// 每个 ViewFamily 调用一次，早于 MeshPass 的 DrawCommand 构建。
+	virtual void PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily) override;
+
+private:
+	// 最近一次提交栅栏时的 GFrameCounter（仅 GT）。
+	uint64 LastFieldFenceFrame = MAX_uint64;
+};
@@ -0,0 +1,271 @@
+﻿// RealityDistortionVoronoi.cpp
+
+#include "Rendering/RealityDistortionVoronoi.h"
+
+#include "HAL/IConsoleManager.h"
+#include "RealityDistortionDefinitions.h"
+#include "RenderResource.h"
+#include "RHICommandList.h"
+#include "RHIStaticStates.h"
+
+namespace
+{
+	static TAutoConsoleVariable<int32> CVarRealityDistortionVoronoiQuality(
+		TEXT("r.RealityDistortion.VoronoiQuality"),
+		REALITY_DISTORTION_VORONOI_QUALITY_HIGH,
+		TEXT("Voronoi fracture evaluation tier (scales with sg.EffectsQuality).\n")
+		TEXT(" 0: Tileable precomputed cellular-noise texture, one fetch\n")
+		TEXT(" 1: Integer hash, 2x2x2 search\n")
+		TEXT(" 2: Integer hash, 3x3x3 search (default)\n")
+		TEXT(" 3: Original sin hash, 3x3x3 search (reference)"),
+		ECVF_Scalability | ECVF_RenderThreadSafe);
+
+	constexpr int32 NoiseTexturePeriod = REALITY_DISTORTION_VORONOI_TEXTURE_PERIOD;
+	constexpr int32 NoiseTextureSize = REALITY_DISTORTION_VORONOI_TEXTURE_PERIOD * REALITY_DISTORTION_VORONOI_TEXTURE_TEXELS_PER_CELL;
+
+	// 与 HLSL RD_Hash3 一致。
+	FVector3f Hash3(const FVector3f& P)
+	{
+		const FVector3f Dots(
+			FVector3f::DotProduct(P, FVector3f(127.1f, 311.7f, 74.7f)),
+			FVector3f::DotProduct(P, FVector3f(269.5f, 183.3f, 246.1f)),
+			FVector3f::DotProduct(P, FVector3f(113.5f, 271.9f, 124.6f)));
+		return FVector3f(
+			FMath::Frac(FMath::Sin(Dots.X) * 43758.5453123f),
+			FMath::Frac(FMath::Sin(Dots.Y) * 43758.5453123f),
+			FMath::Frac(FMath::Sin(Dots.Z) * 43758.5453123f));
+	}
+
+	// 与 HLSL RD_HashInt3 / RD_PCG3D 一致（uint32 回绕乘法）。
+	FVector3f HashInt3(const FIntVector& Cell)
+	{
+		uint32 V[3] = { static_cast<uint32>(Cell.X), static_cast<uint32>(Cell.Y), static_cast<uint32>(Cell.Z) };
+		for (uint32& Component : V)
+		{
+			Component = Component * 1664525u + 1013904223u;
+		}
+		V[0] += V[1] * V[2];
+		V[1] += V[2] * V[0];
+		V[2] += V[0] * V[1];
+		for (uint32& Component : V)
+		{
+			Component ^= Component >> 16u;
+		}
+		V[0] += V[1] * V[2];
+		V[1] += V[2] * V[0];
+		V[2] += V[0] * V[1];
+
+		constexpr float InvRange = 1.0f / 16777216.0f;
+		return FVector3f(float(V[0] >> 8u) * InvRange, float(V[1] >> 8u) * InvRange, float(V[2] >> 8u) * InvRange);
+	}
+
+	void Accumulate(float Distance, FVector2f& InOutF1F2)
+	{
+		if (Distance < InOutF1F2.X)
+		{
+			InOutF1F2.Y = InOutF1F2.X;
+			InOutF1F2.X = Distance;
+		}
+		else if (Distance < InOutF1F2.Y)
+		{
+			InOutF1F2.Y = Distance;
+		}
+	}
+
+	int32 WrapCell(int32 Cell, int32 Period)
+	{
+		return ((Cell % Period) + Period) % Period;
+	}
+
+	// 整数哈希 Voronoi，P 以单元为单位。Period > 0 时哈希输入按周期折回（噪声纹理的生成与校验用）。
+	FVector2f VoronoiIntegerHash(const FVector3f& P, int32 Period)
+	{
+		const FIntVector BaseCell(FMath::FloorToInt32(P.X), FMath::FloorToInt32(P.Y), FMath::FloorToInt32(P.Z));
+
+		FVector2f F1F2(100.0f, 100.0f);
+		for (int32 X = -1; X <= 1; ++X)
+		{
+			for (int32 Y = -1; Y <= 1; ++Y)
+			{
+				for (int32 Z = -1; Z <= 1; ++Z)
+				{
+					const FIntVector NeighborCell = BaseCell + FIntVector(X, Y, Z);
+					const FIntVector HashCell = Period > 0
+						? FIntVector(WrapCell(NeighborCell.X, Period), WrapCell(NeighborCell.Y, Period), WrapCell(NeighborCell.Z, Period))
+						: NeighborCell;
+					const FVector3f CellCenter = FVector3f(NeighborCell) + HashInt3(HashCell);
+					Accumulate((P - CellCenter).Length(), F1F2);
+				}
+			}
+		}
+		return F1F2;
+	}
+
+	// 与 HLSL RD_VoronoiIntegerHash2x2x2 一致。
+	FVector2f VoronoiIntegerHash2x2x2(const FVector3f& P)
+	{
+		const FVector3f FloorP(FMath::FloorToFloat(P.X), FMath::FloorToFloat(P.Y), FMath::FloorToFloat(P.Z));
+		const FIntVector FirstCell(
+			int32(FloorP.X) - (P.X - FloorP.X < 0.5f ? 1 : 0),
+			int32(FloorP.Y) - (P.Y - FloorP.Y < 0.5f ? 1 : 0),
+			int32(FloorP.Z) - (P.Z - FloorP.Z < 0.5f ? 1 : 0));
+
+		FVector2f F1F2(100.0f, 100.0f);
+		for (int32 X = 0; X <= 1; ++X)
+		{
+			for (int32 Y = 0; Y <= 1; ++Y)
+			{
+				for (int32 Z = 0; Z <= 1; ++Z)
+				{
+					const FIntVector NeighborCell = FirstCell + FIntVector(X, Y, Z);
+					const FVector3f CellCenter = FVector3f(NeighborCell) + HashInt3(NeighborCell);
+					Accumulate((P - CellCenter).Length(), F1F2);
+				}
+			}
+		}
+		return F1F2;
+	}
+
+	// 与 HLSL RD_Voronoi 一致。
+	FVector2f VoronoiReference(const FVector3f& P)
+	{
+		const FVector3f BaseCell(FMath::FloorToFloat(P.X), FMath::FloorToFloat(P.Y), FMath::FloorToFloat(P.Z));
+
+		FVector2f F1F2(100.0f, 100.0f);
+		for (int32 X = -1; X <= 1; ++X)
+		{
+			for (int32 Y = -1; Y <= 1; ++Y)
+			{
+				for (int32 Z = -1; Z <= 1; ++Z)
+				{
+					const FVector3f NeighborCell = BaseCell + FVector3f(X, Y, Z);
+					const FVector3f CellCenter = NeighborCell + Hash3(NeighborCell);
+					Accumulate((P - CellCenter).Length(), F1F2);
+				}
+			}
+		}
+		return F1F2;
+	}
+
+	// 噪声纹理的三线性 Wrap 采样（与 GPU 的 SF_Bilinear + AM_Wrap 一致，不模拟硬件的滤波权重精度）。
+	FVector2f SampleNoiseTexture(const FVector3f& P)
+	{
+		const TArray<FFloat16>& Texels = GetRealityDistortionVoronoiNoiseTexels();
+		const FVector3f TexelPosition = P * float(REALITY_DISTORTION_VORONOI_TEXTURE_TEXELS_PER_CELL) - FVector3f(0.5f);
+		const FIntVector BaseTexel(FMath::FloorToInt32(TexelPosition.X), FMath::FloorToInt32(TexelPosition.Y), FMath::FloorToInt32(TexelPosition.Z));
+		const FVector3f Weight = TexelPosition - FVector3f(BaseTexel);
+
+		FVector2f Result(0.0f, 0.0f);
+		for (int32 Corner = 0; Corner < 8; ++Corner)
+		{
+			const FIntVector Offset(Corner & 1, (Corner >> 1) & 1, Corner >> 2);
+			const int32 X = WrapCell(BaseTexel.X + Offset.X, NoiseTextureSize);
+			const int32 Y = WrapCell(BaseTexel.Y + Offset.Y, NoiseTextureSize);
+			const int32 Z = WrapCell(BaseTexel.Z + Offset.Z, NoiseTextureSize);
+			const int32 TexelIndex = ((Z * NoiseTextureSize + Y) * NoiseTextureSize + X) * 2;
+
+			const float CornerWeight =
+				(Offset.X ? Weight.X : 1.0f - Weight.X) *
+				(Offset.Y ? Weight.Y : 1.0f - Weight.Y) *
+				(Offset.Z ? Weight.Z : 1.0f - Weight.Z);
+			Result += FVector2f(Texels[TexelIndex].GetFloat(), Texels[TexelIndex + 1].GetFloat()) * CornerWeight;
+		}
+		return Result;
+	}
+
+	// 常驻噪声纹理。数据由 GetRealityDistortionVoronoiNoiseTexels 生成，PF_G16R16F，共 1 MB。
+	class FRealityDistortionVoronoiNoiseTexture : public FTexture
+	{
+	public:
+		virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+		{
+			const FRHITextureCreateDesc Desc = FRHITextureCreateDesc::Create3D(TEXT("RealityDistortion.VoronoiNoise"))
+				.SetExtent(NoiseTextureSize, NoiseTextureSize)
+				.SetDepth(NoiseTextureSize)
+				.SetFormat(PF_G16R16F)
+				.SetFlags(ETextureCreateFlags::ShaderResource)
+				.SetInitialState(ERHIAccess::SRVMask);
+			TextureRHI = RHICmdList.CreateTexture(Desc);
+
+			const TArray<FFloat16>& Texels = GetRealityDistortionVoronoiNoiseTexels();
+			const uint32 RowPitch = NoiseTextureSize * 2 * sizeof(FFloat16);
+			const FUpdateTextureRegion3D Region(0, 0, 0, 0, 0, 0, NoiseTextureSize, NoiseTextureSize, NoiseTextureSize);
+			RHICmdList.UpdateTexture3D(TextureRHI, 0, Region, RowPitch, RowPitch * NoiseTextureSize, reinterpret_cast<const uint8*>(Texels.GetData()));
+
+			SamplerStateRHI = TStaticSamplerState<SF_Bilinear, AM_Wrap, AM_Wrap, AM_Wrap>::GetRHI();
+		}
+
+		virtual uint32 GetSizeX() const override { return NoiseTextureSize; }
+		virtual uint32 GetSizeY() const override { return NoiseTextureSize; }
+	};
+
+	TGlobalResource<FRealityDistortionVoronoiNoiseTexture> GRealityDistortionVoronoiNoiseTexture;
+}
+
+FVector2f CalculateRealityDistortionVoronoi(const FVector3f& WorldPos, float CellSize, int32 Quality)
+{
+	const FVector3f P = WorldPos / CellSize;
+	switch (Quality)
+	{
+	case REALITY_DISTORTION_VORONOI_QUALITY_NOISE_TEXTURE:
+		return SampleNoiseTexture(P);
+	case REALITY_DISTORTION_VORONOI_QUALITY_FAST:
+		return VoronoiIntegerHash2x2x2(P);
+	case REALITY_DISTORTION_VORONOI_QUALITY_HIGH:
+		return VoronoiIntegerHash(P, 0);
+	default:
+		return VoronoiReference(P);
+	}
+}
+
+float CalculateRealityDistortionVoronoiEdge(const FVector3f& WorldPos, float CellSize, int32 Quality)
+{
+	const FVector2f F1F2 = CalculateRealityDistortionVoronoi(WorldPos, CellSize, Quality);
+	return FMath::Clamp(F1F2.Y - F1F2.X, 0.0f, 1.0f);
+}
+
+const TArray<FFloat16>& GetRealityDistortionVoronoiNoiseTexels()
+{
+	static const TArray<FFloat16> Texels = []()
+	{
+		TArray<FFloat16> Result;
+		Result.SetNumUninitialized(NoiseTextureSize * NoiseTextureSize * NoiseTextureSize * 2);
+
+		int32 TexelIndex = 0;
+		for (int32 Z = 0; Z < NoiseTextureSize; ++Z)
+		{
+			for (int32 Y = 0; Y < NoiseTextureSize; ++Y)
+			{
+				for (int32 X = 0; X < NoiseTextureSize; ++X)
+				{
+					const FVector3f P = (FVector3f(X, Y, Z) + 0.5f) / float(REALITY_DISTORTION_VORONOI_TEXTURE_TEXELS_PER_CELL);
+					const FVector2f F1F2 = VoronoiIntegerHash(P, NoiseTexturePeriod);
+					Result[TexelIndex++] = FFloat16(F1F2.X);
+					Result[TexelIndex++] = FFloat16(F1F2.Y);
+				}
+			}
+		}
+		return Result;
+	}();
+	return Texels;
+}
+
+int32 GetRealityDistortionVoronoiQuality_RenderThread()
+{
+	return FMath::Clamp(
+		CVarRealityDistortionVoronoiQuality.GetValueOnRenderThread(),
+		REALITY_DISTORTION_VORONOI_QUALITY_NOISE_TEXTURE,
+		REALITY_DISTORTION_VORONOI_QUALITY_REFERENCE);
+}
+
+FRHITexture* GetRealityDistortionVoronoiNoiseTexture_RenderThread()
+{
+	check(IsInRenderingThread());
+	return GRealityDistortionVoronoiNoiseTexture.TextureRHI;
+}
+
+FRHISamplerState* GetRealityDistortionVoronoiNoiseSampler_RenderThread()
+{
+	check(IsInRenderingThread());
+	return GRealityDistortionVoronoiNoiseTexture.SamplerStateRHI;
+}
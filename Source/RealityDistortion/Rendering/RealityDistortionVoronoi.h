@@ -0,0 +1,37 @@
+﻿// RealityDistortionVoronoi.h
+//
+// Voronoi 裂纹质量档位
+// --------------------
+// MainPS（RealityDistortionShader.usf）用 RD_VoronoiEdgeTiered 绘制裂纹。RD_Voronoi（RealityDistortionCommon.ush）逐像素搜索 27 个单元、每个单元一次 sin 哈希，是最贵的 ALU 路径之一。
+// r.RealityDistortion.VoronoiQuality（受 sg.EffectsQuality 控制）选择档位，取值见 REALITY_DISTORTION_VORONOI_QUALITY_*：
+// 0 = 可平铺的预计算细胞噪声 3D 纹理（一次采样）
+// 1 = 整数哈希 + 2x2x2 搜索
+// 2 = 整数哈希 + 3x3x3 搜索
+// 3 = 原始 sin 哈希 + 3x3x3 搜索（参考实现）
+//
+// 说明：
+// - 本文件的函数是 HLSL 各档位的 CPU 移植，两边必须同步修改；RealityDistortionVoronoiTests.cpp 用它们校验误差。
+// - 整数哈希与 sin 哈希生成的裂纹图案不同，只保证统计上等价；2x2x2 与噪声纹理逐点对比整数哈希 3x3x3。
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FRHISamplerState;
+class FRHITexture;
+
+// CPU 移植：返回 (F1, F2)，即到最近 / 次近单元特征点的距离（单元尺寸为单位）。Quality 取 REALITY_DISTORTION_VORONOI_QUALITY_*。
+REALITYDISTORTION_API FVector2f CalculateRealityDistortionVoronoi(const FVector3f& WorldPos, float CellSize, int32 Quality);
+
+// CPU 移植：裂纹边缘掩码，saturate(F2 - F1)；边缘处为 0。
+REALITYDISTORTION_API float CalculateRealityDistortionVoronoiEdge(const FVector3f& WorldPos, float CellSize, int32 Quality);
+
+// 噪声纹理的 CPU 数据：每个纹素两个 half（F1, F2），X 最快、Z 最慢。首次调用时生成，之后只读。
+REALITYDISTORTION_API const TArray<FFloat16>& GetRealityDistortionVoronoiNoiseTexels();
+
+// 当前档位（已钳制到有效范围），写入力场 Uniform Buffer。
+int32 GetRealityDistortionVoronoiQuality_RenderThread();
+
+// 噪声纹理与 Wrap 采样器（常驻）。
+FRHITexture* GetRealityDistortionVoronoiNoiseTexture_RenderThread();
+FRHISamplerState* GetRealityDistortionVoronoiNoiseSampler_RenderThread();
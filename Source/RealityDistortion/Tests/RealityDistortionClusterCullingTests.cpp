@@ -0,0 +1,288 @@
+﻿// RealityDistortionClusterCullingTests.cpp
+//
+// 接收体三角形簇（RealityDistortionClusterCulling.h）的自动化测试。
+// 纯 CPU，不依赖 RT / GPU：在合成地板上把簇剔除后提交的索引区间与整段提交（完整绘制）逐三角形比较。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Rendering/RealityDistortionClusterCulling.h"
+#include "Rendering/RealityDistortionFieldCulling.h"
+#include "Rendering/RealityDistortionMeshClusterData.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionClusterCullingTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	// 合成地板：GridSize x GridSize 个格子，边长 FloorSize，位于 XY 平面、以原点为中心。
+	void BuildTestFloor(int32 GridSize, float FloorSize, TArray<FVector3f>& OutPositions, TArray<uint32>& OutIndices)
+	{
+		const float CellSize = FloorSize / GridSize;
+
+		OutPositions.Reset((GridSize + 1) * (GridSize + 1));
+		for (int32 Y = 0; Y <= GridSize; ++Y)
+		{
+			for (int32 X = 0; X <= GridSize; ++X)
+			{
+				OutPositions.Emplace(X * CellSize - FloorSize * 0.5f, Y * CellSize - FloorSize * 0.5f, 0.0f);
+			}
+		}
+
+		OutIndices.Reset(GridSize * GridSize * 6);
+		for (int32 Y = 0; Y < GridSize; ++Y)
+		{
+			for (int32 X = 0; X < GridSize; ++X)
+			{
+				const uint32 V0 = Y * (GridSize + 1) + X;
+				const uint32 V1 = V0 + 1;
+				const uint32 V2 = V0 + GridSize + 1;
+				const uint32 V3 = V2 + 1;
+				OutIndices.Append({ V0, V2, V1, V1, V2, V3 });
+			}
+		}
+	}
+
+	bool IsTriangleInRanges(uint32 Triangle, TConstArrayView<FRealityDistortionIndexRange> Ranges)
+	{
+		const uint32 Index = Triangle * 3;
+		return Ranges.ContainsByPredicate([Index](const FRealityDistortionIndexRange& Range)
+		{
+			return Index >= Range.FirstIndex && Index < Range.FirstIndex + Range.NumTriangles * 3;
+		});
+	}
+}
+
+// 每种力场布置下，簇剔除后的区间：
+// 1) 落在 Section 内、按 FirstIndex 升序且互不重叠，数量不超过上限；
+// 2) 完整绘制中与力场相交的每个三角形都被某个区间覆盖（不会漏画）；
+// 3) 提交的三角形不多于完整绘制；力场不碰地板时不提交，覆盖整块地板时等同完整绘制。
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionClusterCullingMatchesFullDrawTest, "RealityDistortion.ClusterCulling.MatchesFullDraw", RealityDistortionClusterCullingTestFlags)
+
+bool FRealityDistortionClusterCullingMatchesFullDrawTest::RunTest(const FString& Parameters)
+{
+	const int32 GridSize = 200;
+	const float FloorSize = 10000.0f;
+
+	TArray<FVector3f> Positions;
+	TArray<uint32> Indices;
+	BuildTestFloor(GridSize, FloorSize, Positions, Indices);
+	const uint32 NumTriangles = Indices.Num() / 3;
+
+	TArray<FRealityDistortionTriangleCluster> Clusters;
+	BuildRealityDistortionTriangleClusters(Indices, Positions, 0, NumTriangles, Clusters);
+	TestEqual(TEXT("Cluster count"), Clusters.Num(), static_cast<int32>(FMath::DivideAndRoundUp(NumTriangles, RealityDistortionTrianglesPerCluster)));
+
+	const FSphere FieldPlacements[] =
+	{
+		FSphere(FVector(0.0, 0.0, 0.0), 250.0),
+		FSphere(FVector(-4800.0, 4800.0, 0.0), 600.0),
+		FSphere(FVector(1234.0, -2100.0, 150.0), 900.0),
+		FSphere(FVector(0.0, 0.0, 5000.0), 400.0),
+		FSphere(FVector(0.0, 0.0, 0.0), 20000.0),
+	};
+
+	// 接收体被平移 + 缩放：簇包围盒按 LocalToWorld 变换后再测试。
+	const FMatrix Transforms[] =
+	{
+		FMatrix::Identity,
+		FScaleMatrix(FVector(1.5, 1.5, 1.0)) * FTranslationMatrix(FVector(300.0, -200.0, 0.0)),
+	};
+
+	const int32 RangeLimits[] = { 16, 1 };
+	for (const FMatrix& LocalToWorld : Transforms)
+	{
+		for (const FSphere& Field : FieldPlacements)
+		{
+			const FSphere FieldSpheres[] = { Field };
+			FRealityDistortionFieldGrid FieldGrid;
+			FieldGrid.Build(FieldSpheres);
+
+			// 完整绘制中与力场相交的三角形（世界空间包围盒与力场球相交）。
+			TArray<uint32> FullDrawHits;
+			for (uint32 Triangle = 0; Triangle < NumTriangles; ++Triangle)
+			{
+				FBox TriangleBounds(ForceInit);
+				for (uint32 Corner = 0; Corner < 3; ++Corner)
+				{
+					TriangleBounds += LocalToWorld.TransformPosition(FVector(Positions[Indices[Triangle * 3 + Corner]]));
+				}
+				if (FMath::SphereAABBIntersection(Field.Center, FMath::Square(Field.W), TriangleBounds))
+				{
+					FullDrawHits.Add(Triangle);
+				}
+			}
+
+			for (const int32 MaxRanges : RangeLimits)
+			{
+				const FString Context = FString::Printf(TEXT("Field (%s, %.0f), MaxRanges=%d"), *Field.Center.ToString(), Field.W, MaxRanges);
+
+				FRealityDistortionIndexRangeArray Ranges;
+				const uint32 NumVisibleTriangles = CullRealityDistortionTriangleClusters(Clusters, LocalToWorld, FieldGrid, MaxRanges, Ranges);
+				TestTrue(*(Context + TEXT(": range count within limit")), Ranges.Num() <= MaxRanges);
+
+				uint32 SubmittedTriangles = 0;
+				uint32 PreviousEnd = 0;
+				for (const FRealityDistortionIndexRange& Range : Ranges)
+				{
+					if (Range.FirstIndex < PreviousEnd || Range.NumTriangles == 0
+						|| Range.FirstIndex + Range.NumTriangles * 3 > static_cast<uint32>(Indices.Num()))
+					{
+						AddError(FString::Printf(TEXT("%s: range [%u, +%u) overlaps or leaves the section"), *Context, Range.FirstIndex, Range.NumTriangles));
+					}
+					PreviousEnd = Range.FirstIndex + Range.NumTriangles * 3;
+					SubmittedTriangles += Range.NumTriangles;
+				}
+				TestTrue(*(Context + TEXT(": submits no more than the full draw")), SubmittedTriangles <= NumTriangles);
+				TestTrue(*(Context + TEXT(": visible triangles within submitted")), NumVisibleTriangles <= SubmittedTriangles);
+
+				int32 NumMissing = 0;
+				for (const uint32 Triangle : FullDrawHits)
+				{
+					NumMissing += IsTriangleInRanges(Triangle, Ranges) ? 0 : 1;
+				}
+				TestEqual(*(Context + TEXT(": full-draw triangles inside the field missing from the ranges")), NumMissing, 0);
+
+				if (FullDrawHits.IsEmpty())
+				{
+					TestEqual(*(Context + TEXT(": field off the floor submits nothing")), Ranges.Num(), 0);
+				}
+				else if (FullDrawHits.Num() == static_cast<int32>(NumTriangles))
+				{
+					TestEqual(*(Context + TEXT(": field covering the floor submits the whole section")), SubmittedTriangles, NumTriangles);
+				}
+				else if (MaxRanges > 1)
+				{
+					TestTrue(*(Context + TEXT(": culling removes triangles")), SubmittedTriangles < NumTriangles);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// 网格簇数据：只为达到门槛的 Section 切簇；Section 与构建时不一致时不使用；序列化往返后完全一致。
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionMeshClustersTest, "RealityDistortion.ClusterCulling.MeshClusters", RealityDistortionClusterCullingTestFlags)
+
+bool FRealityDistortionMeshClustersTest::RunTest(const FString& Parameters)
+{
+	// LOD0：一大一小两个 Section；LOD1：只有一个小 Section（整个 LOD 不需要切簇）。
+	FRealityDistortionMeshClusterSource Source;
+	Source.bMaxTriangleEdgeLength = true;
+	Source.LODs.SetNum(2);
+	for (int32 LODIndex = 0; LODIndex < 2; ++LODIndex)
+	{
+		FRealityDistortionMeshClusterSource::FLOD& LOD = Source.LODs[LODIndex];
+		BuildTestFloor(LODIndex == 0 ? 64 : 4, 1000.0f, LOD.Positions, LOD.Indices);
+	}
+
+	const uint32 LOD0Triangles = Source.LODs[0].Indices.Num() / 3;
+	const uint32 SmallSectionTriangles = RealityDistortionTrianglesPerCluster;
+	Source.LODs[0].Sections = { { 0, LOD0Triangles - SmallSectionTriangles }, { (LOD0Triangles - SmallSectionTriangles) * 3, SmallSectionTriangles } };
+	Source.LODs[1].Sections = { { 0, static_cast<uint32>(Source.LODs[1].Indices.Num() / 3) } };
+
+	FRealityDistortionMeshClusters MeshClusters;
+	BuildRealityDistortionMeshClusters(Source, MeshClusters);
+
+	TestTrue(TEXT("Large section is clustered"), MeshClusters.LODSections[0][0].NumClusters > 0);
+	TestEqual(TEXT("Section below the threshold is not clustered"), MeshClusters.LODSections[0][1].NumClusters, 0);
+	TestEqual(TEXT("Small LOD is not clustered"), MeshClusters.LODSections[1][0].NumClusters, 0);
+
+	int32 NumClusters = 0;
+	TestNotNull(TEXT("Matching section returns its clusters"),
+		MeshClusters.FindSectionClusters(0, 0, 0, LOD0Triangles - SmallSectionTriangles, NumClusters));
+	TestNull(TEXT("Section rebuilt with a different triangle count is rejected"),
+		MeshClusters.FindSectionClusters(0, 0, 0, LOD0Triangles - SmallSectionTriangles - 1, NumClusters));
+	TestNull(TEXT("Out-of-range LOD is rejected"), MeshClusters.FindSectionClusters(2, 0, 0, 1, NumClusters));
+
+	// 最长边：LOD1 的格子最粗，对角线为最长边。
+	const float CoarseCell = 1000.0f / 4;
+	TestTrue(TEXT("Max triangle edge is the coarse LOD's diagonal"),
+		FMath::IsNearlyEqual(MeshClusters.LocalMaxTriangleEdgeLength, CoarseCell * UE_SQRT_2, 0.01f));
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Writer << MeshClusters;
+
+	FRealityDistortionMeshClusters Loaded;
+	FMemoryReader Reader(Bytes);
+	Reader << Loaded;
+
+	TestEqual(TEXT("Round trip keeps the cluster count"), Loaded.Clusters.Num(), MeshClusters.Clusters.Num());
+	TestEqual(TEXT("Round trip keeps the edge length"), Loaded.LocalMaxTriangleEdgeLength, MeshClusters.LocalMaxTriangleEdgeLength);
+	bool bClustersEqual = Loaded.Clusters.Num() == MeshClusters.Clusters.Num();
+	for (int32 Index = 0; bClustersEqual && Index < Loaded.Clusters.Num(); ++Index)
+	{
+		bClustersEqual = Loaded.Clusters[Index].FirstIndex == MeshClusters.Clusters[Index].FirstIndex
+			&& Loaded.Clusters[Index].NumTriangles == MeshClusters.Clusters[Index].NumTriangles
+			&& Loaded.Clusters[Index].LocalBounds == MeshClusters.Clusters[Index].LocalBounds;
+	}
+	TestTrue(TEXT("Round trip keeps every cluster"), bClustersEqual);
+
+	bool bSectionsEqual = Loaded.LODSections.Num() == MeshClusters.LODSections.Num();
+	for (int32 LODIndex = 0; bSectionsEqual && LODIndex < Loaded.LODSections.Num(); ++LODIndex)
+	{
+		bSectionsEqual = Loaded.LODSections[LODIndex].Num() == MeshClusters.LODSections[LODIndex].Num()
+			&& FMemory::Memcmp(Loaded.LODSections[LODIndex].GetData(), MeshClusters.LODSections[LODIndex].GetData(),
+				Loaded.LODSections[LODIndex].Num() * sizeof(FRealityDistortionSectionClusters)) == 0;
+	}
+	TestTrue(TEXT("Round trip keeps every section"), bSectionsEqual);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionMeshClusterPayloadTest, "RealityDistortion.ClusterCulling.VersionedPayload", RealityDistortionClusterCullingTestFlags)
+
+bool FRealityDistortionMeshClusterPayloadTest::RunTest(const FString& Parameters)
+{
+	FRealityDistortionMeshClusterSource Source;
+	Source.LODs.SetNum(1);
+	BuildTestFloor(64, 1000.0f, Source.LODs[0].Positions, Source.LODs[0].Indices);
+	Source.LODs[0].Sections = { { 0, static_cast<uint32>(Source.LODs[0].Indices.Num() / 3) } };
+
+	TSharedRef<FRealityDistortionMeshClusters, ESPMode::ThreadSafe> Built = MakeShared<FRealityDistortionMeshClusters, ESPMode::ThreadSafe>();
+	BuildRealityDistortionMeshClusters(Source, *Built);
+
+	// 负载之后再写一个哨兵：跳过负载后必须正好读到它，后续属性不受影响。
+	constexpr int32 Sentinel = 0x52440012;
+	auto WritePayload = [Sentinel](FRealityDistortionMeshClustersPtr Clusters)
+	{
+		TArray<uint8> Bytes;
+		FMemoryWriter Writer(Bytes);
+		SerializeRealityDistortionMeshClusters(Writer, Clusters);
+		int32 Trailer = Sentinel;
+		Writer << Trailer;
+		return Bytes;
+	};
+	auto ReadPayload = [](const TArray<uint8>& Bytes, FRealityDistortionMeshClustersPtr& OutClusters)
+	{
+		FMemoryReader Reader(Bytes);
+		SerializeRealityDistortionMeshClusters(Reader, OutClusters);
+		int32 Trailer = 0;
+		Reader << Trailer;
+		return Trailer;
+	};
+
+	const TArray<uint8> Bytes = WritePayload(Built);
+	FRealityDistortionMeshClustersPtr Loaded;
+	TestEqual(TEXT("Current version is followed by the next property"), ReadPayload(Bytes, Loaded), Sentinel);
+	TestTrue(TEXT("Current version loads the clusters"), Loaded.IsValid() && Loaded->Clusters.Num() == Built->Clusters.Num());
+
+	// 版本号是负载前的第一个 int32：改成其他版本后整个负载被跳过。
+	for (const int32 OtherVersion : { 1, 99 })
+	{
+		TArray<uint8> OtherBytes = Bytes;
+		FMemory::Memcpy(OtherBytes.GetData(), &OtherVersion, sizeof(OtherVersion));
+		FRealityDistortionMeshClustersPtr Skipped = Built;
+		TestEqual(FString::Printf(TEXT("Version %d payload is skipped up to the next property"), OtherVersion), ReadPayload(OtherBytes, Skipped), Sentinel);
+		TestFalse(FString::Printf(TEXT("Version %d payload is dropped for a rebuild"), OtherVersion), Skipped.IsValid());
+	}
+
+	FRealityDistortionMeshClustersPtr Empty = Built;
+	TestEqual(TEXT("Empty payload is followed by the next property"), ReadPayload(WritePayload(nullptr), Empty), Sentinel);
+	TestFalse(TEXT("Empty payload loads no clusters"), Empty.IsValid());
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,242 @@
+﻿// RealityDistortionFieldAnimationTests.cpp
+//
+// 力场动画求值（EvaluateRealityDistortionFieldAnimation / ComputeRealityDistortionFieldAnimationBounds）的自动化测试。
+// 纯 CPU，不触碰注册表：
+// 1) 无动画描述返回单位结果；曲线在 Key 时刻取到 Key 值，周期末尾连续回到首个 Key；
+// 2) 振荡与公式一致；开放样条往返（两端、中点、对称），闭合样条在 Key 时刻落在采样点上；
+// 3) 动画包围球包含整个周期内所有时刻的求值结果（力场空间索引只登记这个球）。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "RealityDistortionField.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionFieldAnimationTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	constexpr float TestTolerance = 1.0e-3f;
+	constexpr float TestOffsetTolerance = 0.1f;
+	// 时钟取较大值，覆盖长时间运行后的精度。
+	constexpr double TestBaseTime = 86400.0;
+
+	FRealityDistortionFieldAnimation MakeTestSplineAnimation(FRandomStream& Random, bool bClosedLoop)
+	{
+		FRealityDistortionFieldAnimation Animation;
+		Animation.Period = 4.0f;
+		Animation.NumSplinePoints = 9;
+		Animation.bSplineClosedLoop = bClosedLoop;
+		for (int32 Point = 0; Point < Animation.NumSplinePoints; ++Point)
+		{
+			Animation.SplinePoints[Point] = FVector3f(Random.GetUnitVector()) * Random.FRandRange(0.0f, 2000.0f);
+		}
+		return Animation;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldAnimationStaticTest, "RealityDistortion.FieldAnimation.StaticDescriptor", RealityDistortionFieldAnimationTestFlags)
+
+bool FRealityDistortionFieldAnimationStaticTest::RunTest(const FString& Parameters)
+{
+	const FRealityDistortionFieldAnimation Static;
+	const FRealityDistortionFieldAnimationSample Sample = EvaluateRealityDistortionFieldAnimation(Static, TestBaseTime);
+	TestFalse(TEXT("Default descriptor is animated"), Static.IsAnimated());
+	TestTrue(TEXT("Default descriptor has no center offset"), Sample.CenterOffset.IsZero());
+	TestEqual(TEXT("Default radius scale"), Sample.RadiusScale, 1.0f);
+	TestEqual(TEXT("Default strength scale"), Sample.StrengthScale, 1.0f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldAnimationCurvesTest, "RealityDistortion.FieldAnimation.CurvesHitKeysAndWrap", RealityDistortionFieldAnimationTestFlags)
+
+bool FRealityDistortionFieldAnimationCurvesTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x52440023);
+
+	// Period 与 TimeOffset 取非整数，Key 时刻 = k * Period / N - TimeOffset。
+	FRealityDistortionFieldAnimation Animation;
+	Animation.Period = 2.5f;
+	Animation.TimeOffset = 0.37f;
+	Animation.NumRadiusKeys = 7;
+	Animation.NumStrengthKeys = RealityDistortionAnimationCurveKeys;
+	for (int32 Key = 0; Key < RealityDistortionAnimationCurveKeys; ++Key)
+	{
+		Animation.RadiusCurve[Key] = Random.FRandRange(0.5f, 2.0f);
+		Animation.StrengthCurve[Key] = Random.FRandRange(0.0f, 3.0f);
+	}
+
+	// Key 时刻略微后移，避免 Frac 恰好落在上一段末尾。
+	const double CycleStart = FMath::CeilToDouble(TestBaseTime / Animation.Period) * Animation.Period - Animation.TimeOffset;
+	for (int32 Key = 0; Key < Animation.NumRadiusKeys; ++Key)
+	{
+		const double Time = CycleStart + Key * Animation.Period / Animation.NumRadiusKeys + 1.0e-6;
+		TestNearlyEqual(FString::Printf(TEXT("Radius curve key %d"), Key), EvaluateRealityDistortionFieldAnimation(Animation, Time).RadiusScale, Animation.RadiusCurve[Key], TestTolerance);
+	}
+	for (int32 Key = 0; Key < Animation.NumStrengthKeys; ++Key)
+	{
+		const double Time = CycleStart + Key * Animation.Period / Animation.NumStrengthKeys + 1.0e-6;
+		TestNearlyEqual(FString::Printf(TEXT("Strength curve key %d"), Key), EvaluateRealityDistortionFieldAnimation(Animation, Time).StrengthScale, Animation.StrengthCurve[Key], TestTolerance);
+	}
+
+	const FRealityDistortionFieldAnimationSample BeforeWrap = EvaluateRealityDistortionFieldAnimation(Animation, CycleStart - 1.0e-4);
+	const FRealityDistortionFieldAnimationSample AfterWrap = EvaluateRealityDistortionFieldAnimation(Animation, CycleStart + 1.0e-4);
+	TestNearlyEqual(TEXT("Radius curve wraps continuously"), BeforeWrap.RadiusScale, AfterWrap.RadiusScale, 0.01f);
+	TestNearlyEqual(TEXT("Strength curve wraps continuously"), BeforeWrap.StrengthScale, AfterWrap.StrengthScale, 0.01f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldAnimationOscillationTest, "RealityDistortion.FieldAnimation.OscillationFormula", RealityDistortionFieldAnimationTestFlags)
+
+bool FRealityDistortionFieldAnimationOscillationTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x52440023);
+
+	FRealityDistortionFieldAnimation Animation;
+	Animation.RadiusOscillationAmplitude = 0.3f;
+	Animation.StrengthOscillationAmplitude = -0.5f;
+	Animation.OscillationFrequency = 1.7f;
+	Animation.OscillationPhase = 0.2f;
+	TestTrue(TEXT("Oscillation is animated"), Animation.IsAnimated());
+
+	int32 NumMismatches = 0;
+	for (int32 Step = 0; Step < 64; ++Step)
+	{
+		const double Time = TestBaseTime + Random.FRandRange(0.0f, 10.0f);
+		const float Wave = FMath::Sin(UE_TWO_PI * static_cast<float>(FMath::Frac(Time * Animation.OscillationFrequency + Animation.OscillationPhase)));
+		const FRealityDistortionFieldAnimationSample Sample = EvaluateRealityDistortionFieldAnimation(Animation, Time);
+		NumMismatches += (FMath::IsNearlyEqual(Sample.RadiusScale, 1.0f + 0.3f * Wave, TestTolerance) && FMath::IsNearlyEqual(Sample.StrengthScale, 1.0f - 0.5f * Wave, TestTolerance)) ? 0 : 1;
+	}
+	TestEqual(TEXT("Samples off the oscillation formula"), NumMismatches, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldAnimationSplineTest, "RealityDistortion.FieldAnimation.SplineMotion", RealityDistortionFieldAnimationTestFlags)
+
+bool FRealityDistortionFieldAnimationSplineTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x52440023);
+
+	for (const bool bClosedLoop : { false, true })
+	{
+		const FRealityDistortionFieldAnimation Animation = MakeTestSplineAnimation(Random, bClosedLoop);
+		const int32 NumPoints = Animation.NumSplinePoints;
+		const double CycleStart = FMath::CeilToDouble(TestBaseTime / Animation.Period) * Animation.Period;
+		auto OffsetAt = [&Animation, CycleStart](double Phase)
+		{
+			return EvaluateRealityDistortionFieldAnimation(Animation, CycleStart + Phase * Animation.Period + 1.0e-6).CenterOffset;
+		};
+
+		if (bClosedLoop)
+		{
+			int32 NumOffPoint = 0;
+			for (int32 Point = 0; Point < NumPoints; ++Point)
+			{
+				NumOffPoint += OffsetAt(static_cast<double>(Point) / NumPoints).Equals(Animation.SplinePoints[Point], TestOffsetTolerance) ? 0 : 1;
+			}
+			TestEqual(TEXT("Closed spline key times off their points"), NumOffPoint, 0);
+		}
+		else
+		{
+			TestTrue(TEXT("Open spline starts at the first point"), OffsetAt(0.0).Equals(Animation.SplinePoints[0], TestOffsetTolerance));
+			TestTrue(TEXT("Open spline reaches the far end at half period"), OffsetAt(0.5).Equals(Animation.SplinePoints[NumPoints - 1], TestOffsetTolerance));
+			TestTrue(TEXT("Open spline passes the midpoint at quarter period"), OffsetAt(0.25).Equals(Animation.SplinePoints[(NumPoints - 1) / 2], TestOffsetTolerance));
+
+			int32 NumAsymmetric = 0;
+			for (int32 Step = 0; Step < 16; ++Step)
+			{
+				const double Phase = Random.FRandRange(0.01f, 0.49f);
+				NumAsymmetric += OffsetAt(Phase).Equals(OffsetAt(1.0 - Phase), TestOffsetTolerance) ? 0 : 1;
+			}
+			TestEqual(TEXT("Open spline ping-pong asymmetries"), NumAsymmetric, 0);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldAnimationBoundsTest, "RealityDistortion.FieldAnimation.BoundsContainEverySample", RealityDistortionFieldAnimationTestFlags)
+
+bool FRealityDistortionFieldAnimationBoundsTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumAnimations = 64;
+	constexpr int32 NumSamplesPerAnimation = 256;
+
+	FRandomStream Random(0x52440023);
+	int32 NumEscapes = 0;
+	float MaxSlack = 0.0f;
+	for (int32 AnimationIndex = 0; AnimationIndex < NumAnimations; ++AnimationIndex)
+	{
+		FRealityDistortionFieldAnimation Animation = MakeTestSplineAnimation(Random, Random.FRand() < 0.5f);
+		Animation.Period = Random.FRandRange(1.0f, 10.0f);
+		Animation.NumRadiusKeys = RealityDistortionAnimationCurveKeys;
+		for (int32 Key = 0; Key < RealityDistortionAnimationCurveKeys; ++Key)
+		{
+			Animation.RadiusCurve[Key] = Random.FRandRange(0.0f, 2.0f);
+		}
+		Animation.RadiusOscillationAmplitude = Random.FRandRange(-0.5f, 0.5f);
+		Animation.OscillationFrequency = Random.FRandRange(0.1f, 4.0f);
+
+		const FVector BaseCenter = FVector(Random.GetUnitVector()) * 10000.0;
+		const float BaseRadius = Random.FRandRange(50.0f, 1000.0f);
+		const FSphere Bounds = ComputeRealityDistortionFieldAnimationBounds(Animation, BaseCenter, BaseRadius);
+
+		float MaxReach = 0.0f;
+		for (int32 Sample = 0; Sample < NumSamplesPerAnimation; ++Sample)
+		{
+			const double Time = TestBaseTime + Random.FRandRange(0.0f, 20.0f);
+			const FRealityDistortionFieldAnimationSample Evaluated = EvaluateRealityDistortionFieldAnimation(Animation, Time);
+			const FVector Center = BaseCenter + FVector(Evaluated.CenterOffset);
+			const float Reach = static_cast<float>(FVector::Dist(Center, Bounds.Center)) + BaseRadius * Evaluated.RadiusScale;
+			NumEscapes += Reach <= Bounds.W + TestOffsetTolerance ? 0 : 1;
+			MaxReach = FMath::Max(MaxReach, Reach);
+		}
+		MaxSlack = FMath::Max(MaxSlack, static_cast<float>(Bounds.W) - MaxReach);
+	}
+
+	// 静止描述的包围球就是基准球。
+	const FSphere StaticBounds = ComputeRealityDistortionFieldAnimationBounds(FRealityDistortionFieldAnimation(), FVector(1.0, 2.0, 3.0), 100.0f);
+	TestTrue(TEXT("Static descriptor bounds equal the base sphere"), StaticBounds.Center.Equals(FVector(1.0, 2.0, 3.0)) && FMath::IsNearlyEqual(StaticBounds.W, 100.0));
+
+	AddInfo(FString::Printf(TEXT("%d animations x %d samples, max slack between the bounds and the farthest sample %.1f cm"), NumAnimations, NumSamplesPerAnimation, MaxSlack));
+	TestEqual(TEXT("Samples escaping the animation bounds"), NumEscapes, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldAnimationCostTest, "RealityDistortion.FieldAnimation.EvaluationCost", RealityDistortionFieldAnimationTestFlags)
+
+bool FRealityDistortionFieldAnimationCostTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumFields = 4096;
+
+	// 全功能描述，相当于注册表满载时 RT 每帧的求值开销。
+	FRandomStream Random(0x52440023);
+	TArray<FRealityDistortionFieldAnimation> Animations;
+	Animations.SetNum(NumFields);
+	for (FRealityDistortionFieldAnimation& Animation : Animations)
+	{
+		Animation.Period = Random.FRandRange(1.0f, 10.0f);
+		Animation.NumRadiusKeys = RealityDistortionAnimationCurveKeys;
+		Animation.NumStrengthKeys = RealityDistortionAnimationCurveKeys;
+		Animation.NumSplinePoints = RealityDistortionAnimationSplinePoints;
+		Animation.RadiusOscillationAmplitude = 0.2f;
+		Animation.OscillationFrequency = Random.FRandRange(0.1f, 4.0f);
+	}
+
+	float Checksum = 0.0f;
+	const double StartTime = FPlatformTime::Seconds();
+	for (const FRealityDistortionFieldAnimation& Animation : Animations)
+	{
+		const FRealityDistortionFieldAnimationSample Sample = EvaluateRealityDistortionFieldAnimation(Animation, TestBaseTime);
+		Checksum += Sample.RadiusScale + Sample.StrengthScale + Sample.CenterOffset.X;
+	}
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	AddInfo(FString::Printf(TEXT("%d animated fields evaluated in %.3f ms (%.1f ns/field, checksum %.3f)"),
+		NumFields, ElapsedMs, ElapsedMs * 1.0e6 / NumFields, Checksum));
+	TestTrue(TEXT("Evaluation produces finite results"), FMath::IsFinite(Checksum));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
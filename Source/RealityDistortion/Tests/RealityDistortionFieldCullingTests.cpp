@@ -0,0 +1,213 @@
+﻿// RealityDistortionFieldCullingTests.cpp
+//
+// FRealityDistortionFieldGrid 的自动化测试（Session Frontend / -ExecCmds="Automation RunTests RealityDistortion"）。
+// 纯 CPU，不依赖 RT / GPU，可在 -nullrhi 的无头进程里运行。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Math/RandomStream.h"
+#include "Rendering/RealityDistortionFieldCulling.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionFieldCullingTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	// 与旧版 AddMeshBatch 相同的逐个测试；非球形力场在包围球测试之后再做精确测试。
+	TArray<uint32> CollectLinearHits(
+		TConstArrayView<FSphere> FieldSpheres,
+		TConstArrayView<FRealityDistortionFieldShape> FieldShapes,
+		const FSphere& Receiver)
+	{
+		TArray<uint32> Hits;
+		for (int32 SlotIndex = 0; SlotIndex < FieldSpheres.Num(); ++SlotIndex)
+		{
+			const FSphere& Field = FieldSpheres[SlotIndex];
+			if (Field.W <= 0.0 || FVector::DistSquared(Receiver.Center, Field.Center) > FMath::Square(Receiver.W + Field.W))
+			{
+				continue;
+			}
+			if (!FieldShapes.IsEmpty() && FieldShapes[SlotIndex].Type != REALITY_DISTORTION_FIELD_SHAPE_SPHERE
+				&& !RealityDistortionFieldShapeIntersectsSphere(FieldShapes[SlotIndex], Receiver.Center, static_cast<float>(Receiver.W)))
+			{
+				continue;
+			}
+			Hits.Add(static_cast<uint32>(SlotIndex));
+		}
+		return Hits;
+	}
+
+	TArray<uint32> CollectGridHits(const FRealityDistortionFieldGrid& Grid, const FSphere& Receiver)
+	{
+		TArray<uint32> Hits;
+		Grid.ForEachOverlappingField(Receiver.Center, static_cast<float>(Receiver.W), [&Hits](uint32 SlotIndex)
+		{
+			Hits.Add(SlotIndex);
+			return true;
+		});
+		Hits.Sort();
+		return Hits;
+	}
+
+	FVector RandomPoint(FRandomStream& Random, double WorldHalfSize)
+	{
+		return FVector(
+			Random.FRandRange(-WorldHalfSize, WorldHalfSize),
+			Random.FRandRange(-WorldHalfSize, WorldHalfSize),
+			Random.FRandRange(-WorldHalfSize * 0.1, WorldHalfSize * 0.1));
+	}
+
+	// 逐个接收体比较网格与线性遍历的命中集合；返回不一致的接收体数。
+	int32 CountMismatchedReceivers(
+		FAutomationTestBase& Test,
+		const FRealityDistortionFieldGrid& Grid,
+		TConstArrayView<FSphere> FieldSpheres,
+		TConstArrayView<FRealityDistortionFieldShape> FieldShapes,
+		TConstArrayView<FSphere> Receivers,
+		uint64& OutNumHits)
+	{
+		int32 NumMismatches = 0;
+		OutNumHits = 0;
+		for (const FSphere& Receiver : Receivers)
+		{
+			const TArray<uint32> Expected = CollectLinearHits(FieldSpheres, FieldShapes, Receiver);
+			const TArray<uint32> Actual = CollectGridHits(Grid, Receiver);
+			OutNumHits += Expected.Num();
+			if (Expected != Actual)
+			{
+				// 只输出第一个不一致，避免刷屏。
+				if (NumMismatches == 0)
+				{
+					Test.AddError(FString::Printf(TEXT("Receiver (%s, %.1f): linear scan found %d fields, grid found %d"),
+						*Receiver.Center.ToString(), Receiver.W, Expected.Num(), Actual.Num()));
+				}
+				++NumMismatches;
+			}
+		}
+		return NumMismatches;
+	}
+}
+
+// 10k 随机接收体 × 1k 随机球形力场：每个接收体的命中集合与线性遍历完全一致，且每个力场只回调一次（排序后无重复）。
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldGridMatchesLinearScanTest, "RealityDistortion.FieldCulling.GridMatchesLinearScan", RealityDistortionFieldCullingTestFlags)
+
+bool FRealityDistortionFieldGridMatchesLinearScanTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x5244);
+	const double WorldHalfSize = 50000.0;
+
+	TArray<FSphere> FieldSpheres;
+	for (int32 Index = 0; Index < 1000; ++Index)
+	{
+		// 每 50 个放一个巨型力场，覆盖 OversizedFields 路径；另有少量禁用槽位（半径 0）。
+		const double Radius = (Index % 50 == 0) ? 40000.0 : (Index % 97 == 0 ? 0.0 : Random.FRandRange(200.0, 2000.0));
+		FieldSpheres.Emplace(RandomPoint(Random, WorldHalfSize), Radius);
+	}
+
+	TArray<FSphere> Receivers;
+	for (int32 Index = 0; Index < 10000; ++Index)
+	{
+		Receivers.Emplace(RandomPoint(Random, WorldHalfSize * 1.2), Random.FRandRange(50.0, 1000.0));
+	}
+
+	FRealityDistortionFieldGrid Grid;
+	Grid.Build(FieldSpheres);
+
+	uint64 NumHits = 0;
+	const int32 NumMismatches = CountMismatchedReceivers(*this, Grid, FieldSpheres, {}, Receivers, NumHits);
+	TestEqual(TEXT("Receivers whose grid hits differ from the linear scan"), NumMismatches, 0);
+	TestTrue(TEXT("Scene produces overlaps"), NumHits > 0);
+
+	for (const FSphere& Receiver : Receivers)
+	{
+		const TArray<uint32> Hits = CollectGridHits(Grid, Receiver);
+		for (int32 Index = 1; Index < Hits.Num(); ++Index)
+		{
+			if (Hits[Index] == Hits[Index - 1])
+			{
+				AddError(FString::Printf(TEXT("Field %u reported twice for one receiver"), Hits[Index]));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// 有向盒 / 胶囊 / 圆柱：网格结果与“包围球 + 精确 SDF”的线性遍历一致，并且确实剔除了只落在包围球内的接收体。
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldGridShapesTest, "RealityDistortion.FieldCulling.GridShapes", RealityDistortionFieldCullingTestFlags)
+
+bool FRealityDistortionFieldGridShapesTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x52440022);
+	const double WorldHalfSize = 20000.0;
+
+	TArray<FSphere> FieldSpheres;
+	TArray<FRealityDistortionFieldShape> FieldShapes;
+	for (int32 Index = 0; Index < 256; ++Index)
+	{
+		FRealityDistortionFieldShape Shape;
+		Shape.Type = static_cast<uint8>(Index % 4);
+		Shape.Center = RandomPoint(Random, WorldHalfSize);
+		Shape.Rotation = FQuat(FVector(Random.GetUnitVector()), Random.FRandRange(0.0f, UE_TWO_PI));
+		// 细长形状：包围球远大于形状本身。
+		const float Radius = Random.FRandRange(100.0f, 600.0f);
+		Shape.Extent = Shape.Type == REALITY_DISTORTION_FIELD_SHAPE_BOX
+			? FVector3f(Random.FRandRange(100.0f, 3000.0f), Random.FRandRange(50.0f, 300.0f), Random.FRandRange(50.0f, 300.0f))
+			: FVector3f(Radius, Radius, Shape.Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE ? 0.0f : Random.FRandRange(500.0f, 3000.0f));
+		if (Shape.Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE)
+		{
+			Shape.Extent = FVector3f(Radius);
+		}
+
+		FieldShapes.Add(Shape);
+		FieldSpheres.Emplace(Shape.Center, ComputeRealityDistortionFieldShapeBoundingRadius(Shape.Type, Shape.Extent));
+	}
+
+	TArray<FSphere> Receivers;
+	for (int32 Index = 0; Index < 4000; ++Index)
+	{
+		Receivers.Emplace(RandomPoint(Random, WorldHalfSize), Random.FRandRange(20.0, 400.0));
+	}
+
+	FRealityDistortionFieldGrid Grid;
+	Grid.Build(FieldSpheres, FieldShapes);
+
+	uint64 NumExactHits = 0;
+	const int32 NumMismatches = CountMismatchedReceivers(*this, Grid, FieldSpheres, FieldShapes, Receivers, NumExactHits);
+	TestEqual(TEXT("Receivers whose grid hits differ from the exact linear scan"), NumMismatches, 0);
+
+	uint64 NumBoundingSphereHits = 0;
+	for (const FSphere& Receiver : Receivers)
+	{
+		NumBoundingSphereHits += CollectLinearHits(FieldSpheres, {}, Receiver).Num();
+	}
+	TestTrue(TEXT("Exact shape test rejects receivers that only touch the bounding sphere"), NumExactHits < NumBoundingSphereHits);
+	return true;
+}
+
+// 边界情况：空输入、全部禁用、单个力场、接收体恰好相切、网格范围之外的查询。
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldGridEdgeCasesTest, "RealityDistortion.FieldCulling.GridEdgeCases", RealityDistortionFieldCullingTestFlags)
+
+bool FRealityDistortionFieldGridEdgeCasesTest::RunTest(const FString& Parameters)
+{
+	FRealityDistortionFieldGrid Grid;
+	Grid.Build({});
+	TestTrue(TEXT("Empty input builds an empty grid"), Grid.IsEmpty());
+	TestFalse(TEXT("Empty grid has no overlaps"), Grid.IntersectsAnyField(FVector::ZeroVector, 1.0e6f));
+
+	const FSphere Disabled[] = { FSphere(FVector::ZeroVector, 0.0f), FSphere(FVector(100.0), -1.0f) };
+	Grid.Build(Disabled);
+	TestTrue(TEXT("Disabled slots are not indexed"), Grid.IsEmpty());
+
+	const FSphere Single[] = { FSphere(FVector::ZeroVector, 0.0f), FSphere(FVector(1000.0, 0.0, 0.0), 500.0f) };
+	Grid.Build(Single);
+	TestEqual(TEXT("One enabled field"), Grid.GetNumFields(), 1);
+	TestTrue(TEXT("Touching receiver overlaps"), Grid.IntersectsAnyField(FVector(1600.0, 0.0, 0.0), 100.0f));
+	TestFalse(TEXT("Separated receiver does not overlap"), Grid.IntersectsAnyField(FVector(1601.0, 0.0, 0.0), 100.0f));
+	TestFalse(TEXT("Query outside the grid bounds"), Grid.IntersectsAnyField(FVector(-1.0e6, 0.0, 0.0), 10.0f));
+	TestEqual(TEXT("Mask uses the slot index"), Grid.GetOverlappingFieldMask(FVector(1000.0, 0.0, 0.0), 1.0f), uint64(1) << 1);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
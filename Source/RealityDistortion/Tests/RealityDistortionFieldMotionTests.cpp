@@ -0,0 +1,232 @@
+﻿// RealityDistortionFieldMotionTests.cpp
+//
+// 降频力场运动预测（EvaluateRealityDistortionFieldMotion）的自动化测试。纯 CPU，不触碰注册表：
+// 1) 没有速度 / 采样间隔过长 / None 模式返回最近一次采样；
+// 2) 外推：匀速运动精确、超过上限（按推送间隔计）后停住；内插：两端落在两次采样上、推送时刻前后连续；
+// 3) 以 60 FPS 模拟发射器按不同间隔（直到 1 秒）推送，直线运动外推 / 内插精确，外推误差小于保持；
+// 4) 输出满载时一次预测的耗时。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "RealityDistortionField.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionFieldMotionTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	constexpr double TestTolerance = 1.0e-2;
+	constexpr double TestMaxExtrapolationIntervals = 1.5;
+	// 时钟取较大值，覆盖长时间运行后的精度。
+	constexpr double TestBaseTime = 86400.0;
+	constexpr double TestFrameTime = 1.0 / 60.0;
+
+	FRealityDistortionFieldMotionSample EvaluateTestMotion(const FRealityDistortionFieldMotionSamples& Samples, double Time, ERealityDistortionFieldMotionPrediction Mode)
+	{
+		return EvaluateRealityDistortionFieldMotion(Samples, Time, Mode, TestMaxExtrapolationIntervals);
+	}
+
+	// 两次采样：间隔 0.1 秒，速度 (1000, -500, 200) cm/s，半径每秒增长 100。
+	const FVector TestVelocity(1000.0, -500.0, 200.0);
+
+	FRealityDistortionFieldMotionSamples MakeTestSamples()
+	{
+		FRealityDistortionFieldMotionSamples Samples;
+		Samples.PreviousCenter = FVector(100.0, 200.0, 300.0);
+		Samples.PreviousRadius = 500.0f;
+		Samples.PreviousTime = TestBaseTime;
+		Samples.LastCenter = Samples.PreviousCenter + TestVelocity * 0.1;
+		Samples.LastRadius = 510.0f;
+		Samples.LastTime = TestBaseTime + 0.1;
+		return Samples;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldMotionHoldTest, "RealityDistortion.FieldMotion.HoldsWithoutVelocity", RealityDistortionFieldMotionTestFlags)
+
+bool FRealityDistortionFieldMotionHoldTest::RunTest(const FString& Parameters)
+{
+	const FRealityDistortionFieldMotionSamples Samples = MakeTestSamples();
+
+	FRealityDistortionFieldMotionSamples NoHistory = Samples;
+	NoHistory.PreviousTime = -1.0;
+	TestEqual(TEXT("No history holds the last sample"), EvaluateTestMotion(NoHistory, Samples.LastTime + 0.05, ERealityDistortionFieldMotionPrediction::Extrapolate).Center, Samples.LastCenter);
+
+	FRealityDistortionFieldMotionSamples LongGap = Samples;
+	LongGap.PreviousTime = Samples.LastTime - 2.0 * RealityDistortionMaxFieldSampleInterval;
+	TestEqual(TEXT("A long gap holds the last sample"), EvaluateTestMotion(LongGap, Samples.LastTime + 0.05, ERealityDistortionFieldMotionPrediction::Extrapolate).Center, Samples.LastCenter);
+
+	TestEqual(TEXT("None holds the last sample"), EvaluateTestMotion(Samples, Samples.LastTime + 0.05, ERealityDistortionFieldMotionPrediction::None).Center, Samples.LastCenter);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldMotionExtrapolateTest, "RealityDistortion.FieldMotion.Extrapolate", RealityDistortionFieldMotionTestFlags)
+
+bool FRealityDistortionFieldMotionExtrapolateTest::RunTest(const FString& Parameters)
+{
+	const FRealityDistortionFieldMotionSamples Samples = MakeTestSamples();
+	const double Interval = Samples.LastTime - Samples.PreviousTime;
+
+	const FRealityDistortionFieldMotionSample AtPush = EvaluateTestMotion(Samples, Samples.LastTime, ERealityDistortionFieldMotionPrediction::Extrapolate);
+	TestTrue(TEXT("Extrapolation at the push time is the last sample"), AtPush.Center.Equals(Samples.LastCenter, TestTolerance));
+	TestNearlyEqual(TEXT("Extrapolated radius at the push time"), AtPush.Radius, Samples.LastRadius, 1.0e-2f);
+
+	const FRealityDistortionFieldMotionSample Ahead = EvaluateTestMotion(Samples, Samples.LastTime + 0.05, ERealityDistortionFieldMotionPrediction::Extrapolate);
+	TestTrue(TEXT("Extrapolation is linear"), Ahead.Center.Equals(Samples.LastCenter + TestVelocity * 0.05, TestTolerance));
+	TestNearlyEqual(TEXT("Extrapolated radius is linear"), Ahead.Radius, 515.0f, 1.0e-2f);
+
+	const FRealityDistortionFieldMotionSample Clamped = EvaluateTestMotion(Samples, Samples.LastTime + 10.0, ERealityDistortionFieldMotionPrediction::Extrapolate);
+	TestTrue(TEXT("Extrapolation stops after MaxExtrapolationIntervals push intervals"), Clamped.Center.Equals(Samples.LastCenter + TestVelocity * (Interval * TestMaxExtrapolationIntervals), TestTolerance));
+
+	const FRealityDistortionFieldMotionSample Before = EvaluateTestMotion(Samples, Samples.LastTime - 0.05, ERealityDistortionFieldMotionPrediction::Extrapolate);
+	TestTrue(TEXT("Extrapolation never goes backwards"), Before.Center.Equals(Samples.LastCenter, TestTolerance));
+
+	FRealityDistortionFieldMotionSamples Shrinking = Samples;
+	Shrinking.LastRadius = 10.0f;
+	TestEqual(TEXT("Extrapolated radius stops at zero"), EvaluateTestMotion(Shrinking, Samples.LastTime + Interval * TestMaxExtrapolationIntervals, ERealityDistortionFieldMotionPrediction::Extrapolate).Radius, 0.0f);
+
+	// 最长推送间隔（1 秒，Tick 按帧对齐后略长）也要一直外推到下一次推送。
+	FRealityDistortionFieldMotionSamples Slow = Samples;
+	Slow.PreviousTime = Samples.LastTime - (RealityDistortionMaxFieldUpdateInterval + TestFrameTime);
+	const double SlowInterval = Slow.LastTime - Slow.PreviousTime;
+	const FVector SlowVelocity = (Slow.LastCenter - Slow.PreviousCenter) / SlowInterval;
+	const FRealityDistortionFieldMotionSample NextPush = EvaluateTestMotion(Slow, Slow.LastTime + SlowInterval, ERealityDistortionFieldMotionPrediction::Extrapolate);
+	TestTrue(TEXT("1 second pushes are extrapolated up to the next push"), NextPush.Center.Equals(Slow.LastCenter + SlowVelocity * SlowInterval, TestTolerance));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldMotionInterpolateTest, "RealityDistortion.FieldMotion.Interpolate", RealityDistortionFieldMotionTestFlags)
+
+bool FRealityDistortionFieldMotionInterpolateTest::RunTest(const FString& Parameters)
+{
+	// 推送时刻落在上一次采样，一个间隔后到达最近一次采样。
+	const FRealityDistortionFieldMotionSamples Samples = MakeTestSamples();
+	TestTrue(TEXT("Interpolation starts at the previous sample"), EvaluateTestMotion(Samples, Samples.LastTime, ERealityDistortionFieldMotionPrediction::Interpolate).Center.Equals(Samples.PreviousCenter, TestTolerance));
+	TestTrue(TEXT("Interpolation passes the midpoint"), EvaluateTestMotion(Samples, Samples.LastTime + 0.05, ERealityDistortionFieldMotionPrediction::Interpolate).Center.Equals((Samples.PreviousCenter + Samples.LastCenter) * 0.5, TestTolerance));
+	TestTrue(TEXT("Interpolation ends at the last sample"), EvaluateTestMotion(Samples, Samples.LastTime + 1.0, ERealityDistortionFieldMotionPrediction::Interpolate).Center.Equals(Samples.LastCenter, TestTolerance));
+
+	// 下一次推送（同样间隔）到来前后连续。
+	FRealityDistortionFieldMotionSamples Next = Samples;
+	Next.PreviousCenter = Samples.LastCenter;
+	Next.PreviousTime = Samples.LastTime;
+	Next.LastCenter = Samples.LastCenter + TestVelocity * 0.1;
+	Next.LastTime = Samples.LastTime + 0.1;
+	TestTrue(TEXT("Interpolation is continuous across pushes"), EvaluateTestMotion(Samples, Next.LastTime, ERealityDistortionFieldMotionPrediction::Interpolate).Center.Equals(
+		EvaluateTestMotion(Next, Next.LastTime, ERealityDistortionFieldMotionPrediction::Interpolate).Center, TestTolerance));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldMotionSimulationTest, "RealityDistortion.FieldMotion.Simulation", RealityDistortionFieldMotionTestFlags)
+
+bool FRealityDistortionFieldMotionSimulationTest::RunTest(const FString& Parameters)
+{
+	// 60 FPS 模拟：发射器每 PushInterval 帧推送一次，RT 每帧预测。内插的误差按“晚一个间隔”的真值计算。
+	const ERealityDistortionFieldMotionPrediction Modes[] =
+	{
+		ERealityDistortionFieldMotionPrediction::None,
+		ERealityDistortionFieldMotionPrediction::Extrapolate,
+		ERealityDistortionFieldMotionPrediction::Interpolate,
+	};
+	// 60 帧即组件允许的最长推送间隔（RealityDistortionMaxFieldUpdateInterval）。
+	const int32 PushIntervals[] = { 1, 4, 15, 60 };
+
+	for (const int32 PushInterval : PushIntervals)
+	{
+		for (const bool bCircular : { false, true })
+		{
+			// 直线 600 cm/s；圆周半径 1000 cm、0.5 圈/秒（约 3140 cm/s，远快于一般角色）。
+			auto TruthAt = [bCircular](double Time)
+			{
+				const double LocalTime = Time - TestBaseTime;
+				if (!bCircular)
+				{
+					return FVector(600.0 * LocalTime, 0.0, 0.0);
+				}
+				const double Angle = UE_DOUBLE_PI * LocalTime;
+				return FVector(1000.0 * FMath::Cos(Angle), 1000.0 * FMath::Sin(Angle), 0.0);
+			};
+
+			double MaxErrors[UE_ARRAY_COUNT(Modes)] = {};
+			FRealityDistortionFieldMotionSamples Simulated;
+			const int32 NumFrames = FMath::Max(600, 10 * PushInterval);
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				const double Time = TestBaseTime + Frame * TestFrameTime;
+				if (Frame % PushInterval == 0)
+				{
+					Simulated.PreviousCenter = Simulated.LastCenter;
+					Simulated.PreviousTime = Simulated.LastTime;
+					Simulated.LastCenter = TruthAt(Time);
+					Simulated.LastTime = Time;
+				}
+				// 前两次推送之前没有速度，不计入。
+				if (Frame < 2 * PushInterval)
+				{
+					continue;
+				}
+
+				for (int32 ModeIndex = 0; ModeIndex < UE_ARRAY_COUNT(Modes); ++ModeIndex)
+				{
+					const double ReferenceTime = Modes[ModeIndex] == ERealityDistortionFieldMotionPrediction::Interpolate ? Time - PushInterval * TestFrameTime : Time;
+					const double Error = FVector::Dist(EvaluateTestMotion(Simulated, Time, Modes[ModeIndex]).Center, TruthAt(ReferenceTime));
+					MaxErrors[ModeIndex] = FMath::Max(MaxErrors[ModeIndex], Error);
+				}
+			}
+
+			AddInfo(FString::Printf(TEXT("%s motion, push every %d frames: max error hold %.2f cm, extrapolate %.2f cm, interpolate %.2f cm (one push interval late)"),
+				bCircular ? TEXT("circular") : TEXT("linear"), PushInterval, MaxErrors[0], MaxErrors[1], MaxErrors[2]));
+
+			if (!bCircular)
+			{
+				TestTrue(FString::Printf(TEXT("Linear motion is predicted exactly when pushing every %d frames"), PushInterval), MaxErrors[1] < TestTolerance && MaxErrors[2] < TestTolerance);
+			}
+			// 圆周运动每秒半圈，1 秒一推时两次采样落在直径两端，速度估计没有意义，只比较更短的间隔。
+			if (PushInterval > 1 && (!bCircular || PushInterval <= 15))
+			{
+				TestTrue(FString::Printf(TEXT("Extrapolation beats holding the last sample when pushing every %d frames"), PushInterval), MaxErrors[1] < MaxErrors[0]);
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldMotionCostTest, "RealityDistortion.FieldMotion.PredictionCost", RealityDistortionFieldMotionTestFlags)
+
+bool FRealityDistortionFieldMotionCostTest::RunTest(const FString& Parameters)
+{
+	// 预测开销：注册表满载（4096 个有速度的力场），即 RT 每帧的开销。
+	constexpr int32 NumFields = 4096;
+	constexpr int32 PushInterval = 4;
+
+	FRandomStream Random(0x52440024);
+	TArray<FRealityDistortionFieldMotionSamples> FieldSamples;
+	FieldSamples.SetNum(NumFields);
+	for (FRealityDistortionFieldMotionSamples& Field : FieldSamples)
+	{
+		Field.PreviousCenter = FVector(Random.GetUnitVector()) * 10000.0;
+		Field.PreviousRadius = Random.FRandRange(100.0f, 1000.0f);
+		Field.PreviousTime = TestBaseTime;
+		Field.LastCenter = Field.PreviousCenter + FVector(Random.GetUnitVector()) * 50.0;
+		Field.LastRadius = Field.PreviousRadius;
+		Field.LastTime = TestBaseTime + PushInterval * TestFrameTime;
+	}
+
+	double Checksum = 0.0;
+	const double StartTime = FPlatformTime::Seconds();
+	for (const FRealityDistortionFieldMotionSamples& Field : FieldSamples)
+	{
+		const FRealityDistortionFieldMotionSample Sample = EvaluateTestMotion(Field, Field.LastTime + TestFrameTime, ERealityDistortionFieldMotionPrediction::Extrapolate);
+		Checksum += Sample.Center.X + Sample.Radius;
+	}
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	AddInfo(FString::Printf(TEXT("%d fields predicted in %.3f ms (%.1f ns/field, checksum %.3f)"),
+		NumFields, ElapsedMs, ElapsedMs * 1.0e6 / NumFields, Checksum));
+	TestTrue(TEXT("Prediction produces finite results"), FMath::IsFinite(Checksum));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,165 @@
+﻿// RealityDistortionFieldRegistryTests.cpp
+//
+// 力场注册表（RealityDistortionField.cpp）的自动化测试：句柄池、增量队列溢出与帧栅栏。
+// 需要渲染线程消费增量（FlushRenderingCommands），-nullrhi 下同样可以运行。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "RealityDistortionField.h"
+#include "RenderingThread.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionFieldRegistryTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	// 句柄低 32 位即槽位号（见 RealityDistortionField.h）。
+	uint32 GetFieldSlotIndex(uint64 Handle)
+	{
+		return static_cast<uint32>(Handle);
+	}
+
+	// 提交栅栏之外的任何增量都不会被消费；测试结束前提交并等待 RT，保证不留下积压的增量。
+	void SubmitAndFlushFieldUpdates()
+	{
+		SubmitRealityDistortionFieldUpdates_GameThread();
+		FlushRenderingCommands();
+	}
+
+	// 读取 RT 侧某个槽位当前的包围球半径；槽位从未写入时返回 -1。
+	float ReadFieldRadius(uint32 SlotIndex)
+	{
+		float Radius = -1.0f;
+		ENQUEUE_RENDER_COMMAND(RealityDistortionTestReadFieldRadius)(
+			[SlotIndex, &Radius](FRHICommandListImmediate&)
+			{
+				const FRealityDistortionFieldsView Fields = GetRealityDistortionFields_RenderThread();
+				Radius = static_cast<int32>(SlotIndex) < Fields.Num() ? Fields.Radii[SlotIndex] : -1.0f;
+			});
+		FlushRenderingCommands();
+		return Radius;
+	}
+
+	FRealityDistortionFieldSettings MakeTestFieldSettings(float Radius)
+	{
+		FRealityDistortionFieldSettings Settings;
+		Settings.Center = FVector(1.0e6, -1.0e6, 1.0e6);
+		Settings.Radius = Radius;
+		Settings.bEnabled = true;
+		return Settings;
+	}
+}
+
+// 整批创建 / 销毁 100k 个句柄：句柄唯一且有效，销毁后被代数拒绝，句柄池容量完全回收。
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldHandleChurnTest, "RealityDistortion.FieldRegistry.HandleChurn", RealityDistortionFieldRegistryTestFlags)
+
+bool FRealityDistortionFieldHandleChurnTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumHandles = 100000;
+	constexpr int32 BatchSize = 1024;
+
+	TArray<uint64> Handles;
+	Handles.Reserve(BatchSize);
+	TSet<uint64> UniqueHandles;
+	UniqueHandles.Reserve(BatchSize);
+
+	int32 NumInvalidOrDuplicate = 0;
+	int32 NumStaleAccepted = 0;
+	for (int32 NumCreated = 0; NumCreated < NumHandles; NumCreated += BatchSize)
+	{
+		Handles.Reset();
+		UniqueHandles.Reset();
+		for (int32 Index = 0; Index < BatchSize; ++Index)
+		{
+			const uint64 Handle = CreateRealityDistortionFieldHandle_GameThread();
+			bool bAlreadyInSet = false;
+			UniqueHandles.Add(Handle, &bAlreadyInSet);
+			NumInvalidOrDuplicate += (Handle == RealityDistortionInvalidFieldHandle || bAlreadyInSet || !IsRealityDistortionFieldHandleValid_GameThread(Handle)) ? 1 : 0;
+			Handles.Add(Handle);
+		}
+
+		for (const uint64 Handle : Handles)
+		{
+			DestroyRealityDistortionFieldHandle_GameThread(Handle);
+			NumStaleAccepted += IsRealityDistortionFieldHandleValid_GameThread(Handle) ? 1 : 0;
+		}
+	}
+
+	TestEqual(TEXT("Invalid or duplicate handles"), NumInvalidOrDuplicate, 0);
+	TestEqual(TEXT("Destroyed handles still valid"), NumStaleAccepted, 0);
+
+	// 销毁产生的 Clear 增量远超环形队列容量，这里同时覆盖溢出数组的消费。
+	SubmitAndFlushFieldUpdates();
+	return true;
+}
+
+// 同一个槽位复用超过 16 位代数的范围后，最早的句柄仍然无效，不会与新句柄重合。
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldStaleHandleTest, "RealityDistortion.FieldRegistry.StaleHandleNeverAliases", RealityDistortionFieldRegistryTestFlags)
+
+bool FRealityDistortionFieldStaleHandleTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumReuses = 70000;
+
+	const uint64 FirstHandle = CreateRealityDistortionFieldHandle_GameThread();
+	if (!TestNotEqual(TEXT("First handle"), FirstHandle, RealityDistortionInvalidFieldHandle))
+	{
+		return false;
+	}
+	DestroyRealityDistortionFieldHandle_GameThread(FirstHandle);
+
+	// 空闲槽位后进先出，每次都复用同一个槽位。
+	int32 NumOtherSlots = 0;
+	int32 NumAliases = 0;
+	for (int32 Reuse = 0; Reuse < NumReuses; ++Reuse)
+	{
+		const uint64 Handle = CreateRealityDistortionFieldHandle_GameThread();
+		NumOtherSlots += GetFieldSlotIndex(Handle) != GetFieldSlotIndex(FirstHandle) ? 1 : 0;
+		NumAliases += (Handle == FirstHandle || IsRealityDistortionFieldHandleValid_GameThread(FirstHandle)) ? 1 : 0;
+		DestroyRealityDistortionFieldHandle_GameThread(Handle);
+	}
+
+	TestEqual(TEXT("Reuses landing on another slot"), NumOtherSlots, 0);
+	TestEqual(TEXT("Stale handle aliases"), NumAliases, 0);
+
+	SubmitAndFlushFieldUpdates();
+	return true;
+}
+
+// 一帧内写入数倍于环形队列容量的增量：不 Flush、不丢弃，RT 按写入顺序消费，且只消费到栅栏为止。
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldDeltaOverflowTest, "RealityDistortion.FieldRegistry.OverflowKeepsOrderAndFence", RealityDistortionFieldRegistryTestFlags)
+
+bool FRealityDistortionFieldDeltaOverflowTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumSets = 3 * 4096 + 17;
+
+	const uint64 Handle = CreateRealityDistortionFieldHandle_GameThread();
+	if (!TestNotEqual(TEXT("Handle"), Handle, RealityDistortionInvalidFieldHandle))
+	{
+		return false;
+	}
+	const uint32 SlotIndex = GetFieldSlotIndex(Handle);
+
+	for (int32 Index = 1; Index <= NumSets; ++Index)
+	{
+		SetRealityDistortionFieldSettings_GameThread(Handle, MakeTestFieldSettings(static_cast<float>(Index)));
+	}
+	SubmitRealityDistortionFieldUpdates_GameThread();
+
+	// 栅栏之后的增量（同样落在溢出数组里）留到下一次提交。
+	constexpr float LateRadius = 0.5f;
+	SetRealityDistortionFieldSettings_GameThread(Handle, MakeTestFieldSettings(LateRadius));
+	FlushRenderingCommands();
+	TestEqual(TEXT("Radius after the fenced drain"), ReadFieldRadius(SlotIndex), static_cast<float>(NumSets));
+
+	SubmitAndFlushFieldUpdates();
+	TestEqual(TEXT("Radius after the next fence"), ReadFieldRadius(SlotIndex), LateRadius);
+
+	// 销毁后槽位在 RT 清成禁用状态。
+	DestroyRealityDistortionFieldHandle_GameThread(Handle);
+	SubmitAndFlushFieldUpdates();
+	TestEqual(TEXT("Radius after destroy"), ReadFieldRadius(SlotIndex), 0.0f);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
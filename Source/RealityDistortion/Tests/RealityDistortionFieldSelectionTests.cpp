@@ -0,0 +1,140 @@
+﻿// RealityDistortionFieldSelectionTests.cpp
+//
+// 力场选择（SelectRealityDistortionFields）的自动化测试。
+// 纯 CPU，不依赖 RT / GPU：随机生成力场（约 1/4 在视锥外、优先级 0~2、随机屏幕尺寸），每帧扰动屏幕尺寸后重新选择，校验：
+// 1) 选中数 = min(Budget, 可见数)，视锥外的力场不会被选中；
+// 2) 没有落选的可见力场排在任何选中力场之前；
+// 3) Buffer 位置唯一且在范围内，连续两帧都选中的力场位置不变。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Math/RandomStream.h"
+#include "Rendering/RealityDistortionFieldSelection.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionFieldSelectionTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	constexpr int32 TestNumFields = 256;
+	constexpr int32 TestBudget = 16;
+	constexpr int32 TestNumFrames = 60;
+
+	// 与 RealityDistortionFieldSelection.cpp 的排序一致：优先级高的在前，同优先级屏幕尺寸大的在前，再按槽位。
+	bool TestRanksBefore(const FRealityDistortionFieldCandidate& A, int32 SlotA, const FRealityDistortionFieldCandidate& B, int32 SlotB)
+	{
+		if (A.Priority != B.Priority)
+		{
+			return A.Priority > B.Priority;
+		}
+		if (A.ScreenSize != B.ScreenSize)
+		{
+			return A.ScreenSize > B.ScreenSize;
+		}
+		return SlotA < SlotB;
+	}
+
+	bool IsTestCandidateVisible(const FRealityDistortionFieldCandidate& Candidate)
+	{
+		return Candidate.Sphere.W > 0.0f && Candidate.ScreenSize >= 0.0f;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldSelectionBudgetTest, "RealityDistortion.FieldSelection.BudgetRankingAndStablePositions", RealityDistortionFieldSelectionTestFlags)
+
+bool FRealityDistortionFieldSelectionBudgetTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x52440015);
+	TArray<FRealityDistortionFieldCandidate> Candidates;
+	Candidates.SetNum(TestNumFields);
+	for (FRealityDistortionFieldCandidate& Candidate : Candidates)
+	{
+		Candidate.Sphere = FSphere(FVector::ZeroVector, Random.FRand() < 0.1f ? 0.0f : 100.0f);
+		Candidate.Priority = Random.RandRange(0, 2);
+	}
+
+	int32 NumCountFailures = 0;
+	int32 NumPositionFailures = 0;
+	int32 NumInvisibleSelected = 0;
+	int32 NumRankingFailures = 0;
+	int32 NumStableFields = 0;
+	int32 NumMovedFields = 0;
+	FRealityDistortionFieldSelection Previous;
+	FRealityDistortionFieldSelection Selection;
+
+	for (int32 Frame = 0; Frame < TestNumFrames; ++Frame)
+	{
+		int32 NumVisible = 0;
+		for (FRealityDistortionFieldCandidate& Candidate : Candidates)
+		{
+			Candidate.ScreenSize = Random.FRand() < 0.25f ? -1.0f : Random.FRand();
+			NumVisible += IsTestCandidateVisible(Candidate) ? 1 : 0;
+		}
+
+		SelectRealityDistortionFields(Candidates, TestBudget, Previous, Selection);
+
+		NumCountFailures += Selection.NumSelected == FMath::Min(TestBudget, NumVisible) ? 0 : 1;
+		NumCountFailures += Selection.NumOverBudget == NumVisible - Selection.NumSelected ? 0 : 1;
+
+		TBitArray<> bSelected(false, TestNumFields);
+		int32 NumOccupied = 0;
+		for (int32 BufferIndex = 0; BufferIndex < static_cast<int32>(MAX_DISTORTION_FIELDS); ++BufferIndex)
+		{
+			const int32 SlotIndex = Selection.BufferToSlot[BufferIndex];
+			if (SlotIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			++NumOccupied;
+			NumPositionFailures += (BufferIndex < Selection.NumBufferSlots && !bSelected[SlotIndex]) ? 0 : 1;
+			NumInvisibleSelected += IsTestCandidateVisible(Candidates[SlotIndex]) ? 0 : 1;
+			bSelected[SlotIndex] = true;
+
+			for (int32 PreviousIndex = 0; PreviousIndex < Previous.NumBufferSlots; ++PreviousIndex)
+			{
+				if (Previous.BufferToSlot[PreviousIndex] == SlotIndex)
+				{
+					++(PreviousIndex == BufferIndex ? NumStableFields : NumMovedFields);
+				}
+			}
+		}
+		NumCountFailures += NumOccupied == Selection.NumSelected ? 0 : 1;
+
+		// 排序一致性：落选的可见力场不能排在任何选中力场之前。
+		for (int32 SlotIndex = 0; SlotIndex < TestNumFields; ++SlotIndex)
+		{
+			const FRealityDistortionFieldCandidate& Candidate = Candidates[SlotIndex];
+			if (bSelected[SlotIndex] || !IsTestCandidateVisible(Candidate))
+			{
+				continue;
+			}
+
+			for (int32 BufferIndex = 0; BufferIndex < Selection.NumBufferSlots; ++BufferIndex)
+			{
+				const int32 SelectedSlot = Selection.BufferToSlot[BufferIndex];
+				if (SelectedSlot != INDEX_NONE && TestRanksBefore(Candidate, SlotIndex, Candidates[SelectedSlot], SelectedSlot))
+				{
+					++NumRankingFailures;
+					break;
+				}
+			}
+		}
+
+		Previous = Selection;
+	}
+
+	AddInfo(FString::Printf(TEXT("%d fields, budget=%d, %d frames, last frame active=%d frustum culled=%d selected=%d over budget=%d, kept position=%d"),
+		TestNumFields, TestBudget, TestNumFrames, Selection.NumActive, Selection.NumFrustumCulled, Selection.NumSelected, Selection.NumOverBudget, NumStableFields));
+
+	TestEqual(TEXT("Frames with wrong selected / over-budget / occupied counts"), NumCountFailures, 0);
+	TestEqual(TEXT("Duplicate or out-of-range buffer positions"), NumPositionFailures, 0);
+	TestEqual(TEXT("Selected fields outside every frustum"), NumInvisibleSelected, 0);
+	TestEqual(TEXT("Unselected visible fields ranking before a selected field"), NumRankingFailures, 0);
+	TestEqual(TEXT("Fields selected in consecutive frames that moved buffer position"), NumMovedFields, 0);
+	TestTrue(TEXT("Some fields stay selected across frames"), NumStableFields > 0);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,240 @@
+﻿// RealityDistortionFieldShapesTests.cpp
+//
+// 力场形状（RealityDistortionFieldShapes.h）的自动化测试。纯 CPU：
+// 1) 参考点：轴对齐 / 旋转后的四种形状上手算的 SDF、影响度、包围球与 AABB；
+// 2) 随机实例：与独立写法的参考实现比较（FTransform 逆变换 + 最近点投影 / 到各面的最小深度），
+//    球形另与原来的 1 - d / R 影响度比较，并检查剔除与顶点阶段判定依赖的性质：
+//    1-Lipschitz、凸性、内部点都在包围球与 AABB 内、中心影响度为 1。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Math/RandomStream.h"
+#include "Rendering/RealityDistortionFieldShapes.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionFieldShapesTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	// 参考点的坐标在 1e3 量级，float 误差远小于该值。
+	constexpr float TestReferenceTolerance = 1.0e-3f;
+
+	// 随机实例：世界坐标在 1e4 量级，float 有符号距离的误差在 1e-3 量级；留出余量。
+	constexpr float TestDistanceTolerance = 0.02f;
+	constexpr float TestInfluenceTolerance = 1.0e-3f;
+	constexpr int32 TestShapesPerType = 32;
+	constexpr int32 TestSamplesPerShape = 1024;
+
+	float TestSmoothFalloff(float T)
+	{
+		return T * T * (3.0f - 2.0f * T);
+	}
+
+	const TCHAR* GetTestFieldShapeName(uint8 Type)
+	{
+		switch (Type)
+		{
+		case REALITY_DISTORTION_FIELD_SHAPE_BOX: return TEXT("Box");
+		case REALITY_DISTORTION_FIELD_SHAPE_CAPSULE: return TEXT("Capsule");
+		case REALITY_DISTORTION_FIELD_SHAPE_CYLINDER: return TEXT("Cylinder");
+		default: return TEXT("Sphere");
+		}
+	}
+
+	FRealityDistortionFieldShape MakeTestShape(uint8 Type, const FVector& Center, const FVector3f& Extent, const FQuat& Rotation = FQuat::Identity)
+	{
+		FRealityDistortionFieldShape Shape;
+		Shape.Type = Type;
+		Shape.Center = Center;
+		Shape.Rotation = Rotation;
+		Shape.Extent = Extent;
+		return Shape;
+	}
+
+	struct FTestReferencePoint
+	{
+		const TCHAR* Name;
+		FRealityDistortionFieldShape Shape;
+		FVector Position;
+		float SignedDistance;
+		float Influence;
+	};
+
+	double ComputeReferenceSignedDistance(const FRealityDistortionFieldShape& Shape, const FVector& Position)
+	{
+		const FVector P = FTransform(Shape.Rotation, Shape.Center).InverseTransformPosition(Position);
+		const FVector E(Shape.Extent);
+
+		switch (Shape.Type)
+		{
+		case REALITY_DISTORTION_FIELD_SHAPE_BOX:
+		{
+			const FVector Closest(FMath::Clamp(P.X, -E.X, E.X), FMath::Clamp(P.Y, -E.Y, E.Y), FMath::Clamp(P.Z, -E.Z, E.Z));
+			if (Closest != P)
+			{
+				return FVector::Dist(P, Closest);
+			}
+			return -FMath::Min3(E.X - FMath::Abs(P.X), E.Y - FMath::Abs(P.Y), E.Z - FMath::Abs(P.Z));
+		}
+		case REALITY_DISTORTION_FIELD_SHAPE_CAPSULE:
+			return FMath::PointDistToSegment(P, FVector(0.0, 0.0, -E.Z), FVector(0.0, 0.0, E.Z)) - E.X;
+		case REALITY_DISTORTION_FIELD_SHAPE_CYLINDER:
+		{
+			const double RadialDistance = FVector2D(P.X, P.Y).Size();
+			if (RadialDistance <= E.X && FMath::Abs(P.Z) <= E.Z)
+			{
+				return -FMath::Min(E.X - RadialDistance, E.Z - FMath::Abs(P.Z));
+			}
+			const double ClosestRadial = FMath::Min(RadialDistance, E.X);
+			const double ClosestZ = FMath::Clamp(P.Z, -E.Z, E.Z);
+			return FVector2D(RadialDistance - ClosestRadial, P.Z - ClosestZ).Size();
+		}
+		default:
+			return FVector::Dist(P, FVector::ZeroVector) - E.X;
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldShapesReferencePointsTest, "RealityDistortion.FieldShapes.ReferencePoints", RealityDistortionFieldShapesTestFlags)
+
+bool FRealityDistortionFieldShapesReferencePointsTest::RunTest(const FString& Parameters)
+{
+	const FRealityDistortionFieldShape Sphere = MakeTestShape(REALITY_DISTORTION_FIELD_SHAPE_SPHERE, FVector::ZeroVector, FVector3f(100.0f));
+	const FRealityDistortionFieldShape Box = MakeTestShape(REALITY_DISTORTION_FIELD_SHAPE_BOX, FVector::ZeroVector, FVector3f(100.0f, 50.0f, 25.0f));
+	const FRealityDistortionFieldShape Capsule = MakeTestShape(REALITY_DISTORTION_FIELD_SHAPE_CAPSULE, FVector::ZeroVector, FVector3f(50.0f, 50.0f, 100.0f));
+	const FRealityDistortionFieldShape Cylinder = MakeTestShape(REALITY_DISTORTION_FIELD_SHAPE_CYLINDER, FVector::ZeroVector, FVector3f(50.0f, 50.0f, 100.0f));
+	// 绕 Z 旋转 90°：局部 X 指向世界 Y。
+	const FRealityDistortionFieldShape RotatedBox = MakeTestShape(REALITY_DISTORTION_FIELD_SHAPE_BOX, FVector(1000.0, 0.0, 0.0), FVector3f(100.0f, 50.0f, 25.0f),
+		FQuat(FVector::UpVector, UE_HALF_PI));
+	// 绕 Y 旋转 90°：局部 Z（轴线）指向世界 X。
+	const FRealityDistortionFieldShape RotatedCapsule = MakeTestShape(REALITY_DISTORTION_FIELD_SHAPE_CAPSULE, FVector(0.0, 1000.0, 0.0), FVector3f(50.0f, 50.0f, 100.0f),
+		FQuat(FVector::RightVector, UE_HALF_PI));
+
+	// 影响度：smoothstep(0.5) = 0.5，smoothstep(0.4) = 0.352，smoothstep(0.2) = 0.104。
+	const FTestReferencePoint ReferencePoints[] =
+	{
+		{ TEXT("Sphere center"), Sphere, FVector::ZeroVector, -100.0f, 1.0f },
+		{ TEXT("Sphere half radius"), Sphere, FVector(50.0, 0.0, 0.0), -50.0f, 0.5f },
+		{ TEXT("Sphere outside"), Sphere, FVector(0.0, 0.0, 150.0), 50.0f, 0.0f },
+		{ TEXT("Box center"), Box, FVector::ZeroVector, -25.0f, 1.0f },
+		{ TEXT("Box inside near X face"), Box, FVector(90.0, 0.0, 0.0), -10.0f, 0.352f },
+		{ TEXT("Box outside X face"), Box, FVector(200.0, 0.0, 0.0), 100.0f, 0.0f },
+		{ TEXT("Box outside XY edge"), Box, FVector(130.0, 90.0, 0.0), 50.0f, 0.0f },
+		{ TEXT("Capsule center"), Capsule, FVector::ZeroVector, -50.0f, 1.0f },
+		{ TEXT("Capsule inside cap"), Capsule, FVector(0.0, 0.0, 130.0), -20.0f, 0.352f },
+		{ TEXT("Capsule outside side"), Capsule, FVector(80.0, 0.0, 0.0), 30.0f, 0.0f },
+		{ TEXT("Capsule outside cap"), Capsule, FVector(0.0, 0.0, 200.0), 50.0f, 0.0f },
+		{ TEXT("Cylinder center"), Cylinder, FVector::ZeroVector, -50.0f, 1.0f },
+		{ TEXT("Cylinder inside side"), Cylinder, FVector(30.0, 0.0, 0.0), -20.0f, 0.352f },
+		{ TEXT("Cylinder inside end"), Cylinder, FVector(0.0, 0.0, 90.0), -10.0f, 0.104f },
+		{ TEXT("Cylinder outside rim"), Cylinder, FVector(80.0, 0.0, 120.0), FMath::Sqrt(1300.0f), 0.0f },
+		{ TEXT("Rotated box outside local X face"), RotatedBox, FVector(1000.0, 150.0, 0.0), 50.0f, 0.0f },
+		{ TEXT("Rotated box outside local Y face"), RotatedBox, FVector(1150.0, 0.0, 0.0), 100.0f, 0.0f },
+		{ TEXT("Rotated box inside local X face"), RotatedBox, FVector(1000.0, 90.0, 0.0), -10.0f, 0.352f },
+		{ TEXT("Rotated capsule inside cap"), RotatedCapsule, FVector(130.0, 1000.0, 0.0), -20.0f, 0.352f },
+		{ TEXT("Rotated capsule outside side"), RotatedCapsule, FVector(0.0, 1000.0, 80.0), 30.0f, 0.0f },
+	};
+
+	for (const FTestReferencePoint& Point : ReferencePoints)
+	{
+		TestNearlyEqual(FString::Printf(TEXT("%s signed distance"), Point.Name),
+			ComputeRealityDistortionFieldSignedDistance(Point.Shape, Point.Position), Point.SignedDistance, TestReferenceTolerance);
+		TestNearlyEqual(FString::Printf(TEXT("%s influence"), Point.Name),
+			CalculateRealityDistortionShapedFieldInfluence(Point.Shape, Point.Position), Point.Influence, TestReferenceTolerance);
+		TestNearlyEqual(FString::Printf(TEXT("%s clip distance"), Point.Name),
+			ComputeRealityDistortionFieldClipDistance(Point.Shape, Point.Position),
+			Point.SignedDistance + REALITY_DISTORTION_INFLUENCE_CLIP_FALLOFF_FRACTION * ComputeRealityDistortionFieldShapeFalloffDistance(Point.Shape.Type, Point.Shape.Extent),
+			TestReferenceTolerance);
+	}
+
+	TestNearlyEqual(TEXT("Box bounding radius"), ComputeRealityDistortionFieldShapeBoundingRadius(Box.Type, Box.Extent), FMath::Sqrt(13125.0f), TestReferenceTolerance);
+	TestNearlyEqual(TEXT("Capsule bounding radius"), ComputeRealityDistortionFieldShapeBoundingRadius(Capsule.Type, Capsule.Extent), 150.0f, TestReferenceTolerance);
+	TestNearlyEqual(TEXT("Cylinder bounding radius"), ComputeRealityDistortionFieldShapeBoundingRadius(Cylinder.Type, Cylinder.Extent), FMath::Sqrt(12500.0f), TestReferenceTolerance);
+
+	const FBox RotatedBoxBounds = ComputeRealityDistortionFieldShapeBounds(RotatedBox);
+	TestTrue(TEXT("Rotated box AABB swaps X / Y extents"), RotatedBoxBounds.Equals(FBox(FVector(950.0, -100.0, -25.0), FVector(1050.0, 100.0, 25.0)), TestReferenceTolerance));
+	const FBox RotatedCapsuleBounds = ComputeRealityDistortionFieldShapeBounds(RotatedCapsule);
+	TestTrue(TEXT("Rotated capsule AABB follows the axis"), RotatedCapsuleBounds.Equals(FBox(FVector(-150.0, 950.0, -50.0), FVector(150.0, 1050.0, 50.0)), TestReferenceTolerance));
+	const FBox CylinderBounds = ComputeRealityDistortionFieldShapeBounds(Cylinder);
+	TestTrue(TEXT("Cylinder AABB"), CylinderBounds.Equals(FBox(FVector(-50.0, -50.0, -100.0), FVector(50.0, 50.0, 100.0)), TestReferenceTolerance));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionFieldShapesMatchesReferenceTest, "RealityDistortion.FieldShapes.MatchesReference", RealityDistortionFieldShapesTestFlags)
+
+bool FRealityDistortionFieldShapesMatchesReferenceTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x52440022);
+
+	for (uint8 Type = REALITY_DISTORTION_FIELD_SHAPE_SPHERE; Type <= REALITY_DISTORTION_FIELD_SHAPE_CYLINDER; ++Type)
+	{
+		float MaxDistanceError = 0.0f;
+		float MaxInfluenceError = 0.0f;
+		int32 NumCenterFailures = 0;
+		int32 NumPropertyFailures = 0;
+
+		for (int32 ShapeIndex = 0; ShapeIndex < TestShapesPerType; ++ShapeIndex)
+		{
+			FRealityDistortionFieldShape Shape;
+			Shape.Type = Type;
+			Shape.Center = FVector(Random.FRandRange(-10000.0f, 10000.0f), Random.FRandRange(-10000.0f, 10000.0f), Random.FRandRange(-1000.0f, 1000.0f));
+			Shape.Rotation = FQuat(FVector(Random.GetUnitVector()), Random.FRandRange(0.0f, 2.0f * UE_PI));
+			// 包含细长 / 扁平的比例，覆盖走廊、墙面一类用法。
+			Shape.Extent = FVector3f(Random.FRandRange(20.0f, 1000.0f), Random.FRandRange(20.0f, 1000.0f), Random.FRandRange(0.0f, 2000.0f));
+			if (Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE)
+			{
+				Shape.Extent = FVector3f(Shape.Extent.X);
+			}
+
+			const float BoundingRadius = ComputeRealityDistortionFieldShapeBoundingRadius(Type, Shape.Extent);
+			const float FalloffDistance = ComputeRealityDistortionFieldShapeFalloffDistance(Type, Shape.Extent);
+			const FBox Bounds = ComputeRealityDistortionFieldShapeBounds(Shape).ExpandBy(TestDistanceTolerance);
+
+			NumCenterFailures += FMath::Abs(CalculateRealityDistortionShapedFieldInfluence(Shape, Shape.Center) - 1.0f) <= TestInfluenceTolerance ? 0 : 1;
+
+			for (int32 Sample = 0; Sample < TestSamplesPerShape; ++Sample)
+			{
+				const FVector Position = Shape.Center + FVector(Random.GetUnitVector()) * (1.5f * BoundingRadius * FMath::Pow(Random.FRand(), 1.0f / 3.0f));
+				const FVector Other = Shape.Center + FVector(Random.GetUnitVector()) * (1.5f * BoundingRadius * FMath::Pow(Random.FRand(), 1.0f / 3.0f));
+
+				const float SignedDistance = ComputeRealityDistortionFieldSignedDistance(Shape, Position);
+				const float ReferenceDistance = static_cast<float>(ComputeReferenceSignedDistance(Shape, Position));
+
+				float ReferenceInfluence;
+				if (Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE)
+				{
+					// 原来的球形公式，保证球形力场的画面不变。
+					ReferenceInfluence = TestSmoothFalloff(FMath::Clamp(1.0f - static_cast<float>(FVector::Dist(Position, Shape.Center)) / Shape.Extent.X, 0.0f, 1.0f));
+				}
+				else
+				{
+					ReferenceInfluence = FalloffDistance > 0.0f ? TestSmoothFalloff(FMath::Clamp(-ReferenceDistance / FalloffDistance, 0.0f, 1.0f)) : 0.0f;
+				}
+
+				MaxDistanceError = FMath::Max(MaxDistanceError, FMath::Abs(SignedDistance - ReferenceDistance));
+				MaxInfluenceError = FMath::Max(MaxInfluenceError, FMath::Abs(CalculateRealityDistortionShapedFieldInfluence(Shape, Position) - ReferenceInfluence));
+
+				const float OtherDistance = ComputeRealityDistortionFieldSignedDistance(Shape, Other);
+				const float MidDistance = ComputeRealityDistortionFieldSignedDistance(Shape, 0.5 * (Position + Other));
+				const bool bLipschitz = FMath::Abs(SignedDistance - OtherDistance) <= FVector::Dist(Position, Other) + TestDistanceTolerance;
+				const bool bConvex = MidDistance <= 0.5f * (SignedDistance + OtherDistance) + TestDistanceTolerance;
+				const bool bInsideBounded = SignedDistance > 0.0f
+					|| (FVector::Dist(Position, Shape.Center) <= BoundingRadius + TestDistanceTolerance && Bounds.IsInsideOrOn(Position));
+				NumPropertyFailures += (bLipschitz && bConvex && bInsideBounded) ? 0 : 1;
+			}
+		}
+
+		const TCHAR* ShapeName = GetTestFieldShapeName(Type);
+		AddInfo(FString::Printf(TEXT("%s: %d shapes x %d samples, max distance error=%.5f, max influence error=%.6f"),
+			ShapeName, TestShapesPerType, TestSamplesPerShape, MaxDistanceError, MaxInfluenceError));
+
+		TestTrue(FString::Printf(TEXT("%s signed distance matches the reference"), ShapeName), MaxDistanceError <= TestDistanceTolerance);
+		TestTrue(FString::Printf(TEXT("%s influence matches the reference"), ShapeName), MaxInfluenceError <= TestInfluenceTolerance);
+		TestEqual(FString::Printf(TEXT("%s shapes without full influence at the center"), ShapeName), NumCenterFailures, 0);
+		TestEqual(FString::Printf(TEXT("%s samples breaking Lipschitz / convexity / bounds"), ShapeName), NumPropertyFailures, 0);
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,286 @@
+﻿// RealityDistortionInfluenceClipmapTests.cpp
+//
+// 影响度 Clipmap（RealityDistortionInfluenceClipmap.h）的自动化测试。
+// 纯 CPU，不依赖 RT / GPU：用 CPU 参考实现模拟环形寻址的 Clipmap，校验包围体素范围、增量更新，
+// 以及 clip 距离的提前结束与精确计算的 clip 结果一致。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Math/RandomStream.h"
+#include "RealityDistortionField.h"
+#include "Rendering/RealityDistortionFieldShapes.h"
+#include "Rendering/RealityDistortionInfluenceClipmap.h"
+#include "Rendering/RealityDistortionShaders.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionInfluenceClipmapTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	constexpr float TestVoxelSize = 50.0f;
+
+	// 与 AddRealityDistortionInfluenceClipmapPasses_RenderThread 相同的合并上限。
+	constexpr int32 TestMaxUpdateRegions = 16;
+
+	// 与 Uniform Buffer 上传相同的打包，包围球半径与组件注册时一致。
+	FRealityDistortionPackedField PackShape(const FRealityDistortionFieldShape& Shape)
+	{
+		return PackRealityDistortionField(Shape, ComputeRealityDistortionFieldShapeBoundingRadius(Shape.Type, Shape.Extent), 1.0f);
+	}
+
+	FRealityDistortionFieldShape MakeRandomShape(FRandomStream& RandomStream, int32 FieldIndex, const FVector& Center)
+	{
+		FRealityDistortionFieldShape Shape;
+		Shape.Type = static_cast<uint8>(FieldIndex % 4);
+		Shape.Center = Center;
+		Shape.Rotation = FQuat(FVector(RandomStream.VRand()), RandomStream.FRandRange(0.0f, UE_TWO_PI));
+		Shape.Extent = FVector3f(RandomStream.FRandRange(40.0f, 300.0f), RandomStream.FRandRange(40.0f, 300.0f), RandomStream.FRandRange(40.0f, 300.0f));
+		return Shape;
+	}
+
+	int32 GetTexelIndex(int32 Resolution, int32 X, int32 Y, int32 Z)
+	{
+		const int32 TX = ((X % Resolution) + Resolution) % Resolution;
+		const int32 TY = ((Y % Resolution) + Resolution) % Resolution;
+		const int32 TZ = ((Z % Resolution) + Resolution) % Resolution;
+		return (TZ * Resolution + TY) * Resolution + TX;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionClipmapFieldVoxelBoundsTest, "RealityDistortion.InfluenceClipmap.FieldVoxelBounds", RealityDistortionInfluenceClipmapTestFlags)
+
+bool FRealityDistortionClipmapFieldVoxelBoundsTest::RunTest(const FString& Parameters)
+{
+	FRandomStream RandomStream(0x52440016);
+	int32 NumOutsideBounds = 0;
+	for (int32 FieldIndex = 0; FieldIndex < 16; ++FieldIndex)
+	{
+		FRealityDistortionPackedField Field;
+		Field.CenterAndRadius = FVector4f(FVector3f(RandomStream.VRand()) * RandomStream.FRandRange(0.0f, 1000.0f), RandomStream.FRandRange(60.0f, 400.0f));
+
+		// 包围范围扩大 2 个体素暴力检查：范围外的体素没有影响度，也不在 clip 等值面以内。
+		const FRealityDistortionVoxelRegion Bounds = ComputeRealityDistortionFieldVoxelBounds(FVector3f(Field.CenterAndRadius), Field.CenterAndRadius.W, TestVoxelSize);
+		FRealityDistortionVoxelRegion Search = Bounds;
+		Search.Min -= FIntVector(2);
+		Search.Max += FIntVector(2);
+
+		TArray<FVector2f> Voxels;
+		Voxels.SetNumUninitialized(Search.NumVoxels());
+		VoxelizeRealityDistortionInfluence(MakeArrayView(&Field, 1), TestVoxelSize, Search, Voxels);
+
+		int32 VoxelIndex = 0;
+		for (int32 Z = Search.Min.Z; Z < Search.Max.Z; ++Z)
+		{
+			for (int32 Y = Search.Min.Y; Y < Search.Max.Y; ++Y)
+			{
+				for (int32 X = Search.Min.X; X < Search.Max.X; ++X)
+				{
+					const FVector2f& Voxel = Voxels[VoxelIndex++];
+					const bool bInBounds = X >= Bounds.Min.X && Y >= Bounds.Min.Y && Z >= Bounds.Min.Z && X < Bounds.Max.X && Y < Bounds.Max.Y && Z < Bounds.Max.Z;
+					NumOutsideBounds += (!bInBounds && (Voxel.X > 0.0f || Voxel.Y < 0.0f)) ? 1 : 0;
+				}
+			}
+		}
+	}
+
+	TestEqual(TEXT("Voxels with influence outside the field voxel bounds"), NumOutsideBounds, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionClipmapIncrementalUpdateTest, "RealityDistortion.InfluenceClipmap.IncrementalUpdate", RealityDistortionInfluenceClipmapTestFlags)
+
+bool FRealityDistortionClipmapIncrementalUpdateTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Resolution = 32;
+	constexpr int32 NumFrames = 60;
+	const float Extent = TestVoxelSize * Resolution;
+
+	// 混合形状：clip 距离通道跨力场取最小，包围球外的体素同样会随力场变化。
+	FRandomStream RandomStream(0x52440116);
+	FVector CameraPosition(123.0, -456.0, 78.0);
+	TArray<FRealityDistortionFieldShape> Shapes;
+	TArray<bool> bFieldEnabled;
+	for (int32 FieldIndex = 0; FieldIndex < 8; ++FieldIndex)
+	{
+		Shapes.Add(MakeRandomShape(RandomStream, FieldIndex, CameraPosition + RandomStream.VRand() * RandomStream.FRandRange(0.0f, Extent * 0.5f)));
+		bFieldEnabled.Add(true);
+	}
+	TArray<FRealityDistortionPackedField> Fields;
+	Fields.SetNum(Shapes.Num());
+
+	TArray<FVector2f> Clipmap;
+	Clipmap.SetNumZeroed(Resolution * Resolution * Resolution);
+	FRealityDistortionVoxelRegion PreviousRegion;
+	TArray<FRealityDistortionPackedField> PreviousFields;
+	int64 TotalUpdatedVoxels = 0;
+	int32 NumStaleVoxels = 0;
+
+	TArray<FVector2f> RegionVoxels;
+	TArray<FRealityDistortionVoxelRegion> DirtyRegions;
+	TArray<FRealityDistortionVoxelRegion> UpdateRegions;
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		// 相机大多数帧小步移动，偶尔瞬移到 Clipmap 之外；力场随机移动 / 开关。
+		CameraPosition += (Frame % 17 == 16)
+			? RandomStream.VRand() * Extent * 2.0
+			: RandomStream.VRand() * RandomStream.FRandRange(0.0f, TestVoxelSize * 3.0f);
+		for (int32 FieldIndex = 0; FieldIndex < Shapes.Num(); ++FieldIndex)
+		{
+			const float Roll = RandomStream.FRand();
+			if (Roll < 0.3f)
+			{
+				Shapes[FieldIndex].Center += RandomStream.VRand() * RandomStream.FRandRange(0.0f, 200.0f);
+			}
+			else if (Roll < 0.35f)
+			{
+				bFieldEnabled[FieldIndex] = !bFieldEnabled[FieldIndex];
+			}
+			else if (Roll < 0.4f)
+			{
+				Shapes[FieldIndex] = MakeRandomShape(RandomStream, FieldIndex, Shapes[FieldIndex].Center);
+			}
+			Fields[FieldIndex] = bFieldEnabled[FieldIndex] ? PackShape(Shapes[FieldIndex]) : FRealityDistortionPackedField();
+		}
+
+		const FRealityDistortionVoxelRegion NewRegion = ComputeRealityDistortionClipmapRegion(CameraPosition, TestVoxelSize, Resolution);
+		CollectRealityDistortionDirtyFieldRegions(PreviousFields, Fields, TestVoxelSize, DirtyRegions);
+		ComputeRealityDistortionClipmapUpdateRegions(PreviousRegion, NewRegion, DirtyRegions, TestMaxUpdateRegions, UpdateRegions);
+
+		for (const FRealityDistortionVoxelRegion& Region : UpdateRegions)
+		{
+			RegionVoxels.SetNumUninitialized(Region.NumVoxels());
+			VoxelizeRealityDistortionInfluence(Fields, TestVoxelSize, Region, RegionVoxels);
+			TotalUpdatedVoxels += Region.NumVoxels();
+
+			int32 VoxelIndex = 0;
+			for (int32 Z = Region.Min.Z; Z < Region.Max.Z; ++Z)
+			{
+				for (int32 Y = Region.Min.Y; Y < Region.Max.Y; ++Y)
+				{
+					for (int32 X = Region.Min.X; X < Region.Max.X; ++X)
+					{
+						Clipmap[GetTexelIndex(Resolution, X, Y, Z)] = RegionVoxels[VoxelIndex++];
+					}
+				}
+			}
+		}
+
+		// 增量更新后的整个 Clipmap 与当帧完整重新光栅化的结果逐体素一致。
+		RegionVoxels.SetNumUninitialized(NewRegion.NumVoxels());
+		VoxelizeRealityDistortionInfluence(Fields, TestVoxelSize, NewRegion, RegionVoxels);
+		int32 VoxelIndex = 0;
+		for (int32 Z = NewRegion.Min.Z; Z < NewRegion.Max.Z; ++Z)
+		{
+			for (int32 Y = NewRegion.Min.Y; Y < NewRegion.Max.Y; ++Y)
+			{
+				for (int32 X = NewRegion.Min.X; X < NewRegion.Max.X; ++X)
+				{
+					NumStaleVoxels += Clipmap[GetTexelIndex(Resolution, X, Y, Z)] == RegionVoxels[VoxelIndex++] ? 0 : 1;
+				}
+			}
+		}
+
+		PreviousRegion = NewRegion;
+		PreviousFields = Fields;
+	}
+
+	TestEqual(TEXT("Stale voxels after incremental updates"), NumStaleVoxels, 0);
+	TestTrue(TEXT("Incremental updates touch less than a full rebuild per frame"), TotalUpdatedVoxels < int64(Resolution) * Resolution * Resolution * NumFrames);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionClipmapConservativeClipTest, "RealityDistortion.InfluenceClipmap.ConservativeClip", RealityDistortionInfluenceClipmapTestFlags)
+
+bool FRealityDistortionClipmapConservativeClipTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Resolution = 48;
+	const FRealityDistortionVoxelRegion Region = ComputeRealityDistortionClipmapRegion(FVector::ZeroVector, TestVoxelSize, Resolution);
+	const FVector3f RegionMin = FVector3f(Region.Min) * TestVoxelSize;
+	const float Extent = TestVoxelSize * Resolution;
+
+	// 混合形状、任意旋转，尺寸与体素同量级，边界附近的体素很多。
+	FRandomStream RandomStream(0x52440216);
+	TArray<FRealityDistortionFieldShape> Shapes;
+	for (int32 FieldIndex = 0; FieldIndex < 12; ++FieldIndex)
+	{
+		Shapes.Add(MakeRandomShape(RandomStream, FieldIndex, FVector(RandomStream.VRand()) * RandomStream.FRandRange(0.0f, Extent * 0.35f)));
+	}
+
+	TArray<FRealityDistortionPackedField> Fields;
+	for (const FRealityDistortionFieldShape& Shape : Shapes)
+	{
+		Fields.Add(PackShape(Shape));
+	}
+
+	TArray<FVector2f> Voxels;
+	Voxels.SetNumUninitialized(Region.NumVoxels());
+	VoxelizeRealityDistortionInfluence(Fields, TestVoxelSize, Region, Voxels);
+
+	// 与硬件三线性过滤相同：体素中心在 (k + 0.5) * VoxelSize。
+	auto SampleClipDistance = [&Voxels, &Region, RegionMin](const FVector3f& Position)
+	{
+		const FVector3f VoxelPosition = (Position - RegionMin) / TestVoxelSize - FVector3f(0.5f);
+		const FIntVector Base(FMath::FloorToInt32(VoxelPosition.X), FMath::FloorToInt32(VoxelPosition.Y), FMath::FloorToInt32(VoxelPosition.Z));
+		const FVector3f Frac = VoxelPosition - FVector3f(Base);
+		const FIntVector Size = Region.Size();
+
+		float Result = 0.0f;
+		for (int32 Corner = 0; Corner < 8; ++Corner)
+		{
+			const FIntVector Offset((Corner & 1) ? 1 : 0, (Corner & 2) ? 1 : 0, (Corner & 4) ? 1 : 0);
+			const FIntVector Voxel = Base + Offset;
+			const float Weight = (Offset.X ? Frac.X : 1.0f - Frac.X) * (Offset.Y ? Frac.Y : 1.0f - Frac.Y) * (Offset.Z ? Frac.Z : 1.0f - Frac.Z);
+			Result += Weight * Voxels[(Voxel.Z * Size.Y + Voxel.Y) * Size.X + Voxel.X].Y;
+		}
+		return Result;
+	};
+
+	const float ClipMargin = REALITY_DISTORTION_CLIPMAP_CLIP_MARGIN * TestVoxelSize;
+	int32 NumDecided = 0;
+	int32 NumWrongDecisions = 0;
+	int32 NumWrongClipDistanceSigns = 0;
+	constexpr int32 NumSamples = 20000;
+	for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		// 与 RD_SampleInfluenceClipmap 相同，离 Clipmap 边缘不足一个体素的位置不采样。
+		const FVector3f Position = RegionMin + FVector3f(
+			RandomStream.FRandRange(TestVoxelSize, Extent - TestVoxelSize),
+			RandomStream.FRandRange(TestVoxelSize, Extent - TestVoxelSize),
+			RandomStream.FRandRange(TestVoxelSize, Extent - TestVoxelSize));
+
+		float ExactInfluence = 0.0f;
+		float ExactClipDistance = MAX_flt;
+		for (const FRealityDistortionFieldShape& Shape : Shapes)
+		{
+			ExactInfluence = FMath::Max(ExactInfluence, CalculateRealityDistortionShapedFieldInfluence(Shape, FVector(Position)));
+			ExactClipDistance = FMath::Min(ExactClipDistance, ComputeRealityDistortionFieldClipDistance(Shape, FVector(Position)));
+		}
+
+		// clip 距离的符号与阈值比较一致（等值面附近留出浮点误差）。
+		if (FMath::Abs(ExactClipDistance) > 0.01f)
+		{
+			NumWrongClipDistanceSigns += (ExactClipDistance < 0.0f) == (ExactInfluence > REALITY_DISTORTION_INFLUENCE_CLIP_THRESHOLD) ? 0 : 1;
+		}
+
+		// 提前结束的判定必须与精确 clip 一致。
+		const float SampledClipDistance = SampleClipDistance(Position);
+		if (SampledClipDistance >= ClipMargin)
+		{
+			++NumDecided;
+			NumWrongDecisions += ExactInfluence <= REALITY_DISTORTION_INFLUENCE_CLIP_THRESHOLD ? 0 : 1;
+		}
+		else if (SampledClipDistance <= -ClipMargin)
+		{
+			++NumDecided;
+			NumWrongDecisions += ExactInfluence >= REALITY_DISTORTION_INFLUENCE_CLIP_THRESHOLD ? 0 : 1;
+		}
+	}
+
+	TestEqual(TEXT("Samples whose clip distance sign disagrees with the influence threshold"), NumWrongClipDistanceSigns, 0);
+	TestEqual(TEXT("Samples the clipmap decides differently from the exact clip"), NumWrongDecisions, 0);
+	TestTrue(TEXT("Clipmap decides most samples"), NumDecided > NumSamples / 2);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
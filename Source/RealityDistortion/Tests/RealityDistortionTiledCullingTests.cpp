@@ -0,0 +1,256 @@
+﻿// RealityDistortionTiledCullingTests.cpp
+//
+// 屏幕 Tile 力场分箱（RealityDistortionTiledCulling.h）的自动化测试。
+// 纯 CPU，不依赖 RT / GPU：构造 1920x1080、90 度 FOV 的透视 View，随机放置力场（包括相机后方、跨近平面的），
+// 校验 CPU 参考实现与 BinFieldsCS 的逐 Tile 写法一致、分箱保守，以及多 View 时每个 View 能找回自己的分箱记录。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Math/RandomStream.h"
+#include "RealityDistortionField.h"
+#include "Rendering/RealityDistortionShaders.h"
+#include "Rendering/RealityDistortionTiledCulling.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionTiledCullingTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	// 与 AddRealityDistortionTileBinningPass_RenderThread 相同的边距。
+	constexpr float TestMarginPixels = 2.0f;
+
+	struct FTestView
+	{
+		FIntPoint ViewSize = FIntPoint(1920, 1080);
+		FVector3f PreViewTranslation = FVector3f::ZeroVector;
+		FMatrix44f TranslatedWorldToClip;
+		FMatrix44f Projection;
+		FVector3f Forward = FVector3f::ForwardVector;
+
+		FVector2f GetUVMargin() const
+		{
+			return FVector2f(TestMarginPixels / ViewSize.X, TestMarginPixels / ViewSize.Y);
+		}
+
+		FUintVector2 GetTileGridSize(int32 TileSize) const
+		{
+			return FUintVector2(
+				static_cast<uint32>(FMath::DivideAndRoundUp(ViewSize.X, TileSize)),
+				static_cast<uint32>(FMath::DivideAndRoundUp(ViewSize.Y, TileSize)));
+		}
+	};
+
+	// UE 的 View 约定：相机看向 +X，先转换到 Z 朝前的 View 空间，再接反向 Z 透视投影。
+	FTestView MakeTestView(const FVector& CameraOrigin, const FRotator& CameraRotation, float HalfFOV, const FIntPoint& ViewSize)
+	{
+		const FMatrix ViewRotationMatrix = FInverseRotationMatrix(CameraRotation) * FMatrix(
+			FPlane(0, 0, 1, 0),
+			FPlane(1, 0, 0, 0),
+			FPlane(0, 1, 0, 0),
+			FPlane(0, 0, 0, 1));
+		const FMatrix ProjectionMatrix = FReversedZPerspectiveMatrix(HalfFOV, ViewSize.X, ViewSize.Y, 10.0f);
+
+		FTestView View;
+		View.ViewSize = ViewSize;
+		View.PreViewTranslation = FVector3f(-CameraOrigin);
+		View.TranslatedWorldToClip = FMatrix44f(ViewRotationMatrix * ProjectionMatrix);
+		View.Projection = FMatrix44f(ProjectionMatrix);
+		View.Forward = FVector3f(ViewRotationMatrix.GetColumn(2));
+		return View;
+	}
+
+	FTestView MakeDefaultTestView()
+	{
+		return MakeTestView(FVector(1000.0, -500.0, 200.0), FRotator(-10.0f, 30.0f, 0.0f), HALF_PI * 0.5f, FIntPoint(1920, 1080));
+	}
+
+	TArray<FRealityDistortionPackedField> MakeRandomFields(const FTestView& View, FRandomStream& RandomStream)
+	{
+		const FVector3f CameraOrigin = -View.PreViewTranslation;
+
+		TArray<FRealityDistortionPackedField> PackedFields;
+		PackedFields.SetNum(MAX_DISTORTION_FIELDS);
+		for (FRealityDistortionPackedField& Packed : PackedFields)
+		{
+			const FVector3f Center = CameraOrigin + FVector3f(
+				RandomStream.FRandRange(-3000.0f, 8000.0f),
+				RandomStream.FRandRange(-6000.0f, 6000.0f),
+				RandomStream.FRandRange(-2000.0f, 2000.0f));
+			Packed.CenterAndRadius = FVector4f(Center, RandomStream.FRandRange(50.0f, 1500.0f));
+			Packed.Params = FVector4f(1.0f, 0.0f, 0.0f, 0.0f);
+		}
+
+		// 一个禁用槽位：永远不进任何 Tile。
+		PackedFields[7].CenterAndRadius.W = 0.0f;
+		return PackedFields;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionTileBinningMatchesPerTileLoopTest, "RealityDistortion.TiledCulling.MatchesPerTileLoop", RealityDistortionTiledCullingTestFlags)
+
+bool FRealityDistortionTileBinningMatchesPerTileLoopTest::RunTest(const FString& Parameters)
+{
+	const FTestView View = MakeDefaultTestView();
+	FRandomStream RandomStream(0x52440015);
+	const TArray<FRealityDistortionPackedField> PackedFields = MakeRandomFields(View, RandomStream);
+
+	for (const int32 TileSize : { 8, 32, 256 })
+	{
+		const FUintVector2 TileGridSize = View.GetTileGridSize(TileSize);
+		TArray<uint64> TileMasks;
+		TileMasks.SetNumUninitialized(static_cast<int32>(TileGridSize.X * TileGridSize.Y));
+		BinRealityDistortionFields(PackedFields, View.TranslatedWorldToClip, View.PreViewTranslation, View.GetUVMargin(), TileGridSize, TileMasks);
+
+		// BinFieldsCS 的写法：每个 Tile 遍历全部力场。
+		int32 NumMismatches = 0;
+		uint64 AllTilesMask = 0;
+		for (uint32 TileY = 0; TileY < TileGridSize.Y; ++TileY)
+		{
+			for (uint32 TileX = 0; TileX < TileGridSize.X; ++TileX)
+			{
+				uint64 ReferenceMask = 0;
+				for (int32 FieldIndex = 0; FieldIndex < PackedFields.Num(); ++FieldIndex)
+				{
+					const FVector4f& CenterAndRadius = PackedFields[FieldIndex].CenterAndRadius;
+					FUintVector4 TileRect;
+					if (CenterAndRadius.W > 0.0f
+						&& ComputeRealityDistortionFieldTileRect(View.TranslatedWorldToClip, FVector3f(CenterAndRadius) + View.PreViewTranslation, CenterAndRadius.W, View.GetUVMargin(), TileGridSize, TileRect)
+						&& TileX >= TileRect.X && TileY >= TileRect.Y && TileX <= TileRect.Z && TileY <= TileRect.W)
+					{
+						ReferenceMask |= uint64(1) << FieldIndex;
+					}
+				}
+
+				const uint64 TileMask = TileMasks[TileY * TileGridSize.X + TileX];
+				NumMismatches += ReferenceMask == TileMask ? 0 : 1;
+				AllTilesMask |= TileMask;
+			}
+		}
+
+		const FString Context = FString::Printf(TEXT("TileSize %d"), TileSize);
+		TestEqual(*(Context + TEXT(": tiles that differ from the per-tile loop")), NumMismatches, 0);
+		TestEqual(*(Context + TEXT(": disabled slot is never binned")), AllTilesMask & (uint64(1) << 7), uint64(0));
+		TestTrue(*(Context + TEXT(": some fields are culled")), FMath::CountBits(AllTilesMask) < PackedFields.Num() - 1);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionTileBinningConservativeTest, "RealityDistortion.TiledCulling.Conservative", RealityDistortionTiledCullingTestFlags)
+
+bool FRealityDistortionTileBinningConservativeTest::RunTest(const FString& Parameters)
+{
+	const FTestView View = MakeDefaultTestView();
+	FRandomStream RandomStream(0x52440115);
+	const TArray<FRealityDistortionPackedField> PackedFields = MakeRandomFields(View, RandomStream);
+
+	const FUintVector2 TileGridSize = View.GetTileGridSize(32);
+	TArray<uint64> TileMasks;
+	TileMasks.SetNumUninitialized(static_cast<int32>(TileGridSize.X * TileGridSize.Y));
+	BinRealityDistortionFields(PackedFields, View.TranslatedWorldToClip, View.PreViewTranslation, View.GetUVMargin(), TileGridSize, TileMasks);
+
+	// 力场球内的随机点投影到的 Tile 必须含有该力场。
+	constexpr int32 SamplesPerField = 512;
+	int32 NumVisibleSamples = 0;
+	int32 NumMissed = 0;
+	for (int32 FieldIndex = 0; FieldIndex < PackedFields.Num(); ++FieldIndex)
+	{
+		const FVector4f& CenterAndRadius = PackedFields[FieldIndex].CenterAndRadius;
+		if (CenterAndRadius.W <= 0.0f)
+		{
+			continue;
+		}
+
+		for (int32 SampleIndex = 0; SampleIndex < SamplesPerField; ++SampleIndex)
+		{
+			const float SampleRadius = CenterAndRadius.W * FMath::Pow(RandomStream.FRand(), 1.0f / 3.0f);
+			const FVector3f SamplePosition = FVector3f(CenterAndRadius) + FVector3f(RandomStream.GetUnitVector()) * SampleRadius;
+			const FVector4f ClipPosition = View.TranslatedWorldToClip.TransformFVector4(FVector4f(SamplePosition + View.PreViewTranslation, 1.0f));
+			if (ClipPosition.W <= REALITY_DISTORTION_TILE_MIN_CLIP_W)
+			{
+				continue;
+			}
+
+			const float U = ClipPosition.X / ClipPosition.W * 0.5f + 0.5f;
+			const float V = ClipPosition.Y / ClipPosition.W * -0.5f + 0.5f;
+			if (U < 0.0f || V < 0.0f || U >= 1.0f || V >= 1.0f)
+			{
+				continue;
+			}
+
+			++NumVisibleSamples;
+			const uint32 TileX = FMath::Min(static_cast<uint32>(U * TileGridSize.X), TileGridSize.X - 1);
+			const uint32 TileY = FMath::Min(static_cast<uint32>(V * TileGridSize.Y), TileGridSize.Y - 1);
+			NumMissed += (TileMasks[TileY * TileGridSize.X + TileX] & (uint64(1) << FieldIndex)) != 0 ? 0 : 1;
+		}
+	}
+
+	TestTrue(TEXT("Scene has visible samples"), NumVisibleSamples > 0);
+	TestEqual(TEXT("Visible samples whose tile misses their field"), NumMissed, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionTileViewMatchingTest, "RealityDistortion.TiledCulling.ViewMatching", RealityDistortionTiledCullingTestFlags)
+
+bool FRealityDistortionTileViewMatchingTest::RunTest(const FString& Parameters)
+{
+	// 立体双眼（相距 6.4）、两个分屏玩家（同一位置不同朝向、另一个位置）、同一相机但更窄的 FOV。
+	const FVector HeadOrigin(250000.0, -120000.0, 5000.0);
+	const FRotator HeadRotation(-5.0f, 75.0f, 0.0f);
+	const FVector RightOffset = FRotationMatrix(HeadRotation).GetUnitAxis(EAxis::Y) * 3.2;
+	const TArray<FTestView> Views =
+	{
+		MakeTestView(HeadOrigin - RightOffset, HeadRotation, HALF_PI * 0.5f, FIntPoint(1920, 1080)),
+		MakeTestView(HeadOrigin + RightOffset, HeadRotation, HALF_PI * 0.5f, FIntPoint(1920, 1080)),
+		MakeTestView(HeadOrigin - RightOffset, FRotator(-5.0f, 80.0f, 0.0f), HALF_PI * 0.5f, FIntPoint(1920, 540)),
+		MakeTestView(HeadOrigin - RightOffset, HeadRotation, HALF_PI * 0.3f, FIntPoint(1920, 1080)),
+	};
+	static_assert(REALITY_DISTORTION_MAX_TILE_VIEWS >= 4, "Test binds four views");
+
+	// 与 AddRealityDistortionTileBinningPass_RenderThread 相同的记录。
+	TArray<FRealityDistortionTileView> TileViews;
+	uint32 NumTiles = 0;
+	for (const FTestView& View : Views)
+	{
+		FRealityDistortionTileView& TileView = TileViews.AddDefaulted_GetRef();
+		TileView.Origin = -View.PreViewTranslation;
+		TileView.Forward = View.Forward;
+		TileView.ProjectionScale = FVector2f(View.Projection.M[0][0], View.Projection.M[1][1]);
+		TileView.TileGridSize = View.GetTileGridSize(32);
+		TileView.FirstTileMask = NumTiles;
+		NumTiles += TileView.TileGridSize.X * TileView.TileGridSize.Y;
+	}
+
+	// Shader 取第一条匹配的记录：每个 View 必须恰好匹配自己的记录。
+	for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ++ViewIndex)
+	{
+		const FRealityDistortionTileView& Camera = TileViews[ViewIndex];
+		for (int32 RecordIndex = 0; RecordIndex < TileViews.Num(); ++RecordIndex)
+		{
+			const bool bMatches = MatchesRealityDistortionTileView(TileViews[RecordIndex], Camera.Origin, Camera.Forward, Camera.ProjectionScale);
+			if (bMatches != (RecordIndex == ViewIndex))
+			{
+				AddError(FString::Printf(TEXT("View %d %s record %d"), ViewIndex, bMatches ? TEXT("matches") : TEXT("does not match"), RecordIndex));
+			}
+		}
+	}
+
+	// 渲染时的投影只多了 TAA 抖动（不影响 [0][0] / [1][1]），位置只有浮点误差。
+	const FRealityDistortionTileView& Eye = TileViews[1];
+	TestTrue(TEXT("Camera with float round-off matches its record"),
+		MatchesRealityDistortionTileView(Eye, Eye.Origin + FVector3f(0.03f, -0.03f, 0.03f), Eye.Forward, Eye.ProjectionScale * 1.00001f));
+
+	// 上限之外的 View 没有记录，不能借用其它 View 的掩码。
+	const FTestView ExtraView = MakeTestView(HeadOrigin + FVector(0.0, 0.0, 200.0), HeadRotation, HALF_PI * 0.5f, FIntPoint(1920, 1080));
+	bool bExtraViewMatches = false;
+	for (const FRealityDistortionTileView& TileView : TileViews)
+	{
+		bExtraViewMatches |= MatchesRealityDistortionTileView(TileView, -ExtraView.PreViewTranslation, ExtraView.Forward,
+			FVector2f(ExtraView.Projection.M[0][0], ExtraView.Projection.M[1][1]));
+	}
+	TestFalse(TEXT("View without a record matches none"), bExtraViewMatches);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,190 @@
+﻿// RealityDistortionVertexInfluenceTests.cpp
+//
+// 顶点阶段影响度（r.RealityDistortion.VertexInfluence）的自动化测试。
+// 纯 CPU，镜像 RealityDistortionShader.usf 的判定：在合成地板上方放 4 个随机形状的有向力场，
+// 每个三角形取若干随机重心坐标作为“像素”，插值 VS 输出的内 / 外界（clip 距离）后分类，
+// 判定为一定保留 / 一定 clip 的像素必须与精确 clip 结果一致。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Math/RandomStream.h"
+#include "RealityDistortionDefinitions.h"
+#include "Rendering/RealityDistortionFieldShapes.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionVertexInfluenceTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	constexpr int32 TestGridSize = 100;
+	constexpr float TestFloorSize = 10000.0f;
+	constexpr int32 TestSamplesPerTriangle = 16;
+
+	// clip 距离在 float 下插值，恰好落在 clip 边界上的像素允许这么多误差。
+	constexpr float TestClipDistanceTolerance = 0.01f;
+
+	// 与 VS 输出一致：InsideMetrics = 各力场 clip 距离，Influence = 最大影响度，OutsideDistance = min(clip 距离)。
+	struct FTestVertexInfluence
+	{
+		FVector4f InsideMetrics;
+		float Influence = 0.0f;
+		float OutsideDistance = 0.0f;
+	};
+
+	FTestVertexInfluence CalculateTestVertexInfluence(const FVector3f& Position, TConstArrayView<FRealityDistortionFieldShape> Fields)
+	{
+		FTestVertexInfluence Result;
+		Result.OutsideDistance = MAX_flt;
+		for (int32 FieldIndex = 0; FieldIndex < Fields.Num(); ++FieldIndex)
+		{
+			const float ClipDistance = ComputeRealityDistortionFieldClipDistance(Fields[FieldIndex], FVector(Position));
+			Result.InsideMetrics[FieldIndex] = ClipDistance;
+			Result.Influence = FMath::Max(Result.Influence, CalculateRealityDistortionShapedFieldInfluence(Fields[FieldIndex], FVector(Position)));
+			Result.OutsideDistance = FMath::Min(Result.OutsideDistance, ClipDistance);
+		}
+		return Result;
+	}
+
+	// 合成地板：GridSize x GridSize 个格子，边长 FloorSize，位于 XY 平面、以原点为中心。
+	void BuildTestFloor(int32 GridSize, float FloorSize, TArray<FVector3f>& OutPositions, TArray<uint32>& OutIndices)
+	{
+		const float CellSize = FloorSize / GridSize;
+
+		OutPositions.Reset((GridSize + 1) * (GridSize + 1));
+		for (int32 Y = 0; Y <= GridSize; ++Y)
+		{
+			for (int32 X = 0; X <= GridSize; ++X)
+			{
+				OutPositions.Emplace(X * CellSize - FloorSize * 0.5f, Y * CellSize - FloorSize * 0.5f, 0.0f);
+			}
+		}
+
+		OutIndices.Reset(GridSize * GridSize * 6);
+		for (int32 Y = 0; Y < GridSize; ++Y)
+		{
+			for (int32 X = 0; X < GridSize; ++X)
+			{
+				const uint32 V0 = Y * (GridSize + 1) + X;
+				const uint32 V1 = V0 + 1;
+				const uint32 V2 = V0 + GridSize + 1;
+				const uint32 V3 = V2 + 1;
+				OutIndices.Append({ V0, V2, V1, V1, V2, V3 });
+			}
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionVertexInfluenceConservativeTest, "RealityDistortion.VertexInfluence.Conservative", RealityDistortionVertexInfluenceTestFlags)
+
+bool FRealityDistortionVertexInfluenceConservativeTest::RunTest(const FString& Parameters)
+{
+	TArray<FVector3f> Positions;
+	TArray<uint32> Indices;
+	BuildTestFloor(TestGridSize, TestFloorSize, Positions, Indices);
+
+	float MaxTriangleEdgeLength = 0.0f;
+	for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+	{
+		MaxTriangleEdgeLength = FMath::Max(MaxTriangleEdgeLength, FMath::Max3(
+			FVector3f::Dist(Positions[Indices[Index + 0]], Positions[Indices[Index + 1]]),
+			FVector3f::Dist(Positions[Indices[Index + 1]], Positions[Indices[Index + 2]]),
+			FVector3f::Dist(Positions[Indices[Index + 2]], Positions[Indices[Index + 0]])));
+	}
+
+	FRandomStream RandomStream(0x52440020);
+	TArray<FRealityDistortionFieldShape> Fields;
+	for (int32 FieldIndex = 0; FieldIndex < 4; ++FieldIndex)
+	{
+		FRealityDistortionFieldShape& Field = Fields.AddDefaulted_GetRef();
+		Field.Type = static_cast<uint8>(FieldIndex);
+		Field.Center = FVector(RandomStream.FRandRange(-0.4f, 0.4f) * TestFloorSize, RandomStream.FRandRange(-0.4f, 0.4f) * TestFloorSize, RandomStream.FRandRange(-200.0f, 200.0f));
+		Field.Rotation = FQuat(FVector(RandomStream.GetUnitVector()), RandomStream.FRandRange(0.0f, 2.0f * UE_PI));
+		Field.Extent = FVector3f(RandomStream.FRandRange(300.0f, 1500.0f), RandomStream.FRandRange(300.0f, 1500.0f), RandomStream.FRandRange(300.0f, 1500.0f));
+		if (Field.Type == REALITY_DISTORTION_FIELD_SHAPE_SPHERE)
+		{
+			Field.Extent = FVector3f(Field.Extent.X);
+		}
+	}
+
+	int32 NumInsideFailures = 0;
+	int32 NumOutsideFailures = 0;
+	int64 NumInside = 0;
+	int64 NumOutside = 0;
+	int64 NumBoundary = 0;
+	double InsideAbsError = 0.0;
+
+	for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+	{
+		const FVector3f Corners[3] = { Positions[Indices[Index + 0]], Positions[Indices[Index + 1]], Positions[Indices[Index + 2]] };
+		const FTestVertexInfluence Vertices[3] =
+		{
+			CalculateTestVertexInfluence(Corners[0], Fields),
+			CalculateTestVertexInfluence(Corners[1], Fields),
+			CalculateTestVertexInfluence(Corners[2], Fields),
+		};
+
+		for (int32 Sample = 0; Sample < TestSamplesPerTriangle; ++Sample)
+		{
+			float U = RandomStream.FRand();
+			float V = RandomStream.FRand();
+			if (U + V > 1.0f)
+			{
+				U = 1.0f - U;
+				V = 1.0f - V;
+			}
+			const float Weights[3] = { 1.0f - U - V, U, V };
+
+			FVector3f Position(0.0f);
+			FVector4f InsideMetrics(0.0f);
+			float Influence = 0.0f;
+			float OutsideDistance = 0.0f;
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				Position += Corners[Corner] * Weights[Corner];
+				InsideMetrics += Vertices[Corner].InsideMetrics * Weights[Corner];
+				Influence += Vertices[Corner].Influence * Weights[Corner];
+				OutsideDistance += Vertices[Corner].OutsideDistance * Weights[Corner];
+			}
+
+			float ExactInfluence = 0.0f;
+			float ExactClipDistance = MAX_flt;
+			for (const FRealityDistortionFieldShape& Field : Fields)
+			{
+				ExactInfluence = FMath::Max(ExactInfluence, CalculateRealityDistortionShapedFieldInfluence(Field, FVector(Position)));
+				ExactClipDistance = FMath::Min(ExactClipDistance, ComputeRealityDistortionFieldClipDistance(Field, FVector(Position)));
+			}
+
+			// 与 MainPS 相同的分支顺序。
+			if (OutsideDistance > MaxTriangleEdgeLength)
+			{
+				++NumOutside;
+				NumOutsideFailures += ExactClipDistance < -TestClipDistanceTolerance ? 1 : 0;
+			}
+			else if (InsideMetrics.X < 0.0f || InsideMetrics.Y < 0.0f || InsideMetrics.Z < 0.0f || InsideMetrics.W < 0.0f)
+			{
+				++NumInside;
+				NumInsideFailures += ExactClipDistance > TestClipDistanceTolerance ? 1 : 0;
+				InsideAbsError += FMath::Abs(FMath::Max(Influence, REALITY_DISTORTION_INFLUENCE_CLIP_THRESHOLD) - ExactInfluence);
+			}
+			else
+			{
+				++NumBoundary;
+			}
+		}
+	}
+
+	const int64 NumSamples = NumInside + NumOutside + NumBoundary;
+	AddInfo(FString::Printf(TEXT("%d triangles, max edge %.1f, %lld samples: inside %.2f%%, outside %.2f%%, boundary (exact test) %.2f%%, inside mean abs error %.4f"),
+		Indices.Num() / 3, MaxTriangleEdgeLength, NumSamples,
+		100.0 * NumInside / NumSamples, 100.0 * NumOutside / NumSamples, 100.0 * NumBoundary / NumSamples,
+		NumInside > 0 ? InsideAbsError / NumInside : 0.0));
+
+	TestEqual(TEXT("Samples classified inside that the exact test clips"), NumInsideFailures, 0);
+	TestEqual(TEXT("Samples classified outside that the exact test keeps"), NumOutsideFailures, 0);
+	TestTrue(TEXT("Some samples skip the exact test as inside"), NumInside > 0);
+	TestTrue(TEXT("Some samples skip the exact test as outside"), NumOutside > 0);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,138 @@
+﻿// RealityDistortionVoronoiTests.cpp
+//
+// Voronoi 裂纹质量档位（RealityDistortionVoronoi.h）的自动化测试。
+// 纯 CPU：在随机位置 / 单元尺寸上对比各档位 CPU 移植的边缘掩码。
+// HIGH 与 REFERENCE 哈希不同，只比统计量；FAST 与 NOISE_TEXTURE 逐点对比 HIGH。
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Math/RandomStream.h"
+#include "RealityDistortionDefinitions.h"
+#include "Rendering/RealityDistortionVoronoi.h"
+
+namespace
+{
+	constexpr EAutomationTestFlags RealityDistortionVoronoiTestFlags = EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter;
+
+	constexpr int32 TestNumSamples = 100000;
+
+	// 边缘像素的判定阈值，以及统计量 / 逐点误差的容差。
+	constexpr float TestEdgeThreshold = 0.05f;
+	constexpr float TestMaxStatisticDelta = 0.01f;
+	constexpr float TestMaxMeanError = 0.03f;
+	constexpr float TestMaxP95Error = 0.12f;
+
+	FVector3f MakeRandomWorldPos(FRandomStream& RandomStream)
+	{
+		return FVector3f(RandomStream.VRand()) * RandomStream.FRandRange(0.0f, 20000.0f);
+	}
+
+	float MakeRandomCellSize(FRandomStream& RandomStream)
+	{
+		return RandomStream.FRandRange(20.0f, 200.0f);
+	}
+
+	// 平均绝对误差与 95 分位误差都在容差内。
+	void TestPointErrors(FAutomationTestBase& Test, const TCHAR* Label, TArray<float>& Errors)
+	{
+		double ErrorSum = 0.0;
+		for (float Error : Errors)
+		{
+			ErrorSum += Error;
+		}
+		Errors.Sort();
+
+		const float MeanError = static_cast<float>(ErrorSum / Errors.Num());
+		const float P95Error = Errors[Errors.Num() * 95 / 100];
+		Test.TestTrue(FString::Printf(TEXT("%s: mean error %.4f <= %.3f"), Label, MeanError, TestMaxMeanError), MeanError <= TestMaxMeanError);
+		Test.TestTrue(FString::Printf(TEXT("%s: p95 error %.4f <= %.3f (worst %.4f)"), Label, P95Error, TestMaxP95Error, Errors.Last()), P95Error <= TestMaxP95Error);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionVoronoiHighMatchesReferenceTest, "RealityDistortion.Voronoi.HighMatchesReference", RealityDistortionVoronoiTestFlags)
+
+bool FRealityDistortionVoronoiHighMatchesReferenceTest::RunTest(const FString& Parameters)
+{
+	FRandomStream RandomStream(0x52440017);
+	double ReferenceEdgeSum = 0.0;
+	double HighEdgeSum = 0.0;
+	int32 ReferenceEdgeCount = 0;
+	int32 HighEdgeCount = 0;
+	for (int32 SampleIndex = 0; SampleIndex < TestNumSamples; ++SampleIndex)
+	{
+		const FVector3f WorldPos = MakeRandomWorldPos(RandomStream);
+		const float CellSize = MakeRandomCellSize(RandomStream);
+
+		const float ReferenceEdge = CalculateRealityDistortionVoronoiEdge(WorldPos, CellSize, REALITY_DISTORTION_VORONOI_QUALITY_REFERENCE);
+		const float HighEdge = CalculateRealityDistortionVoronoiEdge(WorldPos, CellSize, REALITY_DISTORTION_VORONOI_QUALITY_HIGH);
+		ReferenceEdgeSum += ReferenceEdge;
+		HighEdgeSum += HighEdge;
+		ReferenceEdgeCount += ReferenceEdge < TestEdgeThreshold ? 1 : 0;
+		HighEdgeCount += HighEdge < TestEdgeThreshold ? 1 : 0;
+	}
+
+	const float MeanDelta = static_cast<float>(FMath::Abs(HighEdgeSum - ReferenceEdgeSum) / TestNumSamples);
+	const float EdgeFractionDelta = static_cast<float>(FMath::Abs(HighEdgeCount - ReferenceEdgeCount)) / TestNumSamples;
+	TestTrue(FString::Printf(TEXT("Mean edge %.4f vs reference %.4f"), HighEdgeSum / TestNumSamples, ReferenceEdgeSum / TestNumSamples), MeanDelta <= TestMaxStatisticDelta);
+	TestTrue(FString::Printf(TEXT("Edge fraction %.4f vs reference %.4f"), float(HighEdgeCount) / TestNumSamples, float(ReferenceEdgeCount) / TestNumSamples), EdgeFractionDelta <= TestMaxStatisticDelta);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionVoronoiFastMatchesHighTest, "RealityDistortion.Voronoi.FastMatchesHigh", RealityDistortionVoronoiTestFlags)
+
+bool FRealityDistortionVoronoiFastMatchesHighTest::RunTest(const FString& Parameters)
+{
+	FRandomStream RandomStream(0x52440117);
+	TArray<float> Errors;
+	Errors.Reserve(TestNumSamples);
+	for (int32 SampleIndex = 0; SampleIndex < TestNumSamples; ++SampleIndex)
+	{
+		const FVector3f WorldPos = MakeRandomWorldPos(RandomStream);
+		const float CellSize = MakeRandomCellSize(RandomStream);
+
+		const float HighEdge = CalculateRealityDistortionVoronoiEdge(WorldPos, CellSize, REALITY_DISTORTION_VORONOI_QUALITY_HIGH);
+		const float FastEdge = CalculateRealityDistortionVoronoiEdge(WorldPos, CellSize, REALITY_DISTORTION_VORONOI_QUALITY_FAST);
+		Errors.Add(FMath::Abs(FastEdge - HighEdge));
+	}
+
+	TestPointErrors(*this, TEXT("FAST vs HIGH"), Errors);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRealityDistortionVoronoiNoiseTextureMatchesHighTest, "RealityDistortion.Voronoi.NoiseTextureMatchesHigh", RealityDistortionVoronoiTestFlags)
+
+bool FRealityDistortionVoronoiNoiseTextureMatchesHighTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Period = REALITY_DISTORTION_VORONOI_TEXTURE_PERIOD;
+	constexpr int32 TextureSize = Period * REALITY_DISTORTION_VORONOI_TEXTURE_TEXELS_PER_CELL;
+	TestEqual(TEXT("Noise texel count"), GetRealityDistortionVoronoiNoiseTexels().Num(), TextureSize * TextureSize * TextureSize * 2);
+
+	// 纹理由按周期折回的 HIGH 生成。单元坐标在 [1, Period - 1) 内时 3x3x3 邻域不跨周期，折回与否结果相同，
+	// 因此可以直接对比 HIGH；纹理一侧再平移整数个周期，同时校验平铺。
+	FRandomStream RandomStream(0x52440217);
+	TArray<float> Errors;
+	Errors.Reserve(TestNumSamples);
+	for (int32 SampleIndex = 0; SampleIndex < TestNumSamples; ++SampleIndex)
+	{
+		const float CellSize = MakeRandomCellSize(RandomStream);
+		const FVector3f P(
+			RandomStream.FRandRange(1.0f, Period - 1.0f),
+			RandomStream.FRandRange(1.0f, Period - 1.0f),
+			RandomStream.FRandRange(1.0f, Period - 1.0f));
+		const FVector3f TileOffset(
+			float(RandomStream.RandRange(-32, 32) * Period),
+			float(RandomStream.RandRange(-32, 32) * Period),
+			float(RandomStream.RandRange(-32, 32) * Period));
+
+		const float HighEdge = CalculateRealityDistortionVoronoiEdge(P * CellSize, CellSize, REALITY_DISTORTION_VORONOI_QUALITY_HIGH);
+		const float TextureEdge = CalculateRealityDistortionVoronoiEdge((P + TileOffset) * CellSize, CellSize, REALITY_DISTORTION_VORONOI_QUALITY_NOISE_TEXTURE);
+		Errors.Add(FMath::Abs(TextureEdge - HighEdge));
+	}
+
+	TestPointErrors(*this, TEXT("NOISE_TEXTURE vs HIGH"), Errors);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS